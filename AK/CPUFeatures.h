@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Platform.h>
+#include <AK/Types.h>
+
+#if ARCH(X86_64)
+#    include <cpuid.h>
+#endif
+
+namespace AK {
+
+#if ARCH(X86_64)
+// Whether code built with [[gnu::target("avx2")]] can run on this CPU.
+inline bool cpu_supports_avx2()
+{
+    u32 eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    constexpr u32 osxsave_bit = 1u << 27;
+    constexpr u32 avx_bit = 1u << 28;
+    if ((ecx & (osxsave_bit | avx_bit)) != (osxsave_bit | avx_bit))
+        return false;
+
+    // The kernel also needs to preserve the upper halves of the YMM registers across context switches
+    u32 xcr0_low, xcr0_high;
+    asm volatile("xgetbv"
+                 : "=a"(xcr0_low), "=d"(xcr0_high)
+                 : "c"(0));
+    constexpr u32 sse_and_avx_state = 0b110;
+    if ((xcr0_low & sse_and_avx_state) != sse_and_avx_state)
+        return false;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    constexpr u32 avx2_bit = 1u << 5;
+    return (ebx & avx2_bit) != 0;
+}
+#endif
+
+}
+
+#if ARCH(X86_64)
+using AK::cpu_supports_avx2;
+#endif
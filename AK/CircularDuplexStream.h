@@ -46,9 +46,14 @@ public:
 
         const auto nread = min(bytes.size(), m_queue.size());
 
-        for (size_t idx = 0; idx < nread; ++idx)
-            bytes[idx] = m_queue.dequeue();
-
+        // The unread bytes wrap around the end of the storage at most once.
+        const auto head = m_queue.head_index();
+        const auto nread_until_wrap = min(nread, Capacity - head);
+        __builtin_memcpy(bytes.data(), m_queue.m_storage + head, nread_until_wrap);
+        __builtin_memcpy(bytes.data() + nread_until_wrap, m_queue.m_storage, nread - nread_until_wrap);
+
+        m_queue.m_head = (head + nread) % Capacity;
+        m_queue.m_size -= nread;
         return nread;
     }
 
@@ -96,6 +101,41 @@ public:
     bool unreliable_eof() const override { return eof(); }
     bool eof() const { return m_queue.size() == 0; }
 
+    size_t remaining_space() const { return Capacity - m_queue.size(); }
+
+    // The caller has to make sure that there is space for the byte.
+    ALWAYS_INLINE void append_byte(u8 byte)
+    {
+        VERIFY(m_queue.size() < Capacity);
+        m_queue.m_storage[(m_queue.head_index() + m_queue.size()) % Capacity] = byte;
+        ++m_queue.m_size;
+        ++m_total_written;
+    }
+
+    // Appends count bytes starting seekback bytes before the end, like an LZ77 back reference does.
+    // The copied range may overlap the appended one, which repeats the last seekback bytes.
+    bool append_from_seekback(size_t seekback, size_t count)
+    {
+        if (seekback == 0 || seekback > Capacity || seekback > m_total_written || count > remaining_space()) {
+            set_recoverable_error();
+            return false;
+        }
+
+        auto destination = (m_queue.head_index() + m_queue.size()) % Capacity;
+        auto source = (destination + Capacity - seekback) % Capacity;
+        for (size_t idx = 0; idx < count; ++idx) {
+            m_queue.m_storage[destination] = m_queue.m_storage[source];
+            if (++destination == Capacity)
+                destination = 0;
+            if (++source == Capacity)
+                source = 0;
+        }
+
+        m_queue.m_size += count;
+        m_total_written += count;
+        return true;
+    }
+
     size_t remaining_contiguous_space() const
     {
         return min(Capacity - m_queue.size(), m_queue.capacity() - (m_queue.head_index() + m_queue.size()) % Capacity);
@@ -34,6 +34,21 @@ ALWAYS_INLINE static constexpr u32x4 expand4(u32 u)
     return u32x4 { u, u, u, u };
 }
 
+ALWAYS_INLINE static constexpr f32x8 expand8(float f)
+{
+    return f32x8 { f, f, f, f, f, f, f, f };
+}
+
+ALWAYS_INLINE static constexpr i32x8 expand8(i32 i)
+{
+    return i32x8 { i, i, i, i, i, i, i, i };
+}
+
+ALWAYS_INLINE static constexpr u32x8 expand8(u32 u)
+{
+    return u32x8 { u, u, u, u, u, u, u, u };
+}
+
 // Casting
 
 template<typename TSrc>
@@ -54,6 +69,24 @@ ALWAYS_INLINE static f32x4 to_f32x4(TSrc v)
     return __builtin_convertvector(v, f32x4);
 }
 
+template<typename TSrc>
+ALWAYS_INLINE static u32x8 to_u32x8(TSrc v)
+{
+    return __builtin_convertvector(v, u32x8);
+}
+
+template<typename TSrc>
+ALWAYS_INLINE static i32x8 to_i32x8(TSrc v)
+{
+    return __builtin_convertvector(v, i32x8);
+}
+
+template<typename TSrc>
+ALWAYS_INLINE static f32x8 to_f32x8(TSrc v)
+{
+    return __builtin_convertvector(v, f32x8);
+}
+
 // Masking
 
 ALWAYS_INLINE static i32 maskbits(i32x4 mask)
@@ -86,6 +119,35 @@ ALWAYS_INLINE static int maskcount(i32x4 mask)
     return count_lut[maskbits(mask)];
 }
 
+ALWAYS_INLINE static i32 maskbits(i32x8 mask)
+{
+#if defined(__AVX__)
+    return __builtin_ia32_movmskps256((f32x8)mask);
+#else
+    return maskbits(i32x4 { mask[0], mask[1], mask[2], mask[3] }) | (maskbits(i32x4 { mask[4], mask[5], mask[6], mask[7] }) << 4);
+#endif
+}
+
+ALWAYS_INLINE static bool all(i32x8 mask)
+{
+    return maskbits(mask) == 255;
+}
+
+ALWAYS_INLINE static bool any(i32x8 mask)
+{
+    return maskbits(mask) != 0;
+}
+
+ALWAYS_INLINE static bool none(i32x8 mask)
+{
+    return maskbits(mask) == 0;
+}
+
+ALWAYS_INLINE static int maskcount(i32x8 mask)
+{
+    return __builtin_popcount(maskbits(mask));
+}
+
 // Load / Store
 
 ALWAYS_INLINE static f32x4 load4(float const* a, float const* b, float const* c, float const* d)
@@ -59,6 +59,48 @@ ALWAYS_INLINE static f32x4 exp(f32x4 v)
     };
 }
 
+ALWAYS_INLINE static f32x8 truncate_int_range(f32x8 v)
+{
+    return to_f32x8(to_i32x8(v));
+}
+
+ALWAYS_INLINE static f32x8 floor_int_range(f32x8 v)
+{
+    auto t = truncate_int_range(v);
+    return t > v ? t - 1.0f : t;
+}
+
+ALWAYS_INLINE static f32x8 ceil_int_range(f32x8 v)
+{
+    auto t = truncate_int_range(v);
+    return t < v ? t + 1.0f : t;
+}
+
+ALWAYS_INLINE static f32x8 frac_int_range(f32x8 v)
+{
+    return v - floor_int_range(v);
+}
+
+ALWAYS_INLINE static f32x8 clamp(f32x8 v, f32x8 min, f32x8 max)
+{
+    return v < min ? min : (v > max ? max : v);
+}
+
+ALWAYS_INLINE static f32x8 exp(f32x8 v)
+{
+    // FIXME: Like exp(f32x4), this calls the scalar expf for every lane and wants a vectorized algorithm as well.
+    return f32x8 {
+        expf(v[0]),
+        expf(v[1]),
+        expf(v[2]),
+        expf(v[3]),
+        expf(v[4]),
+        expf(v[5]),
+        expf(v[6]),
+        expf(v[7]),
+    };
+}
+
 }
 
 #pragma GCC diagnostic pop
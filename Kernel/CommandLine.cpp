@@ -301,4 +301,13 @@ UNMAP_AFTER_INIT size_t CommandLine::switch_to_tty() const
     }
     PANIC("Invalid default tty value: {}", default_tty);
 }
+
+size_t CommandLine::disk_cache_size() const
+{
+    const auto value = lookup("disk_cache_size"sv).value_or("64"sv);
+    auto size = value.to_uint();
+    if (size.has_value() && size.value() >= 1)
+        return size.value();
+    PANIC("Invalid disk_cache_size value: {}", value);
+}
 }
@@ -89,6 +89,7 @@ public:
     [[nodiscard]] StringView root_device() const;
     [[nodiscard]] bool is_nvme_polling_enabled() const;
     [[nodiscard]] size_t switch_to_tty() const;
+    [[nodiscard]] size_t disk_cache_size() const;
 
 private:
     CommandLine(StringView);
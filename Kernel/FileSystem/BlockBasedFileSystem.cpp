@@ -4,36 +4,111 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/FixedArray.h>
 #include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/Debug.h>
+#include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Process.h>
 
 namespace Kernel {
 
+// Blocks read ahead of a sequential reader. The data is only copied into the cache entries of these blocks once
+// they are actually read, waiting for the device if the request hasn't completed by then.
+// Dropping the last reference to a request that is still in flight waits for the device as well, so references
+// taken out of cache entries have to be dropped only after the shard lock has been released.
+class ReadaheadRequest : public RefCounted<ReadaheadRequest> {
+public:
+    static ErrorOr<NonnullRefPtr<ReadaheadRequest>> try_create(BlockBasedFileSystem::BlockIndex first_block, size_t block_count, size_t block_size)
+    {
+        auto buffer = TRY(KBuffer::try_create_with_size(block_count * block_size, Memory::Region::Access::ReadWrite, "Readahead"sv));
+        return adopt_nonnull_ref_or_enomem(new (nothrow) ReadaheadRequest(first_block, block_count, block_size, move(buffer)));
+    }
+
+    ~ReadaheadRequest()
+    {
+        // The device keeps writing to the buffer until the request has completed.
+        if (m_request)
+            (void)m_request->wait();
+    }
+
+    ErrorOr<void> start(BlockDevice& device)
+    {
+        MutexLocker locker(m_lock);
+        auto device_blocks_per_block = m_block_size / device.block_size();
+        m_request = TRY(device.try_make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read,
+            m_first_block.value() * device_blocks_per_block, m_block_count * device_blocks_per_block,
+            UserOrKernelBuffer::for_kernel_buffer(m_buffer->data()), m_buffer->size()));
+        return {};
+    }
+
+    // Waits for the device to fill the buffer. Nothing that other readers of the cache might need, like a shard lock,
+    // may be held while waiting.
+    void wait()
+    {
+        RefPtr<AsyncBlockDeviceRequest> request;
+        {
+            MutexLocker locker(m_lock);
+            request = m_request;
+        }
+        m_succeeded = request && request->wait().request_result() == AsyncDeviceRequest::Success;
+        m_waited_for = true;
+    }
+
+    bool has_been_waited_for() const { return m_waited_for; }
+
+    bool copy_block(BlockBasedFileSystem::BlockIndex block_index, u8* destination)
+    {
+        VERIFY(m_waited_for);
+        if (!m_succeeded)
+            return false;
+
+        VERIFY(block_index >= m_first_block && block_index.value() < m_first_block.value() + m_block_count);
+        memcpy(destination, m_buffer->data() + (block_index.value() - m_first_block.value()) * m_block_size, m_block_size);
+        return true;
+    }
+
+private:
+    ReadaheadRequest(BlockBasedFileSystem::BlockIndex first_block, size_t block_count, size_t block_size, NonnullOwnPtr<KBuffer> buffer)
+        : m_first_block(first_block)
+        , m_block_count(block_count)
+        , m_block_size(block_size)
+        , m_buffer(move(buffer))
+    {
+    }
+
+    BlockBasedFileSystem::BlockIndex m_first_block;
+    size_t m_block_count { 0 };
+    size_t m_block_size { 0 };
+    NonnullOwnPtr<KBuffer> m_buffer;
+    Mutex m_lock { "ReadaheadRequest"sv };
+    RefPtr<AsyncBlockDeviceRequest> m_request;
+    Atomic<bool> m_succeeded { false };
+    Atomic<bool> m_waited_for { false };
+};
+
 struct CacheEntry {
     IntrusiveListNode<CacheEntry> list_node;
     BlockBasedFileSystem::BlockIndex block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
+    RefPtr<ReadaheadRequest> readahead;
 };
 
-class DiskCache {
-public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_fs(fs)
-        , m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
-    {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * m_fs.block_size();
-            m_clean_list.append(entries()[i]);
-        }
-    }
+struct DiskCacheChunk {
+    NonnullOwnPtr<KBuffer> cached_block_data;
+    FixedArray<CacheEntry> entries;
+};
 
-    ~DiskCache() = default;
+class DiskCache;
 
+// A part of the cache with its own lock, so that blocks in different shards can be accessed concurrently.
+class DiskCacheShard {
+public:
     bool is_dirty() const { return !m_dirty_list.is_empty(); }
     bool entry_is_dirty(CacheEntry const& entry) const { return m_dirty_list.contains(entry); }
 
@@ -53,61 +128,162 @@ public:
         m_clean_list.prepend(entry);
     }
 
-    CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index) const
+    CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index)
     {
         auto it = m_hash.find(block_index);
         if (it == m_hash.end())
             return nullptr;
-        auto& entry = const_cast<CacheEntry&>(*it->value);
+        auto& entry = *it->value;
         VERIFY(entry.block_index == block_index);
         return &entry;
     }
 
-    ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index) const
-    {
-        if (auto* entry = get(block_index))
-            return entry;
-
-        if (m_clean_list.is_empty()) {
-            // Not a single clean entry! Flush writes and try again.
-            // NOTE: We want to make sure we only call FileBackedFileSystem flush here,
-            //       not some FileBackedFileSystem subclass flush!
-            m_fs.flush_writes_impl();
-            return ensure(block_index);
-        }
+    // If the entry that is handed out was waiting for data read ahead before, that request is moved to `stale_readahead`.
+    ErrorOr<CacheEntry*> ensure(DiskCache&, BlockBasedFileSystem::BlockIndex, RefPtr<ReadaheadRequest>& stale_readahead);
+    ErrorOr<void> grow(size_t block_size, size_t entry_count);
+    size_t flush_dirty_entries(BlockBasedFileSystem&);
+
+private:
+    NonnullOwnPtrVector<DiskCacheChunk> m_chunks;
+    HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
+    IntrusiveList<&CacheEntry::list_node> m_clean_list;
+    IntrusiveList<&CacheEntry::list_node> m_dirty_list;
+};
 
-        VERIFY(m_clean_list.last());
-        auto& new_entry = *m_clean_list.last();
-        m_clean_list.prepend(new_entry);
+class DiskCache {
+public:
+    static constexpr size_t ShardCount = 16;
+    static constexpr size_t EntriesPerChunk = 64;
 
-        m_hash.remove(new_entry.block_index);
-        TRY(m_hash.try_set(block_index, &new_entry));
+    DiskCache(BlockBasedFileSystem& fs, size_t maximum_entry_count)
+        : m_fs(fs)
+        , m_maximum_entry_count(maximum_entry_count)
+    {
+    }
 
-        new_entry.block_index = block_index;
-        new_entry.has_data = false;
+    ~DiskCache() = default;
 
-        return &new_entry;
+    ErrorOr<void> initialize()
+    {
+        for (auto& shard : m_shards) {
+            TRY(shard.with_exclusive([&](auto& shard) { return shard.grow(m_fs.block_size(), EntriesPerChunk); }));
+            m_entry_count += EntriesPerChunk;
+        }
+        return {};
     }
 
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries->data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
+    BlockBasedFileSystem& fs() { return m_fs; }
+
+    MutexProtected<DiskCacheShard>& shard_for(BlockBasedFileSystem::BlockIndex block_index) { return m_shards[block_index.value() % ShardCount]; }
 
     template<typename Callback>
-    void for_each_dirty_entry(Callback callback)
+    void for_each_shard(Callback callback)
+    {
+        for (auto& shard : m_shards)
+            shard.with_exclusive(callback);
+    }
+
+    // The cache grows one chunk at a time, up to its maximum size, and only while it takes up no more than a
+    // quarter of the memory that would be free without it.
+    bool try_reserve_chunk()
+    {
+        auto free_bytes = MM.get_system_memory_info().user_physical_pages_uncommitted * PAGE_SIZE;
+        auto entry_count = m_entry_count.load(AK::MemoryOrder::memory_order_relaxed);
+        do {
+            auto new_entry_count = entry_count + EntriesPerChunk;
+            if (new_entry_count > m_maximum_entry_count)
+                return false;
+            if (new_entry_count * m_fs.block_size() * 4 > free_bytes + entry_count * m_fs.block_size())
+                return false;
+        } while (!m_entry_count.compare_exchange_strong(entry_count, entry_count + EntriesPerChunk, AK::MemoryOrder::memory_order_relaxed));
+        return true;
+    }
+
+    void release_chunk()
     {
-        for (auto& entry : m_dirty_list)
-            callback(entry);
+        m_entry_count.fetch_sub(EntriesPerChunk, AK::MemoryOrder::memory_order_relaxed);
     }
 
 private:
     BlockBasedFileSystem& m_fs;
-    mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
-    mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
-    mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
-    NonnullOwnPtr<KBuffer> m_cached_block_data;
-    NonnullOwnPtr<KBuffer> m_entries;
+    size_t const m_maximum_entry_count { 0 };
+    Atomic<size_t> m_entry_count { 0 };
+    Array<MutexProtected<DiskCacheShard>, ShardCount> m_shards;
 };
 
+ErrorOr<void> DiskCacheShard::grow(size_t block_size, size_t entry_count)
+{
+    auto cached_block_data = TRY(KBuffer::try_create_with_size(entry_count * block_size, Memory::Region::Access::ReadWrite, "DiskCache"sv));
+    auto entries = TRY(FixedArray<CacheEntry>::try_create(entry_count));
+    auto chunk = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCacheChunk { move(cached_block_data), move(entries) }));
+
+    for (size_t i = 0; i < entry_count; ++i) {
+        auto& entry = chunk->entries[i];
+        entry.data = chunk->cached_block_data->data() + i * block_size;
+        m_clean_list.append(entry);
+    }
+    TRY(m_chunks.try_append(move(chunk)));
+    return {};
+}
+
+ErrorOr<CacheEntry*> DiskCacheShard::ensure(DiskCache& cache, BlockBasedFileSystem::BlockIndex block_index, RefPtr<ReadaheadRequest>& stale_readahead)
+{
+    if (auto* entry = get(block_index))
+        return entry;
+
+    if (m_clean_list.is_empty() && cache.try_reserve_chunk()) {
+        if (auto result = grow(cache.fs().block_size(), DiskCache::EntriesPerChunk); result.is_error())
+            cache.release_chunk();
+    }
+
+    if (m_clean_list.is_empty()) {
+        // Not a single clean entry! Flush the writes in this shard and try again.
+        flush_dirty_entries(cache.fs());
+    }
+
+    VERIFY(m_clean_list.last());
+    auto& new_entry = *m_clean_list.last();
+    m_clean_list.prepend(new_entry);
+
+    // Entries that were never used don't have a hash entry of their own yet.
+    if (auto it = m_hash.find(new_entry.block_index); it != m_hash.end() && it->value == &new_entry)
+        m_hash.remove(it);
+    TRY(m_hash.try_set(block_index, &new_entry));
+
+    new_entry.block_index = block_index;
+    new_entry.has_data = false;
+    stale_readahead = move(new_entry.readahead);
+
+    return &new_entry;
+}
+
+size_t DiskCacheShard::flush_dirty_entries(BlockBasedFileSystem& fs)
+{
+    size_t count = 0;
+    for (auto& entry : m_dirty_list) {
+        auto base_offset = entry.block_index.value() * fs.block_size();
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+        [[maybe_unused]] auto rc = fs.file_description().write(base_offset, entry_data_buffer, fs.block_size());
+        ++count;
+    }
+    mark_all_clean();
+    return count;
+}
+
+// The readahead request the data was copied from (if any) is moved to `used_readahead`. It has to have been waited for.
+static ErrorOr<void> read_entry_data(BlockBasedFileSystem const& fs, CacheEntry& entry, RefPtr<ReadaheadRequest>& used_readahead)
+{
+    used_readahead = move(entry.readahead);
+    if (!used_readahead || !used_readahead->copy_block(entry.block_index, entry.data)) {
+        auto base_offset = entry.block_index.value() * fs.block_size();
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+        auto nread = TRY(fs.file_description().read(entry_data_buffer, base_offset, fs.block_size()));
+        VERIFY(nread == fs.block_size());
+    }
+    entry.has_data = true;
+    return {};
+}
+
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
     : FileBackedFileSystem(file_description)
 {
@@ -121,16 +297,44 @@ BlockBasedFileSystem::~BlockBasedFileSystem()
 ErrorOr<void> BlockBasedFileSystem::initialize()
 {
     VERIFY(block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size(DiskCache::EntryCount * block_size()));
-    auto entries_data = TRY(KBuffer::try_create_with_size(DiskCache::EntryCount * sizeof(CacheEntry)));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
-
-    m_cache.with_exclusive([&](auto& cache) {
-        cache = move(disk_cache);
-    });
+    auto maximum_entry_count = max(kernel_command_line().disk_cache_size() * MiB / block_size(), DiskCache::ShardCount * DiskCache::EntriesPerChunk);
+    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, maximum_entry_count)));
+    TRY(disk_cache->initialize());
+    m_cache = move(disk_cache);
     return {};
 }
 
+DiskCache& BlockBasedFileSystem::cache() const
+{
+    return *m_cache;
+}
+
+ErrorOr<void> BlockBasedFileSystem::with_cache_entry(BlockIndex index, bool needs_data, Function<ErrorOr<void>(DiskCacheShard&, CacheEntry&)> callback) const
+{
+    for (;;) {
+        RefPtr<ReadaheadRequest> stale_readahead;
+        RefPtr<ReadaheadRequest> used_readahead;
+        RefPtr<ReadaheadRequest> pending_readahead;
+        TRY(cache().shard_for(index).with_exclusive([&](auto& shard) -> ErrorOr<void> {
+            auto* entry = TRY(shard.ensure(cache(), index, stale_readahead));
+            if (needs_data && !entry->has_data) {
+                if (entry->readahead && !entry->readahead->has_been_waited_for()) {
+                    pending_readahead = entry->readahead;
+                    return {};
+                }
+                TRY(read_entry_data(*this, *entry, used_readahead));
+            }
+            return callback(shard, *entry);
+        }));
+        if (!pending_readahead)
+            return {};
+
+        // The shard stays usable while the device is busy. The entry may have been handed out for another block
+        // by the time we get back to it, so we start over.
+        pending_readahead->wait();
+    }
+}
+
 ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, const UserOrKernelBuffer& data, size_t count, u64 offset, bool allow_cache)
 {
     VERIFY(m_logical_block_size);
@@ -144,24 +348,22 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, const UserOrKe
 
     TRY(data.read(buffered_data.bytes()));
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
-        if (!allow_cache) {
-            flush_specific_block_if_needed(index);
-            u64 base_offset = index.value() * block_size() + offset;
-            auto nwritten = TRY(file_description().write(base_offset, data, count));
-            VERIFY(nwritten == count);
-            return {};
-        }
+    if (!allow_cache) {
+        flush_specific_block_if_needed(index);
+        u64 base_offset = index.value() * block_size() + offset;
+        auto nwritten = TRY(file_description().write(base_offset, data, count));
+        VERIFY(nwritten == count);
+        return {};
+    }
 
-        auto entry = TRY(cache->ensure(index));
-        if (count < block_size()) {
-            // Fill the cache first.
-            TRY(read_block(index, nullptr, block_size()));
-        }
-        memcpy(entry->data + offset, buffered_data.data(), count);
+    RefPtr<ReadaheadRequest> outdated_readahead;
+    return with_cache_entry(index, count < block_size(), [&](auto& shard, auto& entry) -> ErrorOr<void> {
+        memcpy(entry.data + offset, buffered_data.data(), count);
 
-        cache->mark_dirty(*entry);
-        entry->has_data = true;
+        // Anything read ahead for this block is outdated now.
+        outdated_readahead = move(entry.readahead);
+        shard.mark_dirty(entry);
+        entry.has_data = true;
         return {};
     });
 }
@@ -212,33 +414,29 @@ ErrorOr<void> BlockBasedFileSystem::write_blocks(BlockIndex index, unsigned coun
     return {};
 }
 
-ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuffer* buffer, size_t count, u64 offset, bool allow_cache) const
+ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuffer* buffer, size_t count, u64 offset, bool allow_cache, ReadaheadState* readahead_state) const
 {
     VERIFY(m_logical_block_size);
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
-        if (!allow_cache) {
-            const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
-            u64 base_offset = index.value() * block_size() + offset;
-            auto nread = TRY(file_description().read(*buffer, base_offset, count));
-            VERIFY(nread == count);
-            return {};
-        }
+    if (!allow_cache) {
+        const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
+        u64 base_offset = index.value() * block_size() + offset;
+        auto nread = TRY(file_description().read(*buffer, base_offset, count));
+        VERIFY(nread == count);
+        return {};
+    }
 
-        auto* entry = TRY(cache->ensure(index));
-        if (!entry->has_data) {
-            auto base_offset = index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
-            auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
-            VERIFY(nread == block_size());
-            entry->has_data = true;
-        }
+    TRY(with_cache_entry(index, true, [&](auto&, auto& entry) -> ErrorOr<void> {
         if (buffer)
-            TRY(buffer->write(entry->data + offset, count));
+            TRY(buffer->write(entry.data + offset, count));
         return {};
-    });
+    }));
+
+    if (readahead_state)
+        note_cached_read(index, *readahead_state);
+    return {};
 }
 
 ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count, UserOrKernelBuffer& buffer, bool allow_cache) const
@@ -257,15 +455,84 @@ ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count
     return {};
 }
 
+void BlockBasedFileSystem::note_cached_read(BlockIndex index, ReadaheadState& readahead_state) const
+{
+    auto readahead_start = readahead_state.with([&](auto& state) -> Optional<BlockIndex> {
+        if (index == state.next_block) {
+            ++state.run_length;
+        } else {
+            state.run_length = 0;
+            state.readahead_end = 0;
+        }
+        state.next_block = index.value() + 1;
+
+        if (state.run_length < ReadaheadTriggerLength)
+            return {};
+
+        // Start the next readahead once the reader is halfway through the blocks that were read ahead last time.
+        if (index.value() + readahead_block_count() / 2 < state.readahead_end.value())
+            return {};
+        auto first_block = max(state.next_block, state.readahead_end);
+        state.readahead_end = first_block.value() + readahead_block_count();
+        return first_block;
+    });
+
+    if (readahead_start.has_value())
+        start_readahead(readahead_start.value());
+}
+
+void BlockBasedFileSystem::start_readahead(BlockIndex first_block) const
+{
+    if (!file().is_block_device())
+        return;
+    auto& device = static_cast<BlockDevice&>(const_cast<File&>(file()));
+    if (block_size() % device.block_size() != 0)
+        return;
+
+    // Only the blocks up to the first one that is already cached are read.
+    size_t block_count = 0;
+    for (; block_count < readahead_block_count(); ++block_count) {
+        BlockIndex index { first_block.value() + block_count };
+        auto is_cached = cache().shard_for(index).with_exclusive([&](auto& shard) { return shard.get(index) != nullptr; });
+        if (is_cached)
+            break;
+    }
+    if (block_count == 0)
+        return;
+
+    auto readahead_or_error = ReadaheadRequest::try_create(first_block, block_count, block_size());
+    if (readahead_or_error.is_error())
+        return;
+    auto readahead = readahead_or_error.release_value();
+
+    // The request is attached to the cache entries before it is started, so that any of these blocks written in
+    // the meantime can't be overwritten with older data from the device.
+    for (size_t i = 0; i < block_count; ++i) {
+        BlockIndex index { first_block.value() + i };
+        RefPtr<ReadaheadRequest> stale_readahead;
+        cache().shard_for(index).with_exclusive([&](auto& shard) {
+            if (shard.get(index))
+                return;
+            auto entry_or_error = shard.ensure(cache(), index, stale_readahead);
+            if (!entry_or_error.is_error())
+                entry_or_error.value()->readahead = readahead;
+        });
+    }
+
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::start_readahead {}, count={}", first_block, block_count);
+    if (auto result = readahead->start(device); result.is_error())
+        dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::start_readahead {}: {}", first_block, result.error());
+}
+
 void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 {
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
+    cache().shard_for(index).with_exclusive([&](auto& shard) {
+        if (!shard.is_dirty())
             return;
-        auto* entry = cache->get(index);
+        auto* entry = shard.get(index);
         if (!entry)
             return;
-        if (!cache->entry_is_dirty(*entry))
+        if (!shard.entry_is_dirty(*entry))
             return;
         size_t base_offset = entry->block_index.value() * block_size();
         auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
@@ -276,18 +543,12 @@ void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 void BlockBasedFileSystem::flush_writes_impl()
 {
     size_t count = 0;
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
-            return;
-        cache->for_each_dirty_entry([&](CacheEntry& entry) {
-            auto base_offset = entry.block_index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
-            ++count;
-        });
-        cache->mark_all_clean();
-        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
+    cache().for_each_shard([&](auto& shard) {
+        if (shard.is_dirty())
+            count += shard.flush_dirty_entries(*this);
     });
+    if (count > 0)
+        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
 }
 
 void BlockBasedFileSystem::flush_writes()
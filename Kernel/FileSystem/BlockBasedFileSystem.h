@@ -6,8 +6,9 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
-#include <Kernel/Locking/MutexProtected.h>
+#include <Kernel/Locking/SpinlockProtected.h>
 
 namespace Kernel {
 
@@ -20,13 +21,21 @@ public:
 
     u64 logical_block_size() const { return m_logical_block_size; };
 
+    // Where a stream of reads (for instance those of one inode) is heading, so that a sequential reader can be read ahead of.
+    struct SequentialReadState {
+        BlockIndex next_block { 0 };
+        size_t run_length { 0 };
+        BlockIndex readahead_end { 0 };
+    };
+    using ReadaheadState = SpinlockProtected<SequentialReadState>;
+
     virtual void flush_writes() override;
     void flush_writes_impl();
 
 protected:
     explicit BlockBasedFileSystem(OpenFileDescription&);
 
-    ErrorOr<void> read_block(BlockIndex, UserOrKernelBuffer*, size_t count, u64 offset = 0, bool allow_cache = true) const;
+    ErrorOr<void> read_block(BlockIndex, UserOrKernelBuffer*, size_t count, u64 offset = 0, bool allow_cache = true, ReadaheadState* = nullptr) const;
     ErrorOr<void> read_blocks(BlockIndex, unsigned count, UserOrKernelBuffer&, bool allow_cache = true) const;
 
     ErrorOr<void> raw_read(BlockIndex, UserOrKernelBuffer&);
@@ -41,10 +50,20 @@ protected:
     u64 m_logical_block_size { 512 };
 
 private:
+    // Blocks are read ahead once this many consecutive blocks have been read, at most 64 KiB at a time.
+    static constexpr size_t ReadaheadTriggerLength = 4;
+    size_t readahead_block_count() const { return max<size_t>(1, min<size_t>(32, 64 * KiB / block_size())); }
+
     DiskCache& cache() const;
+
+    // Calls `callback` with the shard of the block locked, once the block's cache entry holds data if `needs_data` is set.
+    ErrorOr<void> with_cache_entry(BlockIndex, bool needs_data, Function<ErrorOr<void>(DiskCacheShard&, CacheEntry&)> callback) const;
+
     void flush_specific_block_if_needed(BlockIndex index);
+    void note_cached_read(BlockIndex, ReadaheadState&) const;
+    void start_readahead(BlockIndex first_block) const;
 
-    mutable MutexProtected<OwnPtr<DiskCache>> m_cache;
+    mutable OwnPtr<DiskCache> m_cache;
 };
 
 }
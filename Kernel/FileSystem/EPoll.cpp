@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static BlockFlags block_flags_for_events(u32 events)
+{
+    BlockFlags block_flags = BlockFlags::Exception;
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        block_flags |= BlockFlags::ReadPriority;
+    return block_flags;
+}
+
+static u32 events_for_unblocked_flags(BlockFlags unblocked_flags)
+{
+    u32 events = 0;
+    if (has_flag(unblocked_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(unblocked_flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    if (has_flag(unblocked_flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    if (has_flag(unblocked_flags, BlockFlags::ReadHangUp))
+        events |= EPOLLRDHUP;
+    if (has_flag(unblocked_flags, BlockFlags::WriteError))
+        events |= EPOLLERR;
+    if (has_flag(unblocked_flags, BlockFlags::WriteHangUp))
+        events |= EPOLLHUP;
+    return events;
+}
+
+EPoll::Watch::Watch(EPoll& epoll, int fd, OpenFileDescription& description, epoll_event const& event)
+    : FileBlocker(NoThread::Tag)
+    , m_epoll(epoll)
+    , m_fd(fd)
+    , m_description(description)
+    , m_events(event.events)
+    , m_data(event.data)
+{
+}
+
+bool EPoll::Watch::register_with_file()
+{
+    // NOTE: Adding ourselves runs unblock_if_conditions_are_met() once, which queues us if we're ready already.
+    //       That always returns false, so we always end up in the blocker set.
+    return add_to_blocker_set(m_description.blocker_set());
+}
+
+void EPoll::Watch::set_event(epoll_event const& event)
+{
+    SpinlockLocker lock(m_lock);
+    m_events = event.events;
+    m_data = event.data;
+    m_enabled = true;
+}
+
+bool EPoll::Watch::unblock_if_conditions_are_met(bool, void*)
+{
+    BlockFlags block_flags;
+    {
+        SpinlockLocker lock(m_lock);
+        if (!m_enabled)
+            return false;
+        block_flags = block_flags_for_events(m_events);
+    }
+
+    if (m_description.should_unblock(block_flags) != BlockFlags::None)
+        m_epoll.watch_became_ready(*this);
+
+    // We're never blocked on ourselves, so we have to stay in the blocker set.
+    return false;
+}
+
+auto EPoll::Watch::take_ready_event() -> Optional<ReadyEvent>
+{
+    BlockFlags block_flags;
+    {
+        SpinlockLocker lock(m_lock);
+        if (!m_enabled)
+            return {};
+        block_flags = block_flags_for_events(m_events);
+    }
+
+    // The watch may have been queued a while ago, so check whether it's still ready.
+    auto unblocked_flags = m_description.should_unblock(block_flags);
+    if (unblocked_flags == BlockFlags::None)
+        return {};
+
+    SpinlockLocker lock(m_lock);
+    if (!m_enabled)
+        return {};
+    ReadyEvent ready_event {};
+    ready_event.event.events = events_for_unblocked_flags(unblocked_flags);
+    ready_event.event.data = m_data;
+    ready_event.is_level_triggered = !(m_events & (EPOLLET | EPOLLONESHOT));
+    if (m_events & EPOLLONESHOT)
+        m_enabled = false;
+    return ready_event;
+}
+
+ErrorOr<NonnullRefPtr<EPoll>> EPoll::try_create()
+{
+    return adopt_nonnull_ref_or_enomem(new (nothrow) EPoll);
+}
+
+EPoll::~EPoll()
+{
+    (void)close();
+}
+
+bool EPoll::can_read(const OpenFileDescription&, u64) const
+{
+    return m_ready_watches.with([](auto& list) { return !list.is_empty(); });
+}
+
+ErrorOr<void> EPoll::close()
+{
+    MutexLocker locker(m_lock);
+    while (!m_watches.is_empty())
+        remove_watch_locked(*m_watches.begin()->value);
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<KString>> EPoll::pseudo_path(const OpenFileDescription&) const
+{
+    return KString::formatted("EPoll:({})", m_watches.size());
+}
+
+ErrorOr<void> EPoll::add_watch(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    // Watching an EPoll from another one could make them wait on each other's locks.
+    if (description.is_epoll())
+        return EINVAL;
+
+    MutexLocker locker(m_lock);
+    if (auto it = m_watches.find(fd); it != m_watches.end()) {
+        if (&it->value->description() == &description)
+            return EEXIST;
+        // The fd has been closed and reused since it was added, but the old description lives on somewhere else.
+        remove_watch_locked(*it->value);
+    }
+
+    auto watch = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Watch(*this, fd, description, event)));
+    TRY(description.did_add_epoll_watch({}, *this));
+    auto& watch_ref = *watch;
+    if (auto result = m_watches.try_set(fd, move(watch)); result.is_error()) {
+        description.did_remove_epoll_watch({}, *this);
+        return result.release_error();
+    }
+
+    if (!watch_ref.register_with_file()) {
+        remove_watch_locked(watch_ref);
+        return EINVAL;
+    }
+    dbgln_if(EPOLL_DEBUG, "EPoll: Added watch for fd {}, events={:#x}", fd, event.events);
+    return {};
+}
+
+ErrorOr<void> EPoll::modify_watch(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    MutexLocker locker(m_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end() || &it->value->description() != &description)
+        return ENOENT;
+
+    auto& watch = *it->value;
+    watch.set_event(event);
+    // The new interest set may be satisfied already, and EPOLLONESHOT watches are armed again.
+    watch.unblock_if_conditions_are_met(false, nullptr);
+    dbgln_if(EPOLL_DEBUG, "EPoll: Modified watch for fd {}, events={:#x}", fd, event.events);
+    return {};
+}
+
+ErrorOr<void> EPoll::remove_watch(int fd, OpenFileDescription& description)
+{
+    MutexLocker locker(m_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end() || &it->value->description() != &description)
+        return ENOENT;
+
+    remove_watch_locked(*it->value);
+    dbgln_if(EPOLL_DEBUG, "EPoll: Removed watch for fd {}", fd);
+    return {};
+}
+
+void EPoll::remove_watch_locked(Watch& watch)
+{
+    VERIFY(m_lock.is_locked());
+
+    // Once we're out of the blocker set, nobody else can queue the watch anymore.
+    watch.unregister_from_file();
+    m_ready_watches.with([&](auto& list) {
+        if (watch.m_ready_list_node.is_in_list())
+            list.remove(watch);
+    });
+    watch.description().did_remove_epoll_watch({}, *this);
+    m_watches.remove(watch.fd());
+}
+
+void EPoll::description_will_be_destroyed(Badge<OpenFileDescription>, OpenFileDescription& description)
+{
+    MutexLocker locker(m_lock);
+    Vector<int, 4> fds_to_remove;
+    for (auto& it : m_watches) {
+        if (&it.value->description() == &description)
+            fds_to_remove.append(it.key);
+    }
+    for (auto fd : fds_to_remove)
+        remove_watch_locked(*m_watches.get(fd).value());
+}
+
+void EPoll::watch_became_ready(Watch& watch)
+{
+    bool was_queued = m_ready_watches.with([&](auto& list) {
+        if (watch.m_ready_list_node.is_in_list())
+            return false;
+        list.append(watch);
+        return true;
+    });
+    if (was_queued)
+        evaluate_block_conditions();
+}
+
+size_t EPoll::collect_ready_events(Span<epoll_event> events)
+{
+    MutexLocker locker(m_lock);
+
+    // Level-triggered watches that are still ready go to the back of the list afterwards,
+    // so that a few busy descriptions can't starve the others when the events buffer is small.
+    ReadyList still_ready;
+    size_t count = 0;
+    while (count < events.size()) {
+        auto* watch = m_ready_watches.with([](auto& list) { return list.take_first(); });
+        if (!watch)
+            break;
+        auto ready_event = watch->take_ready_event();
+        if (!ready_event.has_value())
+            continue;
+        events[count++] = ready_event->event;
+        if (ready_event->is_level_triggered)
+            m_ready_watches.with([&](auto&) { still_ready.append(*watch); });
+    }
+
+    m_ready_watches.with([&](auto& list) {
+        while (auto* watch = still_ready.take_first())
+            list.append(*watch);
+    });
+    return count;
+}
+
+}
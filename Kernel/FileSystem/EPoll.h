@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Locking/SpinlockProtected.h>
+#include <Kernel/Thread.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// An EPoll keeps a set of watched file descriptions and a list of the ones that became ready.
+// Each watch sits in the blocker set of its file for as long as it exists, so the file tells us
+// about state changes instead of every epoll_wait() having to walk all watched descriptions.
+class EPoll final : public File {
+public:
+    static ErrorOr<NonnullRefPtr<EPoll>> try_create();
+    virtual ~EPoll() override;
+
+    // The epoll description is readable when some watch is (probably) ready.
+    virtual bool can_read(const OpenFileDescription&, u64) const override;
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(const OpenFileDescription&, u64) const override { return false; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual ErrorOr<void> close() override;
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(const OpenFileDescription&) const override;
+    virtual StringView class_name() const override { return "EPoll"sv; }
+    virtual bool is_epoll() const override { return true; }
+
+    ErrorOr<void> add_watch(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> modify_watch(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> remove_watch(int fd, OpenFileDescription&);
+
+    // Fills in events for the watches that are ready right now, without blocking.
+    size_t collect_ready_events(Span<epoll_event>);
+
+    void description_will_be_destroyed(Badge<OpenFileDescription>, OpenFileDescription&);
+
+private:
+    EPoll() = default;
+
+    class Watch final : public Thread::FileBlocker {
+    public:
+        Watch(EPoll&, int fd, OpenFileDescription&, epoll_event const&);
+
+        virtual StringView state_string() const override { return "EPoll"sv; }
+        virtual bool unblock_if_conditions_are_met(bool, void*) override;
+        virtual void will_unblock_immediately_without_blocking(UnblockImmediatelyReason) override { }
+
+        bool register_with_file();
+        void unregister_from_file() { finalize(); }
+
+        int fd() const { return m_fd; }
+        OpenFileDescription& description() { return m_description; }
+
+        void set_event(epoll_event const&);
+
+        struct ReadyEvent {
+            epoll_event event;
+            bool is_level_triggered;
+        };
+        Optional<ReadyEvent> take_ready_event();
+
+        IntrusiveListNode<Watch> m_ready_list_node;
+
+    private:
+        EPoll& m_epoll;
+        int m_fd { -1 };
+        OpenFileDescription& m_description;
+        u32 m_events { 0 };
+        epoll_data_t m_data {};
+        bool m_enabled { true };
+    };
+
+    using ReadyList = IntrusiveList<&Watch::m_ready_list_node>;
+
+    void watch_became_ready(Watch&);
+    void remove_watch_locked(Watch&);
+
+    Mutex m_lock { "EPoll"sv };
+    HashMap<int, NonnullOwnPtr<Watch>> m_watches;
+    SpinlockProtected<ReadyList> m_ready_watches;
+};
+
+}
@@ -9,6 +9,7 @@
 #include <Kernel/API/POSIX/errno.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/InodeFile.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
@@ -51,6 +52,10 @@ OpenFileDescription::OpenFileDescription(File& file)
 
 OpenFileDescription::~OpenFileDescription()
 {
+    auto epoll_watchers = m_epoll_watchers.with([](auto& epoll_watchers) { return move(epoll_watchers); });
+    for (auto& epoll : epoll_watchers)
+        epoll->description_will_be_destroyed({}, *this);
+
     m_file->detach(*this);
     if (is_fifo())
         static_cast<FIFO*>(m_file.ptr())->detach(fifo_direction());
@@ -327,6 +332,25 @@ InodeWatcher* OpenFileDescription::inode_watcher()
     return static_cast<InodeWatcher*>(m_file.ptr());
 }
 
+bool OpenFileDescription::is_epoll() const
+{
+    return m_file->is_epoll();
+}
+
+const EPoll* OpenFileDescription::epoll() const
+{
+    if (!is_epoll())
+        return nullptr;
+    return static_cast<const EPoll*>(m_file.ptr());
+}
+
+EPoll* OpenFileDescription::epoll()
+{
+    if (!is_epoll())
+        return nullptr;
+    return static_cast<EPoll*>(m_file.ptr());
+}
+
 bool OpenFileDescription::is_master_pty() const
 {
     return m_file->is_master_pty();
@@ -460,6 +484,26 @@ ErrorOr<void> OpenFileDescription::get_flock(Userspace<flock*> lock) const
 
     return m_inode->get_flock(*this, lock);
 }
+
+ErrorOr<void> OpenFileDescription::did_add_epoll_watch(Badge<EPoll>, EPoll& epoll)
+{
+    return m_epoll_watchers.with([&](auto& epoll_watchers) { return epoll_watchers.try_append(epoll); });
+}
+
+void OpenFileDescription::did_remove_epoll_watch(Badge<EPoll>, EPoll& epoll)
+{
+    // NOTE: The reference is dropped after we've let go of the spinlock.
+    RefPtr<EPoll> removed_epoll;
+    m_epoll_watchers.with([&](auto& epoll_watchers) {
+        for (size_t i = 0; i < epoll_watchers.size(); ++i) {
+            if (epoll_watchers[i].ptr() == &epoll) {
+                removed_epoll = epoll_watchers.take(i);
+                return;
+            }
+        }
+    });
+}
+
 bool OpenFileDescription::is_readable() const
 {
     return m_state.with([](auto& state) { return state.readable; });
@@ -80,6 +80,10 @@ public:
     const InodeWatcher* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_epoll() const;
+    const EPoll* epoll() const;
+    EPoll* epoll();
+
     bool is_master_pty() const;
     const MasterPTY* master_pty() const;
     MasterPTY* master_pty();
@@ -127,6 +131,9 @@ public:
     ErrorOr<void> apply_flock(Process const&, Userspace<flock const*>);
     ErrorOr<void> get_flock(Userspace<flock*>) const;
 
+    ErrorOr<void> did_add_epoll_watch(Badge<EPoll>, EPoll&);
+    void did_remove_epoll_watch(Badge<EPoll>, EPoll&);
+
 private:
     friend class VirtualFileSystem;
     explicit OpenFileDescription(File&);
@@ -156,5 +163,8 @@ private:
     };
 
     SpinlockProtected<State> m_state;
+
+    // One entry per watch on this description, so they can be removed when it goes away.
+    SpinlockProtected<Vector<NonnullRefPtr<EPoll>>> m_epoll_watchers;
 };
 }
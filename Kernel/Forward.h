@@ -22,7 +22,9 @@ class DevTmpFSPtsDirectoryInode;
 class DevTmpFSRootDirectoryInode;
 class Device;
 class DiskCache;
+class DiskCacheShard;
 class DoubleBuffer;
+class EPoll;
 class File;
 class OpenFileDescription;
 class FileSystem;
@@ -87,6 +89,7 @@ class Spinlock;
 template<typename LockType>
 class SpinlockLocker;
 
+struct CacheEntry;
 struct InodeMetadata;
 struct TrapFrame;
 
@@ -20,6 +20,7 @@
 #include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/Net/LocalSocket.h>
+#include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCPSocket.h>
@@ -107,6 +108,12 @@ private:
             obj.add("bytes_in", socket.bytes_in());
             obj.add("packets_out", socket.packets_out());
             obj.add("bytes_out", socket.bytes_out());
+            obj.add("retransmitted_packets", socket.retransmitted_packets());
+            obj.add("congestion_window", socket.congestion_window());
+            obj.add("slow_start_threshold", socket.slow_start_threshold());
+            obj.add("send_window_size", socket.send_window_size());
+            obj.add("smoothed_rtt_us", socket.smoothed_round_trip_time().to_microseconds());
+            obj.add("rto_ms", socket.retransmission_timeout().to_milliseconds());
             if (Process::current().is_superuser() || Process::current().uid() == socket.origin_uid()) {
                 obj.add("origin_pid", socket.origin_pid().value());
                 obj.add("origin_uid", socket.origin_uid().value());
@@ -290,6 +297,37 @@ private:
     mutable Mutex m_lock;
 };
 
+class ProcFSLoopbackDropRate : public ProcFSGlobalInformation {
+public:
+    static NonnullRefPtr<ProcFSLoopbackDropRate> must_create(const ProcFSSystemDirectory&);
+
+private:
+    ProcFSLoopbackDropRate();
+
+    virtual ErrorOr<void> try_generate(KBufferBuilder& builder) override
+    {
+        return builder.appendff("{}\n", LoopbackAdapter::drop_rate());
+    }
+
+    virtual ErrorOr<size_t> write_bytes(off_t, size_t count, const UserOrKernelBuffer& buffer, OpenFileDescription*) override
+    {
+        char value[8];
+        if (count == 0 || count > sizeof(value))
+            return EINVAL;
+        MutexLocker locker(m_refresh_lock);
+        TRY(buffer.read(value, count));
+        auto drop_rate = StringView(value, count).trim_whitespace().to_uint();
+        if (!drop_rate.has_value() || drop_rate.value() > 1000)
+            return EINVAL;
+        LoopbackAdapter::set_drop_rate(drop_rate.value());
+        return count;
+    }
+
+    virtual mode_t required_mode() const override { return 0644; }
+    virtual ErrorOr<void> truncate(u64) override { return {}; }
+    virtual ErrorOr<void> set_mtime(time_t) override { return {}; }
+};
+
 UNMAP_AFTER_INIT NonnullRefPtr<ProcFSDumpKmallocStacks> ProcFSDumpKmallocStacks::must_create(const ProcFSSystemDirectory&)
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSDumpKmallocStacks).release_nonnull();
@@ -303,6 +341,11 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSCapsLockRemap> ProcFSCapsLockRemap::must_cr
     return adopt_ref_if_nonnull(new (nothrow) ProcFSCapsLockRemap).release_nonnull();
 }
 
+UNMAP_AFTER_INIT NonnullRefPtr<ProcFSLoopbackDropRate> ProcFSLoopbackDropRate::must_create(const ProcFSSystemDirectory&)
+{
+    return adopt_ref_if_nonnull(new (nothrow) ProcFSLoopbackDropRate).release_nonnull();
+}
+
 UNMAP_AFTER_INIT ProcFSDumpKmallocStacks::ProcFSDumpKmallocStacks()
     : ProcFSSystemBoolean("kmalloc_stacks"sv)
 {
@@ -318,6 +361,11 @@ UNMAP_AFTER_INIT ProcFSCapsLockRemap::ProcFSCapsLockRemap()
 {
 }
 
+UNMAP_AFTER_INIT ProcFSLoopbackDropRate::ProcFSLoopbackDropRate()
+    : ProcFSGlobalInformation("loopback_drop_rate"sv)
+{
+}
+
 class ProcFSSelfProcessDirectory final : public ProcFSExposedLink {
 public:
     static NonnullRefPtr<ProcFSSelfProcessDirectory> must_create();
@@ -895,6 +943,7 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSSystemDirectory> ProcFSSystemDirectory::mus
     directory->m_components.append(ProcFSDumpKmallocStacks::must_create(directory));
     directory->m_components.append(ProcFSUBSanDeadly::must_create(directory));
     directory->m_components.append(ProcFSCapsLockRemap::must_create(directory));
+    directory->m_components.append(ProcFSLoopbackDropRate::must_create(directory));
     return directory;
 }
 
@@ -37,7 +37,7 @@ MutexProtected<IPv4Socket::List>& IPv4Socket::all_sockets()
 
 ErrorOr<NonnullOwnPtr<DoubleBuffer>> IPv4Socket::try_create_receive_buffer()
 {
-    return DoubleBuffer::try_create(256 * KiB);
+    return DoubleBuffer::try_create(receive_buffer_size);
 }
 
 ErrorOr<NonnullRefPtr<Socket>> IPv4Socket::create(int type, int protocol)
@@ -425,8 +425,12 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
     if (buffer_mode() == BufferMode::Bytes) {
         VERIFY(m_receive_buffer);
 
+        // Only the payload ends up in the receive buffer, so don't hold the headers against it.
+        auto payload_size_or_error = protocol_size(packet);
+        if (payload_size_or_error.is_error())
+            return false;
         size_t space_in_receive_buffer = m_receive_buffer->space_for_writing();
-        if (packet_size > space_in_receive_buffer) {
+        if (payload_size_or_error.value() > space_in_receive_buffer) {
             dbgln("IPv4Socket({}): did_receive refusing packet since buffer is full.", this);
             VERIFY(m_can_read);
             return false;
@@ -4,12 +4,26 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/Singleton.h>
+#include <Kernel/Debug.h>
 #include <Kernel/Net/LoopbackAdapter.h>
+#include <Kernel/Random.h>
 
 namespace Kernel {
 
 static bool s_loopback_initialized = false;
+static Atomic<u32> s_drop_rate { 0 };
+
+u32 LoopbackAdapter::drop_rate()
+{
+    return s_drop_rate.load(AK::MemoryOrder::memory_order_relaxed);
+}
+
+void LoopbackAdapter::set_drop_rate(u32 drop_rate)
+{
+    s_drop_rate.store(min(drop_rate, 1000u), AK::MemoryOrder::memory_order_relaxed);
+}
 
 RefPtr<LoopbackAdapter> LoopbackAdapter::try_create()
 {
@@ -34,7 +48,11 @@ LoopbackAdapter::~LoopbackAdapter()
 
 void LoopbackAdapter::send_raw(ReadonlyBytes payload)
 {
-    dbgln("LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
+    if (auto rate = drop_rate(); rate != 0 && get_fast_random<u32>() % 1000 < rate) {
+        dbgln_if(LOOPBACK_DEBUG, "LoopbackAdapter: Dropping {} byte(s).", payload.size());
+        return;
+    }
+    dbgln_if(LOOPBACK_DEBUG, "LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
     did_receive(payload);
 }
 
@@ -23,6 +23,10 @@ public:
     virtual bool link_up() override { return true; }
     virtual bool link_full_duplex() override { return true; }
     virtual int link_speed() override { return 1000; }
+
+    // Drops this many out of every 1000 packets, to see how the protocols above cope with loss.
+    static u32 drop_rate();
+    static void set_drop_rate(u32);
 };
 
 }
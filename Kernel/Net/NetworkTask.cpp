@@ -457,6 +457,7 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
             auto client = client_or_error.release_value();
             MutexLocker locker(client->mutex());
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
+            client->process_syn_options(tcp_packet);
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
@@ -471,11 +472,13 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
     case TCPSocket::State::SynSent:
         switch (tcp_packet.flags()) {
         case TCPFlags::SYN:
+            socket->process_syn_options(tcp_packet);
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
             (void)socket->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             socket->set_state(TCPSocket::State::SynReceived);
             return;
         case TCPFlags::ACK | TCPFlags::SYN:
+            socket->process_syn_options(tcp_packet);
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
             (void)socket->send_ack(true);
             socket->set_state(TCPSocket::State::Established);
@@ -620,8 +623,16 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
         }
 
         if (tcp_packet.sequence_number() != socket->ack_number()) {
+            if (socket->queue_out_of_order_packet(ipv4_packet, tcp_packet, payload_size, packet_timestamp)) {
+                // RFC 5681 says out of order segments should be acknowledged right away, that's how the sender finds out about the loss.
+                dbgln_if(TCP_DEBUG, "Holding out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
+                [[maybe_unused]] auto result = socket->send_ack(true);
+                return;
+            }
             dbgln_if(TCP_DEBUG, "Discarding out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
-            if (socket->duplicate_acks() < TCPSocket::maximum_duplicate_acks) {
+            // Old segments, like zero window probes, always get an ACK with our current window.
+            bool is_old_segment = static_cast<i32>(tcp_packet.sequence_number() - socket->ack_number()) < 0;
+            if (is_old_segment || socket->duplicate_acks() < TCPSocket::maximum_duplicate_acks) {
                 dbgln_if(TCP_DEBUG, "Sending ACK with same ack number to trigger fast retransmission");
                 socket->set_duplicate_acks(socket->duplicate_acks() + 1);
                 [[maybe_unused]] auto result = socket->send_ack(true);
@@ -647,7 +658,13 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
                 socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
                 dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
                     tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
-                send_delayed_tcp_ack(socket);
+                if (socket->has_out_of_order_packets()) {
+                    // This packet filled a gap, so it has to be acknowledged right away as well.
+                    socket->deliver_out_of_order_packets();
+                    [[maybe_unused]] auto result = socket->send_ack(true);
+                } else {
+                    send_delayed_tcp_ack(socket);
+                }
             }
         }
     }
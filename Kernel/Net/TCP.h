@@ -22,6 +22,17 @@ struct TCPFlags {
     };
 };
 
+struct TCPOptionKind {
+    enum : u8 {
+        End = 0,
+        NOP = 1,
+        MSS = 2,
+        WindowScale = 3,
+        SACKPermitted = 4,
+        SACK = 5,
+    };
+};
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -32,13 +43,49 @@ public:
     u16 value() const { return m_value; }
 
 private:
-    u8 m_option_kind { 0x02 };
+    u8 m_option_kind { TCPOptionKind::MSS };
     u8 m_option_length { sizeof(TCPOptionMSS) };
     NetworkOrdered<u16> m_value;
 };
 
 static_assert(AssertSize<TCPOptionMSS, 4>());
 
+// RFC 7323, preceded by a NOP so the option list stays 32-bit aligned.
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 shift_count)
+        : m_shift_count(shift_count)
+    {
+    }
+
+    u8 shift_count() const { return m_shift_count; }
+
+private:
+    u8 m_nop { TCPOptionKind::NOP };
+    u8 m_option_kind { TCPOptionKind::WindowScale };
+    u8 m_option_length { 3 };
+    u8 m_shift_count { 0 };
+};
+
+static_assert(AssertSize<TCPOptionWindowScale, 4>());
+
+// RFC 2018, preceded by two NOPs so the option list stays 32-bit aligned.
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_nops[2] { TCPOptionKind::NOP, TCPOptionKind::NOP };
+    u8 m_option_kind { TCPOptionKind::SACKPermitted };
+    u8 m_option_length { 2 };
+};
+
+static_assert(AssertSize<TCPOptionSACKPermitted, 4>());
+
+struct [[gnu::packed]] TCPSACKBlock {
+    NetworkOrdered<u32> left_edge;
+    NetworkOrdered<u32> right_edge;
+};
+
+static_assert(AssertSize<TCPSACKBlock, 8>());
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -81,6 +128,33 @@ public:
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
+    ReadonlyBytes options() const { return { ((const u8*)this) + sizeof(TCPPacket), header_size() - sizeof(TCPPacket) }; }
+    Bytes options() { return { ((u8*)this) + sizeof(TCPPacket), header_size() - sizeof(TCPPacket) }; }
+
+    // Calls the callback with the kind and the data of every option, and stops at the first malformed one.
+    template<typename Callback>
+    void for_each_option(Callback callback) const
+    {
+        auto options = this->options();
+        size_t offset = 0;
+        while (offset < options.size()) {
+            u8 kind = options[offset];
+            if (kind == TCPOptionKind::End)
+                return;
+            if (kind == TCPOptionKind::NOP) {
+                ++offset;
+                continue;
+            }
+            if (offset + 1 >= options.size())
+                return;
+            u8 length = options[offset + 1];
+            if (length < 2 || offset + length > options.size())
+                return;
+            callback(kind, options.slice(offset + 2, length - 2));
+            offset += length;
+        }
+    }
+
 private:
     NetworkOrdered<u16> m_source_port;
     NetworkOrdered<u16> m_destination_port;
@@ -22,6 +22,16 @@
 
 namespace Kernel {
 
+// Sequence numbers wrap around, so they can only be compared relative to each other.
+static bool sequence_less_than(u32 a, u32 b) { return static_cast<i32>(a - b) < 0; }
+static bool sequence_less_than_or_equal(u32 a, u32 b) { return static_cast<i32>(a - b) <= 0; }
+static bool sequence_greater_than(u32 a, u32 b) { return sequence_less_than(b, a); }
+static bool sequence_greater_than_or_equal(u32 a, u32 b) { return sequence_less_than_or_equal(b, a); }
+
+// RFC 7323 caps the window shift count at 14.
+static constexpr u8 maximum_window_scale = 14;
+static constexpr u32 maximum_congestion_window = 1 * GiB;
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
     sockets_by_tuple().for_each_shared([&](const auto& it) {
@@ -157,6 +167,12 @@ TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, N
     : IPv4Socket(SOCK_STREAM, protocol, move(receive_buffer), move(scratch_buffer))
 {
     m_last_retransmit_time = kgettimeofday();
+
+    // Pick the smallest shift that lets us advertise the whole receive buffer.
+    while ((receive_buffer_size >> m_receive_window_scale) > NumericLimits<u16>::max() && m_receive_window_scale < maximum_window_scale)
+        ++m_receive_window_scale;
+
+    m_congestion_window = initial_congestion_window();
 }
 
 TCPSocket::~TCPSocket()
@@ -196,12 +212,30 @@ ErrorOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_t
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
+    size_t mss = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_send_mss);
+    // can_write() makes sure there is room before writers get here, but the window may have shrunk in the meantime.
+    // sendto() then blocks until it opens again, unless the socket is non-blocking.
+    auto window_available = send_window_available();
+    if (window_available == 0)
+        return EAGAIN;
+    data_length = min(data_length, min(mss, window_available));
     TRY(send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision));
     return data_length;
 }
 
+ErrorOr<size_t> TCPSocket::sendto(OpenFileDescription& description, const UserOrKernelBuffer& data, size_t data_length, int flags, Userspace<const sockaddr*> addr, socklen_t addr_length)
+{
+    while (true) {
+        auto result = IPv4Socket::sendto(description, data, data_length, flags, addr, addr_length);
+        if (!result.is_error() || result.error().code() != EAGAIN || !description.is_blocking())
+            return result;
+
+        auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+        if (Thread::current()->block<Thread::WriteBlocker>({}, description, unblock_flags).was_interrupted())
+            return set_so_error(EINTR);
+    }
+}
+
 ErrorOr<void> TCPSocket::send_ack(bool allow_duplicate)
 {
     if (!allow_duplicate && m_last_ack_number_sent == m_ack_number)
@@ -217,8 +251,34 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    const bool has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    // The SYN offers window scaling and SACK, and the SYN|ACK only agrees to what the peer offered.
+    const bool is_syn = flags & TCPFlags::SYN;
+    const bool has_window_scale_option = is_syn && (!(flags & TCPFlags::ACK) || m_window_scaling_enabled);
+    const bool has_sack_permitted_option = is_syn && (!(flags & TCPFlags::ACK) || m_sack_enabled);
+    const bool has_sack_option = flags == TCPFlags::ACK && payload_size == 0 && m_sack_enabled && has_out_of_order_packets();
+
+    u8 options[40];
+    size_t options_size = 0;
+    if (is_syn) {
+        u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+        TCPOptionMSS mss_option { mss };
+        memcpy(options, &mss_option, sizeof(mss_option));
+        options_size += sizeof(mss_option);
+    }
+    if (has_window_scale_option) {
+        TCPOptionWindowScale window_scale_option { m_receive_window_scale };
+        memcpy(options + options_size, &window_scale_option, sizeof(window_scale_option));
+        options_size += sizeof(window_scale_option);
+    }
+    if (has_sack_permitted_option) {
+        TCPOptionSACKPermitted sack_permitted_option;
+        memcpy(options + options_size, &sack_permitted_option, sizeof(sack_permitted_option));
+        options_size += sizeof(sack_permitted_option);
+    }
+    if (has_sack_option)
+        options_size += write_sack_option({ options + options_size, sizeof(options) - options_size });
+    VERIFY(options_size % sizeof(u32) == 0);
+
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -232,7 +292,8 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    m_last_window_advertised = receive_window_to_advertise(is_syn);
+    tcp_packet.set_window_size(m_last_window_advertised);
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
@@ -250,18 +311,14 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
         tcp_packet.set_ack_number(m_ack_number);
     }
 
+    auto sequence_number = m_sequence_number;
     if (flags & TCPFlags::SYN) {
         ++m_sequence_number;
     } else {
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
-        u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-        TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
-    }
+    memcpy(tcp_packet.options().data(), options, options_size);
 
     tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
 
@@ -271,7 +328,13 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            unacked_packets.packets.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+            if (unacked_packets.packets.is_empty()) {
+                // RFC 6298 (5.1): Start the retransmission timer when there is nothing else in flight.
+                m_last_retransmit_time = kgettimeofday();
+                if (tcp_packet.has_syn())
+                    m_send_unacknowledged = sequence_number;
+            }
+            unacked_packets.packets.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter, 0, sequence_number, kgettimeofday() });
             unacked_packets.size += payload_size;
             enqueue_for_retransmit();
         });
@@ -286,44 +349,378 @@ void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 {
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
+        size_t payload_size = size - packet.header_size();
+        auto now = kgettimeofday();
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
+        // The window field of a SYN segment is never scaled.
+        auto previous_send_window_size = m_send_window_size;
+        m_send_window_size = packet.has_syn() ? packet.window_size() : static_cast<u32>(packet.window_size()) << m_send_window_scale;
+
+        if (m_sack_enabled && !packet.has_syn())
+            process_sack_blocks(packet);
+
         int removed = 0;
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            while (!unacked_packets.packets.is_empty()) {
-                auto& packet = unacked_packets.packets.first();
+            if (sequence_greater_than(ack_number, m_send_unacknowledged) && sequence_less_than_or_equal(ack_number, m_sequence_number)) {
+                u32 bytes_acked = ack_number - m_send_unacknowledged;
+                m_send_unacknowledged = ack_number;
+
+                Optional<Time> round_trip_time;
+                while (!unacked_packets.packets.is_empty()) {
+                    auto& packet = unacked_packets.packets.first();
+
+                    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
 
-                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
+                    if (!sequence_less_than_or_equal(packet.ack_number, ack_number))
+                        break;
+
+                    // Karn's algorithm: the ACK for a retransmitted packet can't tell us which transmission it was for.
+                    if (packet.tx_counter == 0)
+                        round_trip_time = now - packet.sent_time;
 
-                if (packet.ack_number <= ack_number) {
                     auto old_adapter = packet.adapter.strong_ref();
                     if (old_adapter)
                         old_adapter->release_packet_buffer(*packet.buffer);
                     TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
                     auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
                     unacked_packets.size -= payload_size;
-                    evaluate_block_conditions();
                     unacked_packets.packets.take_first();
                     removed++;
+                }
+
+                if (round_trip_time.has_value())
+                    update_round_trip_time(round_trip_time.value());
+
+                // RFC 6298 (5.3): Restart the retransmission timer whenever new data is acknowledged.
+                m_retransmit_attempts = 0;
+                m_last_retransmit_time = now;
+                m_duplicate_acks_received = 0;
+
+                if (m_in_recovery) {
+                    if (sequence_greater_than_or_equal(ack_number, m_recovery_point)) {
+                        // Everything that was outstanding when the loss was detected has arrived, deflate the window (RFC 6582 3.2 step 3).
+                        m_in_recovery = false;
+                        m_congestion_window = min(m_slow_start_threshold, static_cast<u32>(max(unacked_packets.size, m_send_mss)) + m_send_mss);
+                    } else {
+                        // A partial acknowledgement means the next segment was lost as well (RFC 6582 3.2 step 4).
+                        m_congestion_window -= min(bytes_acked, m_congestion_window);
+                        if (bytes_acked >= m_send_mss)
+                            m_congestion_window += m_send_mss;
+                        m_congestion_window = max(m_congestion_window, static_cast<u32>(m_send_mss));
+                        m_highest_retransmitted = m_send_unacknowledged;
+                        retransmit_next_lost_packet(unacked_packets);
+                    }
+                } else if (m_congestion_window < m_slow_start_threshold) {
+                    m_congestion_window = min(m_congestion_window + min(bytes_acked, static_cast<u32>(m_send_mss)), maximum_congestion_window);
                 } else {
-                    break;
+                    u32 increase = static_cast<u64>(m_send_mss) * m_send_mss / m_congestion_window;
+                    m_congestion_window = min(m_congestion_window + max(increase, 1u), maximum_congestion_window);
+                }
+            } else if (ack_number == m_send_unacknowledged && payload_size == 0 && !packet.has_syn() && !packet.has_fin()
+                && m_send_window_size == previous_send_window_size && !unacked_packets.packets.is_empty()) {
+                ++m_duplicate_acks_received;
+                if (m_in_recovery) {
+                    // Every duplicate ACK means another segment has left the network (RFC 5681 3.2 step 4).
+                    m_congestion_window = min(m_congestion_window + m_send_mss, maximum_congestion_window);
+                    if (m_sack_enabled)
+                        retransmit_next_lost_packet(unacked_packets);
+                } else if (m_duplicate_acks_received == duplicate_ack_threshold) {
+                    // Fast retransmit and fast recovery (RFC 5681 3.2 steps 2 and 3).
+                    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) fast retransmit at {}", this, m_send_unacknowledged);
+                    m_slow_start_threshold = max(static_cast<u32>(unacked_packets.size / 2), 2u * m_send_mss);
+                    m_in_recovery = true;
+                    m_recovery_point = m_sequence_number;
+                    m_highest_retransmitted = m_send_unacknowledged;
+                    retransmit_next_lost_packet(unacked_packets);
+                    m_congestion_window = m_slow_start_threshold + duplicate_ack_threshold * m_send_mss;
                 }
             }
 
             if (unacked_packets.packets.is_empty()) {
                 m_retransmit_attempts = 0;
-                dequeue_for_retransmit();
+                // With a closed window we have to keep probing it, otherwise a lost window update would stall us forever.
+                if (m_send_window_size == 0)
+                    enqueue_for_retransmit();
+                else
+                    dequeue_for_retransmit();
             }
 
             dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
         });
+
+        if (removed || m_send_window_size != previous_send_window_size)
+            evaluate_block_conditions();
     }
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::process_syn_options(const TCPPacket& packet)
+{
+    Optional<u16> mss;
+    Optional<u8> window_scale;
+    bool sack_permitted = false;
+    packet.for_each_option([&](u8 kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == 2)
+                mss = (data[0] << 8) | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == 1)
+                window_scale = data[0];
+            break;
+        case TCPOptionKind::SACKPermitted:
+            sack_permitted = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    if (mss.has_value() && mss.value() != 0)
+        m_send_mss = mss.value();
+
+    // Window scaling is only used if both sides asked for it, otherwise neither side scales.
+    m_window_scaling_enabled = window_scale.has_value();
+    if (m_window_scaling_enabled)
+        m_send_window_scale = min(window_scale.value(), maximum_window_scale);
+    else
+        m_send_window_scale = m_receive_window_scale = 0;
+
+    m_sack_enabled = sack_permitted;
+    m_congestion_window = initial_congestion_window();
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) peer mss={}, window_scale={}, sack={}", this, m_send_mss, window_scale, m_sack_enabled);
+}
+
+void TCPSocket::process_sack_blocks(const TCPPacket& packet)
+{
+    packet.for_each_option([&](u8 kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK || data.size() % sizeof(TCPSACKBlock) != 0)
+            return;
+        m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+            for (size_t offset = 0; offset < data.size(); offset += sizeof(TCPSACKBlock)) {
+                TCPSACKBlock block;
+                memcpy(&block, data.offset(offset), sizeof(block));
+                u32 left_edge = block.left_edge;
+                u32 right_edge = block.right_edge;
+                if (!sequence_less_than(left_edge, right_edge) || !sequence_greater_than_or_equal(left_edge, m_send_unacknowledged))
+                    continue;
+                for (auto& packet : unacked_packets.packets) {
+                    if (sequence_greater_than_or_equal(packet.sequence_number, left_edge) && sequence_less_than_or_equal(packet.ack_number, right_edge))
+                        packet.sacked = true;
+                }
+                if (sequence_greater_than(right_edge, m_highest_sacked))
+                    m_highest_sacked = right_edge;
+            }
+        });
+    });
+}
+
+size_t TCPSocket::write_sack_option(Bytes buffer) const
+{
+    // Report the ranges we are holding on to, which tells the sender exactly which segments are missing.
+    constexpr size_t maximum_sack_blocks = 3;
+    constexpr size_t header_size = 4;
+    Array<TCPSACKBlock, maximum_sack_blocks> blocks;
+    size_t block_count = 0;
+    for (auto& packet : m_out_of_order_packets) {
+        u32 right_edge = packet.sequence_number + packet.payload_size;
+        if (block_count > 0 && sequence_less_than_or_equal(packet.sequence_number, blocks[block_count - 1].right_edge)) {
+            if (sequence_greater_than(right_edge, blocks[block_count - 1].right_edge))
+                blocks[block_count - 1].right_edge = right_edge;
+            continue;
+        }
+        if (block_count == maximum_sack_blocks)
+            break;
+        blocks[block_count++] = { packet.sequence_number, right_edge };
+    }
+    if (block_count == 0)
+        return 0;
+
+    size_t option_size = header_size + block_count * sizeof(TCPSACKBlock);
+    VERIFY(buffer.size() >= option_size);
+    buffer[0] = TCPOptionKind::NOP;
+    buffer[1] = TCPOptionKind::NOP;
+    buffer[2] = TCPOptionKind::SACK;
+    buffer[3] = option_size - 2;
+    memcpy(buffer.offset(header_size), blocks.data(), block_count * sizeof(TCPSACKBlock));
+    return option_size;
+}
+
+size_t TCPSocket::maximum_out_of_order_packet_count() const
+{
+    // Every held segment takes up at least a page, however few bytes it carries, so hold no more of them than it takes
+    // full-sized segments to fill the receive buffer.
+    return max<size_t>(receive_buffer_space() / minimum_full_sized_segment, 1);
+}
+
+// Copies the headers of a segment along with `size` bytes of its payload starting at `offset`, so that the copy looks
+// like a segment that carried just those bytes.
+static ErrorOr<NonnullOwnPtr<KBuffer>> copy_partial_segment(IPv4Packet const& ipv4_packet, size_t offset, size_t size)
+{
+    auto& tcp_packet = *static_cast<TCPPacket const*>(ipv4_packet.payload());
+    size_t headers_size = sizeof(IPv4Packet) + tcp_packet.header_size();
+    auto buffer = TRY(KBuffer::try_create_with_size(headers_size + size));
+    memcpy(buffer->data(), &ipv4_packet, headers_size);
+    memcpy(buffer->data() + headers_size, static_cast<u8 const*>(tcp_packet.payload()) + offset, size);
+    auto& copy = *reinterpret_cast<IPv4Packet*>(buffer->data());
+    copy.set_length(headers_size + size);
+    static_cast<TCPPacket*>(copy.payload())->set_sequence_number(tcp_packet.sequence_number() + offset);
+    return buffer;
+}
+
+bool TCPSocket::queue_out_of_order_packet(const IPv4Packet& ipv4_packet, const TCPPacket& tcp_packet, size_t payload_size, const Time& packet_timestamp)
+{
+    u32 sequence_number = tcp_packet.sequence_number();
+    if (payload_size == 0 || tcp_packet.has_syn() || tcp_packet.has_fin() || !sequence_greater_than(sequence_number, m_ack_number))
+        return false;
+
+    // Don't hold on to anything that wouldn't fit into the receive buffer once the gap in front of it is filled.
+    if (sequence_number + payload_size - m_ack_number > receive_buffer_space())
+        return false;
+
+    // Held segments never overlap. Only the bytes from the first one we don't hold yet up to the next held segment that
+    // extends past this one are kept, and the held segments in between are replaced.
+    u32 start = sequence_number;
+    u32 end = sequence_number + payload_size;
+    size_t replaced_count = 0;
+    size_t replaced_size = 0;
+    for (auto& packet : m_out_of_order_packets) {
+        u32 packet_end = packet.sequence_number + packet.payload_size;
+        if (sequence_less_than_or_equal(packet_end, start))
+            continue;
+        if (sequence_less_than_or_equal(packet.sequence_number, start)) {
+            start = packet_end;
+            continue;
+        }
+        if (sequence_greater_than_or_equal(packet.sequence_number, end))
+            break;
+        if (sequence_greater_than(packet_end, end)) {
+            end = packet.sequence_number;
+            break;
+        }
+        ++replaced_count;
+        replaced_size += packet.payload_size;
+    }
+    if (sequence_greater_than_or_equal(start, end))
+        return true;
+
+    size_t size = end - start;
+    if (m_out_of_order_packet_count - replaced_count + 1 > maximum_out_of_order_packet_count())
+        return false;
+    if (m_out_of_order_size - replaced_size + size > receive_buffer_space())
+        return false;
+
+    auto data_or_error = copy_partial_segment(ipv4_packet, start - sequence_number, size);
+    if (data_or_error.is_error())
+        return false;
+
+    auto it = m_out_of_order_packets.begin();
+    while (!it.is_end() && sequence_less_than(it->sequence_number, start))
+        ++it;
+    while (!it.is_end() && sequence_less_than(it->sequence_number, end)) {
+        it.remove(m_out_of_order_packets);
+        ++it;
+    }
+
+    OutOfOrderPacket packet { start, static_cast<u32>(size), data_or_error.release_value(), packet_timestamp };
+    if (it.is_end())
+        m_out_of_order_packets.append(move(packet));
+    else
+        m_out_of_order_packets.insert_before(it, move(packet));
+    m_out_of_order_packet_count = m_out_of_order_packet_count - replaced_count + 1;
+    m_out_of_order_size = m_out_of_order_size - replaced_size + size;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) holding out of order packet seq_no={}, {} bytes in {} packets held", this, start, m_out_of_order_size, m_out_of_order_packet_count);
+    return true;
+}
+
+void TCPSocket::deliver_out_of_order_packets()
+{
+    while (!m_out_of_order_packets.is_empty()) {
+        if (sequence_greater_than(m_out_of_order_packets.first().sequence_number, m_ack_number))
+            return;
+        auto packet = m_out_of_order_packets.take_first();
+        m_out_of_order_size -= packet.payload_size;
+        --m_out_of_order_packet_count;
+        u32 packet_end = packet.sequence_number + packet.payload_size;
+        if (sequence_less_than_or_equal(packet_end, m_ack_number))
+            continue;
+        // The segment that filled the gap may have carried the start of this one as well, only the rest is new.
+        if (packet.sequence_number != m_ack_number) {
+            auto& ipv4_packet = *reinterpret_cast<IPv4Packet const*>(packet.ipv4_packet->data());
+            auto data_or_error = copy_partial_segment(ipv4_packet, m_ack_number - packet.sequence_number, packet_end - m_ack_number);
+            if (data_or_error.is_error()) {
+                discard_out_of_order_packets();
+                return;
+            }
+            packet.ipv4_packet = data_or_error.release_value();
+        }
+        if (!did_receive(peer_address(), peer_port(), packet.ipv4_packet->bytes(), packet.timestamp)) {
+            discard_out_of_order_packets();
+            return;
+        }
+        m_ack_number = packet_end;
+    }
+}
+
+void TCPSocket::discard_out_of_order_packets()
+{
+    m_out_of_order_packets.clear();
+    m_out_of_order_packet_count = 0;
+    m_out_of_order_size = 0;
+}
+
+void TCPSocket::update_round_trip_time(Time sample)
+{
+    // RFC 6298 (2.2) and (2.3), with the recommended alpha=1/8 and beta=1/4.
+    constexpr i64 clock_granularity_us = 10'000;
+    i64 sample_us = max<i64>(sample.to_microseconds(), 0);
+    i64 smoothed_us = m_smoothed_round_trip_time.to_microseconds();
+    i64 variance_us = m_round_trip_time_variance.to_microseconds();
+    if (!m_has_round_trip_time_sample) {
+        smoothed_us = sample_us;
+        variance_us = sample_us / 2;
+        m_has_round_trip_time_sample = true;
+    } else {
+        i64 delta = smoothed_us > sample_us ? smoothed_us - sample_us : sample_us - smoothed_us;
+        variance_us = (3 * variance_us + delta) / 4;
+        smoothed_us = (7 * smoothed_us + sample_us) / 8;
+    }
+    m_smoothed_round_trip_time = Time::from_microseconds(smoothed_us);
+    m_round_trip_time_variance = Time::from_microseconds(variance_us);
+
+    auto timeout = Time::from_microseconds(smoothed_us + max(clock_granularity_us, 4 * variance_us));
+    m_retransmission_timeout = clamp(timeout, minimum_retransmission_timeout, maximum_retransmission_timeout);
+}
+
+u32 TCPSocket::initial_congestion_window() const
+{
+    // RFC 6928
+    return min(10u * m_send_mss, max(2u * m_send_mss, 14600u));
+}
+
+size_t TCPSocket::send_window_available() const
+{
+    size_t window = min(m_send_window_size, m_congestion_window);
+    return m_unacked_packets.with_shared([&](auto& unacked_packets) -> size_t {
+        return window > unacked_packets.size ? window - unacked_packets.size : 0;
+    });
+}
+
+u16 TCPSocket::receive_window_to_advertise(bool is_syn) const
+{
+    size_t space = receive_buffer_space();
+    if (!is_syn)
+        space >>= m_receive_window_scale;
+    return min(space, static_cast<size_t>(NumericLimits<u16>::max()));
+}
+
 bool TCPSocket::should_delay_next_ack() const
 {
     // FIXME: We don't know the MSS here so make a reasonable guess.
@@ -553,12 +950,28 @@ void TCPSocket::retransmit_packets()
 
     // RFC6298 says we should have at least one second between retransmits. According to
     // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    if (m_last_retransmit_time > now - m_retransmission_timeout)
+        return;
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    bool has_unacked_packets = m_unacked_packets.with_shared([&](auto& unacked_packets) {
+        return !unacked_packets.packets.is_empty();
+    });
+
+    if (!has_unacked_packets) {
+        if (m_send_window_size != 0 || m_state != State::Established) {
+            dequeue_for_retransmit();
+            return;
+        }
+
+        // Probe the closed window with an old sequence number, which the peer has to answer with an ACK carrying its current window.
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) probing zero window", this);
+        m_last_retransmit_time = now;
+        m_retransmission_timeout = min(m_retransmission_timeout + m_retransmission_timeout, maximum_retransmission_timeout);
+        --m_sequence_number;
+        [[maybe_unused]] auto result = send_ack(true);
+        ++m_sequence_number;
         return;
+    }
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
 
@@ -572,46 +985,81 @@ void TCPSocket::retransmit_packets()
         return;
     }
 
+    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        // A timeout means the ACK clock is gone, so start over with slow start (RFC 5681 3.1).
+        if (m_retransmit_attempts == 1)
+            m_slow_start_threshold = max(static_cast<u32>(unacked_packets.size / 2), 2u * m_send_mss);
+        m_congestion_window = m_send_mss;
+        // Fast recovery is over as well, the window grows back through slow start rather than being deflated to ssthresh (RFC 6582 3.2).
+        m_in_recovery = false;
+        m_duplicate_acks_received = 0;
+
+        // RFC 2018 says the receiver may have discarded what it SACKed, so forget about it.
+        for (auto& packet : unacked_packets.packets)
+            packet.sacked = false;
+        m_highest_sacked = m_send_unacknowledged;
+        m_highest_retransmitted = m_send_unacknowledged;
+
+        retransmit_next_lost_packet(unacked_packets);
+    });
+
+    // RFC 6298 (5.5): Back off the timer.
+    m_retransmission_timeout = min(m_retransmission_timeout + m_retransmission_timeout, maximum_retransmission_timeout);
+}
+
+void TCPSocket::retransmit_next_lost_packet(UnackedPackets& unacked_packets)
+{
     auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return;
 
-    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-        for (auto& packet : unacked_packets.packets) {
-            packet.tx_counter++;
-
-            if constexpr (TCP_SOCKET_DEBUG) {
-                auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                    local_address(), local_port(),
-                    peer_address(), peer_port(),
-                    (tcp_packet.has_syn() ? "SYN " : ""),
-                    (tcp_packet.has_ack() ? "ACK " : ""),
-                    (tcp_packet.has_fin() ? "FIN " : ""),
-                    (tcp_packet.has_rst() ? "RST " : ""),
-                    tcp_packet.sequence_number(),
-                    tcp_packet.ack_number(),
-                    packet.tx_counter);
-            }
+    for (auto& packet : unacked_packets.packets) {
+        if (packet.sacked || sequence_less_than(packet.sequence_number, m_highest_retransmitted))
+            continue;
+        // Without SACK only the first unacknowledged packet is known to be lost, with it every hole below the highest SACKed packet is.
+        if (packet.sequence_number != m_send_unacknowledged && !sequence_less_than(packet.sequence_number, m_highest_sacked))
+            return;
+        retransmit_packet(packet, routing_decision);
+        m_highest_retransmitted = packet.ack_number;
+        return;
+    }
+}
 
-            size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-            if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-                // FIXME: Add support for this. This can happen if after a route change
-                // we ended up on another adapter which doesn't have the same layer 2 type
-                // like the previous adapter.
-                VERIFY_NOT_REACHED();
-            }
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    packet.tx_counter++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
 
-            auto packet_buffer = packet.buffer->bytes();
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
 
-            routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-                local_address(), routing_decision.next_hop, peer_address(),
-                IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
-            m_packets_out++;
-            m_bytes_out += packet_buffer.size();
-        }
-    });
+    auto packet_buffer = packet.buffer->bytes();
+
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
+    routing_decision.adapter->send_packet(packet_buffer);
+    m_packets_out++;
+    m_bytes_out += packet_buffer.size();
+    m_retransmitted_packets++;
 }
 
 bool TCPSocket::can_write(const OpenFileDescription& file_description, u64 size) const
@@ -622,11 +1070,27 @@ bool TCPSocket::can_write(const OpenFileDescription& file_description, u64 size)
     if (m_state == State::SynSent || m_state == State::SynReceived)
         return false;
 
-    if (!file_description.is_blocking())
+    // Wait until a full segment fits, unless nothing is in flight (RFC 9293 3.8.6.2.1).
+    auto window_available = send_window_available();
+    if (window_available >= m_send_mss)
         return true;
-
-    return m_unacked_packets.with_shared([&](auto& unacked_packets) {
-        return unacked_packets.size + size <= m_send_window_size;
+    return window_available > 0 && m_unacked_packets.with_shared([&](auto& unacked_packets) {
+        return unacked_packets.packets.is_empty();
     });
 }
+
+ErrorOr<size_t> TCPSocket::recvfrom(OpenFileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> user_addr, Userspace<socklen_t*> user_addr_length, Time& packet_timestamp)
+{
+    auto nreceived = TRY(IPv4Socket::recvfrom(description, buffer, buffer_length, flags, user_addr, user_addr_length, packet_timestamp));
+
+    // Let the peer know once reading has opened up a good part of the window again (RFC 1122 4.2.3.3).
+    MutexLocker locker(mutex());
+    if (m_state == State::Established) {
+        auto window = receive_window_to_advertise(false);
+        if (window > m_last_window_advertised && (static_cast<size_t>(window - m_last_window_advertised) << m_receive_window_scale) >= receive_buffer_size / 2)
+            (void)send_ack(true);
+    }
+    return nreceived;
+}
+
 }
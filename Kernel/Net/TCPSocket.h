@@ -141,6 +141,19 @@ public:
     ErrorOr<void> send_ack(bool allow_duplicate = false);
     ErrorOr<void> send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    void process_syn_options(const TCPPacket&);
+
+    // Segments that arrive ahead of ack_number() are held here until the gap before them is filled.
+    bool queue_out_of_order_packet(const IPv4Packet&, const TCPPacket&, size_t payload_size, const Time& packet_timestamp);
+    bool has_out_of_order_packets() const { return !m_out_of_order_packets.is_empty(); }
+    void deliver_out_of_order_packets();
+
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 slow_start_threshold() const { return m_slow_start_threshold; }
+    u32 send_window_size() const { return m_send_window_size; }
+    Time smoothed_round_trip_time() const { return m_smoothed_round_trip_time; }
+    Time retransmission_timeout() const { return m_retransmission_timeout; }
+    u32 retransmitted_packets() const { return m_retransmitted_packets; }
 
     bool should_delay_next_ack() const;
 
@@ -160,6 +173,8 @@ public:
     virtual ErrorOr<void> close() override;
 
     virtual bool can_write(const OpenFileDescription&, u64) const override;
+    virtual ErrorOr<size_t> sendto(OpenFileDescription&, const UserOrKernelBuffer&, size_t, int flags, Userspace<const sockaddr*>, socklen_t) override;
+    virtual ErrorOr<size_t> recvfrom(OpenFileDescription&, UserOrKernelBuffer&, size_t, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&) override;
 
     static NetworkOrdered<u16> compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const&, u16 payload_size);
 
@@ -184,6 +199,19 @@ private:
     void enqueue_for_retransmit();
     void dequeue_for_retransmit();
 
+    struct OutgoingPacket;
+    struct UnackedPackets;
+    void retransmit_packet(OutgoingPacket&, RoutingDecision&);
+    void retransmit_next_lost_packet(UnackedPackets&);
+    void update_round_trip_time(Time sample);
+    void process_sack_blocks(const TCPPacket&);
+    size_t send_window_available() const;
+    u16 receive_window_to_advertise(bool is_syn) const;
+    size_t write_sack_option(Bytes) const;
+    u32 initial_congestion_window() const;
+    size_t maximum_out_of_order_packet_count() const;
+    void discard_out_of_order_packets();
+
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
     Direction m_direction { Direction::Unspecified };
@@ -203,6 +231,9 @@ private:
         size_t ipv4_payload_offset;
         WeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        u32 sequence_number { 0 };
+        Time sent_time;
+        bool sacked { false };
     };
 
     struct UnackedPackets {
@@ -212,18 +243,58 @@ private:
 
     MutexProtected<UnackedPackets> m_unacked_packets;
 
+    struct OutOfOrderPacket {
+        u32 sequence_number { 0 };
+        u32 payload_size { 0 };
+        NonnullOwnPtr<KBuffer> ipv4_packet;
+        Time timestamp;
+    };
+
+    // RFC 1122 says every host has to accept segments of this size.
+    static constexpr size_t minimum_full_sized_segment = 536;
+    SinglyLinkedList<OutOfOrderPacket> m_out_of_order_packets;
+    size_t m_out_of_order_packet_count { 0 };
+    size_t m_out_of_order_size { 0 };
+
     u32 m_duplicate_acks { 0 };
 
     u32 m_last_ack_number_sent { 0 };
     Time m_last_ack_sent_time;
+    u16 m_last_window_advertised { 0 };
 
     // FIXME: Make this configurable (sysctl)
     static constexpr u32 maximum_retransmits = 5;
     Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
+    u32 m_retransmitted_packets { 0 };
+
+    // RFC 6298 retransmission timer state.
+    static constexpr Time minimum_retransmission_timeout = Time::from_seconds(1);
+    static constexpr Time maximum_retransmission_timeout = Time::from_seconds(60);
+    bool m_has_round_trip_time_sample { false };
+    Time m_smoothed_round_trip_time;
+    Time m_round_trip_time_variance;
+    Time m_retransmission_timeout { minimum_retransmission_timeout };
+
+    // RFC 7323 window scaling, and RFC 2018 selective acknowledgements.
+    bool m_window_scaling_enabled { false };
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
+    bool m_sack_enabled { false };
 
-    // FIXME: Parse window size TCP option from the peer
     u32 m_send_window_size { 64 * KiB };
+    u16 m_send_mss { 536 };
+
+    // RFC 5681 congestion control with the RFC 6582 (NewReno) modification to fast recovery.
+    static constexpr u32 duplicate_ack_threshold = 3;
+    u32 m_send_unacknowledged { 0 };
+    u32 m_congestion_window { 0 };
+    u32 m_slow_start_threshold { NumericLimits<u32>::max() };
+    u32 m_duplicate_acks_received { 0 };
+    bool m_in_recovery { false };
+    u32 m_recovery_point { 0 };
+    u32 m_highest_retransmitted { 0 };
+    u32 m_highest_sacked { 0 };
 
     IntrusiveListNode<TCPSocket> m_retransmit_list_node;
 
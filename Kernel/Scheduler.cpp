@@ -48,9 +48,17 @@ struct ThreadReadyQueues {
     u32 mask {};
     static constexpr size_t count = sizeof(mask) * 8;
     Array<ThreadReadyQueue, count> queues;
+    size_t thread_count { 0 };
 };
 
-static Singleton<SpinlockProtected<ThreadReadyQueues>> g_ready_queues;
+// Every processor has its own set of ready queues, so that processors don't all contend on
+// a single lock and threads tend to keep running where their caches are still warm.
+// Thread affinity masks are 32 bits wide, so that's how many processors we can schedule on.
+static constexpr size_t max_scheduling_processors = sizeof(u32) * 8;
+static Singleton<Array<SpinlockProtected<ThreadReadyQueues>, max_scheduling_processors>> g_ready_queues;
+
+// A thread is only moved to a less loaded processor if its preferred processor has at least this many more threads queued up.
+static constexpr size_t load_balancing_threshold = 2;
 
 static SpinlockProtected<TotalTimeScheduled> g_total_time_scheduled;
 
@@ -72,71 +80,158 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+// Only these processors pick threads from their ready queues, so nothing may be queued anywhere else.
+static inline u32 scheduling_processor_count()
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                thread.m_runnable_priority = -1;
-                ready_queue.thread_list.remove(thread);
-                if (ready_queue.thread_list.is_empty())
-                    ready_queues.mask &= ~(1u << priority);
-                // Mark it as active because we are using this thread. This is similar
-                // to comparing it with Processor::current_thread, but when there are
-                // multiple processors there's no easy way to check whether the thread
-                // is actually still needed. This prevents accidental finalization when
-                // a thread is no longer in Running state, but running on another core.
-
-                // We need to mark it active here so that this thread won't be
-                // scheduled on another core if it were to be queued before actually
-                // switching to it.
-                // FIXME: Figure out a better way maybe?
-                thread.set_active(true);
-                return thread;
-            }
-            priority_mask &= ~(1u << priority);
+#if SCHEDULE_ON_ALL_PROCESSORS
+    return min(Processor::count(), (u32)max_scheduling_processors);
+#else
+    return 1;
+#endif
+}
+
+static inline u32 scheduling_processor_mask()
+{
+    auto processor_count = scheduling_processor_count();
+    return processor_count == max_scheduling_processors ? NumericLimits<u32>::max() : (1u << processor_count) - 1;
+}
+
+static SpinlockProtected<ThreadReadyQueues>& ready_queues_for_processor(u32 cpu)
+{
+    VERIFY(cpu < max_scheduling_processors);
+    return (*g_ready_queues)[cpu];
+}
+
+Thread* Scheduler::find_runnable_thread_in(ThreadReadyQueues& ready_queues, u32 affinity_mask)
+{
+    auto priority_mask = ready_queues.mask;
+    while (priority_mask != 0) {
+        auto priority = bit_scan_forward(priority_mask);
+        VERIFY(priority > 0);
+        auto& ready_queue = ready_queues.queues[--priority];
+        for (auto& thread : ready_queue.thread_list) {
+            VERIFY(thread.m_runnable_priority == (int)priority);
+            if (thread.is_active())
+                continue;
+            if (!(thread.affinity() & affinity_mask))
+                continue;
+            return &thread;
         }
-        return *Processor::idle_thread();
+        priority_mask &= ~(1u << priority);
+    }
+    return nullptr;
+}
+
+void Scheduler::remove_from_ready_queues(ThreadReadyQueues& ready_queues, Thread& thread)
+{
+    auto priority = thread.m_runnable_priority;
+    VERIFY(priority >= 0);
+    VERIFY(ready_queues.mask & (1u << priority));
+    auto& ready_queue = ready_queues.queues[priority];
+    thread.m_runnable_priority = -1;
+    thread.m_runnable_processor = -1;
+    ready_queue.thread_list.remove(thread);
+    if (ready_queue.thread_list.is_empty())
+        ready_queues.mask &= ~(1u << priority);
+    VERIFY(ready_queues.thread_count > 0);
+    --ready_queues.thread_count;
+}
+
+Thread* Scheduler::take_runnable_thread_from(u32 cpu, u32 affinity_mask)
+{
+    return ready_queues_for_processor(cpu).with([&](auto& ready_queues) -> Thread* {
+        auto* thread = find_runnable_thread_in(ready_queues, affinity_mask);
+        if (!thread)
+            return nullptr;
+        remove_from_ready_queues(ready_queues, *thread);
+        // Mark it as active because we are using this thread. This is similar
+        // to comparing it with Processor::current_thread, but when there are
+        // multiple processors there's no easy way to check whether the thread
+        // is actually still needed. This prevents accidental finalization when
+        // a thread is no longer in Running state, but running on another core.
+
+        // We need to mark it active here so that this thread won't be
+        // scheduled on another core if it were to be queued before actually
+        // switching to it.
+        // FIXME: Figure out a better way maybe?
+        thread->set_active(true);
+        return thread;
     });
 }
 
-Thread* Scheduler::peek_next_runnable_thread()
+Thread* Scheduler::steal_runnable_thread(u32 current_cpu)
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                return &thread;
-            }
-            priority_mask &= ~(1u << priority);
-        }
+    auto affinity_mask = 1u << current_cpu;
+    auto processor_count = scheduling_processor_count();
+
+    auto try_steal_from = [&](u32 cpu) -> Thread* {
+        auto* thread = take_runnable_thread_from(cpu, affinity_mask);
+        if (thread)
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from processor {}", current_cpu, *thread, cpu);
+        return thread;
+    };
 
-        // Unlike in pull_next_runnable_thread() we don't want to fall back to
-        // the idle thread. We just want to see if we have any other thread ready
-        // to be scheduled.
+    // Try the busiest processor first, that's where stealing helps the most.
+    Optional<u32> busiest_cpu;
+    size_t busiest_thread_count = 0;
+    for (u32 cpu = 0; cpu < processor_count; ++cpu) {
+        if (cpu == current_cpu)
+            continue;
+        auto thread_count = ready_queues_for_processor(cpu).with([](auto& ready_queues) { return ready_queues.thread_count; });
+        if (thread_count > busiest_thread_count) {
+            busiest_cpu = cpu;
+            busiest_thread_count = thread_count;
+        }
+    }
+    if (!busiest_cpu.has_value())
         return nullptr;
-    });
+    if (auto* thread = try_steal_from(*busiest_cpu))
+        return thread;
+
+    // Everything queued on the busiest processor may be pinned elsewhere, so look at the others too.
+    for (u32 i = 1; i < processor_count; ++i) {
+        auto cpu = (current_cpu + i) % processor_count;
+        if (cpu == *busiest_cpu)
+            continue;
+        if (auto* thread = try_steal_from(cpu))
+            return thread;
+    }
+    return nullptr;
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto current_cpu = Processor::current_id();
+
+    if (auto* thread = take_runnable_thread_from(current_cpu, 1u << current_cpu))
+        return *thread;
+
+    // Nothing to do locally, so see if we can help out another processor instead of idling.
+    if (auto* thread = steal_runnable_thread(current_cpu))
+        return *thread;
+
+    return *Processor::idle_thread();
+}
+
+Thread* Scheduler::peek_next_runnable_thread()
+{
+    auto current_cpu = Processor::current_id();
+    auto affinity_mask = 1u << current_cpu;
+
+    // Unlike in pull_next_runnable_thread() we don't want to fall back to
+    // the idle thread. We just want to see if we have any other thread ready
+    // to be scheduled, either locally or on a processor we could steal from.
+    if (auto* thread = ready_queues_for_processor(current_cpu).with([&](auto& ready_queues) { return find_runnable_thread_in(ready_queues, affinity_mask); }))
+        return thread;
+
+    auto processor_count = scheduling_processor_count();
+    for (u32 cpu = 0; cpu < processor_count; ++cpu) {
+        if (cpu == current_cpu)
+            continue;
+        if (auto* thread = ready_queues_for_processor(cpu).with([&](auto& ready_queues) { return find_runnable_thread_in(ready_queues, affinity_mask); }))
+            return thread;
+    }
+    return nullptr;
 }
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
@@ -144,26 +239,55 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
-        auto priority = thread.m_runnable_priority;
-        if (priority < 0) {
-            VERIFY(!thread.m_ready_queue_node.is_in_list());
-            return false;
-        }
+    auto cpu = thread.m_runnable_processor;
+    if (cpu < 0) {
+        VERIFY(thread.m_runnable_priority < 0);
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        return false;
+    }
 
+    return ready_queues_for_processor(cpu).with([&](auto& ready_queues) {
         if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
             return false;
 
-        VERIFY(ready_queues.mask & (1u << priority));
-        auto& ready_queue = ready_queues.queues[priority];
-        thread.m_runnable_priority = -1;
-        ready_queue.thread_list.remove(thread);
-        if (ready_queue.thread_list.is_empty())
-            ready_queues.mask &= ~(1u << priority);
+        remove_from_ready_queues(ready_queues, thread);
         return true;
     });
 }
 
+u32 Scheduler::pick_processor_for(Thread const& thread)
+{
+    auto processor_count = scheduling_processor_count();
+    auto affinity = thread.affinity();
+
+    auto thread_count_on = [](u32 cpu) {
+        return ready_queues_for_processor(cpu).with([](auto& ready_queues) { return ready_queues.thread_count; });
+    };
+
+    Optional<u32> least_loaded_cpu;
+    size_t least_loaded_thread_count = NumericLimits<size_t>::max();
+    for (u32 cpu = 0; cpu < processor_count; ++cpu) {
+        if (!(affinity & (1u << cpu)))
+            continue;
+        auto thread_count = thread_count_on(cpu);
+        if (thread_count < least_loaded_thread_count) {
+            least_loaded_cpu = cpu;
+            least_loaded_thread_count = thread_count;
+        }
+    }
+
+    VERIFY(least_loaded_cpu.has_value());
+
+    // Prefer the processor the thread last ran on, as its caches are likely still warm,
+    // unless that processor is noticeably busier than the least loaded one.
+    auto last_cpu = thread.cpu();
+    if (last_cpu < processor_count && (affinity & (1u << last_cpu))) {
+        if (thread_count_on(last_cpu) < least_loaded_thread_count + load_balancing_threshold)
+            return last_cpu;
+    }
+    return *least_loaded_cpu;
+}
+
 void Scheduler::enqueue_runnable_thread(Thread& thread)
 {
     VERIFY(g_scheduler_lock.is_locked_by_current_processor());
@@ -171,15 +295,25 @@ void Scheduler::enqueue_runnable_thread(Thread& thread)
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
 
-    g_ready_queues->with([&](auto& ready_queues) {
+    // A thread that isn't allowed on any processor that schedules would sit in a queue that nobody picks it from.
+    if (!(thread.affinity() & scheduling_processor_mask())) {
+        dbgln("Scheduler: {} isn't allowed on any scheduling processor (affinity {:#x}), letting it run on all of them", thread, thread.affinity());
+        thread.set_affinity(scheduling_processor_mask());
+    }
+    auto cpu = pick_processor_for(thread);
+
+    ready_queues_for_processor(cpu).with([&](auto& ready_queues) {
         VERIFY(thread.m_runnable_priority < 0);
+        VERIFY(thread.m_runnable_processor < 0);
         thread.m_runnable_priority = (int)priority;
+        thread.m_runnable_processor = (int)cpu;
         VERIFY(!thread.m_ready_queue_node.is_in_list());
         auto& ready_queue = ready_queues.queues[priority];
         bool was_empty = ready_queue.thread_list.is_empty();
         ready_queue.thread_list.append(thread);
         if (was_empty)
             ready_queues.mask |= (1u << priority);
+        ++ready_queues.thread_count;
     });
 }
 
@@ -18,6 +18,7 @@
 namespace Kernel {
 
 struct RegisterState;
+struct ThreadReadyQueues;
 
 extern Thread* g_finalizer;
 extern WaitQueue* g_finalizer_wait_queue;
@@ -56,6 +57,13 @@ public:
     static TotalTimeScheduled get_total_time_scheduled();
     static void add_time_scheduled(u64, bool);
     static u64 (*current_time)();
+
+private:
+    static Thread* find_runnable_thread_in(ThreadReadyQueues&, u32 affinity_mask);
+    static void remove_from_ready_queues(ThreadReadyQueues&, Thread&);
+    static Thread* take_runnable_thread_from(u32 cpu, u32 affinity_mask);
+    static Thread* steal_runnable_thread(u32 current_cpu);
+    static u32 pick_processor_for(Thread const&);
 };
 
 }
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+ErrorOr<FlatPtr> Process::sys$epoll_create(int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto fd_allocation = TRY(allocate_fd());
+    auto epoll = TRY(EPoll::try_create());
+    auto description = TRY(OpenFileDescription::try_create(move(epoll)));
+    description->set_readable(true);
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        fds[fd_allocation.fd].set(move(description), (flags & EPOLL_CLOEXEC) ? FD_CLOEXEC : 0);
+        return fd_allocation.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    auto epoll_description = TRY(open_file_description(params.epfd));
+    if (!epoll_description->is_epoll())
+        return EINVAL;
+    auto& epoll = *epoll_description->epoll();
+
+    auto description = TRY(open_file_description(params.fd));
+    if (description.ptr() == epoll_description.ptr())
+        return EINVAL;
+
+    epoll_event event {};
+    if (params.op != EPOLL_CTL_DEL)
+        TRY(copy_from_user(&event, params.event, sizeof(event)));
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        TRY(epoll.add_watch(params.fd, *description, event));
+        return 0;
+    case EPOLL_CTL_MOD:
+        TRY(epoll.modify_watch(params.fd, *description, event));
+        return 0;
+    case EPOLL_CTL_DEL:
+        TRY(epoll.remove_watch(params.fd, *description));
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    if (params.maxevents <= 0)
+        return EINVAL;
+
+    auto epoll_description = TRY(open_file_description(params.epfd));
+    if (!epoll_description->is_epoll())
+        return EINVAL;
+    auto& epoll = *epoll_description->epoll();
+
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        auto timeout_time = TRY(copy_time_from_user(params.timeout));
+        timeout = Thread::BlockTimeout(false, &timeout_time);
+    }
+
+    sigset_t sigmask = {};
+    if (params.sigmask)
+        TRY(copy_from_user(&sigmask, params.sigmask));
+
+    // There can't be more ready events than open file descriptions, so this also bounds the kernel buffer.
+    size_t max_events = min(static_cast<size_t>(params.maxevents), OpenFileDescriptions::max_open());
+    Vector<epoll_event> events;
+    TRY(events.try_resize(max_events));
+
+    auto* current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask)
+        previous_signal_mask = current_thread->update_signal_mask(sigmask);
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    // A watch can be queued as ready and then stop being ready before we get to it, so keep waiting
+    // on the epoll description until some event survives or the (absolute) deadline passes.
+    for (;;) {
+        size_t event_count = epoll.collect_ready_events(events.span());
+        if (event_count > 0) {
+            dbgln_if(EPOLL_DEBUG, "epoll_wait: {} events on epoll fd {}", event_count, params.epfd);
+            TRY(copy_n_to_user(params.events, events.data(), event_count));
+            return event_count;
+        }
+
+        auto unblocked_flags = BlockFlags::None;
+        auto block_result = current_thread->block<Thread::ReadBlocker>(timeout, *epoll_description, unblocked_flags);
+        if (block_result.was_interrupted())
+            return EINTR;
+        if (block_result == Thread::BlockResult::InterruptedByTimeout) {
+            event_count = epoll.collect_ready_events(events.span());
+            if (event_count > 0)
+                TRY(copy_n_to_user(params.events, events.data(), event_count));
+            return event_count;
+        }
+    }
+}
+
+}
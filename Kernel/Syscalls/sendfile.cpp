@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// The file contents are moved through a kernel buffer of at most this size, so they never
+// have to be copied out to userspace and back in again.
+static constexpr size_t sendfile_chunk_size = 64 * KiB;
+
+ErrorOr<FlatPtr> Process::sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> userspace_offset, size_t count)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    if (count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto in_description = TRY(open_file_description(in_fd));
+    if (!in_description->is_readable())
+        return EBADF;
+    // Only regular files can be read from without blocking, and have a position that we can update.
+    if (!in_description->file().is_inode() || in_description->is_directory())
+        return EINVAL;
+
+    auto out_description = TRY(open_file_description(out_fd));
+    if (!out_description->is_writable())
+        return EBADF;
+
+    off_t offset;
+    if (userspace_offset) {
+        TRY(copy_from_user(&offset, userspace_offset));
+        if (offset < 0)
+            return EINVAL;
+    } else {
+        offset = in_description->offset();
+    }
+
+    dbgln_if(IO_DEBUG, "sys$sendfile({}, {}, {}, {})", out_fd, in_fd, offset, count);
+
+    if (count == 0)
+        return 0;
+
+    auto buffer = TRY(KBuffer::try_create_with_size(min(count, sendfile_chunk_size), Memory::Region::Access::ReadWrite, "sendfile"sv));
+    auto kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer->data());
+
+    size_t total_nwritten = 0;
+    Optional<Error> error;
+    while (total_nwritten < count) {
+        auto chunk_size = min(count - total_nwritten, buffer->size());
+        auto nread_or_error = in_description->read(kernel_buffer, offset + total_nwritten, chunk_size);
+        if (nread_or_error.is_error()) {
+            error = nread_or_error.release_error();
+            break;
+        }
+        auto nread = nread_or_error.value();
+        if (nread == 0)
+            break;
+
+        auto nwritten_or_error = do_write(*out_description, kernel_buffer, nread);
+        if (nwritten_or_error.is_error()) {
+            error = nwritten_or_error.release_error();
+            break;
+        }
+        total_nwritten += nwritten_or_error.value();
+
+        // A non-blocking destination that is full, or a signal.
+        if (nwritten_or_error.value() < nread)
+            break;
+    }
+
+    if (error.has_value() && total_nwritten == 0)
+        return error.release_value();
+
+    off_t new_offset = offset + total_nwritten;
+    if (userspace_offset)
+        TRY(copy_to_user(userspace_offset, &new_offset));
+    else
+        TRY(in_description->seek(new_offset, SEEK_SET));
+
+    return total_nwritten;
+}
+
+}
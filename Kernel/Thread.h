@@ -299,7 +299,7 @@ public:
         virtual bool setup_blocker();
         virtual void finalize();
 
-        Thread& thread() { return m_thread; }
+        Thread& thread() { return *m_thread; }
 
         enum class UnblockImmediatelyReason {
             UnblockConditionAlreadyMet,
@@ -351,6 +351,15 @@ public:
         {
         }
 
+        // Blockers that are never blocked on, like the watches of an EPoll, only live in a BlockerSet
+        // to be told about state changes and should not keep the thread that created them alive.
+        enum class NoThread {
+            Tag,
+        };
+        explicit Blocker(NoThread)
+        {
+        }
+
         void do_set_interrupted_by_death()
         {
             m_was_interrupted_by_death = true;
@@ -381,6 +390,7 @@ public:
                 m_is_blocking = false;
             }
 
+            VERIFY(m_thread);
             m_thread->unblock_from_blocker(*this);
         }
 
@@ -391,7 +401,7 @@ public:
 
     private:
         BlockerSet* m_blocker_set { nullptr };
-        NonnullRefPtr<Thread> m_thread;
+        RefPtr<Thread> m_thread;
         u8 m_was_interrupted_by_signal { 0 };
         bool m_is_blocking { false };
         bool m_was_interrupted_by_death { false };
@@ -602,6 +612,13 @@ public:
         virtual Type blocker_type() const override { return Type::File; }
 
         virtual bool unblock_if_conditions_are_met(bool, void*) = 0;
+
+    protected:
+        FileBlocker() = default;
+        explicit FileBlocker(NoThread tag)
+            : Blocker(tag)
+        {
+        }
     };
 
     class OpenFileDescriptionBlocker : public FileBlocker {
@@ -826,7 +843,12 @@ public:
     u32 cpu() const { return m_cpu.load(AK::MemoryOrder::memory_order_consume); }
     void set_cpu(u32 cpu) { m_cpu.store(cpu, AK::MemoryOrder::memory_order_release); }
     u32 affinity() const { return m_cpu_affinity; }
-    void set_affinity(u32 affinity) { m_cpu_affinity = affinity; }
+    void set_affinity(u32 affinity)
+    {
+        // A thread that isn't allowed on any processor could never run.
+        VERIFY(affinity != 0);
+        m_cpu_affinity = affinity;
+    }
 
     RegisterState& get_register_dump_from_stack();
     const RegisterState& get_register_dump_from_stack() const { return const_cast<Thread*>(this)->get_register_dump_from_stack(); }
@@ -1134,6 +1156,7 @@ private:
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    int m_runnable_processor { -1 };
 
     friend class WaitQueue;
 
@@ -41,6 +41,7 @@ set(E1000E_DEBUG ON)
 set(EDITOR_DEBUG ON)
 set(ELF_IMAGE_DEBUG ON)
 set(EMOJI_DEBUG ON)
+set(EPOLL_DEBUG ON)
 set(ESCAPE_SEQUENCE_DEBUG ON)
 set(ETHERNET_DEBUG ON)
 set(ETHERNET_VERY_DEBUG ON)
@@ -81,6 +82,7 @@ set(ICMP_DEBUG ON)
 set(ICO_DEBUG ON)
 set(IMAGE_DECODER_DEBUG ON)
 set(IMAGE_LOADER_DEBUG ON)
+set(INCREMENTAL_GC_DEBUG ON)
 set(INTEL_GRAPHICS_DEBUG ON)
 set(INTERRUPT_DEBUG ON)
 set(IOAPIC_DEBUG ON)
@@ -110,6 +112,7 @@ set(LOCK_RESTORE_DEBUG ON)
 set(LOCK_SHARED_UPGRADE_DEBUG ON)
 set(LOCK_TRACE_DEBUG ON)
 set(LOOKUPSERVER_DEBUG ON)
+set(LOOPBACK_DEBUG ON)
 set(MALLOC_DEBUG ON)
 set(MARKDOWN_DEBUG ON)
 set(MATROSKA_DEBUG ON)
@@ -2235,6 +2235,12 @@ public:
 private:
 )~~~");
 
+    if (interface.is_legacy_platform_object() || interface.extended_attributes.contains("CustomGet") || interface.extended_attributes.contains("CustomSet")) {
+        generator.append(R"~~~(
+    virtual bool may_interfere_with_property_lookup_caches() const override { return true; }
+)~~~");
+    }
+
     if (interface.is_legacy_platform_object()) {
         generator.append(R"~~~(
     JS::ThrowCompletionOr<bool> is_named_property_exposed_on_object(JS::PropertyKey const&) const;
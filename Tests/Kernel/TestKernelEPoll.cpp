@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+struct Pipe {
+    Pipe()
+    {
+        VERIFY(pipe(fds) == 0);
+    }
+    ~Pipe()
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+    int read_fd() const { return fds[0]; }
+    int write_fd() const { return fds[1]; }
+
+    int fds[2];
+};
+
+static int add_watch(int epfd, int fd, u32 events)
+{
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event);
+}
+
+TEST_CASE(level_triggered)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    EXPECT(epfd >= 0);
+    Pipe pipe;
+    EXPECT_EQ(add_watch(epfd, pipe.read_fd(), EPOLLIN), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    EXPECT_EQ(write(pipe.write_fd(), "ab", 2), 2);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+    EXPECT_EQ(events[0].data.fd, pipe.read_fd());
+    EXPECT(events[0].events & EPOLLIN);
+
+    // The pipe is still readable, so it has to be reported again.
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+
+    char buffer[2];
+    EXPECT_EQ(read(pipe.read_fd(), buffer, 2), 2);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+    close(epfd);
+}
+
+TEST_CASE(edge_triggered)
+{
+    int epfd = epoll_create1(0);
+    Pipe pipe;
+    EXPECT_EQ(add_watch(epfd, pipe.read_fd(), EPOLLIN | EPOLLET), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(write(pipe.write_fd(), "a", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+    // Nothing changed since the last report.
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    EXPECT_EQ(write(pipe.write_fd(), "b", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+    close(epfd);
+}
+
+TEST_CASE(oneshot_and_modify)
+{
+    int epfd = epoll_create1(0);
+    Pipe pipe;
+    EXPECT_EQ(add_watch(epfd, pipe.read_fd(), EPOLLIN | EPOLLONESHOT), 0);
+    EXPECT_EQ(add_watch(epfd, pipe.read_fd(), EPOLLIN), -1);
+    EXPECT_EQ(errno, EEXIST);
+
+    epoll_event events[4];
+    EXPECT_EQ(write(pipe.write_fd(), "a", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+    EXPECT_EQ(write(pipe.write_fd(), "b", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    // Re-arming the watch reports the data that's already there.
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u64 = 1234;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_MOD, pipe.read_fd(), &event), 0);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.u64, 1234u);
+
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, pipe.read_fd(), nullptr), 0);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, pipe.read_fd(), nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+    close(epfd);
+}
+
+TEST_CASE(only_ready_fds_are_reported)
+{
+    int epfd = epoll_create1(0);
+    Pipe pipes[16];
+    for (auto& pipe : pipes)
+        EXPECT_EQ(add_watch(epfd, pipe.read_fd(), EPOLLIN), 0);
+
+    EXPECT_EQ(write(pipes[3].write_fd(), "a", 1), 1);
+    EXPECT_EQ(write(pipes[11].write_fd(), "a", 1), 1);
+
+    epoll_event events[16];
+    int count = epoll_wait(epfd, events, 16, 1000);
+    EXPECT_EQ(count, 2);
+    for (int i = 0; i < count; ++i)
+        EXPECT(events[i].data.fd == pipes[3].read_fd() || events[i].data.fd == pipes[11].read_fd());
+
+    // A small buffer gets the ready fds in turns.
+    EXPECT_EQ(epoll_wait(epfd, events, 1, 0), 1);
+    int first_fd = events[0].data.fd;
+    EXPECT_EQ(epoll_wait(epfd, events, 1, 0), 1);
+    EXPECT_NE(events[0].data.fd, first_fd);
+    close(epfd);
+}
+
+TEST_CASE(closing_the_fd_removes_the_watch)
+{
+    int epfd = epoll_create1(0);
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    EXPECT_EQ(add_watch(epfd, fds[0], EPOLLIN), 0);
+    EXPECT_EQ(write(fds[1], "a", 1), 1);
+    close(fds[0]);
+    close(fds[1]);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+    close(epfd);
+}
+
+TEST_CASE(invalid_arguments)
+{
+    int epfd = epoll_create1(0);
+    Pipe pipe;
+    epoll_event events[1];
+    EXPECT_EQ(epoll_wait(pipe.read_fd(), events, 1, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(epoll_wait(epfd, events, 0, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(add_watch(epfd, epfd, EPOLLIN), -1);
+    EXPECT_EQ(errno, EINVAL);
+    close(epfd);
+}
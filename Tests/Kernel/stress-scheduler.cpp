@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <AK/ScopeGuard.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Measures context switch throughput by bouncing a byte between pairs of threads over pipes.
+// Every round trip forces two context switches, and with N pairs there are N independent
+// streams of work for the scheduler to spread across processors.
+
+struct PingPongPair {
+    int ping_fds[2] { -1, -1 };
+    int pong_fds[2] { -1, -1 };
+    int round_trips { 0 };
+    pthread_t ping_thread {};
+    pthread_t pong_thread {};
+};
+
+static void* ping(void* argument)
+{
+    auto& pair = *static_cast<PingPongPair*>(argument);
+    char byte = 0;
+    for (int i = 0; i < pair.round_trips; ++i) {
+        if (write(pair.ping_fds[1], &byte, 1) != 1 || read(pair.pong_fds[0], &byte, 1) != 1) {
+            warnln("ping: {}", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+    }
+    return nullptr;
+}
+
+static void* pong(void* argument)
+{
+    auto& pair = *static_cast<PingPongPair*>(argument);
+    char byte = 0;
+    for (int i = 0; i < pair.round_trips; ++i) {
+        if (read(pair.ping_fds[0], &byte, 1) != 1 || write(pair.pong_fds[1], &byte, 1) != 1) {
+            warnln("pong: {}", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+    }
+    return nullptr;
+}
+
+static double seconds_since(timespec const& start)
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1'000'000'000.0;
+}
+
+static bool run_with_pairs(int pair_count, int round_trips)
+{
+    Vector<PingPongPair> pairs;
+    pairs.resize(pair_count);
+    ScopeGuard close_pipes = [&] {
+        for (auto& pair : pairs) {
+            for (int fd : { pair.ping_fds[0], pair.ping_fds[1], pair.pong_fds[0], pair.pong_fds[1] }) {
+                if (fd >= 0)
+                    close(fd);
+            }
+        }
+    };
+    for (auto& pair : pairs) {
+        pair.round_trips = round_trips;
+        if (pipe(pair.ping_fds) < 0 || pipe(pair.pong_fds) < 0) {
+            warnln("pipe: {}", strerror(errno));
+            return false;
+        }
+    }
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (auto& pair : pairs) {
+        int rc = pthread_create(&pair.pong_thread, nullptr, pong, &pair);
+        if (rc == 0)
+            rc = pthread_create(&pair.ping_thread, nullptr, ping, &pair);
+        if (rc != 0) {
+            warnln("pthread_create: {}", strerror(rc));
+            return false;
+        }
+    }
+    for (auto& pair : pairs) {
+        pthread_join(pair.ping_thread, nullptr);
+        pthread_join(pair.pong_thread, nullptr);
+    }
+
+    auto elapsed = seconds_since(start);
+    auto switches = 2.0 * round_trips * pair_count;
+    auto switches_per_second = static_cast<u64>(switches / elapsed);
+    outln("{:3} pair(s): {:>8.3} s, {:12} context switches/s, {:8} per pair/s", pair_count, elapsed, switches_per_second, switches_per_second / pair_count);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int max_pairs = sysconf(_SC_NPROCESSORS_ONLN);
+    int round_trips = 20000;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure context switch throughput with 1 up to N concurrently active pairs of threads.");
+    args_parser.add_option(max_pairs, "Maximum number of thread pairs (defaults to the number of processors)", "pairs", 'p', "number");
+    args_parser.add_option(round_trips, "Number of round trips per pair", "round-trips", 'n', "number");
+    args_parser.parse(argc, argv);
+
+    if (max_pairs < 1)
+        max_pairs = 1;
+
+    for (int pair_count = 1; pair_count <= max_pairs; ++pair_count) {
+        if (!run_with_pairs(pair_count, round_trips))
+            return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Pushes a stream through a TCP connection over 127.0.0.1 and reports the goodput.
+// With --drop-rate, the loopback adapter drops that many out of every 1000 packets (needs root).
+
+static constexpr char const* drop_rate_path = "/proc/sys/loopback_drop_rate";
+
+static Optional<int> read_drop_rate()
+{
+    int fd = open(drop_rate_path, O_RDONLY);
+    if (fd < 0)
+        return {};
+    char buffer[16] {};
+    auto nread = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (nread <= 0)
+        return {};
+    return atoi(buffer);
+}
+
+static bool write_drop_rate(int drop_rate)
+{
+    int fd = open(drop_rate_path, O_WRONLY);
+    if (fd < 0) {
+        perror("open");
+        return false;
+    }
+    char buffer[16];
+    int length = snprintf(buffer, sizeof(buffer), "%d", drop_rate);
+    bool ok = write(fd, buffer, length) == length;
+    if (!ok)
+        perror("write");
+    close(fd);
+    return ok;
+}
+
+static u8 pattern_byte(size_t offset)
+{
+    return (offset * 31 + (offset >> 12)) & 0xff;
+}
+
+static int run_sender(u16 port, size_t total_size, size_t chunk_size)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr const*)&address, sizeof(address)) < 0) {
+        perror("connect");
+        return 1;
+    }
+
+    auto buffer = ByteBuffer::create_uninitialized(chunk_size).release_value();
+    size_t sent = 0;
+    while (sent < total_size) {
+        size_t count = min(chunk_size, total_size - sent);
+        for (size_t i = 0; i < count; ++i)
+            buffer[i] = pattern_byte(sent + i);
+        size_t offset = 0;
+        while (offset < count) {
+            auto nwritten = write(fd, buffer.data() + offset, count - offset);
+            if (nwritten < 0) {
+                perror("write");
+                return 1;
+            }
+            offset += nwritten;
+        }
+        sent += count;
+    }
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int size_in_mib = 64;
+    int chunk_size = 64 * KiB;
+    int drop_rate = -1;
+    int port = 8642;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure TCP goodput over the loopback adapter, optionally with simulated packet loss.");
+    args_parser.add_option(size_in_mib, "Amount of data to send in MiB", "size", 's', "size");
+    args_parser.add_option(chunk_size, "Size of each write and read", "chunk-size", 'c', "bytes");
+    args_parser.add_option(drop_rate, "Packets dropped out of every 1000", "drop-rate", 'd', "per-mille");
+    args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
+    args_parser.parse(argc, argv);
+
+    if (size_in_mib <= 0 || chunk_size <= 0 || drop_rate > 1000) {
+        args_parser.print_usage(stderr, argv[0]);
+        return 1;
+    }
+
+    auto previous_drop_rate = read_drop_rate();
+    if (drop_rate >= 0 && !write_drop_rate(drop_rate))
+        return 1;
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listen_fd, (sockaddr const*)&address, sizeof(address)) < 0 || listen(listen_fd, 1) < 0) {
+        perror("bind/listen");
+        return 1;
+    }
+
+    size_t total_size = static_cast<size_t>(size_in_mib) * MiB;
+
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (child == 0) {
+        close(listen_fd);
+        _exit(run_sender(port, total_size, chunk_size));
+    }
+
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        perror("accept");
+        return 1;
+    }
+
+    auto buffer = ByteBuffer::create_uninitialized(chunk_size).release_value();
+    size_t received = 0;
+    bool corrupted = false;
+    auto timer = Core::ElapsedTimer::start_new();
+    while (received < total_size) {
+        auto nread = read(fd, buffer.data(), buffer.size());
+        if (nread < 0) {
+            perror("read");
+            break;
+        }
+        if (nread == 0)
+            break;
+        for (ssize_t i = 0; i < nread && !corrupted; ++i) {
+            if (buffer[i] != pattern_byte(received + i)) {
+                fprintf(stderr, "Data mismatch at offset %zu\n", received + i);
+                corrupted = true;
+            }
+        }
+        received += nread;
+    }
+    int elapsed_ms = max(timer.elapsed(), 1);
+
+    close(fd);
+    close(listen_fd);
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    if (drop_rate >= 0 && previous_drop_rate.has_value())
+        write_drop_rate(previous_drop_rate.value());
+
+    printf("Received %zu of %zu bytes in %d ms: %.2f MiB/s (drop rate %d/1000)\n",
+        received, total_size, elapsed_ms,
+        (double)received / MiB / ((double)elapsed_ms / 1000),
+        drop_rate >= 0 ? drop_rate : previous_drop_rate.value_or(0));
+
+    if (corrupted || received != total_size || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return 1;
+    return 0;
+}
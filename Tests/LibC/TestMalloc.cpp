@@ -6,9 +6,12 @@
 
 #include <LibTest/TestCase.h>
 
+#include <AK/Array.h>
 #include <LibC/mallocdefs.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 TEST_CASE(malloc_limits)
 {
@@ -38,3 +41,122 @@ TEST_CASE(malloc_limits)
         return Test::Crash::Failure::DidNotCrash;
     });
 }
+
+static constexpr size_t allocations_per_thread = 1000;
+
+TEST_CASE(free_allocations_of_another_thread)
+{
+    Array<void*, allocations_per_thread> allocations {};
+
+    pthread_t thread;
+    auto rc = pthread_create(
+        &thread, nullptr, [](void* argument) -> void* {
+            auto& allocations = *static_cast<Array<void*, allocations_per_thread>*>(argument);
+            for (size_t i = 0; i < allocations.size(); ++i) {
+                auto size = size_classes[i % num_size_classes];
+                allocations[i] = malloc(size);
+                memset(allocations[i], static_cast<int>(i), size);
+            }
+            return nullptr;
+        },
+        &allocations);
+    EXPECT_EQ(rc, 0);
+    EXPECT_EQ(pthread_join(thread, nullptr), 0);
+
+    // The other thread is gone, and the chunks it had cached should be usable again.
+    for (size_t i = 0; i < allocations.size(); ++i) {
+        auto size = size_classes[i % num_size_classes];
+        auto* bytes = static_cast<u8*>(allocations[i]);
+        EXPECT_EQ(bytes[0], static_cast<u8>(i));
+        EXPECT_EQ(bytes[size - 1], static_cast<u8>(i));
+        free(allocations[i]);
+    }
+
+    for (size_t i = 0; i < allocations.size(); ++i)
+        allocations[i] = malloc(size_classes[i % num_size_classes]);
+    for (auto* allocation : allocations)
+        free(allocation);
+}
+
+static constexpr size_t cached_size_class_count = [] {
+    size_t count = 0;
+    while (size_classes[count] && size_classes[count] <= thread_cache_max_chunk_size)
+        ++count;
+    return count;
+}();
+
+TEST_CASE(chunks_freed_by_another_thread_are_reused)
+{
+    if (getenv("LIBC_NOCACHE_MALLOC"))
+        return;
+
+    Array<void*, cached_size_class_count> allocations {};
+
+    pthread_t thread;
+    auto rc = pthread_create(
+        &thread, nullptr, [](void* argument) -> void* {
+            auto& allocations = *static_cast<Array<void*, cached_size_class_count>*>(argument);
+            for (size_t i = 0; i < cached_size_class_count; ++i)
+                allocations[i] = malloc(size_classes[i]);
+            return nullptr;
+        },
+        &allocations);
+    EXPECT_EQ(rc, 0);
+    EXPECT_EQ(pthread_join(thread, nullptr), 0);
+
+    // Start from empty caches, so that each chunk freed below is the first one handed out again.
+    __malloc_release_thread_cache();
+    for (size_t i = 0; i < cached_size_class_count; ++i)
+        free(allocations[i]);
+
+    Array<void*, cached_size_class_count> reused {};
+    for (size_t i = 0; i < cached_size_class_count; ++i)
+        reused[i] = malloc(size_classes[i]);
+
+    for (size_t i = 0; i < cached_size_class_count; ++i) {
+        EXPECT_EQ(reused[i], allocations[i]);
+        EXPECT_EQ(malloc_size(reused[i]), static_cast<size_t>(size_classes[i]));
+        free(reused[i]);
+    }
+}
+
+static void* churn_small_allocations(void*)
+{
+    static constexpr size_t working_set_size = 64;
+    static constexpr size_t iterations = 1'000'000;
+
+    Array<void*, working_set_size> working_set {};
+    for (size_t i = 0; i < iterations; ++i) {
+        auto& slot = working_set[(i * 7) % working_set_size];
+        free(slot);
+        slot = malloc(16 + (i % 31) * 16);
+    }
+    for (auto* allocation : working_set)
+        free(allocation);
+    return nullptr;
+}
+
+static void churn_small_allocations_on_threads(size_t thread_count)
+{
+    Array<pthread_t, 8> threads {};
+    VERIFY(thread_count <= threads.size());
+    for (size_t i = 0; i < thread_count; ++i)
+        EXPECT_EQ(pthread_create(&threads[i], nullptr, churn_small_allocations, nullptr), 0);
+    for (size_t i = 0; i < thread_count; ++i)
+        EXPECT_EQ(pthread_join(threads[i], nullptr), 0);
+}
+
+BENCHMARK_CASE(malloc_free_churn_1_thread)
+{
+    churn_small_allocations_on_threads(1);
+}
+
+BENCHMARK_CASE(malloc_free_churn_4_threads)
+{
+    churn_small_allocations_on_threads(4);
+}
+
+BENCHMARK_CASE(malloc_free_churn_8_threads)
+{
+    churn_small_allocations_on_threads(8);
+}
@@ -9,7 +9,9 @@
 #include <AK/Array.h>
 #include <AK/MemoryStream.h>
 #include <AK/Random.h>
+#include <AK/StringBuilder.h>
 #include <LibCompress/Deflate.h>
+#include <LibCore/ElapsedTimer.h>
 #include <cstring>
 
 TEST_CASE(canonical_code_simple)
@@ -154,3 +156,122 @@ TEST_CASE(deflate_compress_literals)
     auto compressed = Compress::DeflateCompressor::compress_all(test, Compress::DeflateCompressor::CompressionLevel::GOOD);
     EXPECT(compressed.has_value());
 }
+
+// Deterministic, text-like input that compresses roughly as well as source code does.
+static ByteBuffer generate_text(size_t size)
+{
+    static constexpr Array words {
+        "the"sv, "deflate"sv, "compressor"sv, "return"sv, "size_t"sv, "window"sv, "for"sv, "if"sv, "match"sv, "length"sv,
+        "auto"sv, "const"sv, "block"sv, "hash"sv, "of"sv, "and"sv, "stream"sv, "bytes"sv, "to"sv, "literal"sv
+    };
+    StringBuilder builder;
+    u32 state = 0x12345678;
+    while (builder.length() < size) {
+        state = state * 1103515245 + 12345;
+        builder.append(words[(state >> 16) % words.size()]);
+        builder.append(((state >> 8) % 11) == 0 ? '\n' : ' ');
+    }
+    return MUST(ByteBuffer::copy(builder.string_view().bytes().slice(0, size)));
+}
+
+TEST_CASE(deflate_round_trip_compress_across_blocks)
+{
+    auto size = Compress::DeflateCompressor::block_size * 3;
+    auto original = ByteBuffer::create_uninitialized(size).release_value();
+    fill_with_random(original.data(), Compress::DeflateCompressor::block_size);
+    // The later blocks repeat the first one, so they can only be compressed by looking back into the previous block
+    original.bytes().slice(0, Compress::DeflateCompressor::block_size).copy_to(original.bytes().slice(Compress::DeflateCompressor::block_size));
+    original.bytes().slice(0, Compress::DeflateCompressor::block_size).copy_to(original.bytes().slice(Compress::DeflateCompressor::block_size * 2));
+
+    for (auto level : { Compress::DeflateCompressor::CompressionLevel::FAST, Compress::DeflateCompressor::CompressionLevel::GOOD }) {
+        auto compressed = Compress::DeflateCompressor::compress_all(original, level);
+        EXPECT(compressed.has_value());
+        EXPECT(compressed->size() < Compress::DeflateCompressor::block_size + 1024);
+        auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+        EXPECT(uncompressed.has_value());
+        EXPECT(uncompressed.value() == original);
+    }
+}
+
+TEST_CASE(deflate_round_trip_compress_parallel)
+{
+    auto original = generate_text(Compress::DeflateCompressor::parallel_slice_size * 4 + 1000);
+    auto serial = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST);
+    auto parallel = Compress::DeflateCompressor::compress_all_parallel(original, 4, Compress::DeflateCompressor::CompressionLevel::FAST);
+    EXPECT(serial.has_value());
+    EXPECT(parallel.has_value());
+    // Every slice starts with the previous slice's data as its dictionary, so splitting the input should barely matter
+    EXPECT(parallel->size() < serial->size() + serial->size() / 50);
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(parallel.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
+
+TEST_CASE(deflate_round_trip_long_codes)
+{
+    // Symbol frequencies that halve from one byte value to the next produce huffman codes longer than the primary decode table
+    ByteBuffer original;
+    u32 state = 1;
+    for (size_t i = 0; i < 64 * KiB; i++) {
+        state = state * 1103515245 + 12345;
+        original.append(static_cast<u8>(count_trailing_zeroes(state | 0x10000) * 13));
+    }
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD);
+    EXPECT(compressed.has_value());
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
+
+static void benchmark_compression_level(Compress::DeflateCompressor::CompressionLevel level, size_t thread_count = 1)
+{
+    auto original = generate_text(4 * MiB);
+    auto timer = Core::ElapsedTimer::start_new();
+    auto compressed = Compress::DeflateCompressor::compress_all_parallel(original, thread_count, level);
+    auto elapsed_milliseconds = max(timer.elapsed(), 1);
+    EXPECT(compressed.has_value());
+    outln("ratio {:.3}, {} MB/s", static_cast<double>(compressed->size()) / original.size(), original.size() / 1000 / elapsed_milliseconds);
+
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
+
+BENCHMARK_CASE(deflate_compress_store)
+{
+    benchmark_compression_level(Compress::DeflateCompressor::CompressionLevel::STORE);
+}
+
+BENCHMARK_CASE(deflate_compress_fast)
+{
+    benchmark_compression_level(Compress::DeflateCompressor::CompressionLevel::FAST);
+}
+
+BENCHMARK_CASE(deflate_compress_good)
+{
+    benchmark_compression_level(Compress::DeflateCompressor::CompressionLevel::GOOD);
+}
+
+BENCHMARK_CASE(deflate_compress_great)
+{
+    benchmark_compression_level(Compress::DeflateCompressor::CompressionLevel::GREAT);
+}
+
+BENCHMARK_CASE(deflate_compress_good_4_threads)
+{
+    benchmark_compression_level(Compress::DeflateCompressor::CompressionLevel::GOOD, 4);
+}
+
+BENCHMARK_CASE(deflate_decompress)
+{
+    auto original = generate_text(4 * MiB);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD);
+    EXPECT(compressed.has_value());
+
+    auto timer = Core::ElapsedTimer::start_new();
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    auto elapsed_milliseconds = max(timer.elapsed(), 1);
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+    outln("{} MB/s", original.size() / 1000 / elapsed_milliseconds);
+}
@@ -95,3 +95,15 @@ TEST_CASE(gzip_round_trip)
     EXPECT(uncompressed.has_value());
     EXPECT(uncompressed.value() == original);
 }
+
+TEST_CASE(gzip_round_trip_parallel)
+{
+    auto size = Compress::DeflateCompressor::parallel_slice_size * 3;
+    auto original = ByteBuffer::create_zeroed(size).release_value();
+    fill_with_random(original.data(), size / 2);
+    auto compressed = Compress::GzipCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD, 3);
+    EXPECT(compressed.has_value());
+    auto uncompressed = Compress::GzipDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
@@ -61,3 +61,104 @@ BENCHMARK_CASE(fill_with_gradient)
         painter.fill_rect_with_gradient(bitmap->rect(), Color::Blue, Color::Red);
     }
 }
+
+BENCHMARK_CASE(fill_translucent)
+{
+    const int run_count = 100;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.fill_rect(bitmap->rect(), Color(Color::Blue).with_alpha(128));
+    }
+}
+
+// Fills a bitmap with varying colors and alphas, so that blending can't take any shortcuts.
+static NonnullRefPtr<Gfx::Bitmap> create_blit_bitmap(Gfx::BitmapFormat format, int size)
+{
+    auto bitmap = Gfx::Bitmap::try_create(format, { size, size }).release_value_but_fixme_should_propagate_errors();
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++)
+            bitmap->set_pixel(x, y, Color(x, y, x + y, x * y));
+    }
+    return bitmap;
+}
+
+static void blit(Gfx::BitmapFormat source_format, Gfx::BitmapFormat target_format, float opacity)
+{
+    const int run_count = 50;
+    const int bitmap_size = 2000;
+
+    auto source = create_blit_bitmap(source_format, bitmap_size);
+    auto target = create_blit_bitmap(target_format, bitmap_size);
+    Gfx::Painter painter(target);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({ 0, 0 }, source, source->rect(), opacity);
+    }
+}
+
+BENCHMARK_CASE(blit_opaque)
+{
+    blit(Gfx::BitmapFormat::BGRx8888, Gfx::BitmapFormat::BGRx8888, 1.0f);
+}
+
+BENCHMARK_CASE(blit_with_opacity_no_alpha)
+{
+    blit(Gfx::BitmapFormat::BGRx8888, Gfx::BitmapFormat::BGRx8888, 0.5f);
+}
+
+BENCHMARK_CASE(blit_with_opacity_src_alpha)
+{
+    blit(Gfx::BitmapFormat::BGRA8888, Gfx::BitmapFormat::BGRx8888, 0.5f);
+}
+
+BENCHMARK_CASE(blit_with_opacity_dst_alpha)
+{
+    blit(Gfx::BitmapFormat::BGRx8888, Gfx::BitmapFormat::BGRA8888, 0.5f);
+}
+
+BENCHMARK_CASE(blit_with_opacity_both_alpha)
+{
+    blit(Gfx::BitmapFormat::BGRA8888, Gfx::BitmapFormat::BGRA8888, 0.5f);
+}
+
+BENCHMARK_CASE(blit_alpha_blended)
+{
+    blit(Gfx::BitmapFormat::BGRA8888, Gfx::BitmapFormat::BGRA8888, 1.0f);
+}
+
+static void draw_scaled(Gfx::Painter::ScalingMode scaling_mode, int source_size, int target_size)
+{
+    const int run_count = 10;
+
+    auto source = create_blit_bitmap(Gfx::BitmapFormat::BGRA8888, source_size);
+    auto target = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { target_size, target_size }).release_value_but_fixme_should_propagate_errors();
+    Gfx::Painter painter(target);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.draw_scaled_bitmap(target->rect(), source, source->rect(), 1.0f, scaling_mode);
+    }
+}
+
+BENCHMARK_CASE(draw_scaled_down_bilinear)
+{
+    draw_scaled(Gfx::Painter::ScalingMode::BilinearBlend, 2000, 300);
+}
+
+BENCHMARK_CASE(draw_scaled_down_box_sampling)
+{
+    draw_scaled(Gfx::Painter::ScalingMode::BoxSampling, 2000, 300);
+}
+
+BENCHMARK_CASE(draw_scaled_down_lanczos)
+{
+    draw_scaled(Gfx::Painter::ScalingMode::Lanczos, 2000, 300);
+}
+
+BENCHMARK_CASE(draw_scaled_up_lanczos)
+{
+    draw_scaled(Gfx::Painter::ScalingMode::Lanczos, 300, 1200);
+}
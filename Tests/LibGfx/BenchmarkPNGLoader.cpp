@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibCore/MappedFile.h>
+#include <LibGfx/PNGLoader.h>
+
+static void decode_png(StringView path, Gfx::IntSize target_size = {})
+{
+    const int run_count = 20;
+    auto file = Core::MappedFile::map(path).release_value();
+
+    for (int run = 0; run < run_count; run++) {
+        auto png = Gfx::PNGImageDecoderPlugin((u8 const*)file->data(), file->size());
+        if (!target_size.is_empty())
+            png.set_target_size(target_size);
+        auto frame = png.frame(0).release_value_but_fixme_should_propagate_errors();
+        EXPECT(frame.image);
+    }
+}
+
+// An RGB wallpaper, filtered mostly with Sub and Paeth.
+BENCHMARK_CASE(decode_rgb)
+{
+    decode_png("/res/wallpapers/sunset-retro.png"sv);
+}
+
+// An RGBA screenshot.
+BENCHMARK_CASE(decode_rgba)
+{
+    decode_png("/res/html/misc/serenity-screenshot.png"sv);
+}
+
+BENCHMARK_CASE(decode_to_target_size)
+{
+    decode_png("/res/wallpapers/sunset-retro.png"sv, { 256, 256 });
+}
@@ -21,6 +21,48 @@
 #include <stdlib.h>
 #include <string.h>
 
+static size_t count_differing_pixels(Gfx::Bitmap const& bitmap, Gfx::Bitmap const& reference)
+{
+    VERIFY(bitmap.size() == reference.size());
+    size_t differing_pixels = 0;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            if (bitmap.get_pixel(x, y) != reference.get_pixel(x, y))
+                ++differing_pixels;
+        }
+    }
+    return differing_pixels;
+}
+
+// Averages every factor x factor block of pixels into one, weighting colors by their alpha, like decoders do when
+// they are given a target size.
+static NonnullRefPtr<Gfx::Bitmap> box_downscale(Gfx::Bitmap const& bitmap, int factor)
+{
+    auto scaled = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { ceil_div(bitmap.width(), factor), ceil_div(bitmap.height(), factor) }).release_value_but_fixme_should_propagate_errors();
+    for (int scaled_y = 0; scaled_y < scaled->height(); ++scaled_y) {
+        for (int scaled_x = 0; scaled_x < scaled->width(); ++scaled_x) {
+            u64 red = 0, green = 0, blue = 0, alpha = 0, pixel_count = 0;
+            for (int y = scaled_y * factor; y < min((scaled_y + 1) * factor, bitmap.height()); ++y) {
+                for (int x = scaled_x * factor; x < min((scaled_x + 1) * factor, bitmap.width()); ++x) {
+                    auto color = bitmap.get_pixel(x, y);
+                    red += color.red() * color.alpha();
+                    green += color.green() * color.alpha();
+                    blue += color.blue() * color.alpha();
+                    alpha += color.alpha();
+                    ++pixel_count;
+                }
+            }
+            if (alpha == 0) {
+                scaled->set_pixel(scaled_x, scaled_y, Gfx::Color::Transparent);
+                continue;
+            }
+            auto average = [&](u64 sum) { return static_cast<u8>((sum + alpha / 2) / alpha); };
+            scaled->set_pixel(scaled_x, scaled_y, Gfx::Color(average(red), average(green), average(blue), static_cast<u8>((alpha + pixel_count / 2) / pixel_count)));
+        }
+    }
+    return scaled;
+}
+
 TEST_CASE(test_bmp)
 {
     auto file = Core::MappedFile::map("/res/html/misc/bmpsuite_files/rgba32-1.bmp").release_value();
@@ -77,6 +119,48 @@ TEST_CASE(test_jpg)
     EXPECT(frame.duration == 0);
 }
 
+TEST_CASE(test_jpg_restart_intervals)
+{
+    auto file = Core::MappedFile::map("/res/html/misc/jpgsuite_files/restart-intervals-lena.jpg").release_value();
+    auto jpg = Gfx::JPGImageDecoderPlugin((u8 const*)file->data(), file->size());
+    EXPECT(jpg.frame_count());
+    auto frame = jpg.frame(0).release_value_but_fixme_should_propagate_errors();
+
+    // The reference was decoded by libjpeg, with the islow IDCT and without fancy upsampling.
+    auto reference_file = Core::MappedFile::map("/res/html/misc/jpgsuite_files/restart-intervals-lena-libjpeg.png").release_value();
+    auto reference_png = Gfx::PNGImageDecoderPlugin((u8 const*)reference_file->data(), reference_file->size());
+    auto reference = reference_png.frame(0).release_value_but_fixme_should_propagate_errors();
+    EXPECT_EQ(frame.image->size(), reference.image->size());
+    EXPECT_EQ(count_differing_pixels(*frame.image, *reference.image), 0u);
+
+    // The restart intervals are spread over several threads, which must not change the decoded image.
+    auto threaded_jpg = Gfx::JPGImageDecoderPlugin((u8 const*)file->data(), file->size());
+    threaded_jpg.set_decoding_thread_count(4);
+    auto threaded_frame = threaded_jpg.frame(0).release_value_but_fixme_should_propagate_errors();
+
+    EXPECT_EQ(frame.image->size(), threaded_frame.image->size());
+    EXPECT_EQ(frame.image->size_in_bytes(), threaded_frame.image->size_in_bytes());
+    EXPECT(!__builtin_memcmp(frame.image->scanline(0), threaded_frame.image->scanline(0), frame.image->size_in_bytes()));
+}
+
+TEST_CASE(test_jpg_target_size)
+{
+    auto file = Core::MappedFile::map("/res/html/misc/jpgsuite_files/oh-lena.jpg").release_value();
+    auto jpg = Gfx::JPGImageDecoderPlugin((u8 const*)file->data(), file->size());
+    jpg.set_target_size({ 150, 150 });
+
+    // The image is decoded at 1/8 of its size, rounding up.
+    auto frame = jpg.frame(0).release_value_but_fixme_should_propagate_errors();
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(150, 103));
+
+    // The reference was decoded by libjpeg at a scale of 1/8, with the islow IDCT and without fancy upsampling.
+    auto reference_file = Core::MappedFile::map("/res/html/misc/jpgsuite_files/oh-lena-libjpeg-eighth.png").release_value();
+    auto reference_png = Gfx::PNGImageDecoderPlugin((u8 const*)reference_file->data(), reference_file->size());
+    auto reference = reference_png.frame(0).release_value_but_fixme_should_propagate_errors();
+    EXPECT_EQ(frame.image->size(), reference.image->size());
+    EXPECT_EQ(count_differing_pixels(*frame.image, *reference.image), 0u);
+}
+
 TEST_CASE(test_pbm)
 {
     auto file = Core::MappedFile::map("/res/html/misc/pbmsuite_files/buggie-raw.pbm").release_value();
@@ -119,6 +203,22 @@ TEST_CASE(test_png)
     EXPECT(frame.duration == 0);
 }
 
+TEST_CASE(test_png_target_size)
+{
+    auto file = Core::MappedFile::map("/res/html/misc/serenity-screenshot.png").release_value();
+    auto png = Gfx::PNGImageDecoderPlugin((u8 const*)file->data(), file->size());
+    png.set_target_size({ 256, 256 });
+
+    auto frame = png.frame(0).release_value_but_fixme_should_propagate_errors();
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(256, 192));
+
+    auto full_size_png = Gfx::PNGImageDecoderPlugin((u8 const*)file->data(), file->size());
+    auto full_size_frame = full_size_png.frame(0).release_value_but_fixme_should_propagate_errors();
+    auto reference = box_downscale(*full_size_frame.image, 4);
+    EXPECT_EQ(frame.image->size(), reference->size());
+    EXPECT_EQ(count_differing_pixels(*frame.image, *reference), 0u);
+}
+
 TEST_CASE(test_ppm)
 {
     auto file = Core::MappedFile::map("/res/html/misc/ppmsuite_files/buggie-raw.ppm").release_value();
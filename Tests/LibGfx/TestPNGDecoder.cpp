@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/Function.h>
+#include <AK/Vector.h>
+#include <LibCrypto/Checksum/Adler32.h>
+#include <LibCrypto/Checksum/CRC32.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/PNGLoader.h>
+#include <LibTest/TestCase.h>
+
+// These tests encode small images with every filter type, bit depth and color type, and check that the decoder
+// reproduces the samples they were made of. The encoder is kept as simple as possible: it filters every scanline
+// the straightforward way and stores the result in uncompressed deflate blocks.
+
+enum class ColorType : u8 {
+    Grayscale = 0,
+    Truecolor = 2,
+    IndexedColor = 3,
+    GrayscaleWithAlpha = 4,
+    TruecolorWithAlpha = 6,
+};
+
+enum class FilterType : u8 {
+    None,
+    Sub,
+    Up,
+    Average,
+    Paeth,
+};
+
+// Wide enough for the vectorized unfiltering to run a few iterations, and with rows that end in a partial byte or vector.
+static constexpr int image_width = 37;
+static constexpr int image_height = 5;
+
+struct TestImage {
+    ColorType color_type;
+    u8 bit_depth;
+    // Channel values, pixel by pixel, or palette indices.
+    Vector<u16> samples;
+    Vector<Color> palette;
+};
+
+static size_t channel_count(ColorType color_type)
+{
+    switch (color_type) {
+    case ColorType::Grayscale:
+    case ColorType::IndexedColor:
+        return 1;
+    case ColorType::GrayscaleWithAlpha:
+        return 2;
+    case ColorType::Truecolor:
+        return 3;
+    case ColorType::TruecolorWithAlpha:
+        return 4;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+static TestImage make_test_image(ColorType color_type, u8 bit_depth)
+{
+    TestImage image { color_type, bit_depth, {}, {} };
+
+    // A fixed xorshift sequence, so that every run checks the same samples.
+    u32 state = 0x9e3779b9u ^ (static_cast<u32>(color_type) << 8) ^ bit_depth;
+    auto next = [&] {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    u32 sample_mask = (1u << bit_depth) - 1;
+    if (color_type == ColorType::IndexedColor) {
+        // Some palette entries are partially or fully transparent.
+        for (u32 i = 0; i <= sample_mask; ++i)
+            image.palette.append(Color(next() & 0xff, next() & 0xff, next() & 0xff, i % 3 == 0 ? next() & 0xff : 0xff));
+    }
+
+    auto sample_count = image_width * image_height * channel_count(color_type);
+    for (size_t i = 0; i < sample_count; ++i)
+        image.samples.append(next() & sample_mask);
+    return image;
+}
+
+static u8 to_8_bits(TestImage const& image, u16 sample)
+{
+    if (image.bit_depth == 16)
+        return sample >> 8;
+    return sample * 255 / ((1 << image.bit_depth) - 1);
+}
+
+static Color expected_color(TestImage const& image, int x, int y)
+{
+    auto* samples = &image.samples[(y * image_width + x) * channel_count(image.color_type)];
+    auto channel = [&](size_t index) { return to_8_bits(image, samples[index]); };
+
+    switch (image.color_type) {
+    case ColorType::Grayscale:
+        return Color(channel(0), channel(0), channel(0));
+    case ColorType::GrayscaleWithAlpha:
+        return Color(channel(0), channel(0), channel(0), channel(1));
+    case ColorType::Truecolor:
+        return Color(channel(0), channel(1), channel(2));
+    case ColorType::TruecolorWithAlpha:
+        return Color(channel(0), channel(1), channel(2), channel(3));
+    case ColorType::IndexedColor:
+        return image.palette[samples[0]];
+    }
+    VERIFY_NOT_REACHED();
+}
+
+static ByteBuffer pack_scanline(TestImage const& image, int y)
+{
+    auto samples_per_row = image_width * channel_count(image.color_type);
+    auto* samples = &image.samples[y * samples_per_row];
+
+    ByteBuffer scanline;
+    if (image.bit_depth == 16) {
+        for (size_t i = 0; i < samples_per_row; ++i) {
+            scanline.append(static_cast<u8>(samples[i] >> 8));
+            scanline.append(static_cast<u8>(samples[i]));
+        }
+    } else {
+        // Samples are packed from the most significant bit down, and the last byte is padded with zeroes.
+        scanline.resize((samples_per_row * image.bit_depth + 7) / 8);
+        scanline.zero_fill();
+        for (size_t i = 0; i < samples_per_row; ++i)
+            scanline[i * image.bit_depth / 8] |= samples[i] << (8 - image.bit_depth - (i * image.bit_depth) % 8);
+    }
+    return scanline;
+}
+
+static u8 paeth_predictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
+
+static void append_filtered_scanline(ByteBuffer& stream, FilterType filter_type, ReadonlyBytes scanline, ReadonlyBytes previous_scanline, size_t bytes_per_pixel)
+{
+    stream.append(static_cast<u8>(filter_type));
+    for (size_t i = 0; i < scanline.size(); ++i) {
+        u8 left = i >= bytes_per_pixel ? scanline[i - bytes_per_pixel] : 0;
+        u8 above = previous_scanline.is_empty() ? 0 : previous_scanline[i];
+        u8 upper_left = i >= bytes_per_pixel && !previous_scanline.is_empty() ? previous_scanline[i - bytes_per_pixel] : 0;
+
+        u8 predictor = 0;
+        switch (filter_type) {
+        case FilterType::None:
+            break;
+        case FilterType::Sub:
+            predictor = left;
+            break;
+        case FilterType::Up:
+            predictor = above;
+            break;
+        case FilterType::Average:
+            predictor = (left + above) / 2;
+            break;
+        case FilterType::Paeth:
+            predictor = paeth_predictor(left, above, upper_left);
+            break;
+        }
+        stream.append(static_cast<u8>(scanline[i] - predictor));
+    }
+}
+
+static void append_u32(ByteBuffer& buffer, u32 value)
+{
+    buffer.append(static_cast<u8>(value >> 24));
+    buffer.append(static_cast<u8>(value >> 16));
+    buffer.append(static_cast<u8>(value >> 8));
+    buffer.append(static_cast<u8>(value));
+}
+
+static void append_chunk(ByteBuffer& png, StringView type, ReadonlyBytes data)
+{
+    append_u32(png, data.size());
+    auto type_and_data_offset = png.size();
+    png.append(type.bytes());
+    png.append(data);
+    append_u32(png, Crypto::Checksum::CRC32(png.bytes().slice(type_and_data_offset)).digest());
+}
+
+// Wraps the data in a zlib stream made of stored deflate blocks.
+static ByteBuffer zlib_store(ReadonlyBytes data)
+{
+    ByteBuffer stream;
+    stream.append(0x78);
+    stream.append(0x01);
+    size_t offset = 0;
+    do {
+        u16 block_size = min<size_t>(data.size() - offset, 0xffff);
+        bool is_final_block = offset + block_size == data.size();
+        stream.append(is_final_block ? 1 : 0);
+        stream.append(static_cast<u8>(block_size));
+        stream.append(static_cast<u8>(block_size >> 8));
+        stream.append(static_cast<u8>(~block_size));
+        stream.append(static_cast<u8>(~block_size >> 8));
+        stream.append(data.slice(offset, block_size));
+        offset += block_size;
+    } while (offset < data.size());
+    append_u32(stream, Crypto::Checksum::Adler32(data).digest());
+    return stream;
+}
+
+static ByteBuffer encode_png(TestImage const& image, Function<FilterType(int)> const& filter_type_for_row)
+{
+    ByteBuffer png;
+    png.append("\x89PNG\r\n\x1a\n"sv.bytes());
+
+    ByteBuffer header;
+    append_u32(header, image_width);
+    append_u32(header, image_height);
+    header.append(image.bit_depth);
+    header.append(static_cast<u8>(image.color_type));
+    header.append(0); // Compression method
+    header.append(0); // Filter method
+    header.append(0); // Interlace method
+    append_chunk(png, "IHDR"sv, header);
+
+    if (image.color_type == ColorType::IndexedColor) {
+        ByteBuffer palette;
+        ByteBuffer transparency;
+        for (auto color : image.palette) {
+            palette.append(color.red());
+            palette.append(color.green());
+            palette.append(color.blue());
+            transparency.append(color.alpha());
+        }
+        append_chunk(png, "PLTE"sv, palette);
+        append_chunk(png, "tRNS"sv, transparency);
+    }
+
+    auto bytes_per_pixel = max<size_t>(1, channel_count(image.color_type) * image.bit_depth / 8);
+    ByteBuffer filtered_scanlines;
+    ByteBuffer previous_scanline;
+    for (int y = 0; y < image_height; ++y) {
+        auto scanline = pack_scanline(image, y);
+        append_filtered_scanline(filtered_scanlines, filter_type_for_row(y), scanline, previous_scanline, bytes_per_pixel);
+        previous_scanline = move(scanline);
+    }
+    append_chunk(png, "IDAT"sv, zlib_store(filtered_scanlines));
+    append_chunk(png, "IEND"sv, {});
+    return png;
+}
+
+static size_t count_mismatched_pixels(TestImage const& image, Function<FilterType(int)> const& filter_type_for_row)
+{
+    auto png_data = encode_png(image, filter_type_for_row);
+    auto png = Gfx::PNGImageDecoderPlugin(png_data.data(), png_data.size());
+    auto frame = png.frame(0).release_value_but_fixme_should_propagate_errors();
+    VERIFY(frame.image->size() == Gfx::IntSize(image_width, image_height));
+
+    size_t mismatched_pixels = 0;
+    for (int y = 0; y < image_height; ++y) {
+        for (int x = 0; x < image_width; ++x) {
+            if (frame.image->get_pixel(x, y) != expected_color(image, x, y))
+                ++mismatched_pixels;
+        }
+    }
+    return mismatched_pixels;
+}
+
+// Decodes the image once with each filter type on every scanline, and once with the filter type changing from row to row.
+static void expect_decodes_with_every_filter_type(ColorType color_type, u8 bit_depth)
+{
+    auto image = make_test_image(color_type, bit_depth);
+    for (u8 filter_type = 0; filter_type <= static_cast<u8>(FilterType::Paeth); ++filter_type)
+        EXPECT_EQ(count_mismatched_pixels(image, [&](int) { return static_cast<FilterType>(filter_type); }), 0u);
+    EXPECT_EQ(count_mismatched_pixels(image, [](int y) { return static_cast<FilterType>(y % 5); }), 0u);
+}
+
+TEST_CASE(png_grayscale)
+{
+    for (u8 bit_depth : { 1, 2, 4, 8, 16 })
+        expect_decodes_with_every_filter_type(ColorType::Grayscale, bit_depth);
+}
+
+TEST_CASE(png_grayscale_with_alpha)
+{
+    for (u8 bit_depth : { 8, 16 })
+        expect_decodes_with_every_filter_type(ColorType::GrayscaleWithAlpha, bit_depth);
+}
+
+TEST_CASE(png_truecolor)
+{
+    for (u8 bit_depth : { 8, 16 })
+        expect_decodes_with_every_filter_type(ColorType::Truecolor, bit_depth);
+}
+
+TEST_CASE(png_truecolor_with_alpha)
+{
+    for (u8 bit_depth : { 8, 16 })
+        expect_decodes_with_every_filter_type(ColorType::TruecolorWithAlpha, bit_depth);
+}
+
+TEST_CASE(png_indexed_color)
+{
+    for (u8 bit_depth : { 1, 2, 4, 8 })
+        expect_decodes_with_every_filter_type(ColorType::IndexedColor, bit_depth);
+}
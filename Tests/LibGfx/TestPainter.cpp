@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <LibTest/TestCase.h>
+
+// The painter fills, copies and blends whole vectors of pixels at a time, and the leftover pixels of a row one by one.
+// These tests paint rows of every width up to a few vectors, starting at every offset within a vector, and check the
+// result against Color::blend() and plain copies on random pixels.
+
+static constexpr int max_row_width = 35;
+static constexpr int row_count = 3;
+static constexpr int bitmap_width = max_row_width + 8;
+
+// A fixed xorshift sequence, so that every run checks the same pixels.
+static u32 next_random()
+{
+    static u32 state = 0x9e3779b9u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Fully transparent and fully opaque pixels take shortcuts in the blending, so they are made as common as the rest.
+static Gfx::RGBA32 random_pixel()
+{
+    auto pixel = next_random();
+    switch (next_random() % 3) {
+    case 0:
+        return pixel & 0xffffff;
+    case 1:
+        return pixel | 0xff000000;
+    default:
+        return pixel;
+    }
+}
+
+static NonnullRefPtr<Gfx::Bitmap> create_random_bitmap(Gfx::BitmapFormat format)
+{
+    auto bitmap = Gfx::Bitmap::try_create(format, { bitmap_width, row_count }).release_value_but_fixme_should_propagate_errors();
+    for (int y = 0; y < row_count; ++y) {
+        for (int x = 0; x < bitmap_width; ++x)
+            bitmap->scanline(y)[x] = random_pixel();
+    }
+    return bitmap;
+}
+
+static NonnullRefPtr<Gfx::Bitmap> clone(Gfx::Bitmap const& bitmap)
+{
+    return bitmap.clone().release_value_but_fixme_should_propagate_errors();
+}
+
+// Calls the callback for every rect that the tests paint: each width, starting at each offset into the bitmap.
+template<typename Callback>
+static void for_each_row_rect(Callback callback)
+{
+    for (int width = 1; width <= max_row_width; ++width) {
+        for (int x = 0; x + width <= bitmap_width && x < 8; ++x)
+            callback(Gfx::IntRect { x, 0, width, row_count });
+    }
+}
+
+// Compares the painted bitmap with the expected one. Pixels outside of the rect must not have changed.
+template<typename ExpectedPixel>
+static size_t count_mismatched_pixels(Gfx::Bitmap const& painted, Gfx::Bitmap const& original, Gfx::IntRect const& rect, ExpectedPixel expected_pixel)
+{
+    size_t mismatched_pixels = 0;
+    for (int y = 0; y < row_count; ++y) {
+        for (int x = 0; x < bitmap_width; ++x) {
+            auto expected = rect.contains(x, y) ? expected_pixel(x, y) : original.scanline(y)[x];
+            if (painted.scanline(y)[x] != expected)
+                ++mismatched_pixels;
+        }
+    }
+    return mismatched_pixels;
+}
+
+TEST_CASE(fill_rect_with_opaque_color)
+{
+    auto original = create_random_bitmap(Gfx::BitmapFormat::BGRA8888);
+    for_each_row_rect([&](auto const& rect) {
+        auto color = Color::from_rgba(next_random() | 0xff000000);
+        auto bitmap = clone(*original);
+        Gfx::Painter(bitmap).fill_rect(rect, color);
+        EXPECT_EQ(count_mismatched_pixels(*bitmap, *original, rect, [&](int, int) { return color.value(); }), 0u);
+    });
+}
+
+TEST_CASE(fill_rect_with_translucent_color)
+{
+    auto original = create_random_bitmap(Gfx::BitmapFormat::BGRA8888);
+    for_each_row_rect([&](auto const& rect) {
+        auto color = Color::from_rgba((next_random() & 0xffffff) | ((next_random() % 254 + 1) << 24));
+        auto bitmap = clone(*original);
+        Gfx::Painter(bitmap).fill_rect(rect, color);
+        EXPECT_EQ(count_mismatched_pixels(*bitmap, *original, rect, [&](int x, int y) {
+            return Color::from_rgba(original->scanline(y)[x]).blend(color).value();
+        }),
+            0u);
+    });
+}
+
+TEST_CASE(blit_opaque_bitmap)
+{
+    auto source = create_random_bitmap(Gfx::BitmapFormat::BGRx8888);
+    auto original = create_random_bitmap(Gfx::BitmapFormat::BGRA8888);
+    for_each_row_rect([&](auto const& rect) {
+        auto bitmap = clone(*original);
+        Gfx::Painter(bitmap).blit(rect.location(), source, { 0, 0, rect.width(), rect.height() });
+        EXPECT_EQ(count_mismatched_pixels(*bitmap, *original, rect, [&](int x, int y) {
+            return source->scanline(y)[x - rect.x()];
+        }),
+            0u);
+    });
+}
+
+// Mirrors the per-pixel code of blit_with_opacity().
+static Gfx::RGBA32 blit_pixel(Gfx::RGBA32 destination, Gfx::RGBA32 source, float opacity, bool destination_has_alpha)
+{
+    auto destination_color = destination_has_alpha ? Color::from_rgba(destination) : Color::from_rgb(destination);
+    auto source_color = Color::from_rgba(source);
+    float pixel_opacity = source_color.alpha() / 255.0;
+    source_color.set_alpha(255 * (opacity * pixel_opacity));
+    return destination_color.blend(source_color).value();
+}
+
+static void expect_blit_matches_color_blend(Gfx::BitmapFormat target_format, float opacity)
+{
+    auto source = create_random_bitmap(Gfx::BitmapFormat::BGRA8888);
+    auto original = create_random_bitmap(target_format);
+    bool target_has_alpha = original->has_alpha_channel();
+    for_each_row_rect([&](auto const& rect) {
+        auto bitmap = clone(*original);
+        Gfx::Painter(bitmap).blit(rect.location(), source, { 0, 0, rect.width(), rect.height() }, opacity);
+        EXPECT_EQ(count_mismatched_pixels(*bitmap, *original, rect, [&](int x, int y) {
+            return blit_pixel(original->scanline(y)[x], source->scanline(y)[x - rect.x()], opacity, target_has_alpha);
+        }),
+            0u);
+    });
+}
+
+TEST_CASE(blit_translucent_bitmap)
+{
+    expect_blit_matches_color_blend(Gfx::BitmapFormat::BGRA8888, 1.0f);
+    expect_blit_matches_color_blend(Gfx::BitmapFormat::BGRx8888, 1.0f);
+}
+
+TEST_CASE(blit_translucent_bitmap_with_opacity)
+{
+    for (float opacity : { 0.1f, 0.5f, 0.73f }) {
+        expect_blit_matches_color_blend(Gfx::BitmapFormat::BGRA8888, opacity);
+        expect_blit_matches_color_blend(Gfx::BitmapFormat::BGRx8888, opacity);
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Resampler.h>
+#include <LibTest/TestCase.h>
+
+static NonnullRefPtr<Gfx::Bitmap> create_bitmap(Gfx::IntSize const& size, Function<Color(int x, int y)> color_at)
+{
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, size).release_value_but_fixme_should_propagate_errors();
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x)
+            bitmap->set_pixel(x, y, color_at(x, y));
+    }
+    return bitmap;
+}
+
+static NonnullRefPtr<Gfx::Bitmap> resample(Gfx::Bitmap const& source, Gfx::FloatRect const& source_rect, Gfx::IntSize const& size, Gfx::Resampler::Filter filter)
+{
+    auto result = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, size).release_value_but_fixme_should_propagate_errors();
+    Gfx::Resampler::resample(source, source_rect, result->rect(), result->rect(), filter, [&](int y, Span<Gfx::RGBA32 const> row) {
+        VERIFY(row.size() == static_cast<size_t>(size.width()));
+        for (size_t x = 0; x < row.size(); ++x)
+            result->scanline(y)[x] = row[x];
+    });
+    return result;
+}
+
+static size_t count_pixels_not_matching(Gfx::Bitmap const& bitmap, Function<Color(int x, int y)> expected_color_at)
+{
+    size_t mismatched_pixels = 0;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            if (bitmap.get_pixel(x, y) != expected_color_at(x, y))
+                ++mismatched_pixels;
+        }
+    }
+    return mismatched_pixels;
+}
+
+static Color gray(int value)
+{
+    return Color(value, value, value);
+}
+
+TEST_CASE(box_filter_averages_covered_pixels)
+{
+    // Every 2x2 block of the source has the values 0, 40, 80 and 120 added to its own base value.
+    auto source = create_bitmap({ 8, 6 }, [](int x, int y) { return gray((x / 2 + y / 2 * 4) * 8 + (x % 2) * 40 + (y % 2) * 80); });
+    auto result = resample(*source, source->rect().to_type<float>(), { 4, 3 }, Gfx::Resampler::Filter::Box);
+    EXPECT_EQ(count_pixels_not_matching(*result, [](int x, int y) { return gray((x + y * 4) * 8 + 60); }), 0u);
+}
+
+TEST_CASE(box_filter_weights_partially_covered_pixels)
+{
+    // Every destination pixel covers one and a half source pixels.
+    auto source = create_bitmap({ 3, 3 }, [](int x, int) { return gray(x * 90); });
+    auto result = resample(*source, source->rect().to_type<float>(), { 2, 2 }, Gfx::Resampler::Filter::Box);
+    EXPECT_EQ(count_pixels_not_matching(*result, [](int x, int) { return gray(x == 0 ? 30 : 150); }), 0u);
+}
+
+TEST_CASE(box_filter_ignores_colors_of_transparent_pixels)
+{
+    auto source = create_bitmap({ 4, 4 }, [](int x, int y) { return (x + y) % 2 ? Color(0, 255, 0, 0) : Color(255, 0, 0); });
+    auto result = resample(*source, source->rect().to_type<float>(), { 2, 2 }, Gfx::Resampler::Filter::Box);
+    EXPECT_EQ(count_pixels_not_matching(*result, [](int, int) { return Color(255, 0, 0, 128); }), 0u);
+}
+
+TEST_CASE(lanczos_filter_keeps_pixels_at_the_same_size)
+{
+    // At the same size, every destination pixel is centered on a source pixel, and the other taps are at the zeroes of sinc.
+    auto source = create_bitmap({ 9, 7 }, [](int x, int y) { return Color(x * 28, y * 36, (x * y * 37) % 256); });
+    auto result = resample(*source, source->rect().to_type<float>(), source->size(), Gfx::Resampler::Filter::Lanczos3);
+    EXPECT_EQ(count_pixels_not_matching(*result, [&](int x, int y) { return source->get_pixel(x, y); }), 0u);
+}
+
+TEST_CASE(lanczos_filter_clamps_ringing_around_edges)
+{
+    // Scaled up by four, a hard edge in the middle makes Lanczos ring: the pixels next to the edge undershoot below black
+    // and overshoot above white, which has to be clamped rather than wrap around, and the ones further out ripple.
+    auto source = create_bitmap({ 8, 1 }, [](int x, int) { return gray(x < 4 ? 0 : 255); });
+    auto result = resample(*source, source->rect().to_type<float>(), { 32, 1 }, Gfx::Resampler::Filter::Lanczos3);
+    for (int x = 10; x < 14; ++x)
+        EXPECT_EQ(result->get_pixel(x, 0), gray(0));
+    for (int x = 18; x < 22; ++x)
+        EXPECT_EQ(result->get_pixel(x, 0), gray(255));
+    EXPECT(result->get_pixel(8, 0).red() > 0);
+    EXPECT(result->get_pixel(23, 0).red() < 255);
+    EXPECT_EQ(result->get_pixel(0, 0), gray(0));
+    EXPECT_EQ(result->get_pixel(31, 0), gray(255));
+}
+
+TEST_CASE(samples_beyond_the_edges_repeat_the_outermost_pixels)
+{
+    // The inner 4x4 pixels are blue, and the ring around them is red. Filters reaching past the edges of the inner rect
+    // have to see its own outermost pixels, and not the red ones next to it or transparent black.
+    auto source = create_bitmap({ 6, 6 }, [](int x, int y) {
+        bool is_inside = x >= 1 && x < 5 && y >= 1 && y < 5;
+        return is_inside ? Color(0, 0, 255) : Color(255, 0, 0);
+    });
+    for (auto filter : { Gfx::Resampler::Filter::Box, Gfx::Resampler::Filter::Lanczos3 }) {
+        for (Gfx::IntSize size : { Gfx::IntSize { 3, 3 }, Gfx::IntSize { 7, 5 }, Gfx::IntSize { 16, 16 } }) {
+            auto result = resample(*source, { 1, 1, 4, 4 }, size, filter);
+            EXPECT_EQ(count_pixels_not_matching(*result, [](int, int) { return Color(0, 0, 255); }), 0u);
+        }
+    }
+}
+
+TEST_CASE(clipped_rows_match_the_unclipped_result)
+{
+    auto source = create_bitmap({ 23, 17 }, [](int x, int y) { return Color(x * 11, y * 15, (x * y * 37) % 256, 128 + (x * 5 + y * 3) % 128); });
+    auto unclipped = resample(*source, source->rect().to_type<float>(), { 10, 40 }, Gfx::Resampler::Filter::Lanczos3);
+
+    Gfx::IntRect clip_rect { 3, 11, 5, 20 };
+    auto clipped = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, unclipped->size()).release_value_but_fixme_should_propagate_errors();
+    int next_y = clip_rect.top();
+    Gfx::Resampler::resample(*source, source->rect().to_type<float>(), unclipped->rect(), clip_rect, Gfx::Resampler::Filter::Lanczos3, [&](int y, Span<Gfx::RGBA32 const> row) {
+        EXPECT_EQ(y, next_y++);
+        EXPECT_EQ(row.size(), static_cast<size_t>(clip_rect.width()));
+        for (size_t x = 0; x < row.size(); ++x)
+            clipped->scanline(y)[clip_rect.left() + x] = row[x];
+    });
+    EXPECT_EQ(next_y, clip_rect.bottom() + 1);
+    EXPECT_EQ(count_pixels_not_matching(*clipped, [&](int x, int y) {
+        return clip_rect.contains(x, y) ? unclipped->get_pixel(x, y) : Color(Color::Transparent);
+    }),
+        0u);
+}
@@ -134,3 +134,38 @@ TEST_CASE(catch_exception)
                             "if (hitCatch !== true) throw new Exception('failed');\n"
                             "if (hitFinally !== true) throw new Exception('failed');");
 }
+
+TEST_CASE(cached_property_access_with_changing_shapes)
+{
+    EXPECT_NO_EXCEPTION_ALL("function get(o) { return o.x; }\n"
+                            "function put(o, v) { o.x = v; }\n"
+                            "var objects = [{ x: 1 }, { y: 0, x: 2 }, { z: 0, y: 0, x: 3 }];\n"
+                            "for (var i = 0; i < 3; ++i) {\n"
+                            "    for (var j = 0; j < objects.length; ++j) {\n"
+                            "        if (get(objects[j]) !== j + 1) throw new Exception('failed');\n"
+                            "        put(objects[j], j + 1);\n"
+                            "    }\n"
+                            "}\n"
+                            "var a = { x: 1 };\n"
+                            "get(a); put(a, 1);\n"
+                            "Object.defineProperty(a, 'x', { get() { return 42; }, set(v) { this.y = v; } });\n"
+                            "if (get(a) !== 42) throw new Exception('failed');\n"
+                            "put(a, 5);\n"
+                            "if (a.y !== 5) throw new Exception('failed');");
+}
+
+TEST_CASE(cached_property_access_through_prototype)
+{
+    EXPECT_NO_EXCEPTION_ALL("function get(o) { return o.value; }\n"
+                            "var prototype = { value: 1 };\n"
+                            "var object = Object.create(prototype);\n"
+                            "if (get(object) !== 1 || get(object) !== 1) throw new Exception('failed');\n"
+                            "prototype.value = 2;\n"
+                            "if (get(object) !== 2) throw new Exception('failed');\n"
+                            "prototype.other = 0;\n"
+                            "if (get(object) !== 2) throw new Exception('failed');\n"
+                            "object.value = 3;\n"
+                            "if (get(object) !== 3) throw new Exception('failed');\n"
+                            "var proxy = new Proxy(Object.create(prototype), { get() { return 4; } });\n"
+                            "if (get(proxy) !== 4) throw new Exception('failed');");
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/VM.h>
+#include <LibJS/Script.h>
+#include <LibTest/TestCase.h>
+
+// A binary tree of objects, where every node also references an array and a string of its own.
+static constexpr auto object_graph_source = R"~~~(
+    function buildTree(depth) {
+        const values = [depth, "node " + depth];
+        if (depth === 0)
+            return { values };
+        return { left: buildTree(depth - 1), right: buildTree(depth - 1), values };
+    }
+
+    function countNodes(node) {
+        if (!node.left)
+            return 1;
+        return 1 + countNodes(node.left) + countNodes(node.right);
+    }
+)~~~"sv;
+
+// Moves subtrees between random nodes at the same depth, and gives the nodes on the way there new values. If the
+// marker missed a subtree that was moved into a node it was already done with, that subtree would be swept.
+static constexpr auto object_graph_shuffling_source = R"~~~(
+    let seed = 1;
+    function random() {
+        seed = (seed * 1103515245 + 12345) % 2147483648;
+        return seed;
+    }
+
+    function walk(node, steps) {
+        for (let i = 0; i < steps; ++i) {
+            node.values = [node.values[0], "node " + node.values[0]];
+            node = random() % 2 ? node.left : node.right;
+        }
+        return node;
+    }
+
+    function shuffleTree(tree, count) {
+        for (let i = 0; i < count; ++i) {
+            const steps = random() % tree.values[0];
+            const a = walk(tree, steps);
+            const b = walk(tree, steps);
+            const left = a.left;
+            a.left = b.left;
+            b.left = left;
+        }
+    }
+
+    function isIntact(node) {
+        const depth = node.values[0];
+        if (node.values[1] !== "node " + depth)
+            return false;
+        if (depth === 0)
+            return !node.left;
+        return node.left.values[0] === depth - 1 && node.right.values[0] === depth - 1 && isIntact(node.left) && isIntact(node.right);
+    }
+)~~~"sv;
+
+static JS::Value run_script(JS::Interpreter& interpreter, StringView source)
+{
+    auto script_or_error = JS::Script::parse(source, interpreter.realm());
+    EXPECT(!script_or_error.is_error());
+    auto result = interpreter.run(script_or_error.release_value());
+    EXPECT(!result.is_error());
+    return result.release_value();
+}
+
+static NonnullOwnPtr<JS::Interpreter> create_interpreter_with_object_graph(JS::VM& vm, size_t depth)
+{
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(vm);
+    run_script(*interpreter, object_graph_source);
+    run_script(*interpreter, String::formatted("globalThis.graph = buildTree({});", depth));
+    return interpreter;
+}
+
+TEST_CASE(marking_keeps_object_graph_alive)
+{
+    static constexpr size_t depth = 12;
+    static constexpr size_t node_count = (1 << (depth + 1)) - 1;
+
+    auto vm = JS::VM::create();
+    auto interpreter = create_interpreter_with_object_graph(*vm, depth);
+    auto& heap = interpreter->heap();
+
+    for (size_t thread_count : AK::Array<size_t, 2> { 1, 4 }) {
+        heap.set_marking_thread_count(thread_count);
+#ifdef JS_PARALLEL_MARKING
+        // Otherwise the heap is always marked on this thread, and only the single-threaded marker is tested.
+        EXPECT_EQ(heap.marking_thread_count(), thread_count);
+#endif
+        heap.collect_garbage();
+        heap.collect_garbage();
+        EXPECT_EQ(run_script(*interpreter, "countNodes(graph)"sv).as_double(), node_count);
+    }
+
+    run_script(*interpreter, "graph = undefined;"sv);
+    heap.collect_garbage();
+}
+
+TEST_CASE(incremental_marking_keeps_object_graph_alive)
+{
+    static constexpr size_t depth = 10;
+    static constexpr size_t node_count = (1 << (depth + 1)) - 1;
+
+    auto vm = JS::VM::create();
+    auto interpreter = create_interpreter_with_object_graph(*vm, depth);
+    run_script(*interpreter, object_graph_shuffling_source);
+    auto& heap = interpreter->heap();
+    heap.set_incremental_marking_enabled(true);
+
+    // Marking starts after a while, and every shuffle allocates enough for a few marking steps to happen in between.
+    size_t shuffles_while_marking = 0;
+    for (size_t i = 0; i < 2000; ++i) {
+        if (heap.is_incremental_marking_in_progress())
+            ++shuffles_while_marking;
+        run_script(*interpreter, "shuffleTree(graph, 20);"sv);
+    }
+    EXPECT(shuffles_while_marking > 0);
+    EXPECT(run_script(*interpreter, "isIntact(graph)"sv).as_bool());
+    EXPECT_EQ(run_script(*interpreter, "countNodes(graph)"sv).as_double(), node_count);
+
+    heap.set_incremental_marking_enabled(false);
+    heap.collect_garbage();
+    EXPECT(run_script(*interpreter, "isIntact(graph)"sv).as_bool());
+    EXPECT_EQ(run_script(*interpreter, "countNodes(graph)"sv).as_double(), node_count);
+}
+
+BENCHMARK_CASE(mark_large_object_graph)
+{
+    static constexpr size_t collections_per_thread_count = 5;
+
+    auto vm = JS::VM::create();
+    auto interpreter = create_interpreter_with_object_graph(*vm, 17);
+    auto& heap = interpreter->heap();
+
+    for (size_t thread_count : AK::Array<size_t, 4> { 1, 2, 4, 8 }) {
+        heap.set_marking_thread_count(thread_count);
+        if (heap.marking_thread_count() != thread_count) {
+            outln("{} marking threads: unavailable, LibJS was built without ENABLE_JS_PARALLEL_MARKING", thread_count);
+            continue;
+        }
+
+        i64 total_marking_time = 0;
+        for (size_t i = 0; i < collections_per_thread_count; ++i) {
+            heap.collect_garbage();
+            total_marking_time += heap.last_marking_time().to_microseconds();
+        }
+        outln("{} marking threads: {} us per collection", thread_count, total_marking_time / collections_per_thread_count);
+    }
+}
@@ -1015,3 +1015,65 @@ TEST_CASE(single_match_flag)
         EXPECT_EQ(result.matches.first().view.to_string(), "A"sv);
     }
 }
+
+TEST_CASE(lazy_dfa_rejects_without_backtracking)
+{
+    // The backtracker would need an exponential number of steps to figure out that there's no match here.
+    Regex<ECMA262> re("(a|aa)*b");
+    auto subject = String::repeated('a', 100);
+    EXPECT_EQ(re.match(subject).success, false);
+    EXPECT_EQ(re.search(subject).success, false);
+
+    auto result = re.search(String::formatted("{}b", subject));
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.first().view.length(), 101u);
+    EXPECT_EQ(result.capture_group_matches.first().first().view.to_string(), "a"sv);
+}
+
+TEST_CASE(lazy_dfa_anchors_and_boundaries)
+{
+    Array tests {
+        Tuple { "\\bfoo\\b"sv, "a foo b"sv, true },
+        Tuple { "\\bfoo\\b"sv, "afoo b"sv, false },
+        Tuple { "\\Bfoo"sv, "afoo"sv, true },
+        Tuple { "^foo$"sv, "foo"sv, true },
+        Tuple { "^foo$"sv, "foo\nbar"sv, false },
+        Tuple { "(?:ab|cd)+$"sv, "xxabcdab"sv, true },
+        Tuple { "(?:ab|cd)+$"sv, "xxabcdax"sv, false },
+    };
+
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.get<0>());
+        EXPECT_EQ(re.search(test.get<1>()).success, test.get<2>());
+    }
+
+    Regex<ECMA262> multiline("^bar$", ECMAScriptFlags::Multiline);
+    EXPECT_EQ(multiline.search("foo\nbar\nbaz").success, true);
+    EXPECT_EQ(multiline.search("foo\nbarbaz").success, false);
+}
+
+TEST_CASE(lazy_dfa_search_finds_every_match)
+{
+    // Each scan of the automaton only looks as far as the earliest possible match end, so the backtracker must still find every match after it.
+    Regex<ECMA262> re("\\d+|x(?:yz)?", ECMAScriptFlags::Global);
+    auto result = re.match("a12bxyz345cxd6");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.count, 5u);
+    Array expected { "12"sv, "xyz"sv, "345"sv, "x"sv, "6"sv };
+    for (size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(result.matches[i].view.to_string(), expected[i]);
+}
+
+static auto g_log_lines = [] {
+    StringBuilder builder;
+    for (size_t i = 0; i < 10'000; ++i)
+        builder.appendff("[{}] kernel: some unremarkable message number {} about nothing in particular\n", i, i * 7);
+    return builder.to_string();
+}();
+
+BENCHMARK_CASE(lazy_dfa_search_performance)
+{
+    Regex<ECMA262> re("error: (\\w+) failed with code \\d+");
+    for (size_t i = 0; i < 10; ++i)
+        EXPECT_EQ(re.search(g_log_lines).success, false);
+}
@@ -119,6 +119,157 @@ TEST_CASE(create_heap)
     EXPECT_EQ(heap->version(), 0x00000001u);
 }
 
+static void write_numbered_blocks(SQL::Heap& heap, u32 count)
+{
+    for (u32 ix = 0; ix < count; ix++) {
+        auto pointer = heap.new_record_pointer();
+        auto buffer = MUST(ByteBuffer::create_zeroed(SQL::BLOCKSIZE));
+        buffer.overwrite(0, &ix, sizeof(u32));
+        EXPECT(!heap.write_block(pointer, buffer).is_error());
+    }
+}
+
+static void verify_numbered_blocks(SQL::Heap& heap, u32 count)
+{
+    for (u32 ix = 0; ix < count; ix++) {
+        auto buffer_or_error = heap.read_block(ix + 1);
+        EXPECT(!buffer_or_error.is_error());
+        u32 value = 0;
+        memcpy(&value, buffer_or_error.value().data(), sizeof(u32));
+        EXPECT_EQ(value, ix);
+    }
+}
+
+TEST_CASE(heap_cache_evicts_and_writes_back_blocks)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        heap->set_cache_size(4);
+        EXPECT(!heap->open().is_error());
+
+        // Uncommitted blocks have to stay in the cache, however small it is.
+        auto writebacks = heap->cache_statistics().writebacks;
+        write_numbered_blocks(heap, 20);
+        EXPECT_EQ(heap->cache_statistics().evictions, 0u);
+        EXPECT_EQ(heap->cache_statistics().writebacks, writebacks);
+
+        EXPECT(!heap->flush().is_error());
+        EXPECT_EQ(heap->cache_statistics().writebacks, writebacks + 20);
+        verify_numbered_blocks(heap, 20);
+        EXPECT(heap->cache_statistics().evictions > 0);
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        heap->set_cache_size(4);
+        EXPECT(!heap->open().is_error());
+        verify_numbered_blocks(heap, 20);
+        EXPECT_EQ(heap->cache_statistics().hits, 0u);
+        EXPECT_EQ(heap->cache_statistics().misses, 21u);
+
+        // The most recently read block is still cached.
+        EXPECT(!heap->read_block(20).is_error());
+        EXPECT_EQ(heap->cache_statistics().hits, 1u);
+    }
+}
+
+static ByteBuffer read_file(String const& name)
+{
+    auto file = MUST(Core::File::open(name, Core::OpenMode::ReadOnly));
+    return file->read_all();
+}
+
+TEST_CASE(heap_rollback_leaves_file_unchanged)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        write_numbered_blocks(heap, 10);
+    }
+    auto committed_contents = read_file("/tmp/test.db");
+
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    heap->set_cache_size(4);
+    EXPECT(!heap->open().is_error());
+
+    // Overwrite some blocks and add new ones, then read the others so that the cache has to evict blocks.
+    for (u32 block = 1; block <= 3; ++block) {
+        auto buffer = MUST(ByteBuffer::create_zeroed(SQL::BLOCKSIZE));
+        buffer.overwrite(0, "uncommitted", 11);
+        EXPECT(!heap->write_block(block, buffer).is_error());
+    }
+    write_numbered_blocks(heap, 10);
+    heap->set_tables_root(42);
+    for (u32 block = 4; block <= 10; ++block)
+        EXPECT(!heap->read_block(block).is_error());
+    EXPECT(heap->cache_statistics().evictions > 0);
+    EXPECT_EQ(heap->cache_statistics().writebacks, 0u);
+    EXPECT_EQ(read_file("/tmp/test.db"), committed_contents);
+
+    EXPECT(!heap->rollback().is_error());
+    EXPECT_EQ(heap->tables_root(), 0u);
+    verify_numbered_blocks(heap, 10);
+    EXPECT_EQ(heap->new_record_pointer(), 11u);
+    EXPECT(!heap->flush().is_error());
+    EXPECT_EQ(read_file("/tmp/test.db"), committed_contents);
+}
+
+TEST_CASE(heap_rollback_fails_with_pinned_uncommitted_block)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(!heap->open().is_error());
+    write_numbered_blocks(heap, 2);
+    EXPECT(!heap->flush().is_error());
+
+    // The pinned block's uncommitted contents survive the failed rollback, and the one after unpinning throws them away.
+    auto buffer = MUST(ByteBuffer::create_zeroed(SQL::BLOCKSIZE));
+    buffer.overwrite(0, "uncommitted", 11);
+    EXPECT(!heap->write_block(1, buffer).is_error());
+    EXPECT(!heap->pin_block(1).is_error());
+    EXPECT(heap->rollback().is_error());
+    EXPECT_EQ(MUST(heap->read_block(1)), buffer);
+    heap->unpin_block(1);
+
+    EXPECT(!heap->rollback().is_error());
+    verify_numbered_blocks(heap, 2);
+}
+
+TEST_CASE(heap_cache_reads_without_mapping)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        write_numbered_blocks(heap, 10);
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        heap->set_read_through_mapping(false);
+        EXPECT(!heap->open().is_error());
+        verify_numbered_blocks(heap, 10);
+        verify_numbered_blocks(heap, 10);
+        EXPECT_EQ(heap->cache_statistics().hits, 10u);
+    }
+}
+
+TEST_CASE(heap_cache_keeps_pinned_blocks)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    heap->set_cache_size(2);
+    EXPECT(!heap->open().is_error());
+    write_numbered_blocks(heap, 10);
+
+    EXPECT(!heap->pin_block(1).is_error());
+    verify_numbered_blocks(heap, 10);
+    auto hits = heap->cache_statistics().hits;
+    EXPECT(!heap->read_block(1).is_error());
+    EXPECT_EQ(heap->cache_statistics().hits, hits + 1);
+    heap->unpin_block(1);
+}
+
 TEST_CASE(create_from_dev_random)
 {
     auto heap = SQL::Heap::construct("/dev/random");
@@ -8,6 +8,7 @@
 #include <unistd.h>
 
 #include <AK/ScopeGuard.h>
+#include <LibSQL/AST/Operator.h>
 #include <LibSQL/AST/Parser.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Result.h>
@@ -267,6 +268,28 @@ TEST_CASE(select_with_where)
     }
 }
 
+TEST_CASE(select_with_non_boolean_where)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    auto result = execute(database,
+        "INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES "
+        "( 'Test_1', 42 ), "
+        "( 'true', 43 ), "
+        "( 'Test_3', 44 );");
+    EXPECT(result.size() == 3);
+
+    // Rows for which the condition isn't a boolean are skipped, rather than failing the whole statement.
+    result = execute(database, "SELECT TextColumn, IntColumn FROM TestSchema.TestTable WHERE TextColumn;");
+    EXPECT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].row[1].to_int().value(), 43);
+
+    result = execute(database, "SELECT TextColumn, IntColumn FROM TestSchema.TestTable WHERE TextColumn AND IntColumn > 42;");
+    EXPECT_EQ(result.size(), 1u);
+}
+
 TEST_CASE(select_cross_join)
 {
     ScopeGuard guard([]() { unlink(db_name); });
@@ -333,6 +356,52 @@ TEST_CASE(select_inner_join)
     EXPECT_EQ(result[0].row[2].to_string(), "Test_12");
 }
 
+TEST_CASE(select_inner_join_with_filters)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    auto result = execute(database,
+        "INSERT INTO TestSchema.TestTable1 ( TextColumn1, IntColumn ) VALUES "
+        "( 'Test_1', 42 ), "
+        "( 'Test_2', 43 ), "
+        "( 'Test_3', 42 ), "
+        "( 'Test_4', 45 );");
+    EXPECT(result.size() == 4);
+    result = execute(database,
+        "INSERT INTO TestSchema.TestTable2 ( TextColumn2, IntColumn ) VALUES "
+        "( 'Test_10', 42 ), "
+        "( 'Test_11', 45 ), "
+        "( 'Test_12', 42 ), "
+        "( 'Test_13', 43 );");
+    EXPECT(result.size() == 4);
+    result = execute(database,
+        "SELECT TextColumn1, TextColumn2 "
+        "FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+        "WHERE (TestTable2.IntColumn = TestTable1.IntColumn) AND (TextColumn1 != 'Test_4') AND (TextColumn2 != 'Test_12') "
+        "ORDER BY TextColumn1;");
+    EXPECT_EQ(result.size(), 3u);
+    EXPECT_EQ(result[0].row[0].to_string(), "Test_1");
+    EXPECT_EQ(result[0].row[1].to_string(), "Test_10");
+    EXPECT_EQ(result[1].row[0].to_string(), "Test_2");
+    EXPECT_EQ(result[1].row[1].to_string(), "Test_13");
+    EXPECT_EQ(result[2].row[0].to_string(), "Test_3");
+    EXPECT_EQ(result[2].row[1].to_string(), "Test_10");
+
+    result = execute(database,
+        "SELECT TextColumn1, TextColumn2 "
+        "FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+        "WHERE (TestTable1.IntColumn < TestTable2.IntColumn) AND (TextColumn1 = 'Test_2');");
+    EXPECT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].row[1].to_string(), "Test_11");
+
+    auto ambiguous_result = try_execute(database,
+        "SELECT TextColumn1 FROM TestSchema.TestTable1, TestSchema.TestTable2 WHERE IntColumn = 42;");
+    EXPECT(ambiguous_result.is_error());
+    EXPECT(ambiguous_result.release_error().error() == SQL::SQLErrorCode::AmbiguousColumnName);
+}
+
 TEST_CASE(select_with_like)
 {
     ScopeGuard guard([]() { unlink(db_name); });
@@ -613,6 +682,50 @@ TEST_CASE(select_with_offset_out_of_bounds)
     EXPECT_EQ(result.size(), 0u);
 }
 
+TEST_CASE(select_rows_one_at_a_time)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    for (auto count = 0; count < 100; count++) {
+        auto result = execute(database,
+            String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'T{}', {} );", count, count));
+        EXPECT_EQ(result.size(), 1u);
+    }
+
+    auto pull_all_rows = [&](StringView sql) {
+        auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
+        auto statement = parser.next_statement();
+        EXPECT(!parser.has_errors());
+        EXPECT(is<SQL::AST::Select>(*statement));
+
+        SQL::AST::ExecutionContext context { database, statement.ptr(), nullptr };
+        auto rows = MUST(static_cast<SQL::AST::Select const&>(*statement).create_operator(context));
+        Vector<Vector<String>> pulled_rows;
+        for (auto row = MUST(rows->next(context)); row.has_value(); row = MUST(rows->next(context)))
+            pulled_rows.append(row->to_string_vector());
+        return pulled_rows;
+    };
+
+    auto rows = pull_all_rows("SELECT TextColumn, IntColumn FROM TestSchema.TestTable WHERE IntColumn >= 50 LIMIT 10 OFFSET 5;");
+    EXPECT_EQ(rows.size(), 10u);
+    for (auto& row : rows)
+        EXPECT(row[1].to_int().value() >= 50);
+
+    rows = pull_all_rows("SELECT TextColumn, IntColumn FROM TestSchema.TestTable ORDER BY IntColumn LIMIT 3;");
+    EXPECT_EQ(rows.size(), 3u);
+    EXPECT_EQ(rows[0][0], "T0");
+    EXPECT_EQ(rows[1][0], "T1");
+    EXPECT_EQ(rows[2][0], "T2");
+
+    auto result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable;");
+    rows = pull_all_rows("SELECT TextColumn FROM TestSchema.TestTable;");
+    EXPECT_EQ(rows.size(), result.size());
+    for (size_t ix = 0; ix < rows.size(); ++ix)
+        EXPECT_EQ(rows[ix][0], result[ix].row[0].to_string());
+}
+
 TEST_CASE(describe_table)
 {
     ScopeGuard guard([]() { unlink(db_name); });
@@ -629,4 +742,25 @@ TEST_CASE(describe_table)
     EXPECT_EQ(result[1].row[1].to_string(), "int");
 }
 
+TEST_CASE(explain_select)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    auto result = execute(database,
+        "EXPLAIN SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+        "WHERE (TestTable1.IntColumn = TestTable2.IntColumn) AND (TextColumn1 = 'Test_1');");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Explain);
+    EXPECT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0].row[0].to_string(), "SCAN TESTSCHEMA.TESTTABLE1 FILTERED BY 1 TERM(S)");
+    EXPECT_EQ(result[1].row[0].to_string(), "HASH JOIN TESTSCHEMA.TESTTABLE2 ON TESTTABLE2.INTCOLUMN JOIN FILTERED BY 1 TERM(S)");
+
+    result = execute(database, "EXPLAIN SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2 WHERE IntColumn = 42;");
+    EXPECT_EQ(result.size(), 3u);
+    EXPECT_EQ(result[0].row[0].to_string(), "SCAN TESTSCHEMA.TESTTABLE1");
+    EXPECT_EQ(result[1].row[0].to_string(), "NESTED LOOP JOIN TESTSCHEMA.TESTTABLE2");
+    EXPECT_EQ(result[2].row[0].to_string(), "FILTER COMPLETE ROWS BY 1 TERM(S)");
+}
+
 }
@@ -776,3 +776,21 @@ TEST_CASE(describe_table)
     validate("DESCRIBE TABLE TableName;", {}, "TABLENAME");
     validate("DESCRIBE TABLE SchemaName.TableName;", "SCHEMANAME", "TABLENAME");
 }
+
+TEST_CASE(explain)
+{
+    EXPECT(parse("EXPLAIN").is_error());
+    EXPECT(parse("EXPLAIN;").is_error());
+    EXPECT(parse("EXPLAIN DESCRIBE TABLE table_name;").is_error());
+    EXPECT(parse("EXPLAIN SELECT * FROM table_name").is_error());
+
+    auto result = parse("EXPLAIN SELECT * FROM table_name WHERE column_name = 1;");
+    EXPECT(!result.is_error());
+
+    auto statement = result.release_value();
+    EXPECT(is<SQL::AST::Explain>(*statement));
+
+    const auto& explain_statement = static_cast<const SQL::AST::Explain&>(*statement);
+    EXPECT_EQ(explain_statement.select_statement()->table_or_subquery_list().size(), 1u);
+    EXPECT(!explain_statement.select_statement()->where_clause().is_null());
+}
@@ -42,6 +42,7 @@ public:
 
 private:
     virtual void visit_edges(Visitor&) override;
+    virtual bool may_interfere_with_property_lookup_caches() const override { return true; }
     Sheet& m_sheet;
 };
 
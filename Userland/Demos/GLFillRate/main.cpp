@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/System.h>
+#include <LibGL/GL/gl.h>
+#include <LibGL/GLContext.h>
+#include <LibGUI/Application.h>
+#include <LibGUI/Icon.h>
+#include <LibGUI/Painter.h>
+#include <LibGUI/Widget.h>
+#include <LibGUI/Window.h>
+#include <LibGfx/Bitmap.h>
+#include <LibMain/Main.h>
+
+// Draws a number of overlapping full screen quads every frame and reports how many pixels per second
+// the rasterizer manages to shade. Useful for comparing changes to the LibSoftGPU fragment pipeline.
+
+static constexpr int RENDER_WIDTH = 640;
+static constexpr int RENDER_HEIGHT = 480;
+static constexpr int TEXTURE_SIZE = 64;
+static constexpr int FRAMES_PER_REPORT = 30;
+
+class FillRateWidget final : public GUI::Widget {
+    C_OBJECT(FillRateWidget);
+
+public:
+    virtual ~FillRateWidget() override = default;
+
+private:
+    FillRateWidget(int layer_count, bool texture_enabled, bool blend_enabled)
+        : m_layer_count(layer_count)
+    {
+        m_bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { RENDER_WIDTH, RENDER_HEIGHT }).release_value_but_fixme_should_propagate_errors();
+        m_context = GL::create_context(*m_bitmap);
+        GL::make_context_current(m_context);
+
+        if (texture_enabled) {
+            u32 texels[TEXTURE_SIZE * TEXTURE_SIZE];
+            for (int y = 0; y < TEXTURE_SIZE; ++y) {
+                for (int x = 0; x < TEXTURE_SIZE; ++x)
+                    texels[y * TEXTURE_SIZE + x] = ((x / 8 + y / 8) % 2) ? 0xffffffff : 0xff808080;
+            }
+
+            GLuint texture;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glEnable(GL_TEXTURE_2D);
+        }
+
+        if (blend_enabled) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClearDepth(1.0);
+
+        start_timer(10);
+    }
+
+    virtual void paint_event(GUI::PaintEvent& event) override
+    {
+        GUI::Painter painter(*this);
+        painter.add_clip_rect(event.rect());
+        painter.draw_scaled_bitmap(rect(), *m_bitmap, m_bitmap->rect());
+    }
+
+    virtual void timer_event(Core::TimerEvent&) override
+    {
+        auto timer = Core::ElapsedTimer::start_new();
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // Back to front, so that every layer passes the depth test and gets shaded
+        for (int layer = 0; layer < m_layer_count; ++layer) {
+            float const depth = 1.0f - 2.0f * (layer + 1) / (m_layer_count + 1);
+            float const offset = (m_frame_count + layer * 7) % 64 / 64.0f;
+
+            glBegin(GL_QUADS);
+            glColor4f((layer % 3) == 0 ? 1.0f : 0.5f, (layer % 3) == 1 ? 1.0f : 0.5f, (layer % 3) == 2 ? 1.0f : 0.5f, 0.5f);
+            glTexCoord2f(offset, offset);
+            glVertex3f(-1, -1, depth);
+            glTexCoord2f(offset + 8, offset);
+            glVertex3f(1, -1, depth);
+            glTexCoord2f(offset + 8, offset + 6);
+            glVertex3f(1, 1, depth);
+            glTexCoord2f(offset, offset + 6);
+            glVertex3f(-1, 1, depth);
+            glEnd();
+        }
+
+        m_context->present();
+        update();
+
+        m_accumulated_time += timer.elapsed();
+        if (++m_frame_count % FRAMES_PER_REPORT == 0) {
+            double const pixels = static_cast<double>(FRAMES_PER_REPORT) * m_layer_count * RENDER_WIDTH * RENDER_HEIGHT;
+            double const megapixels_per_second = m_accumulated_time > 0 ? pixels / m_accumulated_time / 1000 : 0;
+            double const frame_time = static_cast<double>(m_accumulated_time) / FRAMES_PER_REPORT;
+            outln("{:.1} Mpixels/s, {:.1} ms per frame", megapixels_per_second, frame_time);
+            window()->set_title(String::formatted("GL Fill Rate - {:.1} Mpixels/s", megapixels_per_second));
+            m_accumulated_time = 0;
+        }
+    }
+
+    RefPtr<Gfx::Bitmap> m_bitmap;
+    OwnPtr<GL::GLContext> m_context;
+    int m_layer_count { 0 };
+    int m_frame_count { 0 };
+    i64 m_accumulated_time { 0 };
+};
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    int layer_count = 8;
+    bool no_texture = false;
+    bool no_blend = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure the fill rate of the software OpenGL rasterizer.");
+    args_parser.add_option(layer_count, "Number of full screen layers drawn per frame", "layers", 'l', "count");
+    args_parser.add_option(no_texture, "Don't texture the layers", "no-texture", 't');
+    args_parser.add_option(no_blend, "Don't blend the layers", "no-blend", 'b');
+    args_parser.parse(arguments);
+
+    auto app = TRY(GUI::Application::try_create(arguments));
+
+    TRY(Core::System::pledge("stdio thread recvfd sendfd rpath"));
+    TRY(Core::System::unveil("/res", "r"));
+    TRY(Core::System::unveil(nullptr, nullptr));
+
+    auto app_icon = TRY(GUI::Icon::try_create_default_icon("app-3d-file-viewer"));
+
+    auto window = TRY(GUI::Window::try_create());
+    window->set_title("GL Fill Rate");
+    window->set_icon(app_icon.bitmap_for_size(16));
+    window->resize(RENDER_WIDTH, RENDER_HEIGHT);
+    window->set_resizable(false);
+    window->set_double_buffering_enabled(true);
+    (void)TRY(window->try_set_main_widget<FillRateWidget>(max(layer_count, 1), !no_texture, !no_blend));
+
+    window->show();
+    return app->exec();
+}
@@ -28,6 +28,8 @@ public:
     Optional<u32> js_to_debugger(JS::Value value, const Debug::DebugInfo::VariableInfo&) const;
 
 private:
+    virtual bool may_interfere_with_property_lookup_caches() const override { return true; }
+
     NonnullOwnPtrVector<Debug::DebugInfo::VariableInfo> m_variables;
 };
 
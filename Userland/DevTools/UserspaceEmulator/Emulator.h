@@ -148,6 +148,9 @@ private:
     int virt$disown(pid_t);
     int virt$dup2(int, int);
     int virt$emuctl(FlatPtr, FlatPtr, FlatPtr);
+    int virt$epoll_create(int flags);
+    int virt$epoll_ctl(FlatPtr);
+    int virt$epoll_wait(FlatPtr);
     int virt$execve(FlatPtr);
     void virt$exit(int);
     int virt$fchmod(int, mode_t);
@@ -20,8 +20,13 @@ static constexpr unsigned short size_classes[] = { 16, 32, 64, 128, 256, 496, 10
 static constexpr size_t num_size_classes = (sizeof(size_classes) / sizeof(unsigned short)) - 1;
 
 #ifndef NO_TLS
+// Chunks of up to this size are kept in per-thread caches when they're freed.
+static constexpr size_t thread_cache_max_chunk_size = 4080;
+
 extern "C" {
 extern __thread bool s_allocation_enabled;
+// Returns the chunks cached by the current thread to the shared blocks. Called when a thread exits.
+void __malloc_release_thread_cache();
 }
 #endif
 
@@ -7,15 +7,91 @@
 
 #include <AK/Array.h>
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/BinaryHeap.h>
 #include <AK/BinarySearch.h>
 #include <AK/MemoryStream.h>
+#include <AK/OwnPtr.h>
 #include <string.h>
 
 #include <LibCompress/Deflate.h>
+#include <LibThreading/Thread.h>
 
 namespace Compress {
 
+bool DeflateInputBitStream::refill()
+{
+    u8 bytes[sizeof(m_bit_buffer)];
+    auto nread = m_stream.read({ bytes, (64 - m_bit_count) / 8 });
+    if (m_stream.has_any_error()) {
+        set_fatal_error();
+        return false;
+    }
+
+    for (size_t i = 0; i < nread; ++i) {
+        m_bit_buffer |= static_cast<u64>(bytes[i]) << m_bit_count;
+        m_bit_count += 8;
+    }
+    return nread != 0;
+}
+
+u32 DeflateInputBitStream::read_bits(size_t count)
+{
+    VERIFY(count <= 32);
+    while (m_bit_count < count) {
+        if (!refill()) {
+            set_fatal_error();
+            return 0;
+        }
+    }
+
+    auto bits = static_cast<u32>(m_bit_buffer & ((1ull << count) - 1));
+    discard_bits(count);
+    return bits;
+}
+
+size_t DeflateInputBitStream::read(Bytes bytes)
+{
+    if (has_any_error())
+        return 0;
+
+    VERIFY(m_bit_count % 8 == 0);
+    size_t nread = 0;
+    while (nread < bytes.size() && m_bit_count != 0) {
+        bytes[nread++] = static_cast<u8>(m_bit_buffer);
+        discard_bits(8);
+    }
+
+    return nread + m_stream.read(bytes.slice(nread));
+}
+
+bool DeflateInputBitStream::read_or_error(Bytes bytes)
+{
+    if (read(bytes) != bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+bool DeflateInputBitStream::discard_or_error(size_t count)
+{
+    VERIFY(m_bit_count % 8 == 0);
+    while (count != 0 && m_bit_count != 0) {
+        discard_bits(8);
+        --count;
+    }
+
+    return m_stream.discard_or_error(count);
+}
+
+bool DeflateInputBitStream::handle_any_error()
+{
+    bool handled_errors = m_stream.handle_any_error();
+    return Stream::handle_any_error() || handled_errors;
+}
+
 const CanonicalCode& CanonicalCode::fixed_literal_codes()
 {
     static CanonicalCode code;
@@ -63,6 +139,7 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         code.m_symbol_values.append(last_non_zero);
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
+        code.build_decode_table(bytes.size());
         return code;
     }
 
@@ -91,9 +168,57 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         return {};
     }
 
+    code.build_decode_table(bytes.size());
     return code;
 }
 
+void CanonicalCode::build_decode_table(size_t symbol_count)
+{
+    constexpr size_t primary_table_size = 1 << primary_table_bits;
+    constexpr size_t primary_table_mask = primary_table_size - 1;
+
+    // Every subtable has to be large enough for the longest code that starts with its prefix.
+    Array<u8, primary_table_size> longest_code_for_prefix {};
+    for (size_t symbol = 0; symbol < symbol_count; ++symbol) {
+        auto code_length = m_bit_code_lengths[symbol];
+        if (code_length <= primary_table_bits)
+            continue;
+        auto& longest_code = longest_code_for_prefix[m_bit_codes[symbol] & primary_table_mask];
+        longest_code = max(longest_code, code_length);
+    }
+
+    m_decode_table.resize(primary_table_size);
+    for (size_t prefix = 0; prefix < primary_table_size; ++prefix) {
+        if (longest_code_for_prefix[prefix] == 0)
+            continue;
+        auto subtable_bits = longest_code_for_prefix[prefix] - primary_table_bits;
+        m_decode_table[prefix] = { static_cast<u16>(m_decode_table.size()), 0, static_cast<u8>(subtable_bits) };
+        m_decode_table.resize(m_decode_table.size() + (1 << subtable_bits));
+    }
+
+    for (size_t symbol = 0; symbol < symbol_count; ++symbol) {
+        auto code_length = m_bit_code_lengths[symbol];
+        if (code_length == 0)
+            continue;
+
+        // The code is stored lsb-first, so all entries whose low bits match the code decode to this symbol.
+        DecodeTableEntry entry { static_cast<u16>(symbol), static_cast<u8>(code_length), 0 };
+        auto code = m_bit_codes[symbol];
+        if (code_length <= primary_table_bits) {
+            for (size_t index = code; index < primary_table_size; index += 1 << code_length)
+                m_decode_table[index] = entry;
+            continue;
+        }
+
+        auto const& subtable = m_decode_table[code & primary_table_mask];
+        auto subtable_offset = subtable.symbol_or_subtable_offset;
+        auto subtable_size = 1u << subtable.subtable_bits;
+        auto remaining_length = code_length - primary_table_bits;
+        for (size_t index = code >> primary_table_bits; index < subtable_size; index += 1 << remaining_length)
+            m_decode_table[subtable_offset + index] = entry;
+    }
+}
+
 u32 CanonicalCode::read_symbol(InputBitStream& stream) const
 {
     u32 code_bits = 1;
@@ -111,6 +236,28 @@ u32 CanonicalCode::read_symbol(InputBitStream& stream) const
     }
 }
 
+u32 CanonicalCode::read_symbol(DeflateInputBitStream& stream) const
+{
+    for (;;) {
+        auto bits = stream.peek_bits();
+        auto entry = m_decode_table[bits & ((1 << primary_table_bits) - 1)];
+        if (entry.subtable_bits != 0)
+            entry = m_decode_table[entry.symbol_or_subtable_offset + ((bits >> primary_table_bits) & ((1 << entry.subtable_bits) - 1))];
+
+        if (entry.code_length == 0)
+            return UINT32_MAX; // see above
+
+        // The missing bits are zero, so the entry is only right if its code was fully available.
+        if (entry.code_length <= stream.available_bits()) {
+            stream.discard_bits(entry.code_length);
+            return entry.symbol_or_subtable_offset;
+        }
+
+        if (!stream.refill())
+            return UINT32_MAX;
+    }
+}
+
 void CanonicalCode::write_symbol(OutputBitStream& stream, u32 symbol) const
 {
     stream.write_bits(m_bit_codes[symbol], m_bit_code_lengths[symbol]);
@@ -128,45 +275,53 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
     if (m_eof == true)
         return false;
 
-    const auto symbol = m_literal_codes.read_symbol(m_decompressor.m_input_stream);
+    auto& input_stream = m_decompressor.m_input_stream;
+    auto& output_stream = m_decompressor.m_output_stream;
 
-    if (symbol >= 286) { // invalid deflate literal/length symbol
-        m_decompressor.set_fatal_error();
-        return false;
-    }
+    // Decode symbols for as long as any of them is guaranteed to fit into the output window, instead of returning after each one.
+    while (output_stream.remaining_space() >= DeflateCompressor::max_match_length) {
+        const auto symbol = m_literal_codes.read_symbol(input_stream);
+
+        if (symbol >= 286) { // invalid deflate literal/length symbol
+            m_decompressor.set_fatal_error();
+            return false;
+        }
+
+        if (symbol < 256) {
+            output_stream.append_byte(static_cast<u8>(symbol));
+            continue;
+        }
+
+        if (symbol == 256) {
+            m_eof = true;
+            return true;
+        }
 
-    if (symbol < 256) {
-        m_decompressor.m_output_stream << static_cast<u8>(symbol);
-        return true;
-    } else if (symbol == 256) {
-        m_eof = true;
-        return false;
-    } else {
         if (!m_distance_codes.has_value()) {
             m_decompressor.set_fatal_error();
             return false;
         }
 
         const auto length = m_decompressor.decode_length(symbol);
-        const auto distance_symbol = m_distance_codes.value().read_symbol(m_decompressor.m_input_stream);
+        const auto distance_symbol = m_distance_codes.value().read_symbol(input_stream);
         if (distance_symbol >= 30) { // invalid deflate distance symbol
             m_decompressor.set_fatal_error();
             return false;
         }
         const auto distance = m_decompressor.decode_distance(distance_symbol);
-
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            m_decompressor.m_output_stream.read({ &byte, sizeof(byte) }, distance);
-            if (m_decompressor.m_output_stream.handle_any_error()) {
-                m_decompressor.set_fatal_error();
-                return false; // a back reference was requested that was too far back (outside our current sliding window)
-            }
-            m_decompressor.m_output_stream << byte;
+        if (input_stream.has_any_error()) {
+            m_decompressor.set_fatal_error();
+            return false;
         }
 
-        return true;
+        if (!output_stream.append_from_seekback(distance, length)) {
+            output_stream.handle_any_error();
+            m_decompressor.set_fatal_error();
+            return false; // a back reference was requested that was too far back (outside our current sliding window)
+        }
     }
+
+    return true;
 }
 
 DeflateDecompressor::UncompressedBlock::UncompressedBlock(DeflateDecompressor& decompressor, size_t length)
@@ -320,6 +475,13 @@ size_t DeflateDecompressor::read(Bytes bytes)
     return total_read;
 }
 
+bool DeflateDecompressor::read_trailing_bytes_or_error(Bytes bytes)
+{
+    VERIFY(unreliable_eof());
+    m_input_stream.align_to_byte_boundary();
+    return m_input_stream.read_or_error(bytes);
+}
+
 bool DeflateDecompressor::read_or_error(Bytes bytes)
 {
     if (read(bytes) < bytes.size()) {
@@ -510,6 +672,8 @@ DeflateCompressor::DeflateCompressor(OutputStream& stream, CompressionLevel comp
 {
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
+    for (auto& slot : m_hash_head)
+        slot = empty_slot;
 }
 
 DeflateCompressor::~DeflateCompressor()
@@ -550,6 +714,28 @@ u16 DeflateCompressor::hash_sequence(const u8* bytes)
     return ((bytes[0] | bytes[1] << 8 | bytes[2] << 16 | bytes[3] << 24) * knuth_constant) >> (32 - hash_bits);
 }
 
+void DeflateCompressor::insert_hash(size_t position, u16 hash)
+{
+    auto window_position = position % window_size;
+    m_hash_prev[window_position] = m_hash_head[hash];
+    m_hash_head[hash] = window_position;
+}
+
+// The pending block is about to be moved to the front of the rolling window, so move all hash table positions along with it.
+// Positions in the old previous block fall out of the window and are dropped.
+void DeflateCompressor::slide_hash()
+{
+    auto slide = [](u16 position) -> u16 {
+        if (position == empty_slot || position < block_size)
+            return empty_slot;
+        return position - block_size;
+    };
+    for (auto& slot : m_hash_head)
+        slot = slide(slot);
+    for (size_t i = 0; i < block_size; i++)
+        m_hash_prev[i] = slide(m_hash_prev[i + block_size]);
+}
+
 size_t DeflateCompressor::compare_match_candidate(size_t start, size_t candidate, size_t previous_match_length, size_t maximum_match_length)
 {
     VERIFY(previous_match_length < maximum_match_length);
@@ -590,7 +776,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_back_reference_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -600,8 +786,8 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             match_position = candidate;
             previous_match_length = match_length;
 
-            if (match_length == maximum_match_length)
-                return match_length; // bail if we got the maximum possible length
+            if (match_length == maximum_match_length || match_length >= m_compression_constants.great_match_length)
+                return match_length; // bail if we got the maximum possible length, or one that's good enough
         }
 
         candidate = m_hash_prev[candidate % window_size];
@@ -688,40 +874,30 @@ void DeflateCompressor::generate_huffman_lengths(Array<u8, Size>& lengths, const
     }
 }
 
-void DeflateCompressor::lz77_compress_block()
+void DeflateCompressor::emit_literal(u16 literal)
 {
-    for (auto& slot : m_hash_head) { // initialize chained hash table
-        slot = empty_slot;
-    }
-
-    auto insert_hash = [&](auto pos, auto hash) {
-        auto window_pos = pos % window_size;
-        m_hash_prev[window_pos] = m_hash_head[hash];
-        m_hash_head[hash] = window_pos;
-    };
-
-    auto emit_literal = [&](auto literal) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = 0;
-        m_symbol_buffer[index].literal = literal;
-        m_symbol_frequencies[literal]++;
-    };
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = 0;
+    m_symbol_buffer[index].literal = literal;
+    m_symbol_frequencies[literal]++;
+}
 
-    auto emit_back_reference = [&](auto distance, auto length) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = distance;
-        m_symbol_buffer[index].length = length;
-        m_symbol_frequencies[length_to_symbol[length]]++;
-        m_distance_frequencies[distance_to_base(distance)]++;
-    };
+void DeflateCompressor::emit_back_reference(u16 distance, u16 length)
+{
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = distance;
+    m_symbol_buffer[index].length = length;
+    m_symbol_frequencies[length_to_symbol[length]]++;
+    m_distance_frequencies[distance_to_base(distance)]++;
+}
 
+void DeflateCompressor::lz77_compress_block()
+{
     size_t previous_match_length = 0;
     size_t previous_match_position = 0;
 
-    VERIFY(m_compression_constants.great_match_length <= max_match_length);
-
     // our block starts at block_size and is m_pending_block_size in length
     auto block_end = block_size + m_pending_block_size;
     size_t current_position;
@@ -729,7 +905,7 @@ void DeflateCompressor::lz77_compress_block()
         auto hash = hash_sequence(&m_rolling_window[current_position]);
         size_t match_position;
         auto match_length = find_back_match(current_position, hash, previous_match_length,
-            min(m_compression_constants.great_match_length, block_end - current_position), match_position);
+            min(max_match_length, block_end - current_position), match_position);
 
         insert_hash(current_position, hash);
 
@@ -773,6 +949,42 @@ void DeflateCompressor::lz77_compress_block()
     }
 }
 
+// Like zlib's deflate_fast(): only the newest candidate with the same hash is checked, and any match found is taken immediately.
+void DeflateCompressor::lz77_compress_block_fast()
+{
+    auto block_end = block_size + m_pending_block_size;
+    auto hash_end = block_end - min_match_length + 1;
+    size_t current_position;
+    for (current_position = block_size; current_position < hash_end; current_position++) {
+        auto hash = hash_sequence(&m_rolling_window[current_position]);
+        auto candidate = m_hash_head[hash];
+        m_hash_head[hash] = current_position;
+
+        size_t match_length = 0;
+        if (candidate != empty_slot && current_position - candidate <= max_back_reference_distance)
+            match_length = compare_match_candidate(current_position, candidate, min_match_length - 1, min(max_match_length, block_end - current_position));
+
+        if (match_length == 0) {
+            emit_literal(m_rolling_window[current_position]);
+            continue;
+        }
+
+        emit_back_reference(current_position - candidate, match_length);
+
+        // Inserting every byte of a long match is slow, and rarely pays off
+        if (match_length <= m_compression_constants.max_lazy_length) {
+            for (size_t j = current_position + 1; j < min(current_position + match_length, hash_end); j++)
+                m_hash_head[hash_sequence(&m_rolling_window[j])] = j;
+        }
+        current_position += match_length - 1;
+    }
+
+    // output remaining literals
+    while (current_position < block_end) {
+        emit_literal(m_rolling_window[current_position++]);
+    }
+}
+
 size_t DeflateCompressor::huffman_block_length(const Array<u8, max_huffman_literals>& literal_bit_lengths, const Array<u8, max_huffman_distances>& distance_bit_lengths)
 {
     size_t length = 0;
@@ -984,7 +1196,10 @@ void DeflateCompressor::flush()
     // The following implementation of lz77 compression and huffman encoding is based on the reference implementation by Hans Wennborg https://www.hanshq.net/zip.html
 
     // this reads from the pending block and writes to m_symbol_buffer
-    lz77_compress_block();
+    if (m_compression_level == CompressionLevel::FAST)
+        lz77_compress_block_fast();
+    else
+        lz77_compress_block();
 
     // insert EndOfBlock marker to the symbol buffer
     m_symbol_buffer[m_pending_symbol_size].distance = 0;
@@ -1042,7 +1257,44 @@ void DeflateCompressor::flush()
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
     // On the final block this copy will potentially produce an invalid search window, but since its the final block we dont care
-    pending_block().copy_trimmed_to({ m_rolling_window, block_size });
+    pending_block().copy_trimmed_to(previous_block());
+    slide_hash();
+}
+
+// Primes the search window with data that directly precedes the input, without emitting it.
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(m_pending_block_size == 0);
+    if (dictionary.size() > block_size)
+        dictionary = dictionary.slice(dictionary.size() - block_size);
+
+    auto dictionary_start = block_size - dictionary.size();
+    dictionary.copy_to(previous_block().slice(dictionary_start));
+    if (m_compression_level == CompressionLevel::STORE || dictionary.size() < min_match_length)
+        return;
+    for (auto position = dictionary_start; position <= block_size - min_match_length; position++)
+        insert_hash(position, hash_sequence(&m_rolling_window[position]));
+}
+
+// Ends the stream without a final block, byte-aligned by an empty stored block (like zlib's Z_SYNC_FLUSH), so that the blocks of another
+// stream can directly follow it.
+void DeflateCompressor::finish_with_sync_flush()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        flush();
+    if (m_output_stream.handle_any_error()) {
+        set_fatal_error();
+        return;
+    }
+    m_output_stream.write_bit(false);
+    m_output_stream.write_bits(0b00, 2); // no compression
+    m_output_stream.align_to_byte_boundary();
+    LittleEndian<u16> len = 0;
+    m_output_stream << len;
+    LittleEndian<u16> nlen = ~0;
+    m_output_stream << nlen;
+    m_finished = true;
 }
 
 void DeflateCompressor::final_flush()
@@ -1067,4 +1319,67 @@ Optional<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, Compre
     return output_stream.copy_into_contiguous_buffer();
 }
 
+Optional<ByteBuffer> DeflateCompressor::compress_all_parallel(ReadonlyBytes bytes, size_t thread_count, CompressionLevel compression_level)
+{
+    auto slice_count = ceil_div(bytes.size(), parallel_slice_size);
+    if (thread_count <= 1 || slice_count <= 1)
+        return compress_all(bytes, compression_level);
+    thread_count = min(thread_count, slice_count);
+
+    Vector<Optional<ByteBuffer>> compressed_slices;
+    compressed_slices.resize(slice_count);
+    Atomic<size_t> next_slice { 0 };
+
+    auto compress_slices = [&]() -> intptr_t {
+        for (;;) {
+            auto slice_index = next_slice.fetch_add(1);
+            if (slice_index >= slice_count)
+                return 0;
+
+            auto slice_start = slice_index * parallel_slice_size;
+            auto slice = bytes.slice(slice_start, min(parallel_slice_size, bytes.size() - slice_start));
+
+            DuplexMemoryStream output_stream;
+            auto deflate_stream = make<DeflateCompressor>(output_stream, compression_level);
+            deflate_stream->set_dictionary(bytes.slice(0, slice_start));
+            deflate_stream->write_or_error(slice);
+            if (slice_index == slice_count - 1)
+                deflate_stream->final_flush();
+            else
+                deflate_stream->finish_with_sync_flush();
+
+            if (!deflate_stream->handle_any_error())
+                compressed_slices[slice_index] = output_stream.copy_into_contiguous_buffer();
+        }
+    };
+
+    // The calling thread does its share of the work too.
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 1; i < thread_count; i++) {
+        auto thread = Threading::Thread::construct([&] { return compress_slices(); }, "DeflateWorker"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+    compress_slices();
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    size_t compressed_size = 0;
+    for (auto& compressed_slice : compressed_slices) {
+        if (!compressed_slice.has_value())
+            return {};
+        compressed_size += compressed_slice->size();
+    }
+
+    auto output = ByteBuffer::create_uninitialized(compressed_size);
+    if (output.is_error())
+        return {};
+    size_t offset = 0;
+    for (auto& compressed_slice : compressed_slices) {
+        compressed_slice->bytes().copy_to(output.value().bytes().slice(offset));
+        offset += compressed_slice->size();
+    }
+    return output.release_value();
+}
+
 }
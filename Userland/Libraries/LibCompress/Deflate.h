@@ -16,10 +16,47 @@
 
 namespace Compress {
 
+// Reads the LSB-first bit stream of deflate through a 64-bit buffer, which is refilled several bytes at a time.
+// This means up to 7 bytes past the end of the deflate stream can end up in the buffer; they can still be read with read().
+class DeflateInputBitStream final : public InputStream {
+public:
+    explicit DeflateInputBitStream(InputStream& stream)
+        : m_stream(stream)
+    {
+    }
+
+    size_t read(Bytes) override;
+    bool read_or_error(Bytes) override;
+    bool unreliable_eof() const override { return m_bit_count == 0 && m_stream.unreliable_eof(); }
+    bool discard_or_error(size_t count) override;
+    bool handle_any_error() override;
+
+    // The bits past available_bits() are always zero.
+    ALWAYS_INLINE u64 peek_bits() const { return m_bit_buffer; }
+    ALWAYS_INLINE size_t available_bits() const { return m_bit_count; }
+    ALWAYS_INLINE void discard_bits(size_t count)
+    {
+        VERIFY(count <= m_bit_count && count < 64);
+        m_bit_buffer >>= count;
+        m_bit_count -= count;
+    }
+    bool refill();
+
+    u32 read_bits(size_t count);
+    bool read_bit() { return read_bits(1); }
+    void align_to_byte_boundary() { discard_bits(m_bit_count % 8); }
+
+private:
+    InputStream& m_stream;
+    u64 m_bit_buffer { 0 };
+    size_t m_bit_count { 0 };
+};
+
 class CanonicalCode {
 public:
     CanonicalCode() = default;
     u32 read_symbol(InputBitStream&) const;
+    u32 read_symbol(DeflateInputBitStream&) const;
     void write_symbol(OutputBitStream&, u32) const;
 
     static const CanonicalCode& fixed_literal_codes();
@@ -28,10 +65,22 @@ public:
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
+    void build_decode_table(size_t symbol_count);
+
     // Decompression - indexed by code
     Vector<u16> m_symbol_codes;
     Vector<u16> m_symbol_values;
 
+    // Decompression - indexed by the next bits of the input, like zlib's inflate tables.
+    // Codes that are longer than primary_table_bits continue in a subtable, which the primary entry points to.
+    static constexpr size_t primary_table_bits = 9;
+    struct DecodeTableEntry {
+        u16 symbol_or_subtable_offset;
+        u8 code_length;
+        u8 subtable_bits;
+    };
+    Vector<DecodeTableEntry> m_decode_table;
+
     // Compression - indexed by symbol
     Array<u16, 288> m_bit_codes {}; // deflate uses a maximum of 288 symbols (maximum of 32 for distances)
     Array<u16, 288> m_bit_code_lengths {};
@@ -77,6 +126,9 @@ public:
     DeflateDecompressor(InputStream&);
     ~DeflateDecompressor();
 
+    // Reads the bytes that follow the deflate stream, like the gzip trailer. Some of them may have been read ahead already.
+    bool read_trailing_bytes_or_error(Bytes);
+
     size_t read(Bytes) override;
     bool read_or_error(Bytes) override;
     bool discard_or_error(size_t) override;
@@ -99,7 +151,7 @@ private:
         UncompressedBlock m_uncompressed_block;
     };
 
-    InputBitStream m_input_stream;
+    DeflateInputBitStream m_input_stream;
     CircularDuplexStream<32 * KiB> m_output_stream;
 };
 
@@ -118,11 +170,12 @@ public:
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t max_back_reference_distance = 32 * KiB;
     static constexpr u16 empty_slot = UINT16_MAX;
 
     struct CompressionConstants {
         size_t good_match_length;  // Once we find a match of at least this length (a good enough match) we reduce max_chain to lower processing time
-        size_t max_lazy_length;    // If the match is at least this long we dont defer matching to the next byte (which takes time) as its good enough
+        size_t max_lazy_length;    // If the match is at least this long we dont defer matching to the next byte (which takes time) as its good enough (FAST: matches longer than this are not inserted into the hash table)
         size_t great_match_length; // Once we find a match of at least this length (a great match) we can just stop searching for longer ones
         size_t max_chain;          // We only check the actual length of the max_chain closest matches
     };
@@ -130,7 +183,7 @@ public:
     // These constants were shamelessly "borrowed" from zlib
     static constexpr CompressionConstants compression_constants[] = {
         { 0, 0, 0, 0 },
-        { 4, 4, 8, 4 },
+        { 4, 16, max_match_length, 1 }, // FAST only ever probes the newest candidate and never defers a match
         { 8, 16, 128, 128 },
         { 32, 258, 258, 4096 },
         { max_match_length, max_match_length, max_match_length, 1 << hash_bits } // disable all limits
@@ -153,14 +206,28 @@ public:
 
     static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
 
+    // Splits the input into slices that are compressed on separate threads, and stitches the results together into a single deflate stream.
+    // Every slice is primed with the end of the slice before it, so this costs very little compression ratio.
+    static Optional<ByteBuffer> compress_all_parallel(ReadonlyBytes bytes, size_t thread_count, CompressionLevel = CompressionLevel::GOOD);
+    static constexpr size_t parallel_slice_size = 128 * KiB;
+
 private:
     Bytes pending_block() { return { m_rolling_window + block_size, block_size }; }
+    Bytes previous_block() { return { m_rolling_window, block_size }; }
+
+    void set_dictionary(ReadonlyBytes);
+    void finish_with_sync_flush();
 
     // LZ77 Compression
     static u16 hash_sequence(const u8* bytes);
+    void insert_hash(size_t position, u16 hash);
+    void slide_hash();
     size_t compare_match_candidate(size_t start, size_t candidate, size_t prev_match_length, size_t max_match_length);
     size_t find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t max_match_length, size_t& match_position);
+    void emit_literal(u16 literal);
+    void emit_back_reference(u16 distance, u16 length);
     void lz77_compress_block();
+    void lz77_compress_block_fast();
 
     // Huffman Coding
     struct code_length_symbol {
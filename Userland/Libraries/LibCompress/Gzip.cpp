@@ -69,8 +69,13 @@ size_t GzipDecompressor::read(Bytes bytes)
             }
 
             if (nread < slice.size()) {
+                // The deflate stream may have read ahead into the trailer.
                 LittleEndian<u32> crc32, input_size;
-                m_input_stream >> crc32 >> input_size;
+                if (!current_member().m_stream.read_trailing_bytes_or_error(Bytes { &crc32, sizeof(crc32) })
+                    || !current_member().m_stream.read_trailing_bytes_or_error(Bytes { &input_size, sizeof(input_size) })) {
+                    set_fatal_error();
+                    break;
+                }
 
                 if (crc32 != current_member().m_checksum.digest()) {
                     // FIXME: Somehow the checksum is incorrect?
@@ -220,8 +225,10 @@ bool GzipDecompressor::handle_any_error()
     return Stream::handle_any_error() || handled_errors;
 }
 
-GzipCompressor::GzipCompressor(OutputStream& stream)
+GzipCompressor::GzipCompressor(OutputStream& stream, DeflateCompressor::CompressionLevel compression_level, size_t thread_count)
     : m_output_stream(stream)
+    , m_compression_level(compression_level)
+    , m_thread_count(thread_count)
 {
 }
 
@@ -240,9 +247,18 @@ size_t GzipCompressor::write(ReadonlyBytes bytes)
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
     m_output_stream << Bytes { &header, sizeof(header) };
-    DeflateCompressor compressed_stream { m_output_stream };
-    VERIFY(compressed_stream.write_or_error(bytes));
-    compressed_stream.final_flush();
+    if (m_thread_count > 1) {
+        auto compressed_bytes = DeflateCompressor::compress_all_parallel(bytes, m_thread_count, m_compression_level);
+        if (!compressed_bytes.has_value()) {
+            set_fatal_error();
+            return 0;
+        }
+        m_output_stream << compressed_bytes->bytes();
+    } else {
+        DeflateCompressor compressed_stream { m_output_stream, m_compression_level };
+        VERIFY(compressed_stream.write_or_error(bytes));
+        compressed_stream.final_flush();
+    }
     Crypto::Checksum::CRC32 crc32;
     crc32.update(bytes);
     LittleEndian<u32> digest = crc32.digest();
@@ -261,10 +277,10 @@ bool GzipCompressor::write_or_error(ReadonlyBytes bytes)
     return true;
 }
 
-Optional<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes)
+Optional<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes, DeflateCompressor::CompressionLevel compression_level, size_t thread_count)
 {
     DuplexMemoryStream output_stream;
-    GzipCompressor gzip_stream { output_stream };
+    GzipCompressor gzip_stream { output_stream, compression_level, thread_count };
 
     gzip_stream.write_or_error(bytes);
 
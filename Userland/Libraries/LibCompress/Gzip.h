@@ -81,16 +81,18 @@ private:
 
 class GzipCompressor final : public OutputStream {
 public:
-    GzipCompressor(OutputStream&);
+    GzipCompressor(OutputStream&, DeflateCompressor::CompressionLevel = DeflateCompressor::CompressionLevel::GOOD, size_t thread_count = 1);
     ~GzipCompressor();
 
     size_t write(ReadonlyBytes) override;
     bool write_or_error(ReadonlyBytes) override;
 
-    static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes);
+    static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes, DeflateCompressor::CompressionLevel = DeflateCompressor::CompressionLevel::GOOD, size_t thread_count = 1);
 
 private:
     OutputStream& m_output_stream;
+    DeflateCompressor::CompressionLevel m_compression_level;
+    size_t m_thread_count;
 };
 
 }
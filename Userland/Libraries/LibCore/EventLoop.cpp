@@ -34,6 +34,11 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__serenity__) || defined(__linux__)
+#    define EVENTLOOP_USES_EPOLL
+#    include <sys/epoll.h>
+#endif
+
 #ifdef __serenity__
 extern bool s_global_initializers_ran;
 #endif
@@ -68,10 +73,68 @@ static Threading::MutexProtected<RefPtr<InspectorServerConnection>> s_inspector_
 // Each thread has its own event loop stack, its own timers, notifiers and a wake pipe.
 static thread_local Vector<EventLoop&>* s_event_loop_stack;
 static thread_local HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
-static thread_local HashTable<Notifier*>* s_notifiers;
+// Several notifiers can watch the same fd, e.g. one for reading and one for writing.
+static thread_local HashMap<int, Vector<Notifier*, 1>>* s_notifiers;
 thread_local int EventLoop::s_wake_pipe_fds[2];
 thread_local bool EventLoop::s_wake_pipe_initialized { false };
 
+#ifdef EVENTLOOP_USES_EPOLL
+// The notifier fds stay registered with an epoll instance, so waiting for events doesn't have to
+// hand every fd to the kernel again, and only the fds that are actually ready come back.
+static thread_local int s_epoll_fd { -1 };
+static thread_local bool s_epoll_watches_wake_pipe { false };
+// Files that epoll refuses to watch (regular files on Linux) are always ready, just like with select().
+static thread_local HashTable<int>* s_always_ready_fds;
+
+static void ensure_epoll_fd()
+{
+    if (s_epoll_fd >= 0)
+        return;
+    s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (s_epoll_fd < 0) {
+        perror("Core::EventLoop: epoll_create1");
+        VERIFY_NOT_REACHED();
+    }
+    if (!s_always_ready_fds)
+        s_always_ready_fds = new HashTable<int>;
+}
+
+static void update_fd_watch(int fd, bool is_wake_pipe = false)
+{
+    ensure_epoll_fd();
+
+    epoll_event event {};
+    event.data.fd = fd;
+    if (is_wake_pipe) {
+        event.events = EPOLLIN;
+    } else if (auto it = s_notifiers->find(fd); it != s_notifiers->end()) {
+        for (auto* notifier : it->value) {
+            if (notifier->event_mask() & Notifier::Read)
+                event.events |= EPOLLIN;
+            if (notifier->event_mask() & Notifier::Write)
+                event.events |= EPOLLOUT;
+            if (notifier->event_mask() & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
+    } else {
+        s_always_ready_fds->remove(fd);
+        // The fd may well have been closed already, in which case the kernel has dropped it for us.
+        (void)epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return;
+    }
+
+    if (epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0)
+        return;
+    if (errno == ENOENT && epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0)
+        return;
+    if (errno == EPERM) {
+        s_always_ready_fds->set(fd);
+        return;
+    }
+    dbgln("Core::EventLoop: Failed to watch fd {}: {}", fd, strerror(errno));
+}
+#endif
+
 void EventLoop::initialize_wake_pipes()
 {
     if (!s_wake_pipe_initialized) {
@@ -319,7 +382,7 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
-        s_notifiers = new HashTable<Notifier*>;
+        s_notifiers = new HashMap<int, Vector<Notifier*, 1>>;
     }
     s_main_event_loop.with_locked([&, this](auto*& main_event_loop) {
         if (main_event_loop == nullptr) {
@@ -632,6 +695,15 @@ void EventLoop::notify_forked(ForkEvent event)
         s_notifiers->clear();
         s_wake_pipe_initialized = false;
         initialize_wake_pipes();
+#ifdef EVENTLOOP_USES_EPOLL
+        // The epoll instance is shared with the parent, so we need one of our own.
+        if (s_epoll_fd >= 0) {
+            close(s_epoll_fd);
+            s_epoll_fd = -1;
+            s_epoll_watches_wake_pipe = false;
+            s_always_ready_fds->clear();
+        }
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -646,34 +718,83 @@ void EventLoop::notify_forked(ForkEvent event)
     VERIFY_NOT_REACHED();
 }
 
-void EventLoop::wait_for_event(WaitMode mode)
+struct ReadyFD {
+    int fd;
+    bool readable;
+    bool writable;
+};
+
+// Blocks until a notifier fd or the wake pipe is ready, or the timeout expires. Returns -1 with errno set on failure.
+static int wait_for_ready_fds(int wake_pipe_fd, Optional<Time> const& timeout, Vector<ReadyFD, 32>& ready_fds)
 {
+    ready_fds.clear_with_capacity();
+
+#ifdef EVENTLOOP_USES_EPOLL
+    if (!s_epoll_watches_wake_pipe) {
+        update_fd_watch(wake_pipe_fd, true);
+        s_epoll_watches_wake_pipe = true;
+    }
+
+    int timeout_ms = -1;
+    if (timeout.has_value())
+        timeout_ms = static_cast<int>(min(timeout->to_milliseconds(), static_cast<i64>(NumericLimits<int>::max())));
+    if (!s_always_ready_fds->is_empty())
+        timeout_ms = 0;
+
+    epoll_event events[32];
+    int event_count = epoll_wait(s_epoll_fd, events, array_size(events), timeout_ms);
+    if (event_count < 0)
+        return -1;
+
+    for (int i = 0; i < event_count; ++i) {
+        auto ready_events = events[i].events;
+        bool has_error = ready_events & (EPOLLERR | EPOLLHUP);
+        ready_fds.append({ events[i].data.fd, has_error || (ready_events & EPOLLIN), has_error || (ready_events & EPOLLOUT) });
+    }
+    for (int fd : *s_always_ready_fds)
+        ready_fds.append({ fd, true, true });
+    return ready_fds.size();
+#else
     fd_set rfds;
     fd_set wfds;
-retry:
     FD_ZERO(&rfds);
     FD_ZERO(&wfds);
 
-    int max_fd = 0;
-    auto add_fd_to_set = [&max_fd](int fd, fd_set& set) {
-        FD_SET(fd, &set);
-        if (fd > max_fd)
-            max_fd = fd;
-    };
-
-    int max_fd_added = -1;
-    add_fd_to_set(s_wake_pipe_fds[0], rfds);
-    max_fd = max(max_fd, max_fd_added);
-
-    for (auto& notifier : *s_notifiers) {
-        if (notifier->event_mask() & Notifier::Read)
-            add_fd_to_set(notifier->fd(), rfds);
-        if (notifier->event_mask() & Notifier::Write)
-            add_fd_to_set(notifier->fd(), wfds);
-        if (notifier->event_mask() & Notifier::Exceptional)
-            VERIFY_NOT_REACHED();
+    int max_fd = wake_pipe_fd;
+    FD_SET(wake_pipe_fd, &rfds);
+    for (auto& it : *s_notifiers) {
+        for (auto* notifier : it.value) {
+            if (notifier->event_mask() & Notifier::Read)
+                FD_SET(it.key, &rfds);
+            if (notifier->event_mask() & Notifier::Write)
+                FD_SET(it.key, &wfds);
+            if (notifier->event_mask() & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
+        max_fd = max(max_fd, it.key);
     }
 
+    struct timeval timeout_tv = {};
+    if (timeout.has_value())
+        timeout_tv = timeout->to_timeval();
+    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, timeout.has_value() ? &timeout_tv : nullptr);
+    if (marked_fd_count <= 0)
+        return marked_fd_count;
+
+    for (int fd = 0; fd <= max_fd; ++fd) {
+        bool readable = FD_ISSET(fd, &rfds);
+        bool writable = FD_ISSET(fd, &wfds);
+        if (readable || writable)
+            ready_fds.append({ fd, readable, writable });
+    }
+    return ready_fds.size();
+#endif
+}
+
+void EventLoop::wait_for_event(WaitMode mode)
+{
+    Vector<ReadyFD, 32> ready_fds;
+retry:
     bool queued_events_is_empty;
     {
         Threading::MutexLocker locker(m_private->lock);
@@ -681,8 +802,7 @@ retry:
     }
 
     Time now;
-    struct timeval timeout = { 0, 0 };
-    bool should_wait_forever = false;
+    Optional<Time> timeout = Time::zero();
     if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
         auto next_timer_expiration = get_next_timer_expiration();
         if (next_timer_expiration.has_value()) {
@@ -690,14 +810,14 @@ retry:
             auto computed_timeout = next_timer_expiration.value() - now;
             if (computed_timeout.is_negative())
                 computed_timeout = Time::zero();
-            timeout = computed_timeout.to_timeval();
+            timeout = computed_timeout;
         } else {
-            should_wait_forever = true;
+            timeout = {};
         }
     }
 
 try_select_again:
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    int marked_fd_count = wait_for_ready_fds(s_wake_pipe_fds[0], timeout, ready_fds);
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -708,7 +828,12 @@ try_select_again:
         dbgln("Core::EventLoop::wait_for_event: {} ({}: {})", marked_fd_count, saved_errno, strerror(saved_errno));
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+    bool wake_pipe_is_ready = false;
+    for (auto& ready_fd : ready_fds) {
+        if (ready_fd.fd == s_wake_pipe_fds[0])
+            wake_pipe_is_ready = true;
+    }
+    if (wake_pipe_is_ready) {
         int wake_events[8];
         ssize_t nread;
         // We might receive another signal while read()ing here. The signal will go to the handle_signal properly,
@@ -766,13 +891,14 @@ try_select_again:
     if (!marked_fd_count)
         return;
 
-    for (auto& notifier : *s_notifiers) {
-        if (FD_ISSET(notifier->fd(), &rfds)) {
-            if (notifier->event_mask() & Notifier::Event::Read)
+    for (auto& ready_fd : ready_fds) {
+        auto it = s_notifiers->find(ready_fd.fd);
+        if (it == s_notifiers->end())
+            continue;
+        for (auto* notifier : it->value) {
+            if (ready_fd.readable && (notifier->event_mask() & Notifier::Event::Read))
                 post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
-        }
-        if (FD_ISSET(notifier->fd(), &wfds)) {
-            if (notifier->event_mask() & Notifier::Event::Write)
+            if (ready_fd.writable && (notifier->event_mask() & Notifier::Event::Write))
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
@@ -831,12 +957,36 @@ bool EventLoop::unregister_timer(int timer_id)
 
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    auto& notifiers = s_notifiers->ensure(notifier.fd());
+    if (notifiers.contains_slow(&notifier))
+        return;
+    notifiers.append(&notifier);
+#ifdef EVENTLOOP_USES_EPOLL
+    update_fd_watch(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    auto it = s_notifiers->find(notifier.fd());
+    if (it == s_notifiers->end())
+        return;
+    if (!it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; }))
+        return;
+    if (it->value.is_empty())
+        s_notifiers->remove(it);
+#ifdef EVENTLOOP_USES_EPOLL
+    update_fd_watch(notifier.fd());
+#endif
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, [[maybe_unused]] Notifier& notifier)
+{
+#ifdef EVENTLOOP_USES_EPOLL
+    auto it = s_notifiers->find(notifier.fd());
+    if (it != s_notifiers->end() && it->value.contains_slow(&notifier))
+        update_fd_watch(notifier.fd());
+#endif
 }
 
 void EventLoop::wake()
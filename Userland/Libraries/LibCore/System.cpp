@@ -25,6 +25,10 @@
 #    include <serenity.h>
 #endif
 
+#if defined(__serenity__) || defined(__linux__)
+#    include <sys/sendfile.h>
+#endif
+
 #if defined(__linux__) && !defined(MFD_CLOEXEC)
 #    include <linux/memfd.h>
 #    include <sys/syscall.h>
@@ -893,6 +897,16 @@ ErrorOr<ssize_t> sendto(int sockfd, void const* source, size_t source_length, in
     return sent;
 }
 
+#if defined(__serenity__) || defined(__linux__)
+ErrorOr<ssize_t> sendfile(int out_fd, int in_fd, off_t* offset, size_t count)
+{
+    auto sent = ::sendfile(out_fd, in_fd, offset, count);
+    if (sent < 0)
+        return Error::from_syscall("sendfile"sv, -errno);
+    return sent;
+}
+#endif
+
 ErrorOr<ssize_t> recv(int sockfd, void* buffer, size_t length, int flags)
 {
     auto received = ::recv(sockfd, buffer, length, flags);
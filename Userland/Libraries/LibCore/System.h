@@ -130,6 +130,9 @@ ErrorOr<void> shutdown(int sockfd, int how);
 ErrorOr<ssize_t> send(int sockfd, void const*, size_t, int flags);
 ErrorOr<ssize_t> sendmsg(int sockfd, const struct msghdr*, int flags);
 ErrorOr<ssize_t> sendto(int sockfd, void const*, size_t, int flags, struct sockaddr const*, socklen_t);
+#if defined(__serenity__) || defined(__linux__)
+ErrorOr<ssize_t> sendfile(int out_fd, int in_fd, off_t* offset, size_t count);
+#endif
 ErrorOr<ssize_t> recv(int sockfd, void*, size_t, int flags);
 ErrorOr<ssize_t> recvmsg(int sockfd, struct msghdr*, int flags);
 ErrorOr<ssize_t> recvfrom(int sockfd, void*, size_t, int flags, struct sockaddr*, socklen_t*);
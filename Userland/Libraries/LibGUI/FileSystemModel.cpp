@@ -11,12 +11,14 @@
 #include <AK/StringBuilder.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/StandardPaths.h>
 #include <LibGUI/AbstractView.h>
 #include <LibGUI/FileIconProvider.h>
 #include <LibGUI/FileSystemModel.h>
 #include <LibGUI/Painter.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/ImageDecoder.h>
 #include <LibThreading/BackgroundAction.h>
 #include <grp.h>
 #include <pwd.h>
@@ -617,7 +619,18 @@ static HashMap<String, RefPtr<Gfx::Bitmap>> s_thumbnail_cache;
 
 static ErrorOr<NonnullRefPtr<Gfx::Bitmap>> render_thumbnail(StringView path)
 {
-    auto bitmap = TRY(Gfx::Bitmap::try_load_from_file(path));
+    // Decoders can produce a smaller image when they know it's only going to be a thumbnail,
+    // which is a lot cheaper than decoding it at full size.
+    auto file = TRY(Core::MappedFile::map(path));
+    auto decoder = Gfx::ImageDecoder::try_create(file->bytes());
+    if (!decoder)
+        return Error::from_string_literal("Unable to find a decoder for the image"sv);
+    decoder->set_target_size({ 32, 32 });
+    auto frame = TRY(decoder->frame(0));
+    if (!frame.image)
+        return Error::from_string_literal("Unable to decode the image"sv);
+    auto bitmap = frame.image.release_nonnull();
+
     auto thumbnail = TRY(Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { 32, 32 }));
 
     double scale = min(32 / (double)bitmap->width(), 32 / (double)bitmap->height());
@@ -10,6 +10,7 @@
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibGfx/BMPLoader.h>
+#include <LibGfx/BoxDownscaler.h>
 
 namespace Gfx {
 
@@ -139,6 +140,7 @@ struct BMPLoadingContext {
 
     Vector<u32> color_table;
     RefPtr<Gfx::Bitmap> bitmap;
+    IntSize target_size;
 
     u32 dib_size() const
     {
@@ -1171,7 +1173,20 @@ static bool decode_bmp_pixel_data(BMPLoadingContext& context)
     const u32 width = abs(context.dib.core.width);
     const u32 height = abs(context.dib.core.height);
 
-    auto bitmap_or_error = Bitmap::try_create(format, { static_cast<int>(width), static_cast<int>(height) });
+    // When the image is going to be scaled down, every row is decoded into a bitmap that is only one row
+    // high, and handed to a downscaler right away.
+    OwnPtr<BoxDownscaler> downscaler;
+    IntSize size { static_cast<int>(width), static_cast<int>(height) };
+    auto reduction_factor = reduction_factor_for_target_size(size, context.target_size);
+    if (reduction_factor > 1) {
+        auto downscaler_or_error = BoxDownscaler::try_create(size, reduction_factor, format == BitmapFormat::BGRA8888);
+        if (downscaler_or_error.is_error())
+            return false;
+        downscaler = downscaler_or_error.release_value();
+        size.set_height(1);
+    }
+
+    auto bitmap_or_error = Bitmap::try_create(format, size);
     if (bitmap_or_error.is_error()) {
         // FIXME: Propagate the *real* error.
         return false;
@@ -1179,6 +1194,9 @@ static bool decode_bmp_pixel_data(BMPLoadingContext& context)
 
     context.bitmap = bitmap_or_error.release_value_but_fixme_should_propagate_errors();
 
+    for (size_t i = 0; i < context.color_table.size(); ++i)
+        context.bitmap->set_palette_color(i, Color::from_rgb(context.color_table[i]));
+
     ByteBuffer rle_buffer;
     ReadonlyBytes bytes { context.file_bytes + context.data_offset, context.file_size - context.data_offset };
 
@@ -1193,6 +1211,7 @@ static bool decode_bmp_pixel_data(BMPLoadingContext& context)
 
     auto process_row = [&](u32 row) -> bool {
         u32 space_remaining_before_consuming_row = streamer.remaining();
+        u32 bitmap_row = downscaler ? 0 : row;
 
         for (u32 column = 0; column < width;) {
             switch (bits_per_pixel) {
@@ -1203,7 +1222,7 @@ static bool decode_bmp_pixel_data(BMPLoadingContext& context)
                 u8 mask = 8;
                 while (column < width && mask > 0) {
                     mask -= 1;
-                    context.bitmap->scanline_u8(row)[column++] = (byte >> mask) & 0x1;
+                    context.bitmap->scanline_u8(bitmap_row)[column++] = (byte >> mask) & 0x1;
                 }
                 break;
             }
@@ -1214,7 +1233,7 @@ static bool decode_bmp_pixel_data(BMPLoadingContext& context)
                 u8 mask = 8;
                 while (column < width && mask > 0) {
                     mask -= 2;
-                    context.bitmap->scanline_u8(row)[column++] = (byte >> mask) & 0x3;
+                    context.bitmap->scanline_u8(bitmap_row)[column++] = (byte >> mask) & 0x3;
                 }
                 break;
             }
@@ -1222,35 +1241,35 @@ static bool decode_bmp_pixel_data(BMPLoadingContext& context)
                 if (!streamer.has_u8())
                     return false;
                 u8 byte = streamer.read_u8();
-                context.bitmap->scanline_u8(row)[column++] = (byte >> 4) & 0xf;
+                context.bitmap->scanline_u8(bitmap_row)[column++] = (byte >> 4) & 0xf;
                 if (column < width)
-                    context.bitmap->scanline_u8(row)[column++] = byte & 0xf;
+                    context.bitmap->scanline_u8(bitmap_row)[column++] = byte & 0xf;
                 break;
             }
             case 8:
                 if (!streamer.has_u8())
                     return false;
-                context.bitmap->scanline_u8(row)[column++] = streamer.read_u8();
+                context.bitmap->scanline_u8(bitmap_row)[column++] = streamer.read_u8();
                 break;
             case 16: {
                 if (!streamer.has_u16())
                     return false;
-                context.bitmap->scanline(row)[column++] = int_to_scaled_rgb(context, streamer.read_u16());
+                context.bitmap->scanline(bitmap_row)[column++] = int_to_scaled_rgb(context, streamer.read_u16());
                 break;
             }
             case 24: {
                 if (!streamer.has_u24())
                     return false;
-                context.bitmap->scanline(row)[column++] = streamer.read_u24();
+                context.bitmap->scanline(bitmap_row)[column++] = streamer.read_u24();
                 break;
             }
             case 32:
                 if (!streamer.has_u32())
                     return false;
                 if (context.dib.info.masks.is_empty()) {
-                    context.bitmap->scanline(row)[column++] = streamer.read_u32() | 0xff000000;
+                    context.bitmap->scanline(bitmap_row)[column++] = streamer.read_u32() | 0xff000000;
                 } else {
-                    context.bitmap->scanline(row)[column++] = int_to_scaled_rgb(context, streamer.read_u32());
+                    context.bitmap->scanline(bitmap_row)[column++] = int_to_scaled_rgb(context, streamer.read_u32());
                 }
                 break;
             }
@@ -1276,6 +1295,8 @@ static bool decode_bmp_pixel_data(BMPLoadingContext& context)
             return false;
         streamer.drop_bytes(bytes_to_drop);
 
+        if (downscaler)
+            downscaler->add_row(row, *context.bitmap, 0);
         return true;
     };
 
@@ -1292,8 +1313,8 @@ static bool decode_bmp_pixel_data(BMPLoadingContext& context)
         }
     }
 
-    for (size_t i = 0; i < context.color_table.size(); ++i)
-        context.bitmap->set_palette_color(i, Color::from_rgb(context.color_table[i]));
+    if (downscaler)
+        context.bitmap = downscaler->finish();
 
     context.state = BMPLoadingContext::State::PixelDataDecoded;
 
@@ -1335,6 +1356,11 @@ bool BMPImageDecoderPlugin::set_nonvolatile(bool& was_purged)
     return m_context->bitmap->set_nonvolatile(was_purged);
 }
 
+void BMPImageDecoderPlugin::set_target_size(IntSize target_size)
+{
+    m_context->target_size = target_size;
+}
+
 bool BMPImageDecoderPlugin::sniff()
 {
     return decode_bmp_header(*m_context);
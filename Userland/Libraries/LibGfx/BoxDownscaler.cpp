@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/BoxDownscaler.h>
+
+namespace Gfx {
+
+IntSize BoxDownscaler::scaled_size(IntSize size, int factor)
+{
+    return { ceil_div(size.width(), factor), ceil_div(size.height(), factor) };
+}
+
+ErrorOr<NonnullOwnPtr<BoxDownscaler>> BoxDownscaler::try_create(IntSize source_size, int factor, bool has_alpha)
+{
+    VERIFY(factor >= 1);
+    auto bitmap = TRY(Bitmap::try_create(has_alpha ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, scaled_size(source_size, factor)));
+    auto downscaler = TRY(adopt_nonnull_own_or_enomem(new (nothrow) BoxDownscaler(move(bitmap), source_size, factor)));
+    TRY(downscaler->m_sums.try_resize(downscaler->m_bitmap->width()));
+    return downscaler;
+}
+
+ErrorOr<NonnullRefPtr<Bitmap>> BoxDownscaler::downscale(Bitmap const& bitmap, int factor)
+{
+    auto downscaler = TRY(try_create(bitmap.size(), factor, bitmap.has_alpha_channel()));
+    for (int y = 0; y < bitmap.height(); ++y)
+        downscaler->add_row(y, bitmap, y);
+    return downscaler->finish();
+}
+
+BoxDownscaler::BoxDownscaler(NonnullRefPtr<Bitmap> bitmap, IntSize source_size, int factor)
+    : m_bitmap(move(bitmap))
+    , m_source_size(source_size)
+    , m_factor(factor)
+    , m_has_alpha(m_bitmap->has_alpha_channel())
+{
+}
+
+void BoxDownscaler::add_row(int y, RGBA32 const* pixels)
+{
+    VERIFY(y >= 0 && y < m_source_size.height());
+
+    int scaled_y = y / m_factor;
+    if (scaled_y != m_current_row) {
+        flush_row();
+        m_current_row = scaled_y;
+    }
+
+    // Colors are weighted by their alpha, so that the colors of (nearly) transparent pixels don't bleed into
+    // the opaque ones around them.
+    for (int scaled_x = 0, x = 0; scaled_x < m_bitmap->width(); ++scaled_x) {
+        auto& sums = m_sums[scaled_x];
+        for (int end_x = min(x + m_factor, m_source_size.width()); x < end_x; ++x) {
+            auto color = Color::from_rgba(pixels[x]);
+            u32 alpha = m_has_alpha ? color.alpha() : 255;
+            sums.red += color.red() * alpha;
+            sums.green += color.green() * alpha;
+            sums.blue += color.blue() * alpha;
+            sums.alpha += alpha;
+        }
+    }
+    ++m_rows_in_current_row;
+}
+
+void BoxDownscaler::add_row(int y, Bitmap const& bitmap, int bitmap_row)
+{
+    VERIFY(bitmap.width() == m_source_size.width());
+
+    if (!bitmap.is_indexed()) {
+        add_row(y, bitmap.scanline(bitmap_row));
+        return;
+    }
+
+    m_row_buffer.resize(bitmap.width());
+    for (int x = 0; x < bitmap.width(); ++x)
+        m_row_buffer[x] = bitmap.get_pixel(x, bitmap_row).value();
+    add_row(y, m_row_buffer.data());
+}
+
+void BoxDownscaler::flush_row()
+{
+    if (m_current_row < 0)
+        return;
+
+    auto* scanline = m_bitmap->scanline(m_current_row);
+    for (int scaled_x = 0; scaled_x < m_bitmap->width(); ++scaled_x) {
+        auto& sums = m_sums[scaled_x];
+        u64 pixel_count = m_rows_in_current_row * min(m_factor, m_source_size.width() - scaled_x * m_factor);
+        if (sums.alpha == 0) {
+            scanline[scaled_x] = 0;
+        } else {
+            auto average = [&](u64 sum) { return static_cast<u8>((sum + sums.alpha / 2) / sums.alpha); };
+            auto alpha = static_cast<u8>((sums.alpha + pixel_count / 2) / pixel_count);
+            scanline[scaled_x] = Color(average(sums.red), average(sums.green), average(sums.blue), alpha).value();
+        }
+        sums = {};
+    }
+    m_rows_in_current_row = 0;
+}
+
+NonnullRefPtr<Bitmap> BoxDownscaler::finish()
+{
+    flush_row();
+    m_current_row = -1;
+    return m_bitmap;
+}
+
+}
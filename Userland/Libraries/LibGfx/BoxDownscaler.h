@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+
+namespace Gfx {
+
+// Scales an image down by an integer factor, averaging every factor x factor block of pixels into one.
+// The image is fed in row by row while it is being decoded, so it never has to exist at full size.
+class BoxDownscaler {
+public:
+    static IntSize scaled_size(IntSize, int factor);
+
+    static ErrorOr<NonnullOwnPtr<BoxDownscaler>> try_create(IntSize source_size, int factor, bool has_alpha);
+    static ErrorOr<NonnullRefPtr<Bitmap>> downscale(Bitmap const&, int factor);
+
+    // Rows have to be added in order, but that order may be either top-down or bottom-up.
+    void add_row(int y, RGBA32 const* pixels);
+    void add_row(int y, Bitmap const& bitmap, int bitmap_row);
+
+    // Returns the scaled image after all rows have been added.
+    NonnullRefPtr<Bitmap> finish();
+
+private:
+    BoxDownscaler(NonnullRefPtr<Bitmap>, IntSize source_size, int factor);
+
+    void flush_row();
+
+    struct Sums {
+        u64 red { 0 };
+        u64 green { 0 };
+        u64 blue { 0 };
+        u64 alpha { 0 };
+    };
+
+    NonnullRefPtr<Bitmap> m_bitmap;
+    IntSize m_source_size;
+    int m_factor { 1 };
+    bool m_has_alpha { false };
+
+    Vector<Sums> m_sums;
+    Vector<RGBA32> m_row_buffer;
+    int m_current_row { -1 };
+    int m_rows_in_current_row { 0 };
+};
+
+}
@@ -10,6 +10,7 @@
 #include <AK/Memory.h>
 #include <AK/MemoryStream.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <LibGfx/BoxDownscaler.h>
 #include <LibGfx/GIFLoader.h>
 #include <string.h>
 
@@ -78,6 +79,7 @@ struct GIFLoadingContext {
     RefPtr<Gfx::Bitmap> frame_buffer;
     size_t current_frame { 0 };
     RefPtr<Gfx::Bitmap> prev_frame_buffer;
+    IntSize target_size;
 };
 
 enum class GIFFormat {
@@ -637,6 +639,11 @@ bool GIFImageDecoderPlugin::set_nonvolatile(bool& was_purged)
     return m_context->frame_buffer->set_nonvolatile(was_purged);
 }
 
+void GIFImageDecoderPlugin::set_target_size(IntSize target_size)
+{
+    m_context->target_size = target_size;
+}
+
 bool GIFImageDecoderPlugin::sniff()
 {
     InputMemoryStream stream { { m_context->data, m_context->data_size } };
@@ -712,8 +719,14 @@ ErrorOr<ImageFrameDescriptor> GIFImageDecoderPlugin::frame(size_t index)
         m_context->error_state = GIFLoadingContext::ErrorState::FailedToDecodeAllFrames;
     }
 
+    // Frames are drawn on top of each other, so the frame buffer has to stay at full size. Every frame
+    // is scaled down when it is copied out of it instead.
     ImageFrameDescriptor frame {};
-    frame.image = TRY(m_context->frame_buffer->clone());
+    auto reduction_factor = reduction_factor_for_target_size(m_context->frame_buffer->size(), m_context->target_size);
+    if (reduction_factor > 1)
+        frame.image = TRY(BoxDownscaler::downscale(*m_context->frame_buffer, reduction_factor));
+    else
+        frame.image = TRY(m_context->frame_buffer->clone());
     frame.duration = m_context->images.at(index).duration * 10;
 
     if (frame.duration <= 10) {
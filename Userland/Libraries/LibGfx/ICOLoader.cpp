@@ -87,6 +87,8 @@ struct ICOLoadingContext {
     size_t data_size { 0 };
     Vector<ICOImageDescriptor> images;
     size_t largest_index;
+    size_t decoded_index;
+    IntSize target_size;
 };
 
 static Optional<size_t> decode_ico_header(InputMemoryStream& stream)
@@ -132,6 +134,26 @@ static size_t find_largest_image(const ICOLoadingContext& context)
     return largest_index;
 }
 
+// Icons usually come in several sizes, so there is no need to decode a bigger one than the target size.
+static size_t find_image_for_target_size(const ICOLoadingContext& context)
+{
+    if (context.target_size.is_empty())
+        return context.largest_index;
+
+    size_t min_area = NumericLimits<size_t>::max();
+    size_t best_index = context.largest_index;
+    size_t index = 0;
+    for (const auto& desc : context.images) {
+        bool covers_target_size = desc.width >= context.target_size.width() && desc.height >= context.target_size.height();
+        if (covers_target_size && static_cast<size_t>(desc.width * desc.height) < min_area) {
+            min_area = desc.width * desc.height;
+            best_index = index;
+        }
+        ++index;
+    }
+    return best_index;
+}
+
 static bool load_ico_directory(ICOLoadingContext& context)
 {
     InputMemoryStream stream { { context.data, context.data_size } };
@@ -262,6 +284,7 @@ static bool load_ico_bitmap(ICOLoadingContext& context, Optional<size_t> index)
     ICOImageDescriptor& desc = context.images[real_index];
 
     PNGImageDecoderPlugin png_decoder(context.data + desc.offset, desc.size);
+    png_decoder.set_target_size(context.target_size);
     if (png_decoder.sniff()) {
         auto decoded_png_frame = png_decoder.frame(0);
         if (decoded_png_frame.is_error() || !decoded_png_frame.value().image) {
@@ -318,6 +341,11 @@ bool ICOImageDecoderPlugin::set_nonvolatile(bool& was_purged)
     return m_context->images[0].bitmap->set_nonvolatile(was_purged);
 }
 
+void ICOImageDecoderPlugin::set_target_size(IntSize target_size)
+{
+    m_context->target_size = target_size;
+}
+
 bool ICOImageDecoderPlugin::sniff()
 {
     InputMemoryStream stream { { m_context->data, m_context->data_size } };
@@ -349,7 +377,8 @@ ErrorOr<ImageFrameDescriptor> ICOImageDecoderPlugin::frame(size_t index)
 
     if (m_context->state < ICOLoadingContext::State::BitmapDecoded) {
         // NOTE: This forces the chunk decoding to happen.
-        bool success = load_ico_bitmap(*m_context, {});
+        m_context->decoded_index = find_image_for_target_size(*m_context);
+        bool success = load_ico_bitmap(*m_context, m_context->decoded_index);
         if (!success) {
             m_context->state = ICOLoadingContext::State::Error;
             return Error::from_string_literal("ICOImageDecoderPlugin: Decoding failed"sv);
@@ -357,8 +386,8 @@ ErrorOr<ImageFrameDescriptor> ICOImageDecoderPlugin::frame(size_t index)
         m_context->state = ICOLoadingContext::State::BitmapDecoded;
     }
 
-    VERIFY(m_context->images[m_context->largest_index].bitmap);
-    return ImageFrameDescriptor { m_context->images[m_context->largest_index].bitmap, 0 };
+    VERIFY(m_context->images[m_context->decoded_index].bitmap);
+    return ImageFrameDescriptor { m_context->images[m_context->decoded_index].bitmap, 0 };
 }
 
 }
@@ -18,6 +18,13 @@
 
 namespace Gfx {
 
+int reduction_factor_for_target_size(IntSize image_size, IntSize target_size)
+{
+    if (target_size.width() <= 0 || target_size.height() <= 0)
+        return 1;
+    return max(1, max(image_size.width() / target_size.width(), image_size.height() / target_size.height()));
+}
+
 RefPtr<ImageDecoder> ImageDecoder::try_create(ReadonlyBytes bytes)
 {
     auto* data = bytes.data();
@@ -20,6 +20,10 @@ class Bitmap;
 static constexpr size_t maximum_width_for_decoded_images = 16384;
 static constexpr size_t maximum_height_for_decoded_images = 16384;
 
+// The largest integer factor by which an image can be scaled down before it becomes smaller than its size
+// when displayed scaled down to fit into the target size. This is 1 for an empty target size.
+int reduction_factor_for_target_size(IntSize image_size, IntSize target_size);
+
 struct ImageFrameDescriptor {
     RefPtr<Bitmap> image;
     int duration { 0 };
@@ -34,6 +38,15 @@ public:
     virtual void set_volatile() = 0;
     [[nodiscard]] virtual bool set_nonvolatile(bool& was_purged) = 0;
 
+    // Decoders that can split up the work of decoding an image may use up to this many threads.
+    // This is opt-in, as the calling process has to be allowed to create threads.
+    virtual void set_decoding_thread_count(size_t) { }
+
+    // Lets the decoder know that the image is going to be displayed scaled down to fit into the target size.
+    // Decoders that can cheaply decode a smaller image may then return frames that are smaller than size(),
+    // but never smaller than what the image is displayed at. This has to be called before decoding any frame.
+    virtual void set_target_size(IntSize) { }
+
     virtual bool sniff() = 0;
 
     virtual bool is_animated() = 0;
@@ -55,6 +68,8 @@ public:
     int height() const { return size().height(); }
     void set_volatile() { m_plugin->set_volatile(); }
     [[nodiscard]] bool set_nonvolatile(bool& was_purged) { return m_plugin->set_nonvolatile(was_purged); }
+    void set_decoding_thread_count(size_t thread_count) { m_plugin->set_decoding_thread_count(thread_count); }
+    void set_target_size(IntSize target_size) { m_plugin->set_target_size(target_size); }
     bool sniff() const { return m_plugin->sniff(); }
     bool is_animated() const { return m_plugin->is_animated(); }
     size_t loop_count() const { return m_plugin->loop_count(); }
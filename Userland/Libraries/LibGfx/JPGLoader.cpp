@@ -4,12 +4,14 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
-#include <AK/Math.h>
 #include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
 #include <AK/Vector.h>
 #include <LibGfx/JPGLoader.h>
+#include <LibThreading/Thread.h>
 
 #define JPG_INVALID 0X0000
 
@@ -158,9 +160,10 @@ struct HuffmanTableSpec {
 };
 
 struct HuffmanStreamState {
-    Vector<u8> stream;
+    ReadonlyBytes stream;
     u8 bit_offset { 0 };
     size_t byte_offset { 0 };
+    i32 previous_dc_values[3] = { 0 };
 };
 
 struct JPGLoadingContext {
@@ -185,9 +188,20 @@ struct JPGLoadingContext {
     u16 dc_reset_interval { 0 };
     HashMap<u8, HuffmanTableSpec> dc_tables;
     HashMap<u8, HuffmanTableSpec> ac_tables;
-    HuffmanStreamState huffman_stream;
-    i32 previous_dc_values[3] = { 0 };
     MacroblockMeta mblock_meta;
+
+    // The entropy-coded data of the scan, without stuffed bytes and restart markers. Every restart interval
+    // begins on a byte boundary, at its offset in restart_offsets.
+    Vector<u8> huffman_stream;
+    Vector<size_t> restart_offsets;
+
+    size_t thread_count { 1 };
+
+    // When the image is only going to be shown at a fraction of its size, the IDCT produces blocks of
+    // luma_block_size x luma_block_size samples instead of 8x8, which scales the image down by a power of two.
+    IntSize target_size;
+    u8 luma_block_size { 8 };
+    u8 chroma_block_size { 8 };
 };
 
 static void generate_huffman_codes(HuffmanTableSpec& table)
@@ -257,21 +271,22 @@ static inline i32* get_component(Macroblock& block, unsigned component)
 }
 
 /**
- * Build the macroblocks possible by reading single (MCU) subsampled pair of CbCr.
+ * Build the macroblocks of a single MCU, i.e. a single (subsampled) pair of CbCr.
  * Depending on the sampling factors, we may not see triples of y, cb, cr in that
  * order. If sample factors differ from one, we'll read more than one block of y-
  * coefficients before we get to read a cb-cr block.
 
- * In the function below, `hcursor` and `vcursor` denote the location of the block
- * we're building in the macroblock matrix. `vfactor_i` and `hfactor_i` are cursors
- * that iterate over the vertical and horizontal subsampling factors, respectively.
- * When we finish one iteration of the innermost loop, we'll have the coefficients
- * of one of the components of block at position `mb_index`. When the outermost loop
- * finishes first iteration, we'll have all the luminance coefficients for all the
- * macroblocks that share the chrominance data. Next two iterations (assuming that
- * we are dealing with three components) will fill up the blocks with chroma data.
+ * In the function below, `vfactor_i` and `hfactor_i` are cursors that iterate over
+ * the vertical and horizontal subsampling factors, respectively, and `macroblocks`
+ * holds the hsample_factor * vsample_factor macroblocks of the MCU in row-major
+ * order. When we finish one iteration of the innermost loop, we'll have the
+ * coefficients of one of the components of block at position `mb_index`. When the
+ * outermost loop finishes first iteration, we'll have all the luminance coefficients
+ * for all the macroblocks that share the chrominance data. Next two iterations
+ * (assuming that we are dealing with three components) will fill up the first block
+ * with chroma data.
  */
-static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
+static bool build_macroblocks(JPGLoadingContext const& context, HuffmanStreamState& hstream, Macroblock* macroblocks)
 {
     for (unsigned component_i = 0; component_i < context.component_count; component_i++) {
         auto& component = context.components[component_i];
@@ -283,13 +298,13 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
 
         for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
             for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
+                u32 mb_index = vfactor_i * context.hsample_factor + hfactor_i;
                 Macroblock& block = macroblocks[mb_index];
 
                 auto& dc_table = context.dc_tables.find(component.dc_destination_id)->value;
                 auto& ac_table = context.ac_tables.find(component.ac_destination_id)->value;
 
-                auto symbol_or_error = get_next_symbol(context.huffman_stream, dc_table);
+                auto symbol_or_error = get_next_symbol(hstream, dc_table);
                 if (!symbol_or_error.has_value())
                     return false;
 
@@ -300,7 +315,7 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
                     return false;
                 }
 
-                auto coeff_or_error = read_huffman_bits(context.huffman_stream, dc_length);
+                auto coeff_or_error = read_huffman_bits(hstream, dc_length);
                 if (!coeff_or_error.has_value())
                     return false;
 
@@ -311,13 +326,16 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
                 if (dc_length != 0 && dc_diff < (1 << (dc_length - 1)))
                     dc_diff -= (1 << dc_length) - 1;
 
+                // The macroblocks are reused for every MCU, so clear out the coefficients of the previous one.
                 auto select_component = get_component(block, component_i);
-                auto& previous_dc = context.previous_dc_values[component_i];
+                __builtin_memset(select_component, 0, 64 * sizeof(i32));
+
+                auto& previous_dc = hstream.previous_dc_values[component_i];
                 select_component[0] = previous_dc += dc_diff;
 
                 // Compute the AC coefficients.
                 for (int j = 1; j < 64;) {
-                    symbol_or_error = get_next_symbol(context.huffman_stream, ac_table);
+                    symbol_or_error = get_next_symbol(hstream, ac_table);
                     if (!symbol_or_error.has_value())
                         return false;
 
@@ -344,7 +362,7 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
                     }
 
                     if (coeff_length != 0) {
-                        coeff_or_error = read_huffman_bits(context.huffman_stream, coeff_length);
+                        coeff_or_error = read_huffman_bits(hstream, coeff_length);
                         if (!coeff_or_error.has_value())
                             return false;
                         i32 ac_coefficient = coeff_or_error.release_value();
@@ -361,61 +379,35 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
     return true;
 }
 
-static Optional<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& context)
+static inline u32 mcus_per_row(JPGLoadingContext const& context)
 {
-    Vector<Macroblock> macroblocks;
-    macroblocks.resize(context.mblock_meta.padded_total);
-
-    if constexpr (JPG_DEBUG) {
-        dbgln("Image width: {}", context.frame.width);
-        dbgln("Image height: {}", context.frame.height);
-        dbgln("Macroblocks in a row: {}", context.mblock_meta.hpadded_count);
-        dbgln("Macroblocks in a column: {}", context.mblock_meta.vpadded_count);
-        dbgln("Macroblock meta padded total: {}", context.mblock_meta.padded_total);
-    }
-
-    // Compute huffman codes for DC and AC tables.
-    for (auto it = context.dc_tables.begin(); it != context.dc_tables.end(); ++it)
-        generate_huffman_codes(it->value);
+    return context.mblock_meta.hpadded_count / context.hsample_factor;
+}
 
-    for (auto it = context.ac_tables.begin(); it != context.ac_tables.end(); ++it)
-        generate_huffman_codes(it->value);
+static inline u32 mcu_row_count(JPGLoadingContext const& context)
+{
+    return context.mblock_meta.vpadded_count / context.vsample_factor;
+}
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            if (context.dc_reset_interval > 0) {
-                if (i % context.dc_reset_interval == 0) {
-                    context.previous_dc_values[0] = 0;
-                    context.previous_dc_values[1] = 0;
-                    context.previous_dc_values[2] = 0;
-
-                    // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
-                    //  the 0th bit of the next byte.
-                    if (context.huffman_stream.byte_offset < context.huffman_stream.stream.size()) {
-                        if (context.huffman_stream.bit_offset > 0) {
-                            context.huffman_stream.bit_offset = 0;
-                            context.huffman_stream.byte_offset++;
-                        }
-
-                        // Skip the restart marker (RSTn).
-                        context.huffman_stream.byte_offset++;
-                    }
-                }
-            }
+// If restart markers are in use, every restart interval starts with fresh DC predictions, on a byte
+// boundary of its own. This moves the huffman stream cursor there when `mcu_index` begins an interval.
+static bool start_mcu(JPGLoadingContext const& context, HuffmanStreamState& hstream, u32 mcu_index)
+{
+    if (context.dc_reset_interval == 0 || mcu_index % context.dc_reset_interval != 0)
+        return true;
 
-            if (!build_macroblocks(context, macroblocks, hcursor, vcursor)) {
-                if constexpr (JPG_DEBUG) {
-                    dbgln("Failed to build Macroblock {}", i);
-                    dbgln("Huffman stream byte offset {}", context.huffman_stream.byte_offset);
-                    dbgln("Huffman stream bit offset {}", context.huffman_stream.bit_offset);
-                }
-                return {};
-            }
-        }
+    auto interval_index = mcu_index / context.dc_reset_interval;
+    if (interval_index >= context.restart_offsets.size()) {
+        dbgln_if(JPG_DEBUG, "Restart interval {} is missing from the huffman stream!", interval_index);
+        return false;
     }
 
-    return macroblocks;
+    hstream.byte_offset = context.restart_offsets[interval_index];
+    hstream.bit_offset = 0;
+    hstream.previous_dc_values[0] = 0;
+    hstream.previous_dc_values[1] = 0;
+    hstream.previous_dc_values[2] = 0;
+    return true;
 }
 
 static inline bool bounds_okay(const size_t cursor, const size_t delta, const size_t bound)
@@ -835,252 +827,456 @@ static bool skip_marker_with_length(InputMemoryStream& stream)
     return !stream.handle_any_error();
 }
 
-static void dequantize(JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+// The integer IDCT below is the "islow" algorithm of the IJG reference decoder, which is exact enough
+// to be used for any quality setting. Its constants are fixed-point numbers with 13 fractional bits,
+// and the intermediate results between the two passes keep 2 extra bits of precision.
+static constexpr int idct_constant_bits = 13;
+static constexpr int idct_pass1_bits = 2;
+
+static constexpr i32 fix_0_298631336 = 2446;
+static constexpr i32 fix_0_390180644 = 3196;
+static constexpr i32 fix_0_541196100 = 4433;
+static constexpr i32 fix_0_765366865 = 6270;
+static constexpr i32 fix_0_899976223 = 7373;
+static constexpr i32 fix_1_175875602 = 9633;
+static constexpr i32 fix_1_501321110 = 12299;
+static constexpr i32 fix_1_847759065 = 15137;
+static constexpr i32 fix_1_961570560 = 16069;
+static constexpr i32 fix_2_053119869 = 16819;
+static constexpr i32 fix_2_562915447 = 20995;
+static constexpr i32 fix_3_072711026 = 25172;
+
+// One-dimensional IDCT of four columns at once. `descale_bits` drops the extra precision of the result,
+// and `bias` is added to it before that, which rounds the result and applies any level shift.
+static ALWAYS_INLINE void inverse_dct_1d(AK::SIMD::i32x4 (&v)[8], int descale_bits, i32 bias)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u32 i = 0; i < context.component_count; i++) {
-                auto& component = context.components[i];
-                const u32* table = component.qtable_id == 0 ? context.luma_table : context.chroma_table;
-                for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[mb_index];
-                        int* block_component = get_component(block, i);
-                        for (u32 k = 0; k < 64; k++)
-                            block_component[k] *= table[k];
-                    }
-                }
-            }
+    using AK::SIMD::i32x4;
+
+    // Even part.
+    i32x4 z1 = (v[2] + v[6]) * fix_0_541196100;
+    i32x4 tmp2 = z1 + v[6] * -fix_1_847759065;
+    i32x4 tmp3 = z1 + v[2] * fix_0_765366865;
+
+    i32x4 tmp0 = (v[0] + v[4]) << idct_constant_bits;
+    i32x4 tmp1 = (v[0] - v[4]) << idct_constant_bits;
+
+    i32x4 tmp10 = tmp0 + tmp3;
+    i32x4 tmp13 = tmp0 - tmp3;
+    i32x4 tmp11 = tmp1 + tmp2;
+    i32x4 tmp12 = tmp1 - tmp2;
+
+    // Odd part.
+    tmp0 = v[7];
+    tmp1 = v[5];
+    tmp2 = v[3];
+    tmp3 = v[1];
+
+    z1 = tmp0 + tmp3;
+    i32x4 z2 = tmp1 + tmp2;
+    i32x4 z3 = tmp0 + tmp2;
+    i32x4 z4 = tmp1 + tmp3;
+    i32x4 z5 = (z3 + z4) * fix_1_175875602;
+
+    tmp0 *= fix_0_298631336;
+    tmp1 *= fix_2_053119869;
+    tmp2 *= fix_3_072711026;
+    tmp3 *= fix_1_501321110;
+    z1 *= -fix_0_899976223;
+    z2 *= -fix_2_562915447;
+    z3 = z3 * -fix_1_961570560 + z5;
+    z4 = z4 * -fix_0_390180644 + z5;
+
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    tmp10 += bias;
+    tmp11 += bias;
+    tmp12 += bias;
+    tmp13 += bias;
+
+    v[0] = (tmp10 + tmp3) >> descale_bits;
+    v[7] = (tmp10 - tmp3) >> descale_bits;
+    v[1] = (tmp11 + tmp2) >> descale_bits;
+    v[6] = (tmp11 - tmp2) >> descale_bits;
+    v[2] = (tmp12 + tmp1) >> descale_bits;
+    v[5] = (tmp12 - tmp1) >> descale_bits;
+    v[3] = (tmp13 + tmp0) >> descale_bits;
+    v[4] = (tmp13 - tmp0) >> descale_bits;
+}
+
+// The block is held as the left and right halves of its 8 rows.
+static ALWAYS_INLINE void transpose_block(AK::SIMD::i32x4 (&block)[2][8])
+{
+    AK::SIMD::i32x4 transposed[2][8];
+    for (int half = 0; half < 2; ++half) {
+        for (int row = 0; row < 8; ++row) {
+            auto const* column = block[row / 4];
+            auto lane = row % 4;
+            transposed[half][row] = AK::SIMD::i32x4 { column[half * 4][lane], column[half * 4 + 1][lane], column[half * 4 + 2][lane], column[half * 4 + 3][lane] };
         }
     }
+    __builtin_memcpy(block, transposed, sizeof(block));
 }
 
-static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+// Turns the coefficients of a block into 8x8 samples in the range 0 to 255, in place.
+static void inverse_dct_8x8(i32* block_component, u32 const* quantization_table)
 {
-    static const float m0 = 2.0 * AK::cos(1.0 / 16.0 * 2.0 * AK::Pi<double>);
-    static const float m1 = 2.0 * AK::cos(2.0 / 16.0 * 2.0 * AK::Pi<double>);
-    static const float m3 = 2.0 * AK::cos(2.0 / 16.0 * 2.0 * AK::Pi<double>);
-    static const float m5 = 2.0 * AK::cos(3.0 / 16.0 * 2.0 * AK::Pi<double>);
-    static const float m2 = m0 - m5;
-    static const float m4 = m0 + m5;
-    static const float s0 = AK::cos(0.0 / 16.0 * AK::Pi<double>) / sqrt(8);
-    static const float s1 = AK::cos(1.0 / 16.0 * AK::Pi<double>) / 2.0;
-    static const float s2 = AK::cos(2.0 / 16.0 * AK::Pi<double>) / 2.0;
-    static const float s3 = AK::cos(3.0 / 16.0 * AK::Pi<double>) / 2.0;
-    static const float s4 = AK::cos(4.0 / 16.0 * AK::Pi<double>) / 2.0;
-    static const float s5 = AK::cos(5.0 / 16.0 * AK::Pi<double>) / 2.0;
-    static const float s6 = AK::cos(6.0 / 16.0 * AK::Pi<double>) / 2.0;
-    static const float s7 = AK::cos(7.0 / 16.0 * AK::Pi<double>) / 2.0;
-
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u32 component_i = 0; component_i < context.component_count; component_i++) {
-                auto& component = context.components[component_i];
-                for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[mb_index];
-                        i32* block_component = get_component(block, component_i);
-                        for (u32 k = 0; k < 8; ++k) {
-                            const float g0 = block_component[0 * 8 + k] * s0;
-                            const float g1 = block_component[4 * 8 + k] * s4;
-                            const float g2 = block_component[2 * 8 + k] * s2;
-                            const float g3 = block_component[6 * 8 + k] * s6;
-                            const float g4 = block_component[5 * 8 + k] * s5;
-                            const float g5 = block_component[1 * 8 + k] * s1;
-                            const float g6 = block_component[7 * 8 + k] * s7;
-                            const float g7 = block_component[3 * 8 + k] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            const float g0 = block_component[l * 8 + 0] * s0;
-                            const float g1 = block_component[l * 8 + 4] * s4;
-                            const float g2 = block_component[l * 8 + 2] * s2;
-                            const float g3 = block_component[l * 8 + 6] * s6;
-                            const float g4 = block_component[l * 8 + 5] * s5;
-                            const float g5 = block_component[l * 8 + 1] * s1;
-                            const float g6 = block_component[l * 8 + 7] * s7;
-                            const float g7 = block_component[l * 8 + 3] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
-                        }
-                    }
-                }
+    using AK::SIMD::i32x4;
+
+    i32x4 block[2][8];
+    for (int half = 0; half < 2; ++half) {
+        for (int row = 0; row < 8; ++row) {
+            i32x4 coefficients;
+            i32x4 quantizers;
+            __builtin_memcpy(&coefficients, &block_component[row * 8 + half * 4], sizeof(coefficients));
+            __builtin_memcpy(&quantizers, &quantization_table[row * 8 + half * 4], sizeof(quantizers));
+            block[half][row] = coefficients * quantizers;
+        }
+    }
+
+    // Columns first, keeping some extra precision for the second pass.
+    int const pass1_descale_bits = idct_constant_bits - idct_pass1_bits;
+    inverse_dct_1d(block[0], pass1_descale_bits, 1 << (pass1_descale_bits - 1));
+    inverse_dct_1d(block[1], pass1_descale_bits, 1 << (pass1_descale_bits - 1));
+
+    // Then the rows, which also removes the factor of 8 of the transform and undoes the level shift.
+    transpose_block(block);
+    int const pass2_descale_bits = idct_constant_bits + idct_pass1_bits + 3;
+    i32 const pass2_bias = (1 << (pass2_descale_bits - 1)) + (128 << pass2_descale_bits);
+    inverse_dct_1d(block[0], pass2_descale_bits, pass2_bias);
+    inverse_dct_1d(block[1], pass2_descale_bits, pass2_bias);
+    transpose_block(block);
+
+    for (int half = 0; half < 2; ++half) {
+        for (int row = 0; row < 8; ++row) {
+            i32x4 samples = block[half][row];
+            samples = samples < 0 ? 0 : (samples > 255 ? 255 : samples);
+            __builtin_memcpy(&block_component[row * 8 + half * 4], &samples, sizeof(samples));
+        }
+    }
+}
+
+// The reduced-size IDCTs below are those of the IJG decoder as well. They only look at the low-frequency
+// coefficients that still matter at the smaller size, so they cost a fraction of the full transform.
+static constexpr i32 fix_0_211164243 = 1730;
+static constexpr i32 fix_0_509795579 = 4176;
+static constexpr i32 fix_0_601344887 = 4926;
+static constexpr i32 fix_0_720959822 = 5906;
+static constexpr i32 fix_0_850430095 = 6967;
+static constexpr i32 fix_1_061594337 = 8697;
+static constexpr i32 fix_1_272758580 = 10426;
+static constexpr i32 fix_1_451774981 = 11893;
+static constexpr i32 fix_2_172734803 = 17799;
+static constexpr i32 fix_3_624509785 = 29692;
+
+static ALWAYS_INLINE i32 descale(i32 value, int bits)
+{
+    return (value + (1 << (bits - 1))) >> bits;
+}
+
+static ALWAYS_INLINE i32 clamp_sample(i32 value)
+{
+    return clamp(value + 128, 0, 255);
+}
+
+// Computes the 4 samples of a 1D IDCT from the 8 inputs at `values`, which are `stride` apart. Input 4 has
+// no effect on them.
+static ALWAYS_INLINE void inverse_dct_1d_4(i32 const* values, int stride, i32 (&out)[4])
+{
+    i32 tmp0 = values[0] << (idct_constant_bits + 1);
+    i32 tmp2 = values[2 * stride] * fix_1_847759065 + values[6 * stride] * -fix_0_765366865;
+    i32 tmp10 = tmp0 + tmp2;
+    i32 tmp12 = tmp0 - tmp2;
+
+    i32 z1 = values[7 * stride];
+    i32 z2 = values[5 * stride];
+    i32 z3 = values[3 * stride];
+    i32 z4 = values[1 * stride];
+    tmp0 = z1 * -fix_0_211164243 + z2 * fix_1_451774981 + z3 * -fix_2_172734803 + z4 * fix_1_061594337;
+    tmp2 = z1 * -fix_0_509795579 + z2 * -fix_0_601344887 + z3 * fix_0_899976223 + z4 * fix_2_562915447;
+
+    out[0] = tmp10 + tmp2;
+    out[3] = tmp10 - tmp2;
+    out[1] = tmp12 + tmp0;
+    out[2] = tmp12 - tmp0;
+}
+
+// Turns the coefficients of a block into 4x4 samples in its top left corner.
+static void inverse_dct_4x4(i32* block_component, u32 const* quantization_table)
+{
+    i32 dequantized[64];
+    for (int i = 0; i < 64; ++i)
+        dequantized[i] = block_component[i] * static_cast<i32>(quantization_table[i]);
+
+    // Column 4 doesn't contribute to the 4 samples of a row, so it is skipped.
+    i32 workspace[4 * 8];
+    for (int column = 0; column < 8; ++column) {
+        if (column == 4)
+            continue;
+        i32 samples[4];
+        inverse_dct_1d_4(&dequantized[column], 8, samples);
+        for (int row = 0; row < 4; ++row)
+            workspace[row * 8 + column] = descale(samples[row], idct_constant_bits - idct_pass1_bits + 1);
+    }
+
+    for (int row = 0; row < 4; ++row) {
+        i32 samples[4];
+        inverse_dct_1d_4(&workspace[row * 8], 1, samples);
+        for (int column = 0; column < 4; ++column)
+            block_component[row * 8 + column] = clamp_sample(descale(samples[column], idct_constant_bits + idct_pass1_bits + 3 + 1));
+    }
+}
+
+// Computes the 2 samples of a 1D IDCT from the DC and odd inputs at `values`, which are `stride` apart.
+static ALWAYS_INLINE void inverse_dct_1d_2(i32 const* values, int stride, i32 (&out)[2])
+{
+    i32 tmp10 = values[0] << (idct_constant_bits + 2);
+    i32 tmp0 = values[7 * stride] * -fix_0_720959822 + values[5 * stride] * fix_0_850430095
+        + values[3 * stride] * -fix_1_272758580 + values[1 * stride] * fix_3_624509785;
+
+    out[0] = tmp10 + tmp0;
+    out[1] = tmp10 - tmp0;
+}
+
+// Turns the coefficients of a block into 2x2 samples in its top left corner.
+static void inverse_dct_2x2(i32* block_component, u32 const* quantization_table)
+{
+    i32 dequantized[64];
+    for (int i = 0; i < 64; ++i)
+        dequantized[i] = block_component[i] * static_cast<i32>(quantization_table[i]);
+
+    // Only the DC and odd columns contribute to the 2 samples of a row.
+    i32 workspace[2 * 8];
+    for (int column = 0; column < 8; ++column) {
+        if (column != 0 && column % 2 == 0)
+            continue;
+        i32 samples[2];
+        inverse_dct_1d_2(&dequantized[column], 8, samples);
+        for (int row = 0; row < 2; ++row)
+            workspace[row * 8 + column] = descale(samples[row], idct_constant_bits - idct_pass1_bits + 2);
+    }
+
+    for (int row = 0; row < 2; ++row) {
+        i32 samples[2];
+        inverse_dct_1d_2(&workspace[row * 8], 1, samples);
+        for (int column = 0; column < 2; ++column)
+            block_component[row * 8 + column] = clamp_sample(descale(samples[column], idct_constant_bits + idct_pass1_bits + 3 + 2));
+    }
+}
+
+// Turns the coefficients of a block into block_size x block_size samples in the range 0 to 255, which
+// are stored in its top left corner.
+static void dequantize_and_inverse_dct(i32* block_component, u32 const* quantization_table, u8 block_size)
+{
+    switch (block_size) {
+    case 8:
+        inverse_dct_8x8(block_component, quantization_table);
+        break;
+    case 4:
+        inverse_dct_4x4(block_component, quantization_table);
+        break;
+    case 2:
+        inverse_dct_2x2(block_component, quantization_table);
+        break;
+    case 1:
+        // A single sample is just the average of the block, which is what the DC coefficient holds.
+        block_component[0] = clamp_sample(descale(block_component[0] * static_cast<i32>(quantization_table[0]), 3));
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+// Chroma samples for 4 horizontally adjacent pixels of an MCU, starting at `mcu_column`. The MCU is
+// `mcu_width` pixels wide, while the chroma block covering it is `chroma_block_size` samples wide.
+static ALWAYS_INLINE AK::SIMD::i32x4 load_chroma(i32 const* chroma_row, u32 mcu_column, u32 mcu_width, u32 chroma_block_size)
+{
+    if (mcu_width == chroma_block_size) {
+        AK::SIMD::i32x4 samples;
+        __builtin_memcpy(&samples, &chroma_row[mcu_column], sizeof(samples));
+        return samples;
+    }
+    return AK::SIMD::i32x4 {
+        chroma_row[mcu_column * chroma_block_size / mcu_width],
+        chroma_row[(mcu_column + 1) * chroma_block_size / mcu_width],
+        chroma_row[(mcu_column + 2) * chroma_block_size / mcu_width],
+        chroma_row[(mcu_column + 3) * chroma_block_size / mcu_width],
+    };
+}
+
+// Fixed-point versions of the JFIF conversion factors, with 16 fractional bits.
+static constexpr i32 cr_to_r_factor = 91881;
+static constexpr i32 cb_to_g_factor = 22554;
+static constexpr i32 cr_to_g_factor = 46802;
+static constexpr i32 cb_to_b_factor = 116130;
+
+static ALWAYS_INLINE AK::SIMD::i32x4 ycbcr_to_rgb(AK::SIMD::i32x4 y, AK::SIMD::i32x4 cb, AK::SIMD::i32x4 cr)
+{
+    using AK::SIMD::i32x4;
+
+    cb -= 128;
+    cr -= 128;
+    i32 const one_half = 1 << 15;
+    i32x4 r = y + ((cr * cr_to_r_factor + one_half) >> 16);
+    i32x4 g = y + ((cb * -cb_to_g_factor - cr * cr_to_g_factor + one_half) >> 16);
+    i32x4 b = y + ((cb * cb_to_b_factor + one_half) >> 16);
+    r = r < 0 ? 0 : (r > 255 ? 255 : r);
+    g = g < 0 ? 0 : (g > 255 ? 255 : g);
+    b = b < 0 ? 0 : (b > 255 ? 255 : b);
+    return (r << 16) | (g << 8) | b | (i32)0xff000000;
+}
+
+// Writes the pixels of one luma block of an MCU to the bitmap, whose top left corner is at (x, y).
+// The chroma samples of the whole MCU are held by its first macroblock.
+static void compose_block(JPGLoadingContext const& context, Macroblock const& block, Macroblock const& chroma, u8 vfactor_i, u8 hfactor_i, Bitmap& bitmap, u32 x, u32 y)
+{
+    using AK::SIMD::i32x4;
+
+    u32 block_size = context.luma_block_size;
+    u32 mcu_width = block_size * context.hsample_factor;
+    u32 mcu_height = block_size * context.vsample_factor;
+    auto pixel_count = min(block_size, bitmap.width() - x);
+    auto row_count = min(block_size, bitmap.height() - y);
+    for (u32 i = 0; i < row_count; ++i) {
+        i32x4 pixels[2];
+        for (u32 half = 0; half * 4 < block_size; ++half) {
+            i32x4 luma;
+            __builtin_memcpy(&luma, &block.y[i * 8 + half * 4], sizeof(luma));
+            if (context.component_count == 1) {
+                pixels[half] = (luma << 16) | (luma << 8) | luma | (i32)0xff000000;
+                continue;
             }
+
+            auto chroma_pxrow = (vfactor_i * block_size + i) * context.chroma_block_size / mcu_height;
+            auto mcu_column = hfactor_i * block_size + half * 4;
+            auto cb = load_chroma(&chroma.cb[chroma_pxrow * 8], mcu_column, mcu_width, context.chroma_block_size);
+            auto cr = load_chroma(&chroma.cr[chroma_pxrow * 8], mcu_column, mcu_width, context.chroma_block_size);
+            pixels[half] = ycbcr_to_rgb(luma, cb, cr);
         }
+        __builtin_memcpy(&bitmap.scanline(y + i)[x], pixels, pixel_count * sizeof(RGBA32));
     }
 }
 
-static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+static void compose_mcu(JPGLoadingContext const& context, Macroblock* macroblocks, u32 mcu_index, Bitmap& bitmap)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            const Macroblock& chroma = macroblocks[chroma_block_index];
-            // Overflows are intentional.
-            for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
-                for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    i32* y = macroblocks[mb_index].y;
-                    i32* cb = macroblocks[mb_index].cb;
-                    i32* cr = macroblocks[mb_index].cr;
-                    for (u8 i = 7; i < 8; --i) {
-                        for (u8 j = 7; j < 8; --j) {
-                            const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
-                            const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
-                            const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
-                            int r = y[pixel] + 1.402f * chroma.cr[chroma_pixel] + 128;
-                            int g = y[pixel] - 0.344f * chroma.cb[chroma_pixel] - 0.714f * chroma.cr[chroma_pixel] + 128;
-                            int b = y[pixel] + 1.772f * chroma.cb[chroma_pixel] + 128;
-                            y[pixel] = r < 0 ? 0 : (r > 255 ? 255 : r);
-                            cb[pixel] = g < 0 ? 0 : (g > 255 ? 255 : g);
-                            cr[pixel] = b < 0 ? 0 : (b > 255 ? 255 : b);
-                        }
-                    }
-                }
+    for (u32 i = 0; i < context.component_count; i++) {
+        auto& component = context.components[i];
+        const u32* table = component.qtable_id == 0 ? context.luma_table : context.chroma_table;
+        auto block_size = i == 0 ? context.luma_block_size : context.chroma_block_size;
+        for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+            for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                Macroblock& block = macroblocks[vfactor_i * context.hsample_factor + hfactor_i];
+                dequantize_and_inverse_dct(get_component(block, i), table, block_size);
             }
         }
     }
+
+    u32 mcu_x = (mcu_index % mcus_per_row(context)) * context.hsample_factor * context.luma_block_size;
+    u32 mcu_y = (mcu_index / mcus_per_row(context)) * context.vsample_factor * context.luma_block_size;
+    for (u8 vfactor_i = 0; vfactor_i < context.vsample_factor; vfactor_i++) {
+        for (u8 hfactor_i = 0; hfactor_i < context.hsample_factor; hfactor_i++) {
+            u32 x = mcu_x + hfactor_i * context.luma_block_size;
+            u32 y = mcu_y + vfactor_i * context.luma_block_size;
+            if (x >= static_cast<u32>(bitmap.width()) || y >= static_cast<u32>(bitmap.height()))
+                continue;
+            auto& block = macroblocks[vfactor_i * context.hsample_factor + hfactor_i];
+            compose_block(context, block, macroblocks[0], vfactor_i, hfactor_i, bitmap, x, y);
+        }
+    }
 }
 
-static bool compose_bitmap(JPGLoadingContext& context, const Vector<Macroblock>& macroblocks)
+// Decodes the MCUs [first_mcu, end_mcu) straight into the bitmap. Decoding can only start at the beginning
+// of a restart interval, so `first_mcu` has to be the first MCU of one. Only a single MCU worth of
+// coefficients is held at a time, no matter how large the image is.
+static bool decode_mcus(JPGLoadingContext const& context, u32 first_mcu, u32 end_mcu, Bitmap& bitmap)
 {
-    auto bitmap_or_error = Bitmap::try_create(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height });
-    if (bitmap_or_error.is_error())
-        return false;
-    context.bitmap = bitmap_or_error.release_value_but_fixme_should_propagate_errors();
-    if (bitmap_or_error.is_error())
-        return false;
+    VERIFY(first_mcu == 0 || (context.dc_reset_interval > 0 && first_mcu % context.dc_reset_interval == 0));
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        const u32 block_row = y / 8;
-        const u32 pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            const u32 block_column = x / 8;
-            auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            const u32 pixel_column = x % 8;
-            const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+    HuffmanStreamState hstream { context.huffman_stream.span() };
+    Macroblock macroblocks[4];
+    for (u32 mcu_index = first_mcu; mcu_index < end_mcu; ++mcu_index) {
+        if (!start_mcu(context, hstream, mcu_index))
+            return false;
+
+        if (!build_macroblocks(context, hstream, macroblocks)) {
+            if constexpr (JPG_DEBUG) {
+                dbgln("Failed to build MCU {}", mcu_index);
+                dbgln("Huffman stream byte offset {}", hstream.byte_offset);
+                dbgln("Huffman stream bit offset {}", hstream.bit_offset);
+            }
+            return false;
         }
+
+        compose_mcu(context, macroblocks, mcu_index, bitmap);
     }
 
     return true;
 }
 
+static bool decode_huffman_stream(JPGLoadingContext& context, Bitmap& bitmap)
+{
+    if constexpr (JPG_DEBUG) {
+        dbgln("Image width: {}", context.frame.width);
+        dbgln("Image height: {}", context.frame.height);
+        dbgln("Macroblocks in a row: {}", context.mblock_meta.hpadded_count);
+        dbgln("Macroblocks in a column: {}", context.mblock_meta.vpadded_count);
+        dbgln("Macroblock meta padded total: {}", context.mblock_meta.padded_total);
+        dbgln("Restart intervals: {}", context.restart_offsets.size());
+    }
+
+    // Compute huffman codes for DC and AC tables.
+    for (auto it = context.dc_tables.begin(); it != context.dc_tables.end(); ++it)
+        generate_huffman_codes(it->value);
+
+    for (auto it = context.ac_tables.begin(); it != context.ac_tables.end(); ++it)
+        generate_huffman_codes(it->value);
+
+    // Restart intervals can be decoded independently of each other, so images that have them are
+    // decoded by several threads at once. Otherwise, there's no telling where an MCU starts without
+    // decoding all of the ones before it.
+    u32 mcu_count = mcu_row_count(context) * mcus_per_row(context);
+    u32 interval_count = context.dc_reset_interval > 0 ? ceil_div(mcu_count, static_cast<u32>(context.dc_reset_interval)) : 1;
+    size_t thread_count = 1;
+    if (context.dc_reset_interval > 0 && context.restart_offsets.size() > 1)
+        thread_count = min(context.thread_count, static_cast<size_t>(interval_count));
+    if (thread_count <= 1)
+        return decode_mcus(context, 0, mcu_count, bitmap);
+
+    // Every thread takes a few whole restart intervals at a time, which keeps them all busy until the end.
+    u32 intervals_per_slice = max(1u, interval_count / static_cast<u32>(thread_count * 4));
+    u32 mcus_per_slice = intervals_per_slice * context.dc_reset_interval;
+    u32 slice_count = ceil_div(interval_count, intervals_per_slice);
+    Atomic<u32> next_slice { 0 };
+    Atomic<bool> failed { false };
+
+    auto decode_slices = [&]() -> intptr_t {
+        for (;;) {
+            auto slice_index = next_slice.fetch_add(1);
+            if (slice_index >= slice_count || failed.load())
+                return 0;
+
+            auto first_mcu = slice_index * mcus_per_slice;
+            if (!decode_mcus(context, first_mcu, min(first_mcu + mcus_per_slice, mcu_count), bitmap))
+                failed.store(true);
+        }
+    };
+
+    // The calling thread does its share of the work too.
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 1; i < thread_count; i++) {
+        auto thread = Threading::Thread::construct([&] { return decode_slices(); }, "JPGDecoder"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+    decode_slices();
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    return !failed.load();
+}
+
 static bool parse_header(InputMemoryStream& stream, JPGLoadingContext& context)
 {
     auto marker = read_marker_at_cursor(stream);
@@ -1171,14 +1367,14 @@ static bool scan_huffman_stream(InputMemoryStream& stream, JPGLoadingContext& co
                 stream >> current_byte;
                 if (stream.handle_any_error())
                     return false;
-                context.huffman_stream.stream.append(last_byte);
+                context.huffman_stream.append(last_byte);
                 continue;
             }
             Marker marker = 0xFF00 | current_byte;
             if (marker == JPG_EOI)
                 return true;
             if (marker >= JPG_RST0 && marker <= JPG_RST7) {
-                context.huffman_stream.stream.append(marker);
+                context.restart_offsets.append(context.huffman_stream.size());
                 stream >> current_byte;
                 if (stream.handle_any_error())
                     return false;
@@ -1187,7 +1383,7 @@ static bool scan_huffman_stream(InputMemoryStream& stream, JPGLoadingContext& co
             dbgln_if(JPG_DEBUG, "{}: Invalid marker: {:x}!", stream.offset(), marker);
             return false;
         } else {
-            context.huffman_stream.stream.append(last_byte);
+            context.huffman_stream.append(last_byte);
         }
     }
 
@@ -1200,21 +1396,34 @@ static bool decode_jpg(JPGLoadingContext& context)
 
     if (!parse_header(stream, context))
         return false;
+
+    context.restart_offsets.append(0);
     if (!scan_huffman_stream(stream, context))
         return false;
 
-    auto result = decode_huffman_stream(context);
-    if (!result.has_value()) {
+    // Chroma blocks that cover twice as many pixels in both directions keep twice the samples of a luma
+    // block, as long as they don't get bigger than a full block.
+    int scale = 1;
+    IntSize frame_size { context.frame.width, context.frame.height };
+    auto reduction_factor = reduction_factor_for_target_size(frame_size, context.target_size);
+    while (scale < 8 && scale * 2 <= reduction_factor)
+        scale *= 2;
+    context.luma_block_size = 8 / scale;
+    context.chroma_block_size = context.luma_block_size;
+    if (context.hsample_factor == 2 && context.vsample_factor == 2)
+        context.chroma_block_size = min(8, context.luma_block_size * 2);
+
+    auto bitmap_or_error = Bitmap::try_create(BitmapFormat::BGRx8888, { ceil_div(frame_size.width(), scale), ceil_div(frame_size.height(), scale) });
+    if (bitmap_or_error.is_error())
+        return false;
+    auto bitmap = bitmap_or_error.release_value();
+
+    if (!decode_huffman_stream(context, *bitmap)) {
         dbgln_if(JPG_DEBUG, "{}: Failed to decode Macroblocks!", stream.offset());
         return false;
     }
 
-    auto macroblocks = result.release_value();
-    dequantize(context, macroblocks);
-    inverse_dct(context, macroblocks);
-    ycbcr_to_rgb(context, macroblocks);
-    if (!compose_bitmap(context, macroblocks))
-        return false;
+    context.bitmap = move(bitmap);
     return true;
 }
 
@@ -1223,7 +1432,7 @@ JPGImageDecoderPlugin::JPGImageDecoderPlugin(const u8* data, size_t size)
     m_context = make<JPGLoadingContext>();
     m_context->data = data;
     m_context->data_size = size;
-    m_context->huffman_stream.stream.ensure_capacity(50 * KiB);
+    m_context->huffman_stream.ensure_capacity(50 * KiB);
 }
 
 JPGImageDecoderPlugin::~JPGImageDecoderPlugin()
@@ -1253,6 +1462,16 @@ bool JPGImageDecoderPlugin::set_nonvolatile(bool& was_purged)
     return m_context->bitmap->set_nonvolatile(was_purged);
 }
 
+void JPGImageDecoderPlugin::set_decoding_thread_count(size_t thread_count)
+{
+    m_context->thread_count = max(thread_count, static_cast<size_t>(1));
+}
+
+void JPGImageDecoderPlugin::set_target_size(IntSize target_size)
+{
+    m_context->target_size = target_size;
+}
+
 bool JPGImageDecoderPlugin::sniff()
 {
     return m_context->data_size > 3
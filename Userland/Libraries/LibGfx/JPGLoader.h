@@ -19,6 +19,8 @@ public:
     virtual IntSize size() override;
     virtual void set_volatile() override;
     [[nodiscard]] virtual bool set_nonvolatile(bool& was_purged) override;
+    virtual void set_decoding_thread_count(size_t) override;
+    virtual void set_target_size(IntSize) override;
     virtual bool sniff() override;
     virtual bool is_animated() override;
     virtual size_t loop_count() override;
@@ -6,8 +6,12 @@
 
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
 #include <AK/Vector.h>
+#include <LibCompress/Deflate.h>
 #include <LibCompress/Zlib.h>
+#include <LibGfx/BoxDownscaler.h>
 #include <LibGfx/PNGLoader.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -17,7 +21,6 @@
 #include <unistd.h>
 
 #ifdef __serenity__
-#    include <LibCompress/Deflate.h>
 #    include <serenity.h>
 #endif
 
@@ -37,11 +40,6 @@ struct PNG_IHDR {
 
 static_assert(AssertSize<PNG_IHDR, 13>());
 
-struct Scanline {
-    u8 filter { 0 };
-    ReadonlyBytes data {};
-};
-
 struct [[gnu::packed]] PaletteEntry {
     u8 r;
     u8 g;
@@ -97,12 +95,17 @@ struct PNGLoadingContext {
     u8 channels { 0 };
     bool has_seen_zlib_header { false };
     bool has_alpha() const { return color_type & 4 || palette_transparency_data.size() > 0; }
-    Vector<Scanline> scanlines;
     RefPtr<Gfx::Bitmap> bitmap;
-    ByteBuffer* decompression_buffer { nullptr };
     Vector<u8> compressed_data;
     Vector<PaletteEntry> palette_data;
     Vector<u8> palette_transparency_data;
+    IntSize target_size;
+
+    // Filters work on whole pixels, but at least on whole bytes.
+    size_t bytes_per_complete_pixel() const
+    {
+        return max<size_t>(1, channels * bit_depth / 8);
+    }
 
     Checked<int> compute_row_size_for_width(int width)
     {
@@ -167,182 +170,227 @@ private:
 
 static bool process_chunk(Streamer&, PNGLoadingContext& context);
 
-ALWAYS_INLINE static u8 paeth_predictor(int a, int b, int c)
-{
-    int p = a + b - c;
-    int pa = abs(p - a);
-    int pb = abs(p - b);
-    int pc = abs(p - c);
-    if (pa <= pb && pa <= pc)
-        return a;
-    if (pb <= pc)
-        return b;
-    return c;
-}
-
 union [[gnu::packed]] Pixel {
     RGBA32 rgba { 0 };
     u8 v[4];
     struct {
-        u8 r;
-        u8 g;
         u8 b;
+        u8 g;
+        u8 r;
         u8 a;
     };
 };
 static_assert(AssertSize<Pixel, 4>());
 
-template<bool has_alpha, u8 filter_type>
-ALWAYS_INLINE static void unfilter_impl(Gfx::Bitmap& bitmap, int y, const void* dummy_scanline_data)
-{
-    auto* dummy_scanline = (const Pixel*)dummy_scanline_data;
-    if constexpr (filter_type == 0) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-        }
+// Filters predict every byte of a scanline from the bytes at the same position in the pixel to its left
+// and in the scanline above, so undoing them works on whole pixels at a time: every byte of a pixel gets
+// a 16-bit lane of a vector, which covers everything from single bytes up to 16-bit RGBA.
+template<size_t bytes_per_pixel>
+struct PixelLanes {
+    static_assert(bytes_per_pixel <= 8);
+    using Vector = AK::SIMD::i16x8;
+
+    // Pixels are moved through a scalar in power-of-two sized pieces, as copying an odd number of bytes straight
+    // into a vector ends up going through memory one byte at a time.
+    template<typename Callback>
+    static ALWAYS_INLINE void for_each_piece(Callback callback)
+    {
+        size_t offset = 0;
+        auto piece = [&]<typename T>(T) {
+            if constexpr ((bytes_per_pixel & sizeof(T)) != 0) {
+                callback(T {}, offset);
+                offset += sizeof(T);
+            }
+        };
+        piece(u64 {});
+        piece(u32 {});
+        piece(u16 {});
+        piece(u8 {});
     }
 
-    if constexpr (filter_type == 1) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        swap(pixels[0].r, pixels[0].b);
-        for (int i = 1; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            auto& a = (const Pixel&)pixels[i - 1];
-            x.v[0] += a.v[0];
-            x.v[1] += a.v[1];
-            x.v[2] += a.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += a.v[3];
+    static ALWAYS_INLINE Vector load(u8 const* pixel)
+    {
+        u64 word = 0;
+        for_each_piece([&]<typename T>(T part, size_t offset) {
+            __builtin_memcpy(&part, pixel + offset, sizeof(T));
+            word |= static_cast<u64>(part) << (offset * 8);
+        });
+        return __builtin_convertvector(bit_cast<AK::SIMD::u8x8>(word), Vector);
+    }
+
+    static ALWAYS_INLINE void store(u8* pixel, Vector lanes)
+    {
+        auto word = bit_cast<u64>(__builtin_convertvector(lanes, AK::SIMD::u8x8));
+        for_each_piece([&]<typename T>(T, size_t offset) {
+            auto part = static_cast<T>(word >> (offset * 8));
+            __builtin_memcpy(pixel + offset, &part, sizeof(T));
+        });
+    }
+
+    static ALWAYS_INLINE Vector abs(Vector lanes)
+    {
+        return lanes < 0 ? -lanes : lanes;
+    }
+
+    static ALWAYS_INLINE Vector paeth_predictor(Vector a, Vector b, Vector c)
+    {
+        auto pa = abs(b - c);
+        auto pb = abs(a - c);
+        auto pc = abs(a + b - c - c);
+        return ((pa <= pb) & (pa <= pc)) ? a : (pb <= pc ? b : c);
+    }
+};
+
+template<size_t bytes_per_pixel>
+static void unfilter_scanline_impl(u8 filter, Bytes scanline, ReadonlyBytes previous_scanline)
+{
+    using Lanes = PixelLanes<bytes_per_pixel>;
+
+    auto* x = scanline.data();
+    auto const* b = previous_scanline.data();
+    size_t size = scanline.size();
+
+    switch (filter) {
+    case 0:
+        break;
+    case 1: {
+        auto a = Lanes::load(x);
+        for (size_t i = bytes_per_pixel; i < size; i += bytes_per_pixel) {
+            a = (a + Lanes::load(x + i)) & 0xff;
+            Lanes::store(x + i, a);
         }
-        return;
-    }
-    if constexpr (filter_type == 2) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] += b.v[0];
-            x.v[1] += b.v[1];
-            x.v[2] += b.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += b.v[3];
+        break;
+    }
+    case 2: {
+        // Up is the only filter without a dependency between neighboring pixels, so it can take 16 bytes at a time.
+        size_t i = 0;
+        for (; i + sizeof(AK::SIMD::u8x16) <= size; i += sizeof(AK::SIMD::u8x16)) {
+            AK::SIMD::u8x16 bytes;
+            AK::SIMD::u8x16 above;
+            __builtin_memcpy(&bytes, x + i, sizeof(bytes));
+            __builtin_memcpy(&above, b + i, sizeof(above));
+            bytes += above;
+            __builtin_memcpy(x + i, &bytes, sizeof(bytes));
         }
-        return;
-    }
-    if constexpr (filter_type == 3) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            if (i != 0)
-                a = pixels[i - 1];
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] = x.v[0] + ((a.v[0] + b.v[0]) / 2);
-            x.v[1] = x.v[1] + ((a.v[1] + b.v[1]) / 2);
-            x.v[2] = x.v[2] + ((a.v[2] + b.v[2]) / 2);
-            if constexpr (has_alpha)
-                x.v[3] = x.v[3] + ((a.v[3] + b.v[3]) / 2);
+        for (; i < size; ++i)
+            x[i] += b[i];
+        break;
+    }
+    case 3: {
+        typename Lanes::Vector a {};
+        for (size_t i = 0; i < size; i += bytes_per_pixel) {
+            a = (Lanes::load(x + i) + ((a + Lanes::load(b + i)) >> 1)) & 0xff;
+            Lanes::store(x + i, a);
         }
-        return;
-    }
-    if constexpr (filter_type == 4) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            const Pixel& b = pixels_y_minus_1[i];
-            Pixel c;
-            if (i != 0) {
-                a = pixels[i - 1];
-                c = pixels_y_minus_1[i - 1];
-            }
-            x.v[0] += paeth_predictor(a.v[0], b.v[0], c.v[0]);
-            x.v[1] += paeth_predictor(a.v[1], b.v[1], c.v[1]);
-            x.v[2] += paeth_predictor(a.v[2], b.v[2], c.v[2]);
-            if constexpr (has_alpha)
-                x.v[3] += paeth_predictor(a.v[3], b.v[3], c.v[3]);
+        break;
+    }
+    case 4: {
+        typename Lanes::Vector a {};
+        typename Lanes::Vector c {};
+        for (size_t i = 0; i < size; i += bytes_per_pixel) {
+            auto above = Lanes::load(b + i);
+            a = (Lanes::load(x + i) + Lanes::paeth_predictor(a, above, c)) & 0xff;
+            c = above;
+            Lanes::store(x + i, a);
         }
+        break;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+// Undoes the filter of a scanline in place. The scanline above has to be unfiltered already, and is all
+// zeroes for the first scanline of an image or interlacing pass.
+static void unfilter_scanline(u8 filter, Bytes scanline, ReadonlyBytes previous_scanline, size_t bytes_per_pixel)
+{
+    VERIFY(scanline.size() % bytes_per_pixel == 0 && previous_scanline.size() == scanline.size());
+    switch (bytes_per_pixel) {
+    case 1:
+        unfilter_scanline_impl<1>(filter, scanline, previous_scanline);
+        break;
+    case 2:
+        unfilter_scanline_impl<2>(filter, scanline, previous_scanline);
+        break;
+    case 3:
+        unfilter_scanline_impl<3>(filter, scanline, previous_scanline);
+        break;
+    case 4:
+        unfilter_scanline_impl<4>(filter, scanline, previous_scanline);
+        break;
+    case 6:
+        unfilter_scanline_impl<6>(filter, scanline, previous_scanline);
+        break;
+    case 8:
+        unfilter_scanline_impl<8>(filter, scanline, previous_scanline);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
     }
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_grayscale_without_alpha(ReadonlyBytes scanline, Pixel* pixels, int width)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* gray_values = reinterpret_cast<const T*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = gray_values[i];
-            pixel.g = gray_values[i];
-            pixel.b = gray_values[i];
-            pixel.a = 0xff;
-        }
+    auto* gray_values = reinterpret_cast<const T*>(scanline.data());
+    for (int i = 0; i < width; ++i) {
+        auto& pixel = pixels[i];
+        pixel.r = gray_values[i];
+        pixel.g = gray_values[i];
+        pixel.b = gray_values[i];
+        pixel.a = 0xff;
     }
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_grayscale_with_alpha(ReadonlyBytes scanline, Pixel* pixels, int width)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* tuples = reinterpret_cast<const Tuple<T>*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = tuples[i].gray;
-            pixel.g = tuples[i].gray;
-            pixel.b = tuples[i].gray;
-            pixel.a = tuples[i].a;
-        }
+    auto* tuples = reinterpret_cast<const Tuple<T>*>(scanline.data());
+    for (int i = 0; i < width; ++i) {
+        auto& pixel = pixels[i];
+        pixel.r = tuples[i].gray;
+        pixel.g = tuples[i].gray;
+        pixel.b = tuples[i].gray;
+        pixel.a = tuples[i].a;
     }
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_triplets_without_alpha(ReadonlyBytes scanline, Pixel* pixels, int width)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* triplets = reinterpret_cast<const Triplet<T>*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = triplets[i].r;
-            pixel.g = triplets[i].g;
-            pixel.b = triplets[i].b;
-            pixel.a = 0xff;
-        }
+    auto* triplets = reinterpret_cast<const Triplet<T>*>(scanline.data());
+    for (int i = 0; i < width; ++i) {
+        auto& pixel = pixels[i];
+        pixel.r = triplets[i].r;
+        pixel.g = triplets[i].g;
+        pixel.b = triplets[i].b;
+        pixel.a = 0xff;
     }
 }
 
-NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
+// Unpacks an unfiltered scanline of `width` pixels to BGRA.
+static ErrorOr<void> unpack_scanline(PNGLoadingContext const& context, ReadonlyBytes scanline, Pixel* pixels, int width)
 {
-    // First unpack the scanlines to RGBA:
     switch (context.color_type) {
     case 0:
         if (context.bit_depth == 8) {
-            unpack_grayscale_without_alpha<u8>(context);
+            unpack_grayscale_without_alpha<u8>(scanline, pixels, width);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_without_alpha<u16>(context);
+            unpack_grayscale_without_alpha<u16>(scanline, pixels, width);
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
-            auto bit_depth_squared = context.bit_depth * context.bit_depth;
             auto pixels_per_byte = 8 / context.bit_depth;
             auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* gray_values = context.scanlines[y].data.data();
-                for (int x = 0; x < context.width; ++x) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
-                    auto value = (gray_values[x / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[x];
-                    pixel.r = value * (0xff / bit_depth_squared);
-                    pixel.g = value * (0xff / bit_depth_squared);
-                    pixel.b = value * (0xff / bit_depth_squared);
-                    pixel.a = 0xff;
-                }
+            // The largest sample value has to map to white, i.e. samples are scaled by 0xff, 0x55 or 0x11.
+            auto scale = 0xff / mask;
+            auto* gray_values = scanline.data();
+            for (int x = 0; x < width; ++x) {
+                auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
+                auto value = (gray_values[x / pixels_per_byte] >> bit_offset) & mask;
+                auto& pixel = pixels[x];
+                pixel.r = value * scale;
+                pixel.g = value * scale;
+                pixel.b = value * scale;
+                pixel.a = 0xff;
             }
         } else {
             VERIFY_NOT_REACHED();
@@ -350,37 +398,38 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         break;
     case 4:
         if (context.bit_depth == 8) {
-            unpack_grayscale_with_alpha<u8>(context);
+            unpack_grayscale_with_alpha<u8>(scanline, pixels, width);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_with_alpha<u16>(context);
+            unpack_grayscale_with_alpha<u16>(scanline, pixels, width);
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case 2:
         if (context.bit_depth == 8) {
-            unpack_triplets_without_alpha<u8>(context);
+            unpack_triplets_without_alpha<u8>(scanline, pixels, width);
         } else if (context.bit_depth == 16) {
-            unpack_triplets_without_alpha<u16>(context);
+            unpack_triplets_without_alpha<u16>(scanline, pixels, width);
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case 6:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
+            // RGBA to BGRA, which the compiler turns into a few vector shuffles.
+            auto* rgba_values = reinterpret_cast<const u32*>(scanline.data());
+            for (int i = 0; i < width; ++i) {
+                u32 rgba = rgba_values[i];
+                pixels[i].rgba = (rgba & 0xff00ff00) | ((rgba & 0xff) << 16) | ((rgba >> 16) & 0xff);
             }
         } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* triplets = reinterpret_cast<const Quad<u16>*>(context.scanlines[y].data.data());
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    pixel.r = triplets[i].r & 0xFF;
-                    pixel.g = triplets[i].g & 0xFF;
-                    pixel.b = triplets[i].b & 0xFF;
-                    pixel.a = triplets[i].a & 0xFF;
-                }
+            auto* triplets = reinterpret_cast<const Quad<u16>*>(scanline.data());
+            for (int i = 0; i < width; ++i) {
+                auto& pixel = pixels[i];
+                pixel.r = triplets[i].r & 0xFF;
+                pixel.g = triplets[i].g & 0xFF;
+                pixel.b = triplets[i].b & 0xFF;
+                pixel.a = triplets[i].a & 0xFF;
             }
         } else {
             VERIFY_NOT_REACHED();
@@ -388,42 +437,38 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         break;
     case 3:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_index = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if (palette_index[i] >= context.palette_data.size())
-                        return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range"sv);
-                    auto& color = context.palette_data.at((int)palette_index[i]);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index[i] + 1u
-                        ? context.palette_transparency_data.data()[palette_index[i]]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
+            auto* palette_index = scanline.data();
+            for (int i = 0; i < width; ++i) {
+                auto& pixel = pixels[i];
+                if (palette_index[i] >= context.palette_data.size())
+                    return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range"sv);
+                auto& color = context.palette_data.at((int)palette_index[i]);
+                auto transparency = context.palette_transparency_data.size() >= palette_index[i] + 1u
+                    ? context.palette_transparency_data.data()[palette_index[i]]
+                    : 0xff;
+                pixel.r = color.r;
+                pixel.g = color.g;
+                pixel.b = color.b;
+                pixel.a = transparency;
             }
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
             auto pixels_per_byte = 8 / context.bit_depth;
             auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_indices = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
-                    auto palette_index = (palette_indices[i / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if ((size_t)palette_index >= context.palette_data.size())
-                        return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range"sv);
-                    auto& color = context.palette_data.at(palette_index);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index + 1u
-                        ? context.palette_transparency_data.data()[palette_index]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
+            auto* palette_indices = scanline.data();
+            for (int i = 0; i < width; ++i) {
+                auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
+                auto palette_index = (palette_indices[i / pixels_per_byte] >> bit_offset) & mask;
+                auto& pixel = pixels[i];
+                if ((size_t)palette_index >= context.palette_data.size())
+                    return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range"sv);
+                auto& color = context.palette_data.at(palette_index);
+                auto transparency = context.palette_transparency_data.size() >= palette_index + 1u
+                    ? context.palette_transparency_data.data()[palette_index]
+                    : 0xff;
+                pixel.r = color.r;
+                pixel.g = color.g;
+                pixel.b = color.b;
+                pixel.a = transparency;
             }
         } else {
             VERIFY_NOT_REACHED();
@@ -433,51 +478,62 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         VERIFY_NOT_REACHED();
         break;
     }
+    return {};
+}
+
+// Inflates the image data one scanline at a time and undoes its filter right away, so that neither the
+// decompressed image data nor more than two of its scanlines ever have to be in memory at once.
+class ScanlineReader {
+public:
+    ScanlineReader(ReadonlyBytes deflate_data, size_t bytes_per_pixel)
+        : m_memory_stream(deflate_data)
+        , m_decompressor(m_memory_stream)
+        , m_bytes_per_pixel(bytes_per_pixel)
+    {
+    }
 
-    u8 dummy_scanline[context.width * sizeof(RGBA32)];
-    memset(dummy_scanline, 0, sizeof(dummy_scanline));
+    ~ScanlineReader()
+    {
+        m_decompressor.handle_any_error();
+        m_memory_stream.handle_any_error();
+    }
 
-    for (int y = 0; y < context.height; ++y) {
-        auto filter = context.scanlines[y].filter;
-        if (filter == 0) {
-            if (context.has_alpha())
-                unfilter_impl<true, 0>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 0>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 1) {
-            if (context.has_alpha())
-                unfilter_impl<true, 1>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 1>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 2) {
-            if (context.has_alpha())
-                unfilter_impl<true, 2>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 2>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 3) {
-            if (context.has_alpha())
-                unfilter_impl<true, 3>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 3>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 4) {
-            if (context.has_alpha())
-                unfilter_impl<true, 4>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 4>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
+    // Starts a new image or interlacing pass, whose scanlines are `row_size` bytes long.
+    ErrorOr<void> start_pass(size_t row_size)
+    {
+        // Every buffer is a filter type byte, followed by the scanline.
+        m_row_size = row_size;
+        TRY(m_buffers.try_resize(2 * (row_size + 1)));
+        m_buffers.span().fill(0);
+        m_current = 0;
+        return {};
     }
 
-    return {};
-}
+    ErrorOr<ReadonlyBytes> read_scanline()
+    {
+        m_current ^= 1;
+        auto buffer = m_buffers.span().slice(m_current * (m_row_size + 1), m_row_size + 1);
+        auto previous_scanline = m_buffers.span().slice((m_current ^ 1) * (m_row_size + 1) + 1, m_row_size);
+        if (!m_decompressor.read_or_error(buffer))
+            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
+
+        auto filter = buffer[0];
+        if (filter > 4)
+            return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter"sv);
+
+        auto scanline = buffer.slice(1);
+        unfilter_scanline(filter, scanline, previous_scanline, m_bytes_per_pixel);
+        return scanline;
+    }
+
+private:
+    InputMemoryStream m_memory_stream;
+    Compress::DeflateDecompressor m_decompressor;
+    size_t m_bytes_per_pixel { 1 };
+    size_t m_row_size { 0 };
+    Vector<u8> m_buffers;
+    u8 m_current { 0 };
+};
 
 static bool decode_png_header(PNGLoadingContext& context)
 {
@@ -556,36 +612,36 @@ static bool decode_png_chunks(PNGLoadingContext& context)
     return true;
 }
 
-static ErrorOr<void> decode_png_bitmap_simple(PNGLoadingContext& context)
+static ErrorOr<void> decode_png_bitmap_simple(PNGLoadingContext& context, ScanlineReader& reader)
 {
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
-
-    for (int y = 0; y < context.height; ++y) {
-        u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
-        }
-
-        if (filter > 4) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter"sv);
-        }
+    auto row_size = context.compute_row_size_for_width(context.width);
+    if (row_size.has_overflow())
+        return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow"sv);
+    TRY(reader.start_pass(row_size.value()));
 
-        context.scanlines.append({ filter });
-        auto& scanline_buffer = context.scanlines.last().data;
-        auto row_size = context.compute_row_size_for_width(context.width);
-        if (row_size.has_overflow())
-            return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow"sv);
+    // With a downscaler, every scanline is unpacked to a row of scratch space and handed to it instead
+    // of being stored in the bitmap, which then never has to exist at full size.
+    OwnPtr<BoxDownscaler> downscaler;
+    Vector<RGBA32> scratch_row;
+    auto reduction_factor = reduction_factor_for_target_size({ context.width, context.height }, context.target_size);
+    if (reduction_factor > 1) {
+        downscaler = TRY(BoxDownscaler::try_create({ context.width, context.height }, reduction_factor, context.has_alpha()));
+        TRY(scratch_row.try_resize(context.width));
+    } else {
+        context.bitmap = TRY(Bitmap::try_create(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height }));
+    }
 
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
-        }
+    for (int y = 0; y < context.height; ++y) {
+        auto scanline = TRY(reader.read_scanline());
+        auto* row = downscaler ? scratch_row.data() : context.bitmap->scanline(y);
+        TRY(unpack_scanline(context, scanline, reinterpret_cast<Pixel*>(row), context.width));
+        if (downscaler)
+            downscaler->add_row(y, row);
     }
 
-    context.bitmap = TRY(Bitmap::try_create(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height }));
-    return unfilter(context);
+    if (downscaler)
+        context.bitmap = downscaler->finish();
+    return {};
 }
 
 static int adam7_height(PNGLoadingContext& context, int pass)
@@ -638,65 +694,43 @@ static int adam7_startx[8] = { 0, 0, 4, 0, 2, 0, 1, 0 };
 static int adam7_stepy[8] = { 1, 8, 8, 8, 4, 4, 2, 2 };
 static int adam7_stepx[8] = { 1, 8, 8, 4, 4, 2, 2, 1 };
 
-static ErrorOr<void> decode_adam7_pass(PNGLoadingContext& context, Streamer& streamer, int pass)
+static ErrorOr<void> decode_adam7_pass(PNGLoadingContext& context, ScanlineReader& reader, Vector<Pixel>& pass_pixels, int pass)
 {
-    PNGLoadingContext subimage_context;
-    subimage_context.width = adam7_width(context, pass);
-    subimage_context.height = adam7_height(context, pass);
-    subimage_context.channels = context.channels;
-    subimage_context.color_type = context.color_type;
-    subimage_context.palette_data = context.palette_data;
-    subimage_context.palette_transparency_data = context.palette_transparency_data;
-    subimage_context.bit_depth = context.bit_depth;
-    subimage_context.filter_method = context.filter_method;
+    int width = adam7_width(context, pass);
+    int height = adam7_height(context, pass);
 
     // For small images, some passes might be empty
-    if (!subimage_context.width || !subimage_context.height)
+    if (!width || !height)
         return {};
 
-    subimage_context.scanlines.clear_with_capacity();
-    for (int y = 0; y < subimage_context.height; ++y) {
-        u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
-        }
-
-        if (filter > 4) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter"sv);
-        }
-
-        subimage_context.scanlines.append({ filter });
-        auto& scanline_buffer = subimage_context.scanlines.last().data;
-
-        auto row_size = context.compute_row_size_for_width(subimage_context.width);
-        if (row_size.has_overflow())
-            return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow"sv);
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
-        }
-    }
-
-    subimage_context.bitmap = TRY(Bitmap::try_create(context.bitmap->format(), { subimage_context.width, subimage_context.height }));
-    TRY(unfilter(subimage_context));
+    auto row_size = context.compute_row_size_for_width(width);
+    if (row_size.has_overflow())
+        return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow"sv);
+    TRY(reader.start_pass(row_size.value()));
 
-    // Copy the subimage data into the main image according to the pass pattern
-    for (int y = 0, dy = adam7_starty[pass]; y < subimage_context.height && dy < context.height; ++y, dy += adam7_stepy[pass]) {
-        for (int x = 0, dx = adam7_startx[pass]; x < subimage_context.width && dy < context.width; ++x, dx += adam7_stepx[pass]) {
-            context.bitmap->set_pixel(dx, dy, subimage_context.bitmap->get_pixel(x, y));
-        }
+    // Copy the pixels of the pass into the main image according to the pass pattern
+    for (int y = 0, dy = adam7_starty[pass]; y < height; ++y, dy += adam7_stepy[pass]) {
+        auto scanline = TRY(reader.read_scanline());
+        TRY(unpack_scanline(context, scanline, pass_pixels.data(), width));
+        auto* destination = context.bitmap->scanline(dy);
+        for (int x = 0, dx = adam7_startx[pass]; x < width; ++x, dx += adam7_stepx[pass])
+            destination[dx] = pass_pixels[x].rgba;
     }
     return {};
 }
 
-static ErrorOr<void> decode_png_adam7(PNGLoadingContext& context)
+static ErrorOr<void> decode_png_adam7(PNGLoadingContext& context, ScanlineReader& reader)
 {
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
     context.bitmap = TRY(Bitmap::try_create(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height }));
+    Vector<Pixel> pass_pixels;
+    TRY(pass_pixels.try_resize(context.width));
     for (int pass = 1; pass <= 7; ++pass)
-        TRY(decode_adam7_pass(context, streamer, pass));
+        TRY(decode_adam7_pass(context, reader, pass_pixels, pass));
+
+    // The passes are spread all over the image, so it only gets scaled down once it is complete.
+    auto reduction_factor = reduction_factor_for_target_size({ context.width, context.height }, context.target_size);
+    if (reduction_factor > 1)
+        context.bitmap = TRY(BoxDownscaler::downscale(*context.bitmap, reduction_factor));
     return {};
 }
 
@@ -716,29 +750,31 @@ static ErrorOr<void> decode_png_bitmap(PNGLoadingContext& context)
     if (context.color_type == 3 && context.palette_data.is_empty())
         return Error::from_string_literal("PNGImageDecoderPlugin: Didn't see a PLTE chunk for a palletized image, or it was empty."sv);
 
-    auto result = Compress::Zlib::decompress_all(context.compressed_data.span());
-    if (!result.has_value()) {
+    auto zlib = Compress::Zlib::try_create(context.compressed_data.span());
+    if (!zlib.has_value()) {
         context.state = PNGLoadingContext::State::Error;
         return Error::from_string_literal("PNGImageDecoderPlugin: Decompression failed"sv);
     }
-    context.decompression_buffer = &result.value();
-    context.compressed_data.clear();
 
-    context.scanlines.ensure_capacity(context.height);
-    switch (context.interlace_method) {
-    case PngInterlaceMethod::Null:
-        TRY(decode_png_bitmap_simple(context));
-        break;
-    case PngInterlaceMethod::Adam7:
-        TRY(decode_png_adam7(context));
-        break;
-    default:
+    auto decode = [&]() -> ErrorOr<void> {
+        ScanlineReader reader { zlib->deflate_data(), context.bytes_per_complete_pixel() };
+        switch (context.interlace_method) {
+        case PngInterlaceMethod::Null:
+            return decode_png_bitmap_simple(context, reader);
+        case PngInterlaceMethod::Adam7:
+            return decode_png_adam7(context, reader);
+        default:
+            return Error::from_string_literal("PNGImageDecoderPlugin: Invalid interlace method"sv);
+        }
+    };
+    auto result = decode();
+    context.compressed_data.clear();
+    if (result.is_error()) {
+        context.bitmap = nullptr;
         context.state = PNGLoadingContext::State::Error;
-        return Error::from_string_literal("PNGImageDecoderPlugin: Invalid interlace method"sv);
+        return result.release_error();
     }
 
-    context.decompression_buffer = nullptr;
-
     context.state = PNGLoadingContext::State::BitmapDecoded;
     return {};
 }
@@ -921,6 +957,11 @@ bool PNGImageDecoderPlugin::set_nonvolatile(bool& was_purged)
     return m_context->bitmap->set_nonvolatile(was_purged);
 }
 
+void PNGImageDecoderPlugin::set_target_size(IntSize target_size)
+{
+    m_context->target_size = target_size;
+}
+
 bool PNGImageDecoderPlugin::sniff()
 {
     return decode_png_header(*m_context);
@@ -15,12 +15,14 @@
 #include "FontDatabase.h"
 #include "Gamma.h"
 #include <AK/Assertions.h>
+#include <AK/CPUFeatures.h>
 #include <AK/Debug.h>
 #include <AK/Function.h>
 #include <AK/Math.h>
 #include <AK/Memory.h>
 #include <AK/Queue.h>
 #include <AK/QuickSort.h>
+#include <AK/SIMD.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf32View.h>
@@ -29,6 +31,7 @@
 #include <LibGfx/FillPathImplementation.h>
 #include <LibGfx/Palette.h>
 #include <LibGfx/Path.h>
+#include <LibGfx/Resampler.h>
 #include <LibGfx/TextDirection.h>
 #include <LibGfx/TextLayout.h>
 #include <stdio.h>
@@ -57,6 +60,178 @@ ALWAYS_INLINE Color get_pixel(Gfx::Bitmap const& bitmap, int x, int y)
     return bitmap.get_pixel(x, y);
 }
 
+// The pixel loops below work on `lane_count` pixels at a time. They are instantiated with 4 lanes, which
+// fits the SSE2 registers every x86_64 CPU has, and with 8 lanes for CPUs with AVX2.
+template<size_t lane_count>
+struct PixelVectors;
+
+template<>
+struct PixelVectors<4> {
+    using U32 = AK::SIMD::u32x4;
+    using I32 = AK::SIMD::i32x4;
+    using F32 = AK::SIMD::f32x4;
+};
+
+template<>
+struct PixelVectors<8> {
+    using U32 = AK::SIMD::u32x8;
+    using I32 = AK::SIMD::i32x8;
+    using F32 = AK::SIMD::f32x8;
+};
+
+template<size_t lane_count>
+struct PixelLanes {
+    using U32 = typename PixelVectors<lane_count>::U32;
+    using I32 = typename PixelVectors<lane_count>::I32;
+    using F32 = typename PixelVectors<lane_count>::F32;
+
+    static ALWAYS_INLINE U32 load(RGBA32 const* pixels)
+    {
+        U32 lanes;
+        __builtin_memcpy(&lanes, pixels, sizeof(lanes));
+        return lanes;
+    }
+
+    static ALWAYS_INLINE void store(RGBA32* pixels, U32 lanes)
+    {
+        __builtin_memcpy(pixels, &lanes, sizeof(lanes));
+    }
+
+    static ALWAYS_INLINE I32 channel(U32 pixels, int shift)
+    {
+        return __builtin_convertvector((pixels >> shift) & 0xff, I32);
+    }
+
+    // Scales the alpha of every pixel by the opacity, rounding just like the scalar code in do_blit_with_opacity().
+    static ALWAYS_INLINE U32 with_alpha_times_opacity(U32 pixels, float opacity)
+    {
+        auto alpha = __builtin_convertvector(channel(pixels, 24), F32) / 255.0f;
+        auto new_alpha = __builtin_convertvector(__builtin_convertvector(255.0f * (opacity * alpha), I32), U32);
+        return (pixels & 0xffffff) | (new_alpha << 24);
+    }
+
+    // Same as Color::blend(), with exactly the same results.
+    static ALWAYS_INLINE U32 blend(U32 destination, U32 source)
+    {
+        auto destination_alpha = channel(destination, 24);
+        auto source_alpha = channel(source, 24);
+        auto d = 255 * (destination_alpha + source_alpha) - destination_alpha * source_alpha;
+        auto destination_weight = destination_alpha * (255 - source_alpha);
+        auto source_weight = 255 * source_alpha;
+
+        // The division by d is done with floats, which can leave the quotient off by one. Comparing the remainder
+        // with d puts it back. d is only 0 where both alphas are 0, and those lanes are replaced below.
+        auto safe_d = d - (d == 0);
+        auto reciprocal = 1.0f / __builtin_convertvector(safe_d, F32);
+        auto blend_channel = [&](int shift) {
+            auto numerator = channel(destination, shift) * destination_weight + channel(source, shift) * source_weight;
+            auto quotient = __builtin_convertvector(__builtin_convertvector(numerator, F32) * reciprocal, I32);
+            auto remainder = numerator - quotient * safe_d;
+            quotient += (remainder < 0) - (remainder >= safe_d);
+            return __builtin_convertvector(quotient, U32) << shift;
+        };
+        auto alpha = __builtin_convertvector((d + 1 + (d >> 8)) >> 8, U32);
+        auto blended = blend_channel(16) | blend_channel(8) | blend_channel(0) | (alpha << 24);
+
+        blended = source_alpha == 0 ? destination : blended;
+        return (destination_alpha == 0) | (source_alpha == 255) ? source : blended;
+    }
+};
+
+template<size_t lane_count>
+static void copy_pixels(RGBA32* destination, RGBA32 const* source, int count)
+{
+    using Lanes = PixelLanes<lane_count>;
+    int i = 0;
+    for (; i + static_cast<int>(lane_count) <= count; i += lane_count)
+        Lanes::store(destination + i, Lanes::load(source + i));
+    for (; i < count; ++i)
+        destination[i] = source[i];
+}
+
+template<size_t lane_count>
+static void fill_pixels(RGBA32* destination, RGBA32 value, int count)
+{
+    using Lanes = PixelLanes<lane_count>;
+    auto lanes = typename Lanes::U32 {} + value;
+    int i = 0;
+    for (; i + static_cast<int>(lane_count) <= count; i += lane_count)
+        Lanes::store(destination + i, lanes);
+    for (; i < count; ++i)
+        destination[i] = value;
+}
+
+template<size_t lane_count>
+static void blend_pixels_with_color(RGBA32* destination, Color color, int count)
+{
+    using Lanes = PixelLanes<lane_count>;
+    auto lanes = typename Lanes::U32 {} + color.value();
+    int i = 0;
+    for (; i + static_cast<int>(lane_count) <= count; i += lane_count)
+        Lanes::store(destination + i, Lanes::blend(Lanes::load(destination + i), lanes));
+    for (; i < count; ++i)
+        destination[i] = Color::from_rgba(destination[i]).blend(color).value();
+}
+
+#if ARCH(X86_64)
+static bool should_use_avx2()
+{
+    static bool const avx2_supported = cpu_supports_avx2();
+    return avx2_supported;
+}
+
+// Everything called from these is inlined, so that it is compiled for AVX2 as well.
+[[gnu::target("avx2"), gnu::flatten]] static void copy_pixels_avx2(RGBA32* destination, RGBA32 const* source, int count)
+{
+    copy_pixels<8>(destination, source, count);
+}
+
+[[gnu::target("avx2"), gnu::flatten]] static void fill_pixels_avx2(RGBA32* destination, RGBA32 value, int count)
+{
+    fill_pixels<8>(destination, value, count);
+}
+
+[[gnu::target("avx2"), gnu::flatten]] static void blend_pixels_with_color_avx2(RGBA32* destination, Color color, int count)
+{
+    blend_pixels_with_color<8>(destination, color, count);
+}
+#endif
+
+// Starting up the string instructions behind fast_u32_copy() and fast_u32_fill() takes a while, but once they
+// run they are faster than vector stores. Rows shorter than this are copied and filled with vectors instead.
+static constexpr int min_pixel_count_for_string_instructions = 128;
+
+static void copy_pixels(RGBA32* destination, RGBA32 const* source, int count)
+{
+    if (count >= min_pixel_count_for_string_instructions)
+        return fast_u32_copy(destination, source, count);
+#if ARCH(X86_64)
+    if (should_use_avx2())
+        return copy_pixels_avx2(destination, source, count);
+#endif
+    copy_pixels<4>(destination, source, count);
+}
+
+static void fill_pixels(RGBA32* destination, RGBA32 value, int count)
+{
+    if (count >= min_pixel_count_for_string_instructions)
+        return fast_u32_fill(destination, value, count);
+#if ARCH(X86_64)
+    if (should_use_avx2())
+        return fill_pixels_avx2(destination, value, count);
+#endif
+    fill_pixels<4>(destination, value, count);
+}
+
+static void blend_pixels_with_color(RGBA32* destination, Color color, int count)
+{
+#if ARCH(X86_64)
+    if (should_use_avx2())
+        return blend_pixels_with_color_avx2(destination, color, count);
+#endif
+    blend_pixels_with_color<4>(destination, color, count);
+}
+
 Painter::Painter(Gfx::Bitmap& bitmap)
     : m_target(bitmap)
 {
@@ -106,7 +281,7 @@ void Painter::clear_rect(IntRect const& a_rect, Color color)
     size_t const dst_skip = m_target->pitch() / sizeof(RGBA32);
 
     for (int i = rect.height() - 1; i >= 0; --i) {
-        fast_u32_fill(dst, color.value(), rect.width());
+        fill_pixels(dst, color.value(), rect.width());
         dst += dst_skip;
     }
 }
@@ -118,8 +293,7 @@ void Painter::fill_physical_rect(IntRect const& physical_rect, Color color)
     size_t const dst_skip = m_target->pitch() / sizeof(RGBA32);
 
     for (int i = physical_rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < physical_rect.width(); ++j)
-            dst[j] = Color::from_rgba(dst[j]).blend(color).value();
+        blend_pixels_with_color(dst, color, physical_rect.width());
         dst += dst_skip;
     }
 }
@@ -768,11 +942,26 @@ struct BlitState {
     float opacity;
 };
 
-template<BlitState::AlphaState has_alpha>
+template<BlitState::AlphaState has_alpha, size_t lane_count>
 static void do_blit_with_opacity(BlitState& state)
 {
+    using Lanes = PixelLanes<lane_count>;
+    u32 const opacity_alpha = static_cast<u8>(state.opacity * 255) << 24;
+
     for (int row = 0; row < state.row_count; ++row) {
-        for (int x = 0; x < state.column_count; ++x) {
+        int x = 0;
+        for (; x + static_cast<int>(lane_count) <= state.column_count; x += lane_count) {
+            auto dest_color = Lanes::load(state.dst + x);
+            if constexpr (!(has_alpha & BlitState::DstAlpha))
+                dest_color |= 0xff000000;
+            auto src_color = Lanes::load(state.src + x);
+            if constexpr (has_alpha & BlitState::SrcAlpha)
+                src_color = Lanes::with_alpha_times_opacity(src_color, state.opacity);
+            else
+                src_color = (src_color & 0xffffff) | opacity_alpha;
+            Lanes::store(state.dst + x, Lanes::blend(dest_color, src_color));
+        }
+        for (; x < state.column_count; ++x) {
             Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_rgba(state.dst[x]) : Color::from_rgb(state.dst[x]);
             if constexpr (has_alpha & BlitState::SrcAlpha) {
                 Color src_color_with_alpha = Color::from_rgba(state.src[x]);
@@ -790,6 +979,38 @@ static void do_blit_with_opacity(BlitState& state)
     }
 }
 
+template<size_t lane_count>
+static void do_blit_with_opacity(BlitState& state, BlitState::AlphaState has_alpha)
+{
+    switch (has_alpha) {
+    case BlitState::NoAlpha:
+        return do_blit_with_opacity<BlitState::NoAlpha, lane_count>(state);
+    case BlitState::SrcAlpha:
+        return do_blit_with_opacity<BlitState::SrcAlpha, lane_count>(state);
+    case BlitState::DstAlpha:
+        return do_blit_with_opacity<BlitState::DstAlpha, lane_count>(state);
+    case BlitState::BothAlpha:
+        return do_blit_with_opacity<BlitState::BothAlpha, lane_count>(state);
+    }
+    VERIFY_NOT_REACHED();
+}
+
+#if ARCH(X86_64)
+[[gnu::target("avx2"), gnu::flatten]] static void do_blit_with_opacity_avx2(BlitState& state, BlitState::AlphaState has_alpha)
+{
+    do_blit_with_opacity<8>(state, has_alpha);
+}
+#endif
+
+static void do_blit_with_opacity(BlitState& state, BlitState::AlphaState has_alpha)
+{
+#if ARCH(X86_64)
+    if (should_use_avx2())
+        return do_blit_with_opacity_avx2(state, has_alpha);
+#endif
+    do_blit_with_opacity<4>(state, has_alpha);
+}
+
 void Painter::blit_with_opacity(IntPoint const& position, Gfx::Bitmap const& source, IntRect const& a_src_rect, float opacity, bool apply_alpha)
 {
     VERIFY(scale() >= source.scale() && "painter doesn't support downsampling scale factors");
@@ -826,17 +1047,12 @@ void Painter::blit_with_opacity(IntPoint const& position, Gfx::Bitmap const& sou
         .opacity = opacity
     };
 
-    if (source.has_alpha_channel() && apply_alpha) {
-        if (m_target->has_alpha_channel())
-            do_blit_with_opacity<BlitState::BothAlpha>(blit_state);
-        else
-            do_blit_with_opacity<BlitState::SrcAlpha>(blit_state);
-    } else {
-        if (m_target->has_alpha_channel())
-            do_blit_with_opacity<BlitState::DstAlpha>(blit_state);
-        else
-            do_blit_with_opacity<BlitState::NoAlpha>(blit_state);
-    }
+    int has_alpha = BlitState::NoAlpha;
+    if (source.has_alpha_channel() && apply_alpha)
+        has_alpha |= BlitState::SrcAlpha;
+    if (m_target->has_alpha_channel())
+        has_alpha |= BlitState::DstAlpha;
+    do_blit_with_opacity(blit_state, static_cast<BlitState::AlphaState>(has_alpha));
 }
 
 void Painter::blit_filtered(IntPoint const& position, Gfx::Bitmap const& source, IntRect const& src_rect, Function<Color(Color)> filter)
@@ -1013,7 +1229,7 @@ void Painter::blit(IntPoint const& position, Gfx::Bitmap const& source, IntRect
         RGBA32 const* src = source.scanline(src_rect.top() + first_row) + src_rect.left() + first_column;
         size_t const src_skip = source.pitch() / sizeof(RGBA32);
         for (int row = first_row; row <= last_row; ++row) {
-            fast_u32_copy(dst, src, clipped_rect.width());
+            copy_pixels(dst, src, clipped_rect.width());
             dst += dst_skip;
             src += src_skip;
         }
@@ -1147,9 +1363,35 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
     case Painter::ScalingMode::BilinearBlend:
         do_draw_scaled_bitmap<has_alpha_channel, true>(target, dst_rect, clipped_rect, source, src_rect, get_pixel, opacity);
         break;
+    case Painter::ScalingMode::BoxSampling:
+    case Painter::ScalingMode::Lanczos:
+        VERIFY_NOT_REACHED();
     }
 }
 
+static void do_draw_resampled_bitmap(Gfx::Bitmap& target, IntRect const& dst_rect, IntRect const& clipped_rect, Gfx::Bitmap const& source, FloatRect const& src_rect, float opacity, Painter::ScalingMode scaling_mode)
+{
+    auto filter = scaling_mode == Painter::ScalingMode::Lanczos ? Resampler::Filter::Lanczos3 : Resampler::Filter::Box;
+    bool has_alpha = source.has_alpha_channel() || opacity != 1.0f;
+    Resampler::resample(source, src_rect, dst_rect, clipped_rect, filter, [&](int y, Span<RGBA32 const> row) {
+        auto* dst = target.scanline(y) + clipped_rect.left();
+        if (!has_alpha) {
+            copy_pixels(dst, row.data(), static_cast<int>(row.size()));
+            return;
+        }
+        BlitState blit_state {
+            .src = row.data(),
+            .dst = dst,
+            .src_pitch = 0,
+            .dst_pitch = 0,
+            .row_count = 1,
+            .column_count = static_cast<int>(row.size()),
+            .opacity = opacity
+        };
+        do_blit_with_opacity(blit_state, target.has_alpha_channel() ? BlitState::BothAlpha : BlitState::SrcAlpha);
+    });
+}
+
 void Painter::draw_scaled_bitmap(IntRect const& a_dst_rect, Gfx::Bitmap const& source, IntRect const& a_src_rect, float opacity, ScalingMode scaling_mode)
 {
     draw_scaled_bitmap(a_dst_rect, source, FloatRect { a_src_rect }, opacity, scaling_mode);
@@ -1167,6 +1409,9 @@ void Painter::draw_scaled_bitmap(IntRect const& a_dst_rect, Gfx::Bitmap const& s
     if (clipped_rect.is_empty())
         return;
 
+    if (scaling_mode == ScalingMode::BoxSampling || scaling_mode == ScalingMode::Lanczos)
+        return do_draw_resampled_bitmap(*m_target, dst_rect, clipped_rect, source, src_rect, opacity, scaling_mode);
+
     if (source.has_alpha_channel() || opacity != 1.0f) {
         switch (source.format()) {
         case BitmapFormat::BGRx8888:
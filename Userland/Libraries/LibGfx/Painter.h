@@ -36,6 +36,10 @@ public:
     enum class ScalingMode {
         NearestNeighbor,
         BilinearBlend,
+        // Averages all the source pixels that make up a destination pixel, which keeps strong downscales from aliasing.
+        BoxSampling,
+        // Sharper than box sampling when scaling down, and smoother than bilinear blending when scaling up.
+        Lanczos,
     };
 
     void clear_rect(IntRect const&, Color);
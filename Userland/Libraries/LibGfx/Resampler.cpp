@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Math.h>
+#include <AK/SIMD.h>
+#include <AK/Vector.h>
+#include <LibGfx/Resampler.h>
+
+namespace Gfx {
+
+using AK::SIMD::f32x4;
+
+namespace {
+
+// The weights of the source pixels that make up every destination pixel along one axis.
+class ResamplingWeights {
+public:
+    ResamplingWeights(Resampler::Filter filter, float source_start, float source_size, int source_limit, int destination_size, int first_destination, int destination_count)
+    {
+        float scale = source_size / destination_size;
+
+        // When scaling down, the filter is stretched to cover all the source pixels that end up in a destination pixel.
+        float filter_scale = max(scale, 1.0f);
+        float support = filter == Resampler::Filter::Box ? scale / 2 : 3 * filter_scale;
+        // The horizontal pass goes through the taps four at a time, the weights that pad them out are 0.
+        m_max_taps = round_up_to_power_of_two(static_cast<int>(ceilf(2 * support)) + 2, 4);
+
+        // Samples beyond the edges of the source rect are taken from its outermost pixels.
+        int first_source = clamp(static_cast<int>(floorf(source_start)), 0, source_limit - 1);
+        int last_source = clamp(static_cast<int>(ceilf(source_start + source_size)) - 1, first_source, source_limit - 1);
+
+        m_first_index.resize(destination_count);
+        m_tap_count.resize(destination_count);
+        m_weights.resize(destination_count * m_max_taps);
+
+        for (int i = 0; i < destination_count; ++i) {
+            auto* weights = &m_weights[i * m_max_taps];
+            for (int tap = 0; tap < m_max_taps; ++tap)
+                weights[tap] = 0;
+
+            // The source pixels with a weight are those whose centers lie within the support around the center of
+            // the destination pixel. As the centers only grow, so do the first and last index, which Resampler
+            // relies on to only keep a few filtered rows around.
+            float center = source_start + (first_destination + i + 0.5f) * scale;
+            int start = static_cast<int>(floorf(center - 0.5f - support));
+            int end = static_cast<int>(ceilf(center - 0.5f + support));
+            int first_index = clamp(start, first_source, last_source);
+            int last_index = clamp(end, first_source, last_source);
+            VERIFY(last_index - first_index < m_max_taps);
+
+            float total = 0;
+            for (int source = start; source <= end; ++source) {
+                float weight = filter == Resampler::Filter::Box
+                    ? box_weight(source, center - scale / 2, center + scale / 2)
+                    : lanczos3_weight((source + 0.5f - center) / filter_scale);
+                weights[clamp(source, first_index, last_index) - first_index] += weight;
+                total += weight;
+            }
+
+            // Normalizing keeps flat areas flat, even where the weights don't quite add up to one.
+            for (int tap = 0; tap < m_max_taps; ++tap)
+                weights[tap] /= total;
+
+            m_first_index[i] = first_index;
+            m_tap_count[i] = last_index - first_index + 1;
+        }
+    }
+
+    int max_taps() const { return m_max_taps; }
+    int first_index(int i) const { return m_first_index[i]; }
+    int last_index(int i) const { return m_first_index[i] + m_tap_count[i] - 1; }
+    int tap_count(int i) const { return m_tap_count[i]; }
+    float const* weights(int i) const { return &m_weights[i * m_max_taps]; }
+
+private:
+    // How much of the source pixel lies within the area from `start` to `end`.
+    static float box_weight(int source, float start, float end)
+    {
+        return max(0.0f, min<float>(source + 1, end) - max<float>(source, start));
+    }
+
+    static float sinc(float x)
+    {
+        if (x == 0)
+            return 1;
+        x *= AK::Pi<float>;
+        return AK::sin(x) / x;
+    }
+
+    static float lanczos3_weight(float x)
+    {
+        if (x <= -3 || x >= 3)
+            return 0;
+        return sinc(x) * sinc(x / 3);
+    }
+
+    int m_max_taps { 0 };
+    Vector<int> m_first_index;
+    Vector<int> m_tap_count;
+    Vector<float> m_weights;
+};
+
+}
+
+// Colors are filtered with premultiplied alpha, so that the colors of transparent pixels don't show up in the
+// result. Every pixel is a vector of its blue, green, red and alpha values, which the filter works on at once.
+static ALWAYS_INLINE f32x4 to_premultiplied(Color color)
+{
+    return f32x4 { static_cast<float>(color.blue()), static_cast<float>(color.green()), static_cast<float>(color.red()), 255.0f } * (color.alpha() / 255.0f);
+}
+
+static ALWAYS_INLINE RGBA32 from_premultiplied(f32x4 pixel)
+{
+    // Lanczos can over- and undershoot, so the values are clamped.
+    float alpha = clamp(pixel[3], 0.0f, 255.0f);
+    if (alpha < 0.5f)
+        return 0;
+    auto color = pixel * (255.0f / alpha);
+    auto to_u8 = [](float value) { return static_cast<u32>(clamp(value, 0.0f, 255.0f) + 0.5f); };
+    return (static_cast<u32>(alpha + 0.5f) << 24) | (to_u8(color[2]) << 16) | (to_u8(color[1]) << 8) | to_u8(color[0]);
+}
+
+// Vector::resize() can't value-initialize vector types, so the pixels are appended instead.
+static void resize_pixels(Vector<f32x4>& pixels, size_t size)
+{
+    pixels.ensure_capacity(size);
+    while (pixels.size() < size)
+        pixels.unchecked_append(f32x4 {});
+}
+
+static void read_row(Bitmap const& source, int y, int first_x, int last_x, f32x4* pixels)
+{
+    int count = last_x - first_x + 1;
+    int i = 0;
+    if (source.format() == BitmapFormat::BGRA8888 || source.format() == BitmapFormat::BGRx8888) {
+        // Four pixels at a time are split into vectors of their blue, green, red and alpha values, which are converted
+        // and premultiplied together, and then transposed back into one vector per pixel.
+        bool has_alpha = source.has_alpha_channel();
+        auto const* scanline = source.scanline(y) + first_x;
+        for (; i + 4 <= count; i += 4) {
+            AK::SIMD::u32x4 values;
+            __builtin_memcpy(&values, scanline + i, sizeof(values));
+            auto channel = [&](int shift) { return __builtin_convertvector(__builtin_convertvector((values >> shift) & 0xff, AK::SIMD::i32x4), f32x4); };
+            auto alpha = has_alpha ? channel(24) : f32x4 { 255, 255, 255, 255 };
+            auto factor = alpha / 255.0f;
+            auto blue = channel(0) * factor;
+            auto green = channel(8) * factor;
+            auto red = channel(16) * factor;
+
+            auto blue_green_low = __builtin_shufflevector(blue, green, 0, 4, 1, 5);
+            auto blue_green_high = __builtin_shufflevector(blue, green, 2, 6, 3, 7);
+            auto red_alpha_low = __builtin_shufflevector(red, alpha, 0, 4, 1, 5);
+            auto red_alpha_high = __builtin_shufflevector(red, alpha, 2, 6, 3, 7);
+            pixels[i] = __builtin_shufflevector(blue_green_low, red_alpha_low, 0, 1, 4, 5);
+            pixels[i + 1] = __builtin_shufflevector(blue_green_low, red_alpha_low, 2, 3, 6, 7);
+            pixels[i + 2] = __builtin_shufflevector(blue_green_high, red_alpha_high, 0, 1, 4, 5);
+            pixels[i + 3] = __builtin_shufflevector(blue_green_high, red_alpha_high, 2, 3, 6, 7);
+        }
+    }
+    for (; i < count; ++i)
+        pixels[i] = to_premultiplied(source.get_pixel(first_x + i, y));
+}
+
+void Resampler::resample(Bitmap const& source, FloatRect const& source_rect, IntRect const& destination_rect, IntRect const& clip_rect, Filter filter, Function<void(int y, Span<RGBA32 const>)> callback)
+{
+    auto rect = destination_rect.intersected(clip_rect);
+    if (rect.is_empty() || source_rect.is_empty())
+        return;
+
+    ResamplingWeights columns { filter, source_rect.x(), source_rect.width(), source.physical_width(), destination_rect.width(), rect.left() - destination_rect.left(), rect.width() };
+    ResamplingWeights rows { filter, source_rect.y(), source_rect.height(), source.physical_height(), destination_rect.height(), rect.top() - destination_rect.top(), rect.height() };
+
+    int first_source_x = columns.first_index(0);
+    int last_source_x = columns.last_index(rect.width() - 1);
+    // The source row is padded, so that the horizontal pass can read up to three pixels past its last tap.
+    Vector<f32x4> source_row;
+    resize_pixels(source_row, last_source_x - first_source_x + 4);
+
+    // Source rows are filtered horizontally as the destination rows that need them come up. The rows needed by one
+    // destination row never span more than the vertical tap count, so that many of them are kept around.
+    int ring_size = rows.max_taps();
+    Vector<f32x4> filtered_rows;
+    resize_pixels(filtered_rows, ring_size * rect.width());
+    int next_source_y = rows.first_index(0);
+
+    auto filter_source_row = [&](int source_y) {
+        read_row(source, source_y, first_source_x, last_source_x, source_row.data());
+        auto* filtered_row = &filtered_rows[(source_y % ring_size) * rect.width()];
+        for (int x = 0; x < rect.width(); ++x) {
+            auto const* pixels = &source_row[columns.first_index(x) - first_source_x];
+            auto const* weights = columns.weights(x);
+            // Independent sums keep the additions from waiting on each other.
+            f32x4 sums[4] {};
+            for (int tap = 0; tap < columns.tap_count(x); tap += 4) {
+                sums[0] += pixels[tap] * weights[tap];
+                sums[1] += pixels[tap + 1] * weights[tap + 1];
+                sums[2] += pixels[tap + 2] * weights[tap + 2];
+                sums[3] += pixels[tap + 3] * weights[tap + 3];
+            }
+            filtered_row[x] = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        }
+    };
+
+    Vector<f32x4> sums;
+    resize_pixels(sums, rect.width());
+    Vector<RGBA32> destination_row;
+    destination_row.resize(rect.width());
+
+    for (int y = 0; y < rect.height(); ++y) {
+        for (; next_source_y <= rows.last_index(y); ++next_source_y)
+            filter_source_row(next_source_y);
+
+        for (auto& sum : sums)
+            sum = f32x4 {};
+        auto const* weights = rows.weights(y);
+        for (int tap = 0; tap < rows.tap_count(y); ++tap) {
+            auto const* filtered_row = &filtered_rows[((rows.first_index(y) + tap) % ring_size) * rect.width()];
+            float weight = weights[tap];
+            for (int x = 0; x < rect.width(); ++x)
+                sums[x] += filtered_row[x] * weight;
+        }
+
+        for (int x = 0; x < rect.width(); ++x)
+            destination_row[x] = from_premultiplied(sums[x]);
+        callback(rect.top() + y, destination_row.span());
+    }
+}
+
+}
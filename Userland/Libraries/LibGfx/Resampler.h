@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Span.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Rect.h>
+
+namespace Gfx {
+
+// Scales images with a separable filter: every row is filtered horizontally first, and the filtered rows are
+// then combined vertically. The filter weights for every destination column and row are computed up front.
+class Resampler {
+public:
+    enum class Filter {
+        // Every destination pixel is the average of the source area it covers.
+        Box,
+        // A windowed sinc filter, which keeps images sharper than the box filter, but may ring around hard edges.
+        Lanczos3,
+    };
+
+    // Scales `source_rect` of the bitmap to the size of `destination_rect`, and calls `callback` with every
+    // row of the result that lies within `clip_rect`. Pixel coordinates are physical.
+    static void resample(Bitmap const& source, FloatRect const& source_rect, IntRect const& destination_rect, IntRect const& clip_rect, Filter, Function<void(int y, Span<RGBA32 const>)> callback);
+};
+
+}
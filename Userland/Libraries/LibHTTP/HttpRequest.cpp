@@ -164,6 +164,7 @@ Optional<HttpRequest> HttpRequest::from_raw_request(ReadonlyBytes raw_request)
         return {};
 
     request.m_resource = URL::percent_decode(resource);
+    request.m_protocol = move(protocol);
     request.m_headers = move(headers);
 
     return request;
@@ -38,6 +38,7 @@ public:
     ~HttpRequest();
 
     String const& resource() const { return m_resource; }
+    String const& protocol() const { return m_protocol; }
     Vector<Header> const& headers() const { return m_headers; }
 
     URL const& url() const { return m_url; }
@@ -61,6 +62,7 @@ public:
 private:
     URL m_url;
     String m_resource;
+    String m_protocol;
     Method m_method { GET };
     Vector<Header> m_headers;
     ByteBuffer m_body;
@@ -30,7 +30,8 @@ class Client final
     IPC_CLIENT_CONNECTION(Client, "/tmp/portal/image");
 
 public:
-    Optional<DecodedImage> decode_image(ReadonlyBytes);
+    // With a target size, the frames may come back scaled down to anything that still covers it.
+    Optional<DecodedImage> decode_image(ReadonlyBytes, Gfx::IntSize target_size = {});
 
     Function<void()> on_death;
 
@@ -533,7 +533,7 @@ void ObjectExpression::generate_bytecode(Bytecode::Generator& generator) const
             Bytecode::IdentifierTableIndex key_name = generator.intern_identifier(string_literal.value());
 
             property.value().generate_bytecode(generator);
-            generator.emit<Bytecode::Op::PutById>(object_reg, key_name);
+            generator.emit<Bytecode::Op::PutById>(object_reg, key_name, generator.next_property_lookup_cache());
         } else {
             property.key().generate_bytecode(generator);
             auto property_reg = generator.allocate_register();
@@ -620,7 +620,7 @@ static void generate_object_binding_pattern_bytecode(Bytecode::Generator& genera
             }
 
             generator.emit<Bytecode::Op::Load>(value_reg);
-            generator.emit<Bytecode::Op::GetById>(generator.intern_identifier(identifier));
+            generator.emit<Bytecode::Op::GetById>(generator.intern_identifier(identifier), generator.next_property_lookup_cache());
         } else {
             auto expression = name.get<NonnullRefPtr<Expression>>();
             expression->generate_bytecode(generator);
@@ -876,7 +876,7 @@ void CallExpression::generate_bytecode(Bytecode::Generator& generator) const
                 generator.emit<Bytecode::Op::GetByValue>(this_reg);
             } else {
                 auto identifier_table_ref = generator.intern_identifier(verify_cast<Identifier>(member_expression.property()).string());
-                generator.emit<Bytecode::Op::GetById>(identifier_table_ref);
+                generator.emit<Bytecode::Op::GetById>(identifier_table_ref, generator.next_property_lookup_cache());
             }
             generator.emit<Bytecode::Op::Store>(callee_reg);
         }
@@ -1085,7 +1085,7 @@ void TaggedTemplateLiteral::generate_bytecode(Bytecode::Generator& generator) co
     generator.emit<Bytecode::Op::Store>(raw_strings_reg);
 
     generator.emit<Bytecode::Op::Load>(strings_reg);
-    generator.emit<Bytecode::Op::PutById>(raw_strings_reg, generator.intern_identifier("raw"));
+    generator.emit<Bytecode::Op::PutById>(raw_strings_reg, generator.intern_identifier("raw"), generator.next_property_lookup_cache());
 
     generator.emit<Bytecode::Op::LoadImmediate>(js_undefined());
     auto this_reg = generator.allocate_register();
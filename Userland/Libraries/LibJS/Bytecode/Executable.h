@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <AK/FixedArray.h>
 #include <AK/FlyString.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
+#include <LibJS/Bytecode/PropertyLookupCache.h>
 #include <LibJS/Bytecode/StringTable.h>
 
 namespace JS::Bytecode {
@@ -19,6 +21,8 @@ struct Executable {
     NonnullOwnPtrVector<BasicBlock> basic_blocks;
     NonnullOwnPtr<StringTable> string_table;
     NonnullOwnPtr<IdentifierTable> identifier_table;
+    // NOTE: These live outside of the instruction stream, as optimization passes copy instructions around bytewise.
+    mutable FixedArray<PropertyLookupCache> property_lookup_caches;
     size_t number_of_registers { 0 };
 
     String const& get_string(StringTableIndex index) const { return string_table->get(index); }
@@ -50,6 +50,7 @@ NonnullOwnPtr<Executable> Generator::generate(ASTNode const& node, FunctionKind
         .basic_blocks = move(generator.m_root_basic_blocks),
         .string_table = move(generator.m_string_table),
         .identifier_table = move(generator.m_identifier_table),
+        .property_lookup_caches = FixedArray<PropertyLookupCache>::must_create_but_fixme_should_propagate_errors(generator.m_next_property_lookup_cache),
         .number_of_registers = generator.m_next_register });
 }
 
@@ -118,7 +119,7 @@ void Generator::emit_load_from_reference(JS::ASTNode const& node)
             emit<Bytecode::Op::GetByValue>(object_reg);
         } else {
             auto identifier_table_ref = intern_identifier(verify_cast<Identifier>(expression.property()).string());
-            emit<Bytecode::Op::GetById>(identifier_table_ref);
+            emit<Bytecode::Op::GetById>(identifier_table_ref, next_property_lookup_cache());
         }
         return;
     }
@@ -152,7 +153,7 @@ void Generator::emit_store_to_reference(JS::ASTNode const& node)
         } else {
             emit<Bytecode::Op::Load>(value_reg);
             auto identifier_table_ref = intern_identifier(verify_cast<Identifier>(expression.property()).string());
-            emit<Bytecode::Op::PutById>(object_reg, identifier_table_ref);
+            emit<Bytecode::Op::PutById>(object_reg, identifier_table_ref, next_property_lookup_cache());
         }
         return;
     }
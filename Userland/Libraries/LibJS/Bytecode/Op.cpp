@@ -272,14 +272,26 @@ ThrowCompletionOr<void> SetVariable::execute_impl(Bytecode::Interpreter& interpr
 ThrowCompletionOr<void> GetById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto* object = TRY(interpreter.accumulator().to_object(interpreter.global_object()));
-    interpreter.accumulator() = TRY(object->get(interpreter.current_executable().get_identifier(m_property)));
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    if (auto cached_value = cache.get(*object); cached_value.has_value()) {
+        interpreter.accumulator() = cached_value.release_value();
+        return {};
+    }
+    auto const& property_name = interpreter.current_executable().get_identifier(m_property);
+    interpreter.accumulator() = TRY(object->get(property_name));
+    cache.update_after_get(*object, property_name);
     return {};
 }
 
 ThrowCompletionOr<void> PutById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto* object = TRY(interpreter.reg(m_base).to_object(interpreter.global_object()));
-    TRY(object->set(interpreter.current_executable().get_identifier(m_property), interpreter.accumulator(), Object::ShouldThrowExceptions::Yes));
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    if (cache.put(*object, interpreter.accumulator()))
+        return {};
+    auto const& property_name = interpreter.current_executable().get_identifier(m_property);
+    TRY(object->set(property_name, interpreter.accumulator(), Object::ShouldThrowExceptions::Yes));
+    cache.update_after_put(*object, property_name);
     return {};
 }
 
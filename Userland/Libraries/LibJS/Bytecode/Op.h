@@ -318,9 +318,10 @@ private:
 
 class GetById final : public Instruction {
 public:
-    explicit GetById(IdentifierTableIndex property)
+    GetById(IdentifierTableIndex property, u32 cache_index)
         : Instruction(Type::GetById)
         , m_property(property)
+        , m_cache_index(cache_index)
     {
     }
 
@@ -330,14 +331,16 @@ public:
 
 private:
     IdentifierTableIndex m_property;
+    u32 m_cache_index { 0 };
 };
 
 class PutById final : public Instruction {
 public:
-    explicit PutById(Register base, IdentifierTableIndex property)
+    PutById(Register base, IdentifierTableIndex property, u32 cache_index)
         : Instruction(Type::PutById)
         , m_base(base)
         , m_property(property)
+        , m_cache_index(cache_index)
     {
     }
 
@@ -348,6 +351,7 @@ public:
 private:
     Register m_base;
     IdentifierTableIndex m_property;
+    u32 m_cache_index { 0 };
 };
 
 class GetByValue final : public Instruction {
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PropertyLookupCache.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/Shape.h>
+
+namespace JS::Bytecode {
+
+static bool is_cacheable(Object const& object)
+{
+    return !object.shape().is_unique() && !object.may_interfere_with_property_lookup_caches();
+}
+
+Optional<Value> PropertyLookupCache::get(Object const& object) const
+{
+    auto const* shape = &object.shape();
+    for (auto const& entry : m_entries) {
+        if (entry.shape.ptr() != shape)
+            continue;
+        // NOTE: Different kinds of objects can share a shape, so this has to be checked for every hit.
+        if (object.may_interfere_with_property_lookup_caches())
+            return {};
+        auto const* holder = &object;
+        if (entry.prototype_shape) {
+            // NOTE: The prototype is part of the (non-unique) shape, so it's the same object we saw when populating the cache.
+            holder = shape->prototype();
+            if (entry.prototype_shape.ptr() != &holder->shape())
+                return {};
+        }
+        // NOTE: Turning a data property into an accessor with the same attributes doesn't transition the shape.
+        auto value = holder->get_direct(entry.property_offset);
+        if (value.is_accessor())
+            return {};
+        return value.value_or(js_undefined());
+    }
+    return {};
+}
+
+void PropertyLookupCache::update_after_get(Object const& object, FlyString const& property_name)
+{
+    if (!is_cacheable(object))
+        return;
+
+    auto& shape = object.shape();
+    StringOrSymbol key { property_name };
+
+    if (auto metadata = shape.lookup(key); metadata.has_value()) {
+        if (object.get_direct(metadata->offset).is_accessor())
+            return;
+        add_entry({ shape.make_weak_ptr(), {}, metadata->offset });
+        return;
+    }
+
+    // Exotic objects like arrays have own properties that are not part of their shape (e.g. "length"),
+    // make sure we're not about to cache a property that would actually be shadowed by one of those.
+    auto own_property = object.internal_get_own_property(key);
+    if (own_property.is_error() || own_property.value().has_value())
+        return;
+
+    auto const* prototype = shape.prototype();
+    if (!prototype || !is_cacheable(*prototype))
+        return;
+    auto metadata = prototype->shape().lookup(key);
+    if (!metadata.has_value() || prototype->get_direct(metadata->offset).is_accessor())
+        return;
+    add_entry({ shape.make_weak_ptr(), prototype->shape().make_weak_ptr(), metadata->offset });
+}
+
+bool PropertyLookupCache::put(Object& object, Value value)
+{
+    auto const* shape = &object.shape();
+    for (auto const& entry : m_entries) {
+        if (entry.shape.ptr() != shape)
+            continue;
+        if (object.may_interfere_with_property_lookup_caches())
+            return false;
+        // NOTE: Entries for stores are only ever created for writable own data properties.
+        VERIFY(!entry.prototype_shape);
+        if (object.get_direct(entry.property_offset).is_accessor())
+            return false;
+        object.put_direct(entry.property_offset, value);
+        return true;
+    }
+    return false;
+}
+
+void PropertyLookupCache::update_after_put(Object const& object, FlyString const& property_name)
+{
+    if (!is_cacheable(object))
+        return;
+
+    auto& shape = object.shape();
+    auto metadata = shape.lookup(StringOrSymbol { property_name });
+    if (!metadata.has_value() || !metadata->attributes.is_writable())
+        return;
+    if (object.get_direct(metadata->offset).is_accessor())
+        return;
+    add_entry({ shape.make_weak_ptr(), {}, metadata->offset });
+}
+
+void PropertyLookupCache::add_entry(Entry entry)
+{
+    for (auto& existing_entry : m_entries) {
+        if (!existing_entry.shape || existing_entry.shape.ptr() == entry.shape.ptr()) {
+            existing_entry = move(entry);
+            return;
+        }
+    }
+    // All slots are taken by live shapes, this access site is megamorphic. Replace entries round-robin.
+    m_entries[m_next_entry_to_replace] = move(entry);
+    m_next_entry_to_replace = (m_next_entry_to_replace + 1) % max_number_of_shapes;
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/FlyString.h>
+#include <AK/Optional.h>
+#include <AK/WeakPtr.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+// A small polymorphic inline cache for named property accesses, keyed on the Shape of the accessed object.
+// Each entry remembers where a data property lives for one shape, either in the object itself or in its direct prototype.
+// Shapes are held weakly, and only non-unique shapes are cached: those never change in place, so any
+// transition (adding, reconfiguring or deleting a property, changing the prototype) yields a different Shape
+// and automatically misses the cache.
+class PropertyLookupCache {
+public:
+    static constexpr size_t max_number_of_shapes = 4;
+
+    Optional<Value> get(Object const&) const;
+    void update_after_get(Object const&, FlyString const& property_name);
+
+    bool put(Object&, Value);
+    void update_after_put(Object const&, FlyString const& property_name);
+
+private:
+    struct Entry {
+        WeakPtr<Shape> shape;
+        // Only set if the property was found on the direct prototype of an object with `shape`.
+        WeakPtr<Shape> prototype_shape;
+        u32 property_offset { 0 };
+    };
+
+    void add_entry(Entry);
+
+    AK::Array<Entry, max_number_of_shapes> m_entries;
+    u8 m_next_entry_to_replace { 0 };
+};
+
+}
@@ -162,6 +162,7 @@ class Interpreter;
 class Module;
 class NativeFunction;
 class ObjectEnvironment;
+class ParallelMarker;
 class PrimitiveString;
 class PromiseReaction;
 class PromiseReactionJob;
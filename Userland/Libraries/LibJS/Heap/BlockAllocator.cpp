@@ -5,6 +5,7 @@
  */
 
 #include <AK/Platform.h>
+#include <AK/QuickSort.h>
 #include <AK/Random.h>
 #include <AK/Vector.h>
 #include <LibJS/Heap/BlockAllocator.h>
@@ -23,25 +24,41 @@ BlockAllocator::BlockAllocator()
 
 BlockAllocator::~BlockAllocator()
 {
-    for (auto* block : m_blocks) {
-        ASAN_UNPOISON_MEMORY_REGION(block, HeapBlock::block_size);
-#ifdef __serenity__
-        if (munmap(block, HeapBlock::block_size) < 0) {
-            perror("munmap");
-            VERIFY_NOT_REACHED();
-        }
-#else
-        free(block);
-#endif
+    for (auto* block : m_hot_blocks)
+        free_block(block);
+    for (auto* block : m_blocks)
+        free_block(block);
+}
+
+void BlockAllocator::free_block(void* block)
+{
+    ASAN_UNPOISON_MEMORY_REGION(block, HeapBlock::block_size);
+    if (munmap(block, HeapBlock::block_size) < 0) {
+        perror("munmap");
+        VERIFY_NOT_REACHED();
     }
 }
 
 void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
 {
-    if (!m_blocks.is_empty()) {
-        // To reduce predictability, take a random block from the cache.
-        size_t random_index = get_random_uniform(m_blocks.size());
-        auto* block = m_blocks.unstable_take(random_index);
+    // To reduce predictability, take a random block from the cache.
+    // Hot blocks are still backed by memory, so we prefer those over decommitted ones.
+    void* block = nullptr;
+    if (!m_hot_blocks.is_empty()) {
+        block = m_hot_blocks.unstable_take(get_random_uniform(m_hot_blocks.size()));
+    } else if (!m_blocks.is_empty()) {
+        block = m_blocks.unstable_take(get_random_uniform(m_blocks.size()));
+#ifdef __serenity__
+        // Whether or not the block was purged doesn't matter, as it gets a new HeapBlock constructed in it anyway.
+        // But if the kernel can't commit its memory again, it stays volatile and is of no use to us.
+        if (madvise(block, HeapBlock::block_size, MADV_SET_NONVOLATILE) < 0) {
+            free_block(block);
+            block = nullptr;
+        }
+#endif
+    }
+
+    if (block) {
         ASAN_UNPOISON_MEMORY_REGION(block, HeapBlock::block_size);
 #ifdef __serenity__
         if (set_mmap_name(block, HeapBlock::block_size, name) < 0) {
@@ -53,11 +70,22 @@ void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
     }
 
 #ifdef __serenity__
-    auto* block = (HeapBlock*)serenity_mmap(nullptr, HeapBlock::block_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_RANDOMIZED | MAP_PRIVATE, 0, 0, HeapBlock::block_size, name);
+    block = serenity_mmap(nullptr, HeapBlock::block_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_RANDOMIZED | MAP_PRIVATE | MAP_PURGEABLE, 0, 0, HeapBlock::block_size, name);
     VERIFY(block != MAP_FAILED);
 #else
-    auto* block = (HeapBlock*)aligned_alloc(HeapBlock::block_size, HeapBlock::block_size);
-    VERIFY(block);
+    // Blocks are mapped rather than taken from malloc(), so that decommitting them never touches memory that malloc() owns.
+    // mmap() only aligns to pages, so map twice the size and unmap whatever lies outside the aligned block.
+    auto* mapping = static_cast<u8*>(mmap(nullptr, 2 * HeapBlock::block_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+    VERIFY(mapping != MAP_FAILED);
+    auto* aligned_block = reinterpret_cast<u8*>(align_up_to(reinterpret_cast<FlatPtr>(mapping), HeapBlock::block_size));
+    auto* block_end = aligned_block + HeapBlock::block_size;
+    auto* mapping_end = mapping + 2 * HeapBlock::block_size;
+    if ((aligned_block != mapping && munmap(mapping, aligned_block - mapping) < 0)
+        || (block_end != mapping_end && munmap(block_end, mapping_end - block_end) < 0)) {
+        perror("munmap");
+        VERIFY_NOT_REACHED();
+    }
+    block = aligned_block;
 #endif
     return block;
 }
@@ -65,20 +93,47 @@ void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
 void BlockAllocator::deallocate_block(void* block)
 {
     VERIFY(block);
-    if (m_blocks.size() >= max_cached_blocks) {
+    if (m_hot_blocks.size() + m_blocks.size() >= max_cached_blocks) {
+        free_block(block);
+        return;
+    }
+
+    ASAN_POISON_MEMORY_REGION(block, HeapBlock::block_size);
+    m_hot_blocks.append(block);
+    if (m_hot_blocks.size() >= max_hot_blocks)
+        decommit_hot_blocks();
+}
+
+void BlockAllocator::decommit_hot_blocks()
+{
+    if (m_hot_blocks.is_empty())
+        return;
+
 #ifdef __serenity__
-        if (munmap(block, HeapBlock::block_size) < 0) {
-            perror("munmap");
+    // Every block is a separate region, which has to be made volatile by itself.
+    for (auto* block : m_hot_blocks) {
+        if (madvise(block, HeapBlock::block_size, MADV_SET_VOLATILE) < 0) {
+            perror("madvise");
             VERIFY_NOT_REACHED();
         }
+    }
 #else
-        free(block);
-#endif
-        return;
+    // Adjacent blocks are decommitted together, to keep the number of syscalls down.
+    quick_sort(m_hot_blocks);
+    for (size_t i = 0; i < m_hot_blocks.size();) {
+        auto* range_start = static_cast<u8*>(m_hot_blocks[i]);
+        size_t range_size = 0;
+        for (; i < m_hot_blocks.size() && m_hot_blocks[i] == range_start + range_size; ++i)
+            range_size += HeapBlock::block_size;
+        if (madvise(range_start, range_size, MADV_DONTNEED) < 0) {
+            perror("madvise");
+            VERIFY_NOT_REACHED();
+        }
     }
+#endif
 
-    ASAN_POISON_MEMORY_REGION(block, HeapBlock::block_size);
-    m_blocks.append(block);
+    for (auto* block : m_hot_blocks)
+        m_blocks.append(block);
+    m_hot_blocks.clear();
 }
-
 }
@@ -19,9 +19,17 @@ public:
     void* allocate_block(char const* name);
     void deallocate_block(void*);
 
+    // Tells the kernel that it may reclaim the memory of the blocks that were deallocated since the last call.
+    void decommit_hot_blocks();
+
 private:
+    void free_block(void*);
+
     static constexpr size_t max_cached_blocks = 512;
+    static constexpr size_t max_hot_blocks = 64;
 
+    // Deallocated blocks are first kept around as they are, and decommitted in bulk later on.
+    Vector<void*, max_hot_blocks> m_hot_blocks;
     Vector<void*, max_cached_blocks> m_blocks;
 };
 
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Format.h>
 #include <AK/Forward.h>
 #include <AK/Noncopyable.h>
@@ -24,7 +25,16 @@ public:
     bool is_marked() const { return m_mark; }
     void set_marked(bool b) { m_mark = b; }
 
-    enum class State {
+    // Marks the cell, and returns whether it wasn't marked before.
+    // Unlike set_marked(), this may be called on the same cell from several marking threads at once.
+    bool try_mark_atomically()
+    {
+        if (AK::atomic_load(&m_mark, AK::memory_order_relaxed))
+            return false;
+        return !AK::atomic_exchange(&m_mark, true, AK::memory_order_relaxed);
+    }
+
+    enum class State : u8 {
         Live,
         Dead,
     };
@@ -58,8 +68,9 @@ protected:
     Cell() { }
 
 private:
-    bool m_mark : 1 { false };
-    State m_state : 7 { State::Live };
+    // The mark lives in a byte of its own, so that it can be set atomically without touching the state.
+    bool m_mark { false };
+    State m_state { State::Live };
 };
 
 }
@@ -18,11 +18,16 @@
 #include <LibJS/Runtime/Object.h>
 #include <LibJS/Runtime/WeakContainer.h>
 #include <setjmp.h>
+#include <unistd.h>
 
 #ifdef __serenity__
 #    include <serenity.h>
 #endif
 
+#ifdef JS_PARALLEL_MARKING
+#    include <LibJS/Heap/ParallelMarker.h>
+#endif
+
 namespace JS {
 
 #ifdef __serenity__
@@ -49,6 +54,11 @@ Heap::Heap(VM& vm)
     m_allocators.append(make<CellAllocator>(512));
     m_allocators.append(make<CellAllocator>(1024));
     m_allocators.append(make<CellAllocator>(3072));
+
+#ifdef JS_PARALLEL_MARKING
+    auto online_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    set_marking_thread_count(clamp(online_processors > 0 ? static_cast<size_t>(online_processors) : 1, 1, default_max_marking_thread_count));
+#endif
 }
 
 Heap::~Heap()
@@ -71,9 +81,17 @@ Cell* Heap::allocate_cell(size_t size)
 {
     if (should_collect_on_every_allocation()) {
         collect_garbage();
+    } else if (m_incremental_marking_in_progress) {
+        if (++m_allocations_since_last_marking_step >= incremental_marking_step_interval) {
+            m_allocations_since_last_marking_step = 0;
+            perform_incremental_marking_step();
+        }
     } else if (m_allocations_since_last_gc > m_max_allocations_between_gc) {
         m_allocations_since_last_gc = 0;
-        collect_garbage();
+        if (m_incremental_marking_enabled)
+            start_incremental_marking();
+        else
+            collect_garbage();
     } else {
         ++m_allocations_since_last_gc;
     }
@@ -92,17 +110,88 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
     perf_event(PERF_EVENT_SIGNPOST, gc_perf_string_id, global_gc_counter++);
 #endif
 
+    auto pause_start_time = Time::now_monotonic();
     auto collection_measurement_timer = Core::ElapsedTimer::start_new();
     if (collection_type == CollectionType::CollectGarbage) {
         if (m_gc_deferrals) {
             m_should_gc_when_deferral_ends = true;
             return;
         }
-        HashTable<Cell*> roots;
-        gather_roots(roots);
-        mark_live_cells(roots);
+        if (m_incremental_marking_in_progress) {
+            // The mutator ran since the roots were gathered, so they have to be looked at again.
+            mark_roots(RescanMarkedRoots::Yes);
+        } else {
+            mark_roots(RescanMarkedRoots::No);
+        }
+        finish_marking();
+    } else if (m_incremental_marking_in_progress) {
+        abandon_incremental_marking();
     }
     sweep_dead_cells(print_report, collection_measurement_timer);
+    m_block_allocator.decommit_hot_blocks();
+    record_pause_time(pause_start_time);
+}
+
+void Heap::set_incremental_marking_enabled(bool enabled)
+{
+    m_incremental_marking_enabled = enabled;
+    if (!enabled && m_incremental_marking_in_progress)
+        collect_garbage();
+}
+
+void Heap::start_incremental_marking()
+{
+    VERIFY(!m_incremental_marking_in_progress);
+    if (m_gc_deferrals) {
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
+    VERIFY(!m_collecting_garbage);
+    TemporaryChange change(m_collecting_garbage, true);
+    auto pause_start_time = Time::now_monotonic();
+
+    dbgln_if(HEAP_DEBUG, "start_incremental_marking:");
+    mark_roots(RescanMarkedRoots::No);
+    m_incremental_marking_in_progress = true;
+    m_allocations_since_last_marking_step = 0;
+
+    record_pause_time(pause_start_time);
+}
+
+void Heap::perform_incremental_marking_step()
+{
+    VERIFY(m_incremental_marking_in_progress);
+    // The cells of a DeferGC scope may be incomplete, so we leave them alone until it ends.
+    if (m_gc_deferrals)
+        return;
+
+    {
+        VERIFY(!m_collecting_garbage);
+        TemporaryChange change(m_collecting_garbage, true);
+        auto pause_start_time = Time::now_monotonic();
+
+        dbgln_if(HEAP_DEBUG, "perform_incremental_marking_step: {} cells on the mark stack", m_mark_stack.size());
+        process_mark_stack(incremental_marking_step_size);
+
+        record_pause_time(pause_start_time);
+    }
+
+    if (m_mark_stack.is_empty())
+        collect_garbage();
+}
+
+void Heap::abandon_incremental_marking()
+{
+    dbgln_if(HEAP_DEBUG, "abandon_incremental_marking:");
+    m_mark_stack.clear();
+    for_each_block([&](auto& block) {
+        block.template for_each_cell_in_state<Cell::State::Live>([](Cell* cell) {
+            cell->set_marked(false);
+        });
+        return IterationDecision::Continue;
+    });
+    m_incremental_marking_in_progress = false;
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -173,7 +262,10 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
 
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    MarkingVisitor() { }
+    explicit MarkingVisitor(Vector<Cell*>& mark_stack)
+        : m_mark_stack(mark_stack)
+    {
+    }
 
     virtual void visit_impl(Cell& cell) override
     {
@@ -182,17 +274,91 @@ public:
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
 
         cell.set_marked(true);
-        cell.visit_edges(*this);
+        m_mark_stack.append(&cell);
     }
+
+private:
+    Vector<Cell*>& m_mark_stack;
 };
 
-void Heap::mark_live_cells(const HashTable<Cell*>& roots)
+void Heap::mark_roots(RescanMarkedRoots rescan_marked_roots)
 {
-    dbgln_if(HEAP_DEBUG, "mark_live_cells:");
+    dbgln_if(HEAP_DEBUG, "mark_roots:");
 
-    MarkingVisitor visitor;
-    for (auto* root : roots)
-        visitor.visit(root);
+    HashTable<Cell*> roots;
+    gather_roots(roots);
+
+    for (auto* root : roots) {
+        if (!root)
+            continue;
+        if (root->is_marked()) {
+            // Roots may have been modified without write barrier while the cells they reference
+            // were being marked, e.g. while being initialized.
+            if (rescan_marked_roots == RescanMarkedRoots::Yes)
+                m_mark_stack.append(root);
+            continue;
+        }
+        root->set_marked(true);
+        m_mark_stack.append(root);
+    }
+}
+
+void Heap::mark_cell(Cell& cell)
+{
+    if (cell.is_marked())
+        return;
+    cell.set_marked(true);
+    m_mark_stack.append(&cell);
+}
+
+void Heap::process_mark_stack(size_t max_cell_count)
+{
+    MarkingVisitor visitor(m_mark_stack);
+    for (size_t i = 0; i < max_cell_count && !m_mark_stack.is_empty(); ++i)
+        m_mark_stack.take_last()->visit_edges(visitor);
+}
+
+size_t Heap::marking_thread_count() const
+{
+#ifdef JS_PARALLEL_MARKING
+    if (m_parallel_marker)
+        return m_parallel_marker->thread_count();
+#endif
+    return 1;
+}
+
+void Heap::set_marking_thread_count(size_t thread_count)
+{
+    VERIFY(thread_count >= 1);
+    VERIFY(!m_collecting_garbage);
+#ifdef JS_PARALLEL_MARKING
+    if (thread_count == marking_thread_count())
+        return;
+    if (thread_count == 1)
+        m_parallel_marker = nullptr;
+    else
+        m_parallel_marker = make<ParallelMarker>(thread_count);
+#endif
+}
+
+void Heap::finish_marking()
+{
+    dbgln_if(HEAP_DEBUG, "finish_marking:");
+
+    auto marking_start_time = Time::now_monotonic();
+#ifdef JS_PARALLEL_MARKING
+    if (m_parallel_marker)
+        m_parallel_marker->mark(m_mark_stack);
+    else
+#endif
+        process_mark_stack();
+    m_last_marking_time = Time::now_monotonic() - marking_start_time;
+
+    if constexpr (INCREMENTAL_GC_DEBUG) {
+        if (m_incremental_marking_in_progress)
+            verify_incremental_marking();
+    }
+    m_incremental_marking_in_progress = false;
 
     for (auto& inverse_root : m_uprooted_cells)
         inverse_root->set_marked(false);
@@ -200,6 +366,38 @@ void Heap::mark_live_cells(const HashTable<Cell*>& roots)
     m_uprooted_cells.clear();
 }
 
+// Checks that no marked cell references an unmarked one, which is only the case if nobody forgot to use a write
+// barrier while the heap was being marked incrementally.
+void Heap::verify_incremental_marking()
+{
+    class VerificationVisitor final : public Cell::Visitor {
+    public:
+        virtual void visit_impl(Cell& cell) override
+        {
+            if (cell.is_marked())
+                return;
+            dbgln("Heap: {} is referenced by {}, but wasn't marked", &cell, m_current_cell);
+            ++m_unmarked_cell_count;
+        }
+
+        Cell* m_current_cell { nullptr };
+        size_t m_unmarked_cell_count { 0 };
+    };
+
+    VerificationVisitor visitor;
+    for_each_block([&](auto& block) {
+        block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+            if (!cell->is_marked())
+                return;
+            visitor.m_current_cell = cell;
+            cell->visit_edges(visitor);
+        });
+        return IterationDecision::Continue;
+    });
+
+    VERIFY(visitor.m_unmarked_cell_count == 0);
+}
+
 void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
 {
     dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
@@ -274,6 +472,36 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
     }
 }
 
+void Heap::record_pause_time(Time const& pause_start_time)
+{
+    auto pause_time = (Time::now_monotonic() - pause_start_time).to_microseconds();
+
+    size_t bucket = 0;
+    while (bucket < pause_time_bucket_limits.size() && pause_time > pause_time_bucket_limits[bucket])
+        ++bucket;
+    ++m_pause_time_histogram[bucket];
+
+    ++m_pause_count;
+    m_total_pause_time_in_microseconds += pause_time;
+    m_longest_pause_time_in_microseconds = max(m_longest_pause_time_in_microseconds, pause_time);
+}
+
+void Heap::dump_pause_time_statistics() const
+{
+    dbgln("Garbage collection pause times");
+    dbgln("=============================================");
+    dbgln("         Pauses: {}", m_pause_count);
+    dbgln("     Total time: {} us", m_total_pause_time_in_microseconds);
+    dbgln("   Longest time: {} us", m_longest_pause_time_in_microseconds);
+    for (size_t bucket = 0; bucket < m_pause_time_histogram.size(); ++bucket) {
+        if (bucket < pause_time_bucket_limits.size())
+            dbgln("    <= {:>6} us: {}", pause_time_bucket_limits[bucket], m_pause_time_histogram[bucket]);
+        else
+            dbgln("     > {:>6} us: {}", pause_time_bucket_limits[pause_time_bucket_limits.size() - 1], m_pause_time_histogram[bucket]);
+    }
+    dbgln("=============================================");
+}
+
 void Heap::did_create_handle(Badge<HandleImpl>, HandleImpl& impl)
 {
     VERIFY(!m_handles.contains(impl));
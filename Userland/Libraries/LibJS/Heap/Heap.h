@@ -6,11 +6,15 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Badge.h>
 #include <AK/HashTable.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/NumericLimits.h>
+#include <AK/OwnPtr.h>
+#include <AK/Time.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -19,6 +23,7 @@
 #include <LibJS/Heap/Cell.h>
 #include <LibJS/Heap/CellAllocator.h>
 #include <LibJS/Heap/Handle.h>
+#include <LibJS/Heap/HeapBlock.h>
 #include <LibJS/Heap/MarkedVector.h>
 #include <LibJS/Runtime/Object.h>
 #include <LibJS/Runtime/WeakContainer.h>
@@ -38,7 +43,9 @@ public:
     {
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
-        return static_cast<T*>(memory);
+        auto* cell = static_cast<T*>(memory);
+        revisit_cell(*cell);
+        return cell;
     }
 
     template<typename T, typename... Args>
@@ -48,6 +55,7 @@ public:
         new (memory) T(forward<Args>(args)...);
         auto* cell = static_cast<T*>(memory);
         cell->initialize(global_object);
+        revisit_cell(*cell);
         return cell;
     }
 
@@ -63,6 +71,52 @@ public:
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
     void set_should_collect_on_every_allocation(bool b) { m_should_collect_on_every_allocation = b; }
 
+    // With incremental marking, a collection is started by marking the roots, and the rest of the heap
+    // is then marked in small steps interleaved with allocations. Only the final re-scan of the roots
+    // and the sweep happen in one go.
+    bool is_incremental_marking_enabled() const { return m_incremental_marking_enabled; }
+    void set_incremental_marking_enabled(bool);
+    bool is_incremental_marking_in_progress() const { return m_incremental_marking_in_progress; }
+
+    // While incremental marking is in progress, the marker may already be done with the cell that a
+    // reference is stored into. Code that stores a reference to a cell into another cell (or into
+    // anything reachable only through one) after that cell was initialized has to call this, so the
+    // marker doesn't overlook the referenced cell.
+    static ALWAYS_INLINE void write_barrier(Cell* cell)
+    {
+        if (!cell)
+            return;
+        auto& heap = HeapBlock::from_cell(cell)->heap();
+        if (heap.m_incremental_marking_in_progress) [[unlikely]]
+            heap.mark_cell(*cell);
+    }
+
+    static ALWAYS_INLINE void write_barrier(Value value)
+    {
+        if (value.is_cell())
+            write_barrier(&value.as_cell());
+    }
+
+    // Makes the marker look at all references in the cell again, if it was already done with it.
+    // This is for code that stores lots of references into a cell without calling write_barrier(),
+    // like the initialization of a cell right after its allocation.
+    ALWAYS_INLINE void revisit_cell(Cell& cell)
+    {
+        if (m_incremental_marking_in_progress && cell.is_marked()) [[unlikely]]
+            m_mark_stack.append(&cell);
+    }
+
+    void dump_pause_time_statistics() const;
+
+    // How long it took to visit all reachable cells during the last collection, not counting the roots.
+    Time last_marking_time() const { return m_last_marking_time; }
+
+    // If LibJS was built with ENABLE_JS_PARALLEL_MARKING, the final, non-incremental part of marking is spread
+    // over this many threads, which defaults to the number of CPUs (up to default_max_marking_thread_count).
+    // Otherwise, the heap is always marked on the calling thread, and the thread count stays at 1.
+    size_t marking_thread_count() const;
+    void set_marking_thread_count(size_t);
+
     void did_create_handle(Badge<HandleImpl>, HandleImpl&);
     void did_destroy_handle(Badge<HandleImpl>, HandleImpl&);
 
@@ -84,9 +138,25 @@ private:
 
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(const HashTable<Cell*>& live_cells);
+
+    enum class RescanMarkedRoots {
+        No,
+        Yes,
+    };
+    void mark_roots(RescanMarkedRoots);
+    void mark_cell(Cell&);
+    void process_mark_stack(size_t max_cell_count = NumericLimits<size_t>::max());
+    void finish_marking();
+
+    void start_incremental_marking();
+    void perform_incremental_marking_step();
+    void abandon_incremental_marking();
+    void verify_incremental_marking();
+
     void sweep_dead_cells(bool print_report, const Core::ElapsedTimer&);
 
+    void record_pause_time(Time const& pause_start_time);
+
     CellAllocator& allocator_for_size(size_t);
 
     template<typename Callback>
@@ -103,6 +173,32 @@ private:
 
     bool m_should_collect_on_every_allocation { false };
 
+    // Cells that are marked, but whose edges still have to be visited.
+    Vector<Cell*> m_mark_stack;
+
+    // While marking incrementally, a marking step that visits up to incremental_marking_step_size cells
+    // is performed every incremental_marking_step_interval allocations. The marker thus visits cells
+    // much faster than new ones are allocated, and a cycle ends long before the heap grows large.
+    static constexpr size_t incremental_marking_step_interval = 128;
+    static constexpr size_t incremental_marking_step_size = 2048;
+
+    static constexpr size_t default_max_marking_thread_count = 4;
+#ifdef JS_PARALLEL_MARKING
+    OwnPtr<ParallelMarker> m_parallel_marker;
+#endif
+    Time m_last_marking_time;
+
+    bool m_incremental_marking_enabled { false };
+    bool m_incremental_marking_in_progress { false };
+    size_t m_allocations_since_last_marking_step { 0 };
+
+    // Upper bounds of the buckets of the pause time histogram, in microseconds.
+    static constexpr AK::Array<i64, 9> pause_time_bucket_limits { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 100000 };
+    AK::Array<size_t, pause_time_bucket_limits.size() + 1> m_pause_time_histogram {};
+    size_t m_pause_count { 0 };
+    i64 m_total_pause_time_in_microseconds { 0 };
+    i64 m_longest_pause_time_in_microseconds { 0 };
+
     VM& m_vm;
 
     Vector<NonnullOwnPtr<CellAllocator>> m_allocators;
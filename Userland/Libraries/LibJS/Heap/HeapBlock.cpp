@@ -5,6 +5,7 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/Debug.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/Platform.h>
 #include <LibJS/Heap/Heap.h>
@@ -35,32 +36,49 @@ HeapBlock::HeapBlock(Heap& heap, size_t cell_size)
     : m_heap(heap)
     , m_cell_size(cell_size)
 {
-    VERIFY(cell_size >= sizeof(FreelistEntry));
+    VERIFY(cell_size >= sizeof(DeadCell));
+    VERIFY(cell_count() <= max_cell_count);
     ASAN_POISON_MEMORY_REGION(m_storage, block_size - sizeof(HeapBlock));
 }
 
 void HeapBlock::deallocate(Cell* cell)
 {
     VERIFY(is_valid_cell_pointer(cell));
-    VERIFY(!m_freelist || is_valid_cell_pointer(m_freelist));
     VERIFY(cell->state() == Cell::State::Live);
     VERIFY(!cell->is_marked());
 
     cell->~Cell();
-    auto* freelist_entry = new (cell) FreelistEntry();
-    freelist_entry->set_state(Cell::State::Dead);
-    freelist_entry->next = m_freelist;
-    m_freelist = freelist_entry;
+    auto* dead_cell = new (cell) DeadCell();
+    dead_cell->set_state(Cell::State::Dead);
+
+    auto index = cell_index(cell);
+    m_free_cell_bitmap[index / 64] |= 1ull << (index % 64);
+    m_first_free_cell_word = min(m_first_free_cell_word, index / 64);
+    ++m_free_cell_count;
 
 #ifdef HAS_ADDRESS_SANITIZER
-    auto dword_after_freelist = round_up_to_power_of_two(reinterpret_cast<uintptr_t>(freelist_entry) + sizeof(FreelistEntry), 8);
-    VERIFY((dword_after_freelist - reinterpret_cast<uintptr_t>(freelist_entry)) <= m_cell_size);
-    VERIFY(m_cell_size >= sizeof(FreelistEntry));
-    // We can't poision the cell tracking data, nor the FreeListEntry's vtable or next pointer
-    // This means there's sizeof(FreelistEntry) data at the front of each cell that is always read/write
-    // On x86_64, this ends up being 24 bytes due to the size of the FreeListEntry's vtable, while on x86, it's only 12 bytes.
-    ASAN_POISON_MEMORY_REGION(reinterpret_cast<void*>(dword_after_freelist), m_cell_size - sizeof(FreelistEntry));
+    auto dword_after_dead_cell = round_up_to_power_of_two(reinterpret_cast<uintptr_t>(dead_cell) + sizeof(DeadCell), 8);
+    VERIFY((dword_after_dead_cell - reinterpret_cast<uintptr_t>(dead_cell)) <= m_cell_size);
+    VERIFY(m_cell_size >= sizeof(DeadCell));
+    // We can't poision the cell tracking data, nor the DeadCell's vtable
+    // This means there's sizeof(DeadCell) data at the front of each cell that is always read/write
+    // On x86_64, this ends up being 16 bytes due to the size of the DeadCell's vtable, while on x86, it's only 8 bytes.
+    ASAN_POISON_MEMORY_REGION(reinterpret_cast<void*>(dword_after_dead_cell), m_cell_size - sizeof(DeadCell));
 #endif
 }
 
+size_t HeapBlock::sweep()
+{
+    size_t collected_cells = 0;
+    for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+        if (cell->is_marked()) {
+            cell->set_marked(false);
+            return;
+        }
+        dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
+        deallocate(cell);
+        ++collected_cells;
+    });
+    return collected_cells;
+}
 }
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/BuiltinWrappers.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Platform.h>
 #include <AK/Types.h>
@@ -28,14 +30,14 @@ public:
 
     size_t cell_size() const { return m_cell_size; }
     size_t cell_count() const { return (block_size - sizeof(HeapBlock)) / m_cell_size; }
-    bool is_full() const { return !has_lazy_freelist() && !m_freelist; }
+    bool is_full() const { return !has_lazy_freelist() && !m_free_cell_count; }
+    bool is_empty() const { return m_free_cell_count == m_next_lazy_freelist_index; }
 
     ALWAYS_INLINE Cell* allocate()
     {
         Cell* allocated_cell = nullptr;
-        if (m_freelist) {
-            VERIFY(is_valid_cell_pointer(m_freelist));
-            allocated_cell = exchange(m_freelist, m_freelist->next);
+        if (m_free_cell_count) {
+            allocated_cell = cell(take_first_free_cell_index());
         } else if (has_lazy_freelist()) {
             allocated_cell = cell(m_next_lazy_freelist_index++);
         }
@@ -48,6 +50,10 @@ public:
 
     void deallocate(Cell*);
 
+    // Deallocates all cells that weren't marked, and clears the mark of all others.
+    // Returns the number of deallocated cells.
+    size_t sweep();
+
     template<typename Callback>
     void for_each_cell(Callback callback)
     {
@@ -95,10 +101,8 @@ private:
 
     bool has_lazy_freelist() const { return m_next_lazy_freelist_index < cell_count(); }
 
-    struct FreelistEntry final : public Cell {
-        FreelistEntry* next { nullptr };
-
-        virtual const char* class_name() const override { return "FreelistEntry"; }
+    struct DeadCell final : public Cell {
+        virtual const char* class_name() const override { return "DeadCell"; }
     };
 
     Cell* cell(size_t index)
@@ -106,14 +110,39 @@ private:
         return reinterpret_cast<Cell*>(&m_storage[index * cell_size()]);
     }
 
+    size_t cell_index(Cell const* cell) const
+    {
+        return (reinterpret_cast<FlatPtr>(cell) - reinterpret_cast<FlatPtr>(m_storage)) / m_cell_size;
+    }
+
+    // Free cells are handed out in address order, so that cells allocated in a row end up next to each other.
+    ALWAYS_INLINE size_t take_first_free_cell_index()
+    {
+        for (;; ++m_first_free_cell_word) {
+            VERIFY(m_first_free_cell_word < m_free_cell_bitmap.size());
+            auto& word = m_free_cell_bitmap[m_first_free_cell_word];
+            if (!word)
+                continue;
+            auto bit = count_trailing_zeroes(word);
+            word &= word - 1;
+            --m_free_cell_count;
+            return m_first_free_cell_word * 64 + bit;
+        }
+    }
+
+    // The smallest cell size in use is 16 bytes, so no block holds more cells than this.
+    static constexpr size_t max_cell_count = block_size / 16;
+
     Heap& m_heap;
     size_t m_cell_size { 0 };
     size_t m_next_lazy_freelist_index { 0 };
-    FreelistEntry* m_freelist { nullptr };
+    size_t m_free_cell_count { 0 };
+    size_t m_first_free_cell_word { 0 };
+    AK::Array<u64, max_cell_count / 64> m_free_cell_bitmap {};
     alignas(Cell) u8 m_storage[];
 
 public:
-    static constexpr size_t min_possible_cell_size = sizeof(FreelistEntry);
+    static constexpr size_t min_possible_cell_size = sizeof(DeadCell);
 };
 
 }
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/String.h>
+#include <LibJS/Heap/Cell.h>
+#include <LibJS/Heap/ParallelMarker.h>
+#include <sched.h>
+
+namespace JS {
+
+class ParallelMarkingVisitor final : public Cell::Visitor {
+public:
+    explicit ParallelMarkingVisitor(Vector<Cell*>& mark_stack)
+        : m_mark_stack(mark_stack)
+    {
+    }
+
+    virtual void visit_impl(Cell& cell) override
+    {
+        if (!cell.try_mark_atomically())
+            return;
+        dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
+
+        m_mark_stack.append(&cell);
+    }
+
+private:
+    Vector<Cell*>& m_mark_stack;
+};
+
+ParallelMarker::ParallelMarker(size_t thread_count)
+{
+    VERIFY(thread_count >= 1);
+    for (size_t i = 0; i < thread_count; ++i)
+        m_markers.append(make<Marker>());
+
+    for (size_t i = 1; i < thread_count; ++i) {
+        auto worker = Threading::Thread::construct([this, i] { return worker_main(i); }, String::formatted("GC marker {}", i));
+        worker->start();
+        m_workers.append(move(worker));
+    }
+}
+
+ParallelMarker::~ParallelMarker()
+{
+    {
+        Threading::MutexLocker locker(m_mutex);
+        m_exiting = true;
+        m_work_available.broadcast();
+    }
+    for (auto& worker : m_workers)
+        (void)worker.join();
+}
+
+intptr_t ParallelMarker::worker_main(size_t index)
+{
+    u64 seen_generation = 0;
+    for (;;) {
+        {
+            Threading::MutexLocker locker(m_mutex);
+            m_work_available.wait_while([&] { return !m_exiting && m_generation == seen_generation; });
+            if (m_exiting)
+                return 0;
+            seen_generation = m_generation;
+        }
+
+        mark_on_thread(index);
+
+        Threading::MutexLocker locker(m_mutex);
+        if (--m_active_workers == 0)
+            m_work_done.signal();
+    }
+}
+
+void ParallelMarker::mark(Vector<Cell*>& mark_stack)
+{
+    // Every thread gets an equal share of the cells to start with.
+    auto cells_per_marker = ceil_div(mark_stack.size(), m_markers.size());
+    for (size_t i = 0; i < m_markers.size(); ++i) {
+        auto start = min(i * cells_per_marker, mark_stack.size());
+        auto count = min(cells_per_marker, mark_stack.size() - start);
+        m_markers[i]->local_stack.append(mark_stack.data() + start, count);
+    }
+    mark_stack.clear();
+    m_idle_marker_count = 0;
+
+    if (!m_workers.is_empty()) {
+        Threading::MutexLocker locker(m_mutex);
+        m_active_workers = m_workers.size();
+        ++m_generation;
+        m_work_available.broadcast();
+    }
+
+    mark_on_thread(0);
+
+    Threading::MutexLocker locker(m_mutex);
+    m_work_done.wait_while([&] { return m_active_workers > 0; });
+}
+
+void ParallelMarker::mark_on_thread(size_t index)
+{
+    auto& marker = *m_markers[index];
+    ParallelMarkingVisitor visitor(marker.local_stack);
+
+    for (;;) {
+        while (!marker.local_stack.is_empty()) {
+            marker.local_stack.take_last()->visit_edges(visitor);
+            if (marker.local_stack.size() >= min_donation_size && marker.shared_stack_size.load(AK::memory_order_relaxed) == 0)
+                donate_work(marker);
+        }
+
+        if (take_shared_work(marker, marker) || steal_work(index))
+            continue;
+
+        ++m_idle_marker_count;
+        for (;;) {
+            if (m_idle_marker_count.load() == m_markers.size())
+                return;
+            if (has_shared_work()) {
+                --m_idle_marker_count;
+                if (steal_work(index))
+                    break;
+                ++m_idle_marker_count;
+            }
+            sched_yield();
+        }
+    }
+}
+
+void ParallelMarker::donate_work(Marker& marker)
+{
+    // The bottom of the stack holds the cells that were found first, which tend to have the most left to visit.
+    auto donation_size = marker.local_stack.size() / 2;
+
+    Threading::MutexLocker locker(marker.shared_stack_mutex);
+    marker.shared_stack.append(marker.local_stack.data(), donation_size);
+    marker.shared_stack_size = marker.shared_stack.size();
+    marker.local_stack.remove(0, donation_size);
+}
+
+bool ParallelMarker::take_shared_work(Marker& thief, Marker& victim)
+{
+    if (victim.shared_stack_size.load(AK::memory_order_relaxed) == 0)
+        return false;
+
+    Threading::MutexLocker locker(victim.shared_stack_mutex);
+    if (victim.shared_stack.is_empty())
+        return false;
+
+    // A thread takes back all of its own work, but others leave half of it for the next thief.
+    auto count = &thief == &victim ? victim.shared_stack.size() : ceil_div(victim.shared_stack.size(), static_cast<size_t>(2));
+    auto remaining = victim.shared_stack.size() - count;
+    thief.local_stack.append(victim.shared_stack.data() + remaining, count);
+    victim.shared_stack.shrink(remaining);
+    victim.shared_stack_size = remaining;
+    return true;
+}
+
+bool ParallelMarker::steal_work(size_t thief_index)
+{
+    auto& thief = *m_markers[thief_index];
+    for (size_t i = 1; i < m_markers.size(); ++i) {
+        if (take_shared_work(thief, *m_markers[(thief_index + i) % m_markers.size()]))
+            return true;
+    }
+    return false;
+}
+
+bool ParallelMarker::has_shared_work() const
+{
+    for (auto& marker : m_markers) {
+        if (marker->shared_stack_size.load(AK::memory_order_relaxed) != 0)
+            return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Vector.h>
+#include <LibJS/Forward.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace JS {
+
+// Visits the edges of marked cells on several threads at once. Every thread works off a mark stack of its own,
+// and hands half of it over to a shared stack whenever that one runs empty. Threads that run out of work steal
+// from the shared stacks of the others.
+//
+// All visit_edges() implementations have to be safe to call concurrently, i.e. they must not modify anything.
+class ParallelMarker {
+    AK_MAKE_NONCOPYABLE(ParallelMarker);
+    AK_MAKE_NONMOVABLE(ParallelMarker);
+
+public:
+    // The thread count includes the thread calling mark().
+    explicit ParallelMarker(size_t thread_count);
+    ~ParallelMarker();
+
+    size_t thread_count() const { return m_markers.size(); }
+
+    // Visits the edges of all cells on the mark stack, and marks and visits every cell reachable from them that
+    // wasn't marked yet. The mark stack is empty afterwards.
+    void mark(Vector<Cell*>& mark_stack);
+
+private:
+    struct Marker {
+        Vector<Cell*> local_stack;
+
+        Threading::Mutex shared_stack_mutex;
+        Vector<Cell*> shared_stack;
+        // Lets other threads check for work without taking the lock.
+        Atomic<size_t> shared_stack_size { 0 };
+    };
+
+    intptr_t worker_main(size_t index);
+    void mark_on_thread(size_t index);
+
+    void donate_work(Marker&);
+    bool take_shared_work(Marker& thief, Marker& victim);
+    bool steal_work(size_t thief_index);
+    bool has_shared_work() const;
+
+    // A thread only donates work once its own stack has grown this large, so that the locking pays off.
+    static constexpr size_t min_donation_size = 64;
+
+    Vector<NonnullOwnPtr<Marker>> m_markers;
+    NonnullRefPtrVector<Threading::Thread> m_workers;
+
+    Threading::Mutex m_mutex;
+    Threading::ConditionVariable m_work_available { m_mutex };
+    Threading::ConditionVariable m_work_done { m_mutex };
+    u64 m_generation { 0 };
+    size_t m_active_workers { 0 };
+    bool m_exiting { false };
+
+    // Marking is done once every thread is idle. Only a thread with work of its own can fill its shared stack,
+    // and it empties that stack again before it goes idle itself.
+    Atomic<size_t> m_idle_marker_count { 0 };
+};
+
+}
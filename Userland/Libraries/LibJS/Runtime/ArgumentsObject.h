@@ -34,6 +34,7 @@ public:
 
 private:
     virtual void visit_edges(Cell::Visitor&) override;
+    virtual bool may_interfere_with_property_lookup_caches() const override { return true; }
 
     Environment& m_environment;
     Object* m_parameter_map { nullptr };
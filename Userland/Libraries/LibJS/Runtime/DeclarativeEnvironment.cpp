@@ -97,6 +97,7 @@ ThrowCompletionOr<void> DeclarativeEnvironment::initialize_binding(GlobalObject&
 
     // 2. Set the bound value for N in envRec to V.
     binding.value = value;
+    Heap::write_barrier(value);
 
     // 3. Record that the binding for N in envRec has been initialized.
     binding.initialized = true;
@@ -143,6 +144,7 @@ ThrowCompletionOr<void> DeclarativeEnvironment::set_mutable_binding_direct(Globa
 
     if (binding.mutable_) {
         binding.value = value;
+        Heap::write_barrier(value);
     } else {
         if (strict)
             return vm().throw_completion<TypeError>(global_object, ErrorType::InvalidAssignToConst);
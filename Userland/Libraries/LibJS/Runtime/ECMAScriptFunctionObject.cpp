@@ -308,11 +308,17 @@ void ECMAScriptFunctionObject::visit_edges(Visitor& visitor)
 void ECMAScriptFunctionObject::make_method(Object& home_object)
 {
     // 1. Set F.[[HomeObject]] to homeObject.
-    m_home_object = &home_object;
+    set_home_object(&home_object);
 
     // 2. Return NormalCompletion(undefined).
 }
 
+void ECMAScriptFunctionObject::set_home_object(Object* home_object)
+{
+    m_home_object = home_object;
+    Heap::write_barrier(home_object);
+}
+
 // 10.2.11 FunctionDeclarationInstantiation ( func, argumentsList ), https://tc39.es/ecma262/#sec-functiondeclarationinstantiation
 ThrowCompletionOr<void> ECMAScriptFunctionObject::function_declaration_instantiation(Interpreter* interpreter)
 {
@@ -859,6 +865,9 @@ void ECMAScriptFunctionObject::set_name(const FlyString& name)
 void ECMAScriptFunctionObject::add_field(ClassElement::ClassElementName property_key, ECMAScriptFunctionObject* initializer)
 {
     m_fields.empend(property_key, initializer);
+    if (auto* property_key_ptr = property_key.get_pointer<PropertyKey>(); property_key_ptr && property_key_ptr->is_symbol())
+        Heap::write_barrier(property_key_ptr->as_symbol());
+    Heap::write_barrier(initializer);
 }
 
 }
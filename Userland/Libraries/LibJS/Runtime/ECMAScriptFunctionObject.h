@@ -63,7 +63,7 @@ public:
     ThisMode this_mode() const { return m_this_mode; }
 
     Object* home_object() const { return m_home_object; }
-    void set_home_object(Object* home_object) { m_home_object = home_object; }
+    void set_home_object(Object* home_object);
 
     String const& source_text() const { return m_source_text; }
     void set_source_text(String source_text) { m_source_text = move(source_text); }
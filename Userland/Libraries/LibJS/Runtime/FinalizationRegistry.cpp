@@ -25,6 +25,8 @@ void FinalizationRegistry::add_finalization_record(Cell& target, Value held_valu
 {
     VERIFY(!held_value.is_empty());
     m_records.append({ &target, held_value, unregister_token });
+    Heap::write_barrier(held_value);
+    Heap::write_barrier(unregister_token);
 }
 
 bool FinalizationRegistry::remove_by_token(Object& unregister_token)
@@ -92,6 +92,7 @@ ThrowCompletionOr<Value> FunctionEnvironment::bind_this_value(GlobalObject& glob
 
     // 3. Set envRec.[[ThisValue]] to V.
     m_this_value = this_value;
+    Heap::write_barrier(this_value);
 
     // 4. Set envRec.[[ThisBindingStatus]] to initialized.
     m_this_binding_status = ThisBindingStatus::Initialized;
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/Completion.h>
 #include <LibJS/Runtime/DeclarativeEnvironment.h>
 #include <LibJS/Runtime/ECMAScriptFunctionObject.h>
@@ -30,13 +31,18 @@ public:
 
     ECMAScriptFunctionObject& function_object() { return *m_function_object; }
     ECMAScriptFunctionObject const& function_object() const { return *m_function_object; }
-    void set_function_object(ECMAScriptFunctionObject& function) { m_function_object = &function; }
+    void set_function_object(ECMAScriptFunctionObject& function)
+    {
+        m_function_object = &function;
+        Heap::write_barrier(&function);
+    }
 
     Value new_target() const { return m_new_target; }
     void set_new_target(Value new_target)
     {
         VERIFY(!new_target.is_empty());
         m_new_target = new_target;
+        Heap::write_barrier(new_target);
     }
 
     // Abstract operations
@@ -119,6 +119,7 @@ ThrowCompletionOr<Value> GeneratorObject::next_impl(VM& vm, GlobalObject& global
     m_done = TRY(generated_continuation(m_previous_value)) == nullptr;
 
     m_previous_value = TRY(next_result);
+    Heap::write_barrier(m_previous_value);
 
     result->define_direct_property("value", TRY(generated_value(m_previous_value)), JS::default_attributes);
     result->define_direct_property("done", Value(m_done), JS::default_attributes);
@@ -5,6 +5,7 @@
  */
 
 #include <AK/QuickSort.h>
+#include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/IndexedProperties.h>
 
@@ -233,6 +234,7 @@ void IndexedProperties::put(u32 index, Value value, PropertyAttributes attribute
     }
 
     m_storage->put(index, value, attributes);
+    Heap::write_barrier(value);
 }
 
 void IndexedProperties::remove(u32 index)
@@ -34,6 +34,12 @@ void DateTimeFormat::visit_edges(Cell::Visitor& visitor)
         visitor.visit(m_bound_format);
 }
 
+void DateTimeFormat::set_bound_format(NativeFunction* bound_format)
+{
+    m_bound_format = bound_format;
+    Heap::write_barrier(bound_format);
+}
+
 DateTimeFormat::Style DateTimeFormat::style_from_string(StringView style)
 {
     if (style == "full"sv)
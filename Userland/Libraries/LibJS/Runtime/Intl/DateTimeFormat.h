@@ -127,7 +127,7 @@ public:
     StringView time_zone_name_string() const { return Unicode::calendar_pattern_style_to_string(*Patterns::time_zone_name); }
 
     NativeFunction* bound_format() const { return m_bound_format; }
-    void set_bound_format(NativeFunction* bound_format) { m_bound_format = bound_format; }
+    void set_bound_format(NativeFunction* bound_format);
 
 private:
     static Style style_from_string(StringView style);
@@ -35,6 +35,12 @@ void NumberFormat::visit_edges(Cell::Visitor& visitor)
         visitor.visit(m_bound_format);
 }
 
+void NumberFormat::set_bound_format(NativeFunction* bound_format)
+{
+    m_bound_format = bound_format;
+    Heap::write_barrier(bound_format);
+}
+
 void NumberFormat::set_style(StringView style)
 {
     if (style == "decimal"sv)
@@ -28,6 +28,12 @@ void RelativeTimeFormat::visit_edges(Cell::Visitor& visitor)
         visitor.visit(m_number_format);
 }
 
+void RelativeTimeFormat::set_number_format(NumberFormat* number_format)
+{
+    m_number_format = number_format;
+    Heap::write_barrier(number_format);
+}
+
 void RelativeTimeFormat::set_numeric(StringView numeric)
 {
     if (numeric == "always"sv) {
@@ -54,7 +54,7 @@ public:
     StringView numeric_string() const;
 
     NumberFormat& number_format() const { return *m_number_format; }
-    void set_number_format(NumberFormat* number_format) { m_number_format = number_format; }
+    void set_number_format(NumberFormat* number_format);
 
 private:
     virtual void visit_edges(Cell::Visitor&) override;
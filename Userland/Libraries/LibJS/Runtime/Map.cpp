@@ -73,7 +73,9 @@ void Map::map_set(Value const& key, Value value)
         auto index = m_next_insertion_id++;
         m_keys.insert(index, key);
         m_entries.set(key, value);
+        Heap::write_barrier(key);
     }
+    Heap::write_barrier(value);
 }
 
 size_t Map::map_size() const
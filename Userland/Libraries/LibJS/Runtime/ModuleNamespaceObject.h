@@ -34,6 +34,8 @@ public:
     virtual void initialize(GlobalObject& object) override;
 
 private:
+    virtual bool may_interfere_with_property_lookup_caches() const override { return true; }
+
     // FIXME: UHHH how do we want to store this to avoid cycles but be safe??
     Module* m_module;            // [[Module]]
     Vector<FlyString> m_exports; // [[Exports]]
@@ -497,6 +497,7 @@ ThrowCompletionOr<void> Object::private_field_add(PrivateName const& name, Value
     if (!m_private_elements)
         m_private_elements = make<Vector<PrivateElement>>();
     m_private_elements->empend(name, PrivateElement::Kind::Field, value);
+    Heap::write_barrier(value);
     return {};
 }
 
@@ -508,6 +509,7 @@ ThrowCompletionOr<void> Object::private_method_or_accessor_add(PrivateElement el
         return vm().throw_completion<TypeError>(global_object(), ErrorType::PrivateFieldAlreadyDeclared, element.key.description);
     if (!m_private_elements)
         m_private_elements = make<Vector<PrivateElement>>();
+    Heap::write_barrier(element.value);
     m_private_elements->append(move(element));
     return {};
 }
@@ -542,6 +544,7 @@ ThrowCompletionOr<void> Object::private_set(PrivateName const& name, Value value
 
     if (entry->kind == PrivateElement::Kind::Field) {
         entry->value = value;
+        Heap::write_barrier(value);
         return {};
     } else if (entry->kind == PrivateElement::Kind::Method) {
         return vm().throw_completion<TypeError>(global_object(), ErrorType::PrivateFieldSetMethod, name.description);
@@ -1009,6 +1012,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
             set_shape(*m_shape->create_put_transition(property_key_string_or_symbol, attributes));
 
         m_storage.append(value);
+        Heap::write_barrier(value);
         return;
     }
 
@@ -1019,7 +1023,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
             set_shape(*m_shape->create_configure_transition(property_key_string_or_symbol, attributes));
     }
 
-    m_storage[metadata->offset] = value;
+    put_direct(metadata->offset, value);
 }
 
 void Object::storage_delete(PropertyKey const& property_key)
@@ -1047,7 +1051,7 @@ void Object::set_prototype(Object* new_prototype)
     if (shape.is_unique())
         shape.set_prototype_without_transition(new_prototype);
     else
-        m_shape = shape.create_prototype_transition(new_prototype);
+        set_shape(*shape.create_prototype_transition(new_prototype));
 }
 
 void Object::define_native_accessor(PropertyKey const& property_key, Function<ThrowCompletionOr<Value>(VM&, GlobalObject&)> getter, Function<ThrowCompletionOr<Value>(VM&, GlobalObject&)> setter, PropertyAttributes attribute)
@@ -1100,7 +1104,7 @@ void Object::ensure_shape_is_unique()
     if (shape().is_unique())
         return;
 
-    m_shape = m_shape->create_unique_clone();
+    set_shape(*m_shape->create_unique_clone());
 }
 
 // Simple side-effect free property lookup, following the prototype chain. Non-standard.
@@ -1203,6 +1207,18 @@ void Object::visit_edges(Cell::Visitor& visitor)
     }
 }
 
+void Object::put_direct(size_t index, Value value)
+{
+    m_storage[index] = value;
+    Heap::write_barrier(value);
+}
+
+void Object::set_shape(Shape& shape)
+{
+    m_shape = &shape;
+    Heap::write_barrier(&shape);
+}
+
 // 7.1.1.1 OrdinaryToPrimitive ( O, hint ), https://tc39.es/ecma262/#sec-ordinarytoprimitive
 ThrowCompletionOr<Value> Object::ordinary_to_primitive(Value::PreferredType preferred_type) const
 {
@@ -163,6 +163,10 @@ public:
     // B.3.7 The [[IsHTMLDDA]] Internal Slot, https://tc39.es/ecma262/#sec-IsHTMLDDA-internal-slot
     virtual bool is_htmldda() const { return false; }
 
+    // Objects whose [[GetPrototypeOf]], [[GetOwnProperty]], [[Get]], [[Set]] or [[DefineOwnProperty]] may disagree
+    // with their shape for string keys must return true here, so the bytecode interpreter's property lookup caches skip them.
+    virtual bool may_interfere_with_property_lookup_caches() const { return false; }
+
     bool has_parameter_map() const { return m_has_parameter_map; }
     void set_has_parameter_map() { m_has_parameter_map = true; }
 
@@ -170,10 +174,10 @@ public:
     virtual void visit_edges(Cell::Visitor&) override;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value);
 
     const IndexedProperties& indexed_properties() const { return m_indexed_properties; }
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
-    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(move(values)); }
 
     Shape& shape() { return *m_shape; }
     Shape const& shape() const { return *m_shape; }
@@ -200,7 +204,7 @@ protected:
     bool m_has_parameter_map { false };
 
 private:
-    void set_shape(Shape& shape) { m_shape = &shape; }
+    void set_shape(Shape&);
 
     Object* prototype() { return shape().prototype(); }
     Object const* prototype() const { return shape().prototype(); }
@@ -191,6 +191,7 @@ Value Promise::fulfill(Value value)
 
     // 3. Set promise.[[PromiseResult]] to value.
     m_result = value;
+    Heap::write_barrier(value);
 
     // 4. Set promise.[[PromiseFulfillReactions]] to undefined.
     // 5. Set promise.[[PromiseRejectReactions]] to undefined.
@@ -221,6 +222,7 @@ Value Promise::reject(Value reason)
 
     // 3. Set promise.[[PromiseResult]] to reason.
     m_result = reason;
+    Heap::write_barrier(reason);
 
     // 4. Set promise.[[PromiseFulfillReactions]] to undefined.
     // 5. Set promise.[[PromiseRejectReactions]] to undefined.
@@ -311,9 +313,11 @@ Value Promise::perform_then(Value on_fulfilled, Value on_rejected, Optional<Prom
 
         // a. Append fulfillReaction as the last element of the List that is promise.[[PromiseFulfillReactions]].
         m_fulfill_reactions.append(fulfill_reaction);
+        Heap::write_barrier(fulfill_reaction);
 
         // b. Append rejectReaction as the last element of the List that is promise.[[PromiseRejectReactions]].
         m_reject_reactions.append(reject_reaction);
+        Heap::write_barrier(reject_reaction);
         break;
     // 10. Else if promise.[[PromiseState]] is fulfilled, then
     case Promise::State::Fulfilled: {
@@ -72,6 +72,7 @@ ThrowCompletionOr<Value> PromiseAllResolveElementFunction::resolve_element()
 
     // 8. Set values[index] to x.
     m_values.values()[m_index] = vm.argument(0);
+    Heap::write_barrier(m_values.values()[m_index]);
 
     // 9. Set remainingElementsCount.[[Value]] to remainingElementsCount.[[Value]] - 1.
     // 10. If remainingElementsCount.[[Value]] is 0, then
@@ -113,6 +114,7 @@ ThrowCompletionOr<Value> PromiseAllSettledResolveElementFunction::resolve_elemen
 
     // 12. Set values[index] to obj.
     m_values.values()[m_index] = object;
+    Heap::write_barrier(m_values.values()[m_index]);
 
     // 13. Set remainingElementsCount.[[Value]] to remainingElementsCount.[[Value]] - 1.
     // 14. If remainingElementsCount.[[Value]] is 0, then
@@ -154,6 +156,7 @@ ThrowCompletionOr<Value> PromiseAllSettledRejectElementFunction::resolve_element
 
     // 12. Set values[index] to obj.
     m_values.values()[m_index] = object;
+    Heap::write_barrier(m_values.values()[m_index]);
 
     // 13. Set remainingElementsCount.[[Value]] to remainingElementsCount.[[Value]] - 1.
     // 14. If remainingElementsCount.[[Value]] is 0, then
@@ -186,6 +189,7 @@ ThrowCompletionOr<Value> PromiseAnyRejectElementFunction::resolve_element()
 
     // 8. Set errors[index] to x.
     m_values.values()[m_index] = vm.argument(0);
+    Heap::write_barrier(m_values.values()[m_index]);
 
     // 9. Set remainingElementsCount.[[Value]] to remainingElementsCount.[[Value]] - 1.
     // 10. If remainingElementsCount.[[Value]] is 0, then
@@ -14,11 +14,6 @@ struct AlreadyResolved final : public Cell {
     bool value { false };
 
     virtual const char* class_name() const override { return "AlreadyResolved"; }
-
-protected:
-    // Allocated cells must be >= sizeof(FreelistEntry), which is 24 bytes -
-    // but AlreadyResolved is only 16 bytes without this.
-    u8 dummy[8];
 };
 
 class PromiseResolvingFunction final : public NativeFunction {
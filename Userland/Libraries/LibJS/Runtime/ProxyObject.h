@@ -51,6 +51,7 @@ private:
 
     virtual bool is_function() const override { return m_target.is_function(); }
     virtual bool is_proxy_object() const final { return true; }
+    virtual bool may_interfere_with_property_lookup_caches() const final { return true; }
 
     Object& m_target;
     Object& m_handler;
@@ -37,6 +37,9 @@ void Realm::set_global_object(GlobalObject& global_object, Object* this_value)
     // 6. Set realmRec.[[GlobalEnv]] to newGlobalEnv.
     m_global_environment = global_object.heap().allocate_without_global_object<GlobalEnvironment>(global_object, *this_value);
 
+    Heap::write_barrier(m_global_object);
+    Heap::write_barrier(m_global_environment);
+
     // 7. Return realmRec.
 }
 
@@ -65,6 +65,7 @@ ThrowCompletionOr<Object*> ShadowRealmConstructor::construct(FunctionObject& new
     // 10. Perform ? SetRealmGlobalObject(realmRec, undefined, undefined).
     auto* new_global_object = vm.heap().allocate_without_global_object<GlobalObject>();
     new_global_object->initialize_global_object();
+    vm.heap().revisit_cell(*new_global_object);
     realm->set_global_object(*new_global_object, nullptr);
 
     // TODO: I don't think we should have these exactly like this, that doesn't work well with how
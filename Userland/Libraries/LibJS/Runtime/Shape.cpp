@@ -203,6 +203,8 @@ void Shape::add_property_to_unique_shape(const StringOrSymbol& property_key, Pro
     VERIFY(m_property_table);
     VERIFY(!m_property_table->contains(property_key));
     m_property_table->set(property_key, { static_cast<u32>(m_property_table->size()), attributes });
+    if (property_key.is_symbol())
+        Heap::write_barrier(const_cast<Symbol*>(property_key.as_symbol()));
 
     VERIFY(m_property_count < NumericLimits<u32>::max());
     ++m_property_count;
@@ -238,9 +240,17 @@ void Shape::add_property_without_transition(StringOrSymbol const& property_key,
     if (m_property_table->set(property_key, { m_property_count, attributes }) == AK::HashSetResult::InsertedNewEntry) {
         VERIFY(m_property_count < NumericLimits<u32>::max());
         ++m_property_count;
+        if (property_key.is_symbol())
+            Heap::write_barrier(const_cast<Symbol*>(property_key.as_symbol()));
     }
 }
 
+void Shape::set_prototype_without_transition(Object* new_prototype)
+{
+    m_prototype = new_prototype;
+    Heap::write_barrier(new_prototype);
+}
+
 FLATTEN void Shape::add_property_without_transition(PropertyKey const& property_key, PropertyAttributes attributes)
 {
     VERIFY(property_key.is_valid());
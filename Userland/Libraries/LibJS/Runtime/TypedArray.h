@@ -41,7 +41,11 @@ public:
     void set_array_length(u32 length) { m_array_length = length; }
     void set_byte_length(u32 length) { m_byte_length = length; }
     void set_byte_offset(u32 offset) { m_byte_offset = offset; }
-    void set_viewed_array_buffer(ArrayBuffer* array_buffer) { m_viewed_array_buffer = array_buffer; }
+    void set_viewed_array_buffer(ArrayBuffer* array_buffer)
+    {
+        m_viewed_array_buffer = array_buffer;
+        Heap::write_barrier(array_buffer);
+    }
 
     virtual size_t element_size() const = 0;
     virtual FlyString const& element_name() const = 0;
@@ -454,6 +458,7 @@ protected:
 
 private:
     virtual bool is_typed_array() const final { return true; }
+    virtual bool may_interfere_with_property_lookup_caches() const final { return true; }
 };
 
 ThrowCompletionOr<TypedArrayBase*> typed_array_create(GlobalObject& global_object, FunctionObject& constructor, MarkedVector<Value> arguments);
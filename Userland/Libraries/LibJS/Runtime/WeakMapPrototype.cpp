@@ -77,6 +77,7 @@ JS_DEFINE_NATIVE_FUNCTION(WeakMapPrototype::set)
     if (!value.is_object())
         return vm.throw_completion<TypeError>(global_object, ErrorType::NotAnObject, value.to_string_without_side_effects());
     weak_map->values().set(&value.as_object(), vm.argument(1));
+    Heap::write_barrier(vm.argument(1));
     return weak_map;
 }
 
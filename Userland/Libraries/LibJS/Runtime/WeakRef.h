@@ -25,7 +25,12 @@ public:
 
     Object* value() const { return m_value; };
 
-    void update_execution_generation() { m_last_execution_generation = vm().execution_generation(); };
+    void update_execution_generation()
+    {
+        m_last_execution_generation = vm().execution_generation();
+        // This turns the reference into a strong one until the end of the current job.
+        Heap::write_barrier(m_value);
+    };
 
     virtual void remove_dead_cells(Badge<Heap>) override;
 
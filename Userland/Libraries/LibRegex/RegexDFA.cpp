@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/Debug.h>
+#include <AK/HashFunctions.h>
+#include <AK/QuickSort.h>
+#include <LibRegex/RegexDFA.h>
+
+namespace regex {
+
+static bool is_word_character(u32 code_unit)
+{
+    return is_ascii_alphanumeric(code_unit) || code_unit == '_';
+}
+
+// Returns the number of code units the comparison consumes if it's a single literal string, or -1 if it consumes exactly one code unit.
+// Comparisons that can't be expressed in the automaton (backreferences, strings mixed with other comparisons) make this return an empty Optional.
+static Optional<ssize_t> analyze_compare(ByteCode const& bytecode, size_t instruction_position)
+{
+    auto arguments_count = bytecode.at(instruction_position + 1);
+    auto offset = instruction_position + 3;
+    Optional<ssize_t> string_length;
+    for (size_t i = 0; i < arguments_count; ++i) {
+        auto compare_type = (CharacterCompareType)bytecode.at(offset++);
+        switch (compare_type) {
+        case CharacterCompareType::Undefined:
+        case CharacterCompareType::Inverse:
+        case CharacterCompareType::TemporaryInverse:
+        case CharacterCompareType::AnyChar:
+        case CharacterCompareType::RangeExpressionDummy:
+            break;
+        case CharacterCompareType::String:
+            string_length = bytecode.at(offset);
+            offset += bytecode.at(offset) + 1;
+            break;
+        case CharacterCompareType::LookupTable:
+            offset += bytecode.at(offset) + 1;
+            break;
+        case CharacterCompareType::Reference:
+            return {};
+        case CharacterCompareType::Char:
+        case CharacterCompareType::CharClass:
+        case CharacterCompareType::CharRange:
+        case CharacterCompareType::Property:
+        case CharacterCompareType::GeneralCategory:
+        case CharacterCompareType::Script:
+        case CharacterCompareType::ScriptExtension:
+            ++offset;
+            break;
+        }
+    }
+    if (string_length.has_value()) {
+        if (arguments_count != 1)
+            return {};
+        return string_length;
+    }
+    return -1;
+}
+
+OwnPtr<LazyDFA> LazyDFA::try_create(ByteCode const& bytecode)
+{
+    auto bytecode_size = bytecode.size();
+
+    // First, figure out which node each instruction starts at. String comparisons are split into one node per code unit.
+    HashMap<size_t, u32> node_for_instruction;
+    u32 node_count = 0;
+    MatchState state;
+    for (state.instruction_position = 0; state.instruction_position < bytecode_size;) {
+        auto& opcode = bytecode.get_opcode(state);
+        node_for_instruction.set(state.instruction_position, node_count);
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            auto string_length = analyze_compare(bytecode, state.instruction_position);
+            if (!string_length.has_value())
+                return nullptr;
+            node_count += max<ssize_t>(*string_length, 1);
+            break;
+        }
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+        case OpCodeId::FailForks:
+        case OpCodeId::Repeat:
+        case OpCodeId::ResetRepeat:
+            return nullptr;
+        default:
+            ++node_count;
+            break;
+        }
+        state.instruction_position += opcode.size();
+    }
+    // Running off the end of the bytecode means the match succeeded.
+    node_for_instruction.set(state.instruction_position, node_count++);
+
+    Vector<Node> nodes;
+    nodes.resize(node_count);
+    nodes.last().kind = Node::Kind::Accept;
+
+    auto resolve = [&](size_t instruction_position) -> Optional<u32> {
+        return node_for_instruction.get(instruction_position);
+    };
+
+    for (state.instruction_position = 0; state.instruction_position < bytecode_size;) {
+        auto& opcode = bytecode.get_opcode(state);
+        auto position = state.instruction_position;
+        auto next_position = position + opcode.size();
+        auto index = *resolve(position);
+        auto next = resolve(next_position);
+        if (!next.has_value())
+            return nullptr;
+
+        auto& node = nodes[index];
+        node.next = *next;
+        node.instruction_position = position;
+
+        auto set_fork_target = [&](ssize_t offset) {
+            auto target = resolve(next_position + offset);
+            if (!target.has_value())
+                return false;
+            node.kind = Node::Kind::Fork;
+            node.alternative = *target;
+            return true;
+        };
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            auto string_length = *analyze_compare(bytecode, position);
+            if (string_length < 0) {
+                node.kind = Node::Kind::Compare;
+                break;
+            }
+            // A string comparison becomes a chain of literals, or a plain jump for the empty string.
+            auto characters = position + 5;
+            for (ssize_t i = 0; i < string_length; ++i) {
+                auto& literal = nodes[index + i];
+                literal.kind = Node::Kind::Literal;
+                literal.code_unit = bytecode.at(characters + i);
+                literal.next = i + 1 == string_length ? *next : index + i + 1;
+            }
+            break;
+        }
+        case OpCodeId::Jump: {
+            auto target = resolve(next_position + static_cast<OpCode_Jump const&>(opcode).offset());
+            if (!target.has_value())
+                return nullptr;
+            node.next = *target;
+            break;
+        }
+        // NOTE: The non-empty check of JumpNonEmpty only exists to stop empty loops from running forever,
+        //       it doesn't change which strings are matched, so it is treated as a plain fork here.
+        case OpCodeId::JumpNonEmpty:
+            if (!set_fork_target(static_cast<OpCode_JumpNonEmpty const&>(opcode).offset()))
+                return nullptr;
+            break;
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+            if (!set_fork_target(static_cast<OpCode_ForkJump const&>(opcode).offset()))
+                return nullptr;
+            break;
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+            if (!set_fork_target(static_cast<OpCode_ForkStay const&>(opcode).offset()))
+                return nullptr;
+            break;
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+            node.kind = Node::Kind::Assertion;
+            break;
+        case OpCodeId::Exit:
+            node.kind = Node::Kind::Accept;
+            break;
+        default:
+            // Capture groups and checkpoints don't affect whether there is a match.
+            break;
+        }
+        state.instruction_position = next_position;
+    }
+
+    dbgln_if(REGEX_DEBUG, "LazyDFA: Created an automaton with {} nodes for {} bytecode values", nodes.size(), bytecode_size);
+    return adopt_own(*new LazyDFA(move(nodes)));
+}
+
+LazyDFA::LazyDFA(Vector<Node>&& nodes)
+    : m_nodes(move(nodes))
+{
+    m_visited_generation.resize(m_nodes.size());
+}
+
+u8 LazyDFA::context_after(u32 code_unit, u8 anchoring_context)
+{
+    u8 context = anchoring_context;
+    if (code_unit == '\n')
+        context |= AfterNewline;
+    if (is_word_character(code_unit))
+        context |= AfterWordCharacter;
+    return context;
+}
+
+u8 LazyDFA::context_at(MatchInput const& input, size_t position, u8 anchoring_context)
+{
+    if (position == 0)
+        return StartOfInput | anchoring_context;
+    return context_after(input.view[position - 1], anchoring_context);
+}
+
+void LazyDFA::flush_if_options_changed(AllOptions options)
+{
+    if (m_cached_options.has_value() && m_cached_options->value() == options.value())
+        return;
+    m_states.clear();
+    m_states_by_hash.clear();
+    m_cached_options = options;
+}
+
+u32 LazyDFA::state_for(Vector<u32>&& nodes, u8 context)
+{
+    u32 hash = int_hash(context);
+    for (auto node : nodes)
+        hash = pair_int_hash(hash, node);
+
+    if (auto bucket = m_states_by_hash.find(hash); bucket != m_states_by_hash.end()) {
+        for (auto index : bucket->value) {
+            auto& state = *m_states[index];
+            if (state.context == context && state.nodes == nodes)
+                return index;
+        }
+    }
+
+    // Keep memory usage bounded: once the cache is full, start over from scratch.
+    // States are cheap to recreate, and the ones that matter will quickly be cached again.
+    if (m_states.size() >= max_cached_states) {
+        dbgln_if(REGEX_DEBUG, "LazyDFA: Flushing {} cached states", m_states.size());
+        m_states.clear();
+        m_states_by_hash.clear();
+        ++m_flush_count;
+    }
+
+    auto index = static_cast<u32>(m_states.size());
+    auto state = make<State>();
+    state->nodes = move(nodes);
+    state->context = context;
+    m_states.append(move(state));
+    m_states_by_hash.ensure(hash).append(index);
+    return index;
+}
+
+bool LazyDFA::compute_closure(State const& state, ByteCode const& bytecode, MatchInput const& input, size_t position)
+{
+    if (++m_generation == 0) {
+        for (auto& generation : m_visited_generation)
+            generation = 0;
+        m_generation = 1;
+    }
+
+    m_closure.clear_with_capacity();
+    m_worklist.clear_with_capacity();
+    m_worklist.extend(state.nodes);
+    if (state.context & Unanchored)
+        m_worklist.append(0);
+
+    bool accepts = false;
+    while (!m_worklist.is_empty()) {
+        auto index = m_worklist.take_last();
+        if (m_visited_generation[index] == m_generation)
+            continue;
+        m_visited_generation[index] = m_generation;
+
+        auto& node = m_nodes[index];
+        switch (node.kind) {
+        case Node::Kind::Jump:
+            m_worklist.append(node.next);
+            break;
+        case Node::Kind::Fork:
+            m_worklist.append(node.alternative);
+            m_worklist.append(node.next);
+            break;
+        case Node::Kind::Assertion: {
+            m_match_state.instruction_position = node.instruction_position;
+            m_match_state.string_position = position;
+            m_match_state.string_position_in_code_units = position;
+            if (bytecode.get_opcode(m_match_state).execute(input, m_match_state) == ExecutionResult::Continue)
+                m_worklist.append(node.next);
+            break;
+        }
+        case Node::Kind::Compare:
+        case Node::Kind::Literal:
+            m_closure.append(index);
+            break;
+        case Node::Kind::Accept:
+            accepts = true;
+            break;
+        }
+    }
+    return accepts;
+}
+
+Optional<Vector<u32>> LazyDFA::compute_step(ByteCode const& bytecode, MatchInput const& input, size_t position)
+{
+    auto code_unit = input.view[position];
+    auto insensitive = input.regex_options.has_flag_set(AllFlags::Insensitive);
+
+    Vector<u32> next_nodes;
+    for (auto index : m_closure) {
+        auto& node = m_nodes[index];
+        if (node.kind == Node::Kind::Literal) {
+            // NOTE: Anything outside ASCII is let through, the backtracker will sort out what it actually matches.
+            if (code_unit == node.code_unit || code_unit >= 0x80 || node.code_unit >= 0x80
+                || (insensitive && to_ascii_lowercase(code_unit) == to_ascii_lowercase(node.code_unit)))
+                next_nodes.append(node.next);
+            continue;
+        }
+
+        m_match_state.instruction_position = node.instruction_position;
+        m_match_state.string_position = position;
+        m_match_state.string_position_in_code_units = position;
+        if (bytecode.get_opcode(m_match_state).execute(input, m_match_state) != ExecutionResult::Continue)
+            continue;
+        if (m_match_state.string_position != position + 1)
+            return {};
+        next_nodes.append(node.next);
+    }
+
+    quick_sort(next_nodes);
+    Vector<u32> unique_nodes;
+    unique_nodes.ensure_capacity(next_nodes.size());
+    for (auto index : next_nodes) {
+        if (unique_nodes.is_empty() || unique_nodes.last() != index)
+            unique_nodes.unchecked_append(index);
+    }
+    return unique_nodes;
+}
+
+Optional<size_t> LazyDFA::find_match_end(ByteCode const& bytecode, MatchInput const& input, size_t position, Anchoring anchoring)
+{
+    VERIFY(can_run_on(input));
+    flush_if_options_changed(input.regex_options);
+
+    u8 anchoring_context = anchoring == Anchoring::Unanchored ? Unanchored : 0;
+    Vector<u32> initial_nodes;
+    if (anchoring == Anchoring::Anchored)
+        initial_nodes.append(0);
+    auto current = state_for(move(initial_nodes), context_at(input, position, anchoring_context));
+
+    auto length = input.view.length();
+    for (; position < length; ++position) {
+        auto code_unit = input.view[position];
+        auto& state = *m_states[current];
+
+        auto transition = code_unit < cached_code_units ? state.transitions[code_unit] : unknown_transition;
+        if (transition == accepts_before_transition)
+            return position;
+        if (transition != unknown_transition) {
+            current = transition - 1;
+        } else {
+            if (compute_closure(state, bytecode, input, position)) {
+                if (code_unit < cached_code_units)
+                    state.transitions[code_unit] = accepts_before_transition;
+                return position;
+            }
+            auto next_nodes = compute_step(bytecode, input, position);
+            if (!next_nodes.has_value()) {
+                // Something consumed more or less than one code unit, so the automaton can't tell where a match would end.
+                // Let the backtracker decide, as if a match could run up to the end of the input.
+                return length;
+            }
+
+            auto flush_count_before = m_flush_count;
+            auto next = state_for(next_nodes.release_value(), context_after(code_unit, anchoring_context));
+            // NOTE: If the cache was flushed to make room for the next state, `state` is gone.
+            if (code_unit < cached_code_units && m_flush_count == flush_count_before)
+                state.transitions[code_unit] = next + 1;
+            current = next;
+        }
+
+        if (anchoring == Anchoring::Anchored && m_states[current]->nodes.is_empty())
+            return {};
+    }
+
+    if (compute_closure(*m_states[current], bytecode, input, length))
+        return length;
+    return {};
+}
+
+}
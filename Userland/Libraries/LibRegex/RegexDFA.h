@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+#include "RegexOptions.h"
+
+#include <AK/Array.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// An automaton-based matcher that decides in linear time whether the pattern can match at all,
+// without producing captures. The bytecode is translated into a Thompson NFA whose epsilon edges are
+// the forks and jumps, and the NFA is simulated through a lazily built DFA: sets of NFA states are
+// turned into DFA states (and their transitions on ASCII code units are cached) only as the input
+// actually reaches them, and the whole cache is thrown away once it grows past a fixed size.
+//
+// Only patterns without backreferences, lookarounds and counted repetitions are supported, see try_create().
+// Character comparisons and anchors are evaluated by the regular opcodes, so the automaton accepts exactly
+// what the backtracker could accept (and possibly more, as non-empty loop checks are not modelled). This
+// makes it a safe filter: the backtracker only has to run where a match is known to be possible.
+class LazyDFA {
+public:
+    enum class Anchoring {
+        Anchored,
+        Unanchored,
+    };
+
+    static OwnPtr<LazyDFA> try_create(ByteCode const&);
+
+    // The automaton works on code units, which only line up with string positions outside of Unicode mode,
+    // and UTF-8 views can't be indexed by code unit.
+    static bool can_run_on(MatchInput const& input) { return !input.view.unicode() && !input.view.is_u8_view(); }
+
+    // Returns whether a match may start at `position`.
+    bool may_match_at(ByteCode const& bytecode, MatchInput const& input, size_t position)
+    {
+        return find_match_end(bytecode, input, position, Anchoring::Anchored).has_value();
+    }
+
+    // Returns the earliest position at which a match starting at or after `position` may end, if there is one.
+    // The leftmost match can't start after that position, so only the positions up to it need to be tried.
+    Optional<size_t> find_earliest_match_end(ByteCode const& bytecode, MatchInput const& input, size_t position)
+    {
+        return find_match_end(bytecode, input, position, Anchoring::Unanchored);
+    }
+
+    size_t cached_state_count() const { return m_states.size(); }
+
+private:
+    struct Node {
+        enum class Kind : u8 {
+            Jump,
+            Fork,
+            Assertion,
+            Compare,
+            Literal,
+            Accept,
+        };
+
+        Kind kind { Kind::Jump };
+        u32 next { 0 };
+        u32 alternative { 0 };
+        // For Compare and Assertion nodes, the instruction to run.
+        size_t instruction_position { 0 };
+        // For Literal nodes, the code unit that has to be matched.
+        u32 code_unit { 0 };
+    };
+
+    // What the code unit preceding the current position looks like, as far as anchors care.
+    enum Context : u8 {
+        StartOfInput = 1 << 0,
+        AfterNewline = 1 << 1,
+        AfterWordCharacter = 1 << 2,
+        Unanchored = 1 << 3,
+    };
+
+    static constexpr size_t cached_code_units = 128;
+    static constexpr size_t max_cached_states = 1024;
+    static constexpr u32 unknown_transition = 0;
+    static constexpr u32 accepts_before_transition = 1u << 31;
+
+    struct State {
+        Vector<u32> nodes;
+        u8 context { 0 };
+        // Index of the next state plus one, or unknown_transition; the high bit says whether
+        // this state accepts before consuming the code unit.
+        Array<u32, cached_code_units> transitions {};
+    };
+
+    explicit LazyDFA(Vector<Node>&&);
+
+    static u8 context_after(u32 code_unit, u8 anchoring_context);
+    static u8 context_at(MatchInput const&, size_t position, u8 anchoring_context);
+
+    u32 state_for(Vector<u32>&& nodes, u8 context);
+    void flush_if_options_changed(AllOptions);
+
+    Optional<size_t> find_match_end(ByteCode const&, MatchInput const&, size_t position, Anchoring);
+
+    bool compute_closure(State const&, ByteCode const&, MatchInput const&, size_t position);
+    Optional<Vector<u32>> compute_step(ByteCode const&, MatchInput const&, size_t position);
+
+    Vector<Node> m_nodes;
+
+    Vector<NonnullOwnPtr<State>> m_states;
+    HashMap<u32, Vector<u32, 1>> m_states_by_hash;
+    Optional<AllOptions> m_cached_options;
+    u32 m_flush_count { 0 };
+
+    // Scratch space for the NFA simulation.
+    Vector<u32> m_visited_generation;
+    u32 m_generation { 0 };
+    Vector<u32> m_closure;
+    Vector<u32> m_worklist;
+    MatchState m_match_state;
+};
+
+}
@@ -77,6 +77,8 @@ public:
         return m_view.get<Utf8View>();
     }
 
+    bool is_u8_view() const { return m_view.has<Utf8View>(); }
+
     bool unicode() const { return m_unicode; }
     void set_unicode(bool unicode) { m_unicode = unicode; }
 
@@ -185,6 +185,8 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
 
     auto single_match_only = input.regex_options.has_flag_set(AllFlags::SingleMatch);
 
+    auto& bytecode = m_pattern->parser_result.bytecode;
+
     for (auto const& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -194,6 +196,11 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         input.view = view;
         dbgln_if(REGEX_DEBUG, "[match] Starting match with view ({}): _{}_", view.length(), view);
 
+        // The automaton can only rule out matches. A search scans ahead with it once to find where the earliest
+        // possible match ends, and the backtracker is then only started at positions up to there.
+        auto* lazy_dfa = LazyDFA::can_run_on(input) ? m_lazy_dfa.ptr() : nullptr;
+        Optional<size_t> last_possible_start;
+
         auto view_length = view.length();
         size_t view_index = m_pattern->start_offset;
         state.string_position = view_index;
@@ -243,6 +250,17 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             input.column = match_count;
             input.match_index = match_count;
 
+            if (lazy_dfa && continue_search) {
+                // Every scan starts where the previous one (or the last match) ended, so the input is only scanned once in total.
+                if (!last_possible_start.has_value() || view_index > *last_possible_start) {
+                    last_possible_start = lazy_dfa->find_earliest_match_end(bytecode, input, view_index);
+                    if (!last_possible_start.has_value())
+                        break;
+                }
+            } else if (lazy_dfa && !lazy_dfa->may_match_at(bytecode, input, view_index)) {
+                break;
+            }
+
             state.string_position = view_index;
             state.string_position_in_code_units = view_index;
             state.instruction_position = 0;
@@ -251,6 +269,8 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             auto success = execute(input, state, operations);
             if (success) {
                 succeeded = true;
+                // The next match can only start after this one, which may be beyond the earliest end we know about.
+                last_possible_start.clear();
 
                 if (input.regex_options.has_flag_set(AllFlags::MatchNotEndOfLine) && state.string_position == input.view.length()) {
                     if (!continue_search)
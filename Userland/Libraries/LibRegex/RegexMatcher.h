@@ -7,6 +7,7 @@
 #pragma once
 
 #include "RegexByteCode.h"
+#include "RegexDFA.h"
 #include "RegexMatch.h"
 #include "RegexOptions.h"
 #include "RegexParser.h"
@@ -56,6 +57,7 @@ public:
     Matcher(Regex<Parser> const* pattern, Optional<typename ParserTraits<Parser>::OptionsType> regex_options = {})
         : m_pattern(pattern)
         , m_regex_options(regex_options.value_or({}))
+        , m_lazy_dfa(LazyDFA::try_create(pattern->parser_result.bytecode))
     {
     }
     ~Matcher() = default;
@@ -78,8 +80,15 @@ private:
 
     Regex<Parser> const* m_pattern;
     typename ParserTraits<Parser>::OptionsType const m_regex_options;
+
+    // Used to skip running the backtracker where it can't possibly succeed, null if the pattern isn't supported by it.
+    // It caches the states it computes while matching, which is fine as long as only one match runs at a time (see Regex).
+    mutable OwnPtr<LazyDFA> m_lazy_dfa;
 };
 
+// Regexes are not thread-safe. Matching changes the Regex (the automaton's cache of states, and the position that stateful
+// regexes continue from), and the backtracker runs the matches of all regexes through the same ByteCode opcode objects.
+// Threads that match at the same time, even with regexes of their own, have to serialize their matches.
 template<class Parser>
 class Regex final {
 public:
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/QueryPlan.h>
+#include <LibSQL/ResultSet.h>
+#include <LibSQL/Tuple.h>
+
+namespace SQL::AST {
+
+ResultOr<ResultSet> Explain::execute(ExecutionContext& context) const
+{
+    auto plan = TRY(QueryPlan::create(context, *m_select_statement));
+    auto steps = plan.describe();
+
+    auto descriptor = adopt_ref(*new TupleDescriptor);
+    descriptor->append({ "", "", "plan", SQLType::Text, Order::Ascending });
+
+    ResultSet result { SQLCommand::Explain };
+    TRY(result.try_ensure_capacity(steps.size()));
+
+    for (auto& step : steps) {
+        Tuple tuple(descriptor);
+        tuple[0] = step;
+
+        result.insert_row(tuple, Tuple {});
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/Operator.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Row.h>
+
+namespace SQL::AST {
+
+ResultOr<bool> evaluate_filters(ExecutionContext& context, NonnullRefPtrVector<Expression> const& filters, Tuple& row)
+{
+    context.current_row = &row;
+    for (auto const& filter : filters) {
+        auto value = TRY(filter.evaluate(context));
+
+        // A row only passes if every filter is true; NULL and values that aren't booleans don't count as true.
+        auto passes = value.to_bool();
+        if (!passes.has_value() || !passes.value())
+            return false;
+    }
+    return true;
+}
+
+ResultOr<Optional<Tuple>> ConstantRowOperator::next(ExecutionContext&)
+{
+    if (m_produced_row)
+        return Optional<Tuple> {};
+    m_produced_row = true;
+    return Tuple {};
+}
+
+TableScanOperator::TableScanOperator(NonnullRefPtr<TableDef> table, NonnullRefPtrVector<Expression> filters)
+    : m_table(move(table))
+    , m_filters(move(filters))
+    , m_descriptor(m_table->to_tuple_descriptor())
+{
+}
+
+ResultOr<Optional<Tuple>> TableScanOperator::next(ExecutionContext& context)
+{
+    if (!m_next_pointer.has_value())
+        m_next_pointer = m_table->pointer();
+
+    while (m_next_pointer.value() != 0) {
+        auto table_row = TRY(context.database->read_row(*m_table, m_next_pointer.value()));
+        m_next_pointer = table_row.next_pointer();
+
+        // Rows read from the database only know their column names, so they are given the table's descriptor
+        // to allow qualified column references.
+        Tuple row(m_descriptor);
+        row.clear();
+        row.extend(table_row);
+        if (TRY(evaluate_filters(context, m_filters, row)))
+            return row;
+    }
+
+    return Optional<Tuple> {};
+}
+
+JoinOperator::JoinOperator(NonnullOwnPtr<Operator> left, NonnullOwnPtr<Operator> right, NonnullRefPtr<TupleDescriptor> descriptor, NonnullRefPtrVector<Expression> join_filters, Optional<HashKey> hash_key)
+    : m_left(move(left))
+    , m_right(move(right))
+    , m_descriptor(move(descriptor))
+    , m_join_filters(move(join_filters))
+    , m_hash_key(move(hash_key))
+{
+}
+
+ResultOr<Optional<Tuple>> JoinOperator::next(ExecutionContext& context)
+{
+    while (true) {
+        while (m_left_row.has_value() && m_next_candidate < m_candidate_count) {
+            auto index = m_candidates ? m_candidates->at(m_next_candidate) : m_next_candidate;
+            ++m_next_candidate;
+
+            Tuple joined_row(m_descriptor);
+            joined_row.clear();
+            joined_row.extend(m_left_row.value());
+            joined_row.extend(m_right_rows[index]);
+            if (TRY(evaluate_filters(context, m_join_filters, joined_row)))
+                return joined_row;
+        }
+
+        m_left_row = TRY(m_left->next(context));
+        if (!m_left_row.has_value())
+            return Optional<Tuple> {};
+
+        if (!m_has_read_right_rows)
+            TRY(read_right_rows(context));
+        TRY(find_candidates(context));
+    }
+}
+
+ResultOr<void> JoinOperator::read_right_rows(ExecutionContext& context)
+{
+    m_has_read_right_rows = true;
+
+    while (true) {
+        auto row = TRY(m_right->next(context));
+        if (!row.has_value())
+            break;
+        m_right_rows.append(row.release_value());
+    }
+
+    if (!m_hash_key.has_value())
+        return {};
+
+    for (size_t ix = 0; ix < m_right_rows.size(); ++ix) {
+        context.current_row = &m_right_rows[ix];
+        auto key = TRY(m_hash_key->build_key->evaluate(context));
+        if (key.is_null())
+            continue;
+        m_buckets.ensure(key.hash()).append(ix);
+    }
+    return {};
+}
+
+ResultOr<void> JoinOperator::find_candidates(ExecutionContext& context)
+{
+    m_next_candidate = 0;
+    m_candidates = nullptr;
+    m_candidate_count = m_right_rows.size();
+
+    if (!m_hash_key.has_value())
+        return {};
+
+    context.current_row = &m_left_row.value();
+    auto probe_value = TRY(m_hash_key->probe_key->evaluate(context));
+
+    // NULL never compares equal to anything.
+    if (probe_value.is_null()) {
+        m_candidate_count = 0;
+        return {};
+    }
+
+    // Values of different types may still compare equal after conversion, so those are tried against every row.
+    if (probe_value.type() != m_hash_key->type)
+        return {};
+
+    auto bucket = m_buckets.find(probe_value.hash());
+    if (bucket == m_buckets.end()) {
+        m_candidate_count = 0;
+        return {};
+    }
+
+    // The join filters still check every candidate, as buckets may contain hash collisions.
+    m_candidates = &bucket->value;
+    m_candidate_count = bucket->value.size();
+    return {};
+}
+
+FilterOperator::FilterOperator(NonnullOwnPtr<Operator> input, NonnullRefPtrVector<Expression> filters)
+    : m_input(move(input))
+    , m_filters(move(filters))
+{
+}
+
+ResultOr<Optional<Tuple>> FilterOperator::next(ExecutionContext& context)
+{
+    while (true) {
+        auto row = TRY(m_input->next(context));
+        if (!row.has_value())
+            return Optional<Tuple> {};
+        if (TRY(evaluate_filters(context, m_filters, row.value())))
+            return row;
+    }
+}
+
+SortOperator::SortOperator(NonnullOwnPtr<Operator> input, NonnullRefPtrVector<OrderingTerm> ordering_terms)
+    : m_input(move(input))
+    , m_ordering_terms(move(ordering_terms))
+{
+}
+
+ResultOr<Optional<Tuple>> SortOperator::next(ExecutionContext& context)
+{
+    if (!m_sorted_rows.has_value()) {
+        m_sorted_rows.emplace(SQLCommand::Select);
+
+        auto sort_descriptor = adopt_ref(*new TupleDescriptor);
+        for (auto const& term : m_ordering_terms)
+            sort_descriptor->append(TupleElementDescriptor { .order = term.order() });
+        Tuple sort_key(sort_descriptor);
+
+        while (true) {
+            auto row = TRY(m_input->next(context));
+            if (!row.has_value())
+                break;
+
+            context.current_row = &row.value();
+            sort_key.clear();
+            for (auto const& term : m_ordering_terms) {
+                auto value = TRY(term.expression()->evaluate(context));
+                sort_key.append(value);
+            }
+            m_sorted_rows->insert_row(row.value(), sort_key);
+        }
+    }
+
+    if (m_next_row >= m_sorted_rows->size())
+        return Optional<Tuple> {};
+    return m_sorted_rows->at(m_next_row++).row;
+}
+
+ProjectOperator::ProjectOperator(NonnullOwnPtr<Operator> input, NonnullRefPtrVector<ResultColumn> columns)
+    : m_input(move(input))
+    , m_columns(move(columns))
+    , m_descriptor(adopt_ref(*new TupleDescriptor))
+{
+}
+
+ResultOr<Optional<Tuple>> ProjectOperator::next(ExecutionContext& context)
+{
+    auto row = TRY(m_input->next(context));
+    if (!row.has_value())
+        return Optional<Tuple> {};
+
+    context.current_row = &row.value();
+
+    // The descriptor is filled in by the values of the first row, and shared by all the following ones.
+    Tuple tuple(m_descriptor);
+    tuple.clear();
+    for (auto const& column : m_columns) {
+        auto value = TRY(column.expression()->evaluate(context));
+        tuple.append(value);
+    }
+
+    context.current_row = nullptr;
+    return tuple;
+}
+
+LimitOperator::LimitOperator(NonnullOwnPtr<Operator> input, size_t offset, size_t limit)
+    : m_input(move(input))
+    , m_rows_to_skip(offset)
+    , m_rows_left(limit)
+{
+}
+
+ResultOr<Optional<Tuple>> LimitOperator::next(ExecutionContext& context)
+{
+    for (; m_rows_to_skip > 0; --m_rows_to_skip) {
+        auto row = TRY(m_input->next(context));
+        if (!row.has_value())
+            return Optional<Tuple> {};
+    }
+
+    if (m_rows_left == 0)
+        return Optional<Tuple> {};
+
+    auto row = TRY(m_input->next(context));
+    if (row.has_value())
+        --m_rows_left;
+    return row;
+}
+
+}
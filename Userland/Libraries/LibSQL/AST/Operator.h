@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Result.h>
+#include <LibSQL/ResultSet.h>
+#include <LibSQL/Tuple.h>
+
+namespace SQL::AST {
+
+// A node of a pull-based operator tree. Statements that produce rows are executed by repeatedly asking the
+// root operator for its next row, which in turn pulls rows from its children only as far as it needs them.
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // Returns the next row, or an empty Optional once all rows have been produced.
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) = 0;
+
+protected:
+    Operator() = default;
+};
+
+// Produces a single row without any columns, for statements that don't read from a table.
+class ConstantRowOperator final : public Operator {
+public:
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    bool m_produced_row { false };
+};
+
+// Reads the rows of a table one at a time, following the list they are stored in.
+class TableScanOperator final : public Operator {
+public:
+    TableScanOperator(NonnullRefPtr<TableDef>, NonnullRefPtrVector<Expression> filters);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullRefPtr<TableDef> m_table;
+    NonnullRefPtrVector<Expression> m_filters;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    Optional<u32> m_next_pointer;
+};
+
+// Combines every row of the left operator with the matching rows of the right one. The right side is read
+// completely on the first call, and looked up through a hash table if a hash key is given.
+class JoinOperator final : public Operator {
+public:
+    struct HashKey {
+        NonnullRefPtr<Expression> build_key;
+        NonnullRefPtr<Expression> probe_key;
+        SQLType type;
+    };
+
+    JoinOperator(NonnullOwnPtr<Operator> left, NonnullOwnPtr<Operator> right, NonnullRefPtr<TupleDescriptor>, NonnullRefPtrVector<Expression> join_filters, Optional<HashKey>);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    ResultOr<void> read_right_rows(ExecutionContext&);
+    ResultOr<void> find_candidates(ExecutionContext&);
+
+    NonnullOwnPtr<Operator> m_left;
+    NonnullOwnPtr<Operator> m_right;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    NonnullRefPtrVector<Expression> m_join_filters;
+    Optional<HashKey> m_hash_key;
+
+    bool m_has_read_right_rows { false };
+    Vector<Tuple> m_right_rows;
+    HashMap<u32, Vector<size_t>> m_buckets;
+
+    Optional<Tuple> m_left_row;
+    // The right rows that may match the current left row: either a hash bucket or, if null, all of them.
+    Vector<size_t> const* m_candidates { nullptr };
+    size_t m_candidate_count { 0 };
+    size_t m_next_candidate { 0 };
+};
+
+class FilterOperator final : public Operator {
+public:
+    FilterOperator(NonnullOwnPtr<Operator>, NonnullRefPtrVector<Expression> filters);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    NonnullRefPtrVector<Expression> m_filters;
+};
+
+// Has to read all of its input before producing the first row.
+class SortOperator final : public Operator {
+public:
+    SortOperator(NonnullOwnPtr<Operator>, NonnullRefPtrVector<OrderingTerm>);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    NonnullRefPtrVector<OrderingTerm> m_ordering_terms;
+    Optional<ResultSet> m_sorted_rows;
+    size_t m_next_row { 0 };
+};
+
+class ProjectOperator final : public Operator {
+public:
+    ProjectOperator(NonnullOwnPtr<Operator>, NonnullRefPtrVector<ResultColumn>);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    NonnullRefPtrVector<ResultColumn> m_columns;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+};
+
+// Stops pulling rows from its input as soon as the limit is reached.
+class LimitOperator final : public Operator {
+public:
+    LimitOperator(NonnullOwnPtr<Operator>, size_t offset, size_t limit);
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    size_t m_rows_to_skip { 0 };
+    size_t m_rows_left { 0 };
+};
+
+ResultOr<bool> evaluate_filters(ExecutionContext&, NonnullRefPtrVector<Expression> const& filters, Tuple& row);
+
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringBuilder.h>
+#include <AK/TypeCasts.h>
+#include <LibSQL/AST/Operator.h>
+#include <LibSQL/AST/QueryPlan.h>
+#include <LibSQL/Database.h>
+
+namespace SQL::AST {
+
+static void split_into_terms(NonnullRefPtr<Expression> const& expression, NonnullRefPtrVector<Expression>& terms)
+{
+    // Binary operators don't have precedence in the parser yet, so terms have to be parenthesized, e.g. `(a = 1) AND (b = 2)`.
+    if (auto const* chained_expression = dynamic_cast<ChainedExpression const*>(expression.ptr()); chained_expression && chained_expression->expressions().size() == 1) {
+        split_into_terms(chained_expression->expressions().first(), terms);
+        return;
+    }
+
+    if (auto const* binary_expression = dynamic_cast<BinaryOperatorExpression const*>(expression.ptr()); binary_expression && binary_expression->type() == BinaryOperator::And) {
+        split_into_terms(binary_expression->lhs(), terms);
+        split_into_terms(binary_expression->rhs(), terms);
+        return;
+    }
+    terms.append(expression);
+}
+
+static Optional<size_t> scan_for_column(ColumnNameExpression const& column, Vector<QueryPlan::TableScan> const& scans)
+{
+    Optional<size_t> scan_index;
+    for (size_t ix = 0; ix < scans.size(); ++ix) {
+        auto const& table = *scans[ix].table;
+        if (!column.table_name().is_empty() && table.name() != column.table_name())
+            continue;
+        for (auto const& column_def : table.columns()) {
+            if (column_def.name() != column.column_name())
+                continue;
+            // An ambiguous column name is left for the evaluation on complete rows to report.
+            if (scan_index.has_value())
+                return {};
+            scan_index = ix;
+            break;
+        }
+    }
+    return scan_index;
+}
+
+// Collects the scans whose columns are referenced by the expression. Returns false if the expression
+// refers to something that can't be attributed to a scan, in which case it has to see the complete row.
+static bool collect_referenced_scans(Expression const& expression, Vector<QueryPlan::TableScan> const& scans, Vector<size_t>& referenced_scans)
+{
+    if (auto const* column = dynamic_cast<ColumnNameExpression const*>(&expression)) {
+        auto scan_index = scan_for_column(*column, scans);
+        if (!scan_index.has_value())
+            return false;
+        if (!referenced_scans.contains_slow(*scan_index))
+            referenced_scans.append(*scan_index);
+        return true;
+    }
+
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<NullLiteral>(expression))
+        return true;
+
+    if (auto const* unary_expression = dynamic_cast<UnaryOperatorExpression const*>(&expression))
+        return collect_referenced_scans(*unary_expression->expression(), scans, referenced_scans);
+
+    if (auto const* binary_expression = dynamic_cast<BinaryOperatorExpression const*>(&expression)) {
+        return collect_referenced_scans(*binary_expression->lhs(), scans, referenced_scans)
+            && collect_referenced_scans(*binary_expression->rhs(), scans, referenced_scans);
+    }
+
+    if (auto const* match_expression = dynamic_cast<MatchExpression const*>(&expression)) {
+        if (match_expression->escape() && !collect_referenced_scans(*match_expression->escape(), scans, referenced_scans))
+            return false;
+        return collect_referenced_scans(*match_expression->lhs(), scans, referenced_scans)
+            && collect_referenced_scans(*match_expression->rhs(), scans, referenced_scans);
+    }
+
+    if (auto const* chained_expression = dynamic_cast<ChainedExpression const*>(&expression)) {
+        for (auto const& element : chained_expression->expressions()) {
+            if (!collect_referenced_scans(element, scans, referenced_scans))
+                return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+static bool can_hash_join_on(SQLType type)
+{
+    // For these types, values compare equal exactly if they are the same value, so equal values have equal hashes.
+    return type == SQLType::Integer || type == SQLType::Text || type == SQLType::Boolean;
+}
+
+static Optional<SQLType> column_type(TableDef const& table, ColumnNameExpression const& column)
+{
+    for (auto const& column_def : table.columns()) {
+        if (column_def.name() == column.column_name())
+            return column_def.type();
+    }
+    return {};
+}
+
+static String column_reference(ColumnNameExpression const& column)
+{
+    if (column.table_name().is_empty())
+        return column.column_name();
+    return String::formatted("{}.{}", column.table_name(), column.column_name());
+}
+
+ResultOr<QueryPlan> QueryPlan::create(ExecutionContext& context, Select const& select)
+{
+    QueryPlan plan;
+
+    for (auto const& table_descriptor : select.table_or_subquery_list()) {
+        if (!table_descriptor.is_table())
+            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
+
+        auto table_def = TRY(context.database->get_table(table_descriptor.schema_name(), table_descriptor.table_name()));
+        if (!table_def)
+            return Result { SQLCommand::Select, SQLErrorCode::TableDoesNotExist, table_descriptor.table_name() };
+        if (table_def->num_columns() == 0)
+            continue;
+
+        plan.m_scans.append({ table_def.release_nonnull() });
+    }
+
+    if (select.where_clause()) {
+        NonnullRefPtrVector<Expression> terms;
+        split_into_terms(*select.where_clause(), terms);
+        for (auto& term : terms)
+            plan.add_term(term);
+    }
+
+    return plan;
+}
+
+void QueryPlan::add_term(NonnullRefPtr<Expression> term)
+{
+    Vector<size_t> referenced_scans;
+    if (m_scans.is_empty() || !collect_referenced_scans(*term, m_scans, referenced_scans)) {
+        m_residual_filters.append(move(term));
+        return;
+    }
+
+    if (referenced_scans.is_empty()) {
+        // Constant terms are still evaluated once per row, as the whole WHERE clause used to be.
+        m_scans.first().filters.append(move(term));
+        return;
+    }
+
+    if (referenced_scans.size() == 1) {
+        m_scans[referenced_scans.first()].filters.append(move(term));
+        return;
+    }
+
+    size_t last_scan_index = 0;
+    for (auto scan_index : referenced_scans)
+        last_scan_index = max(last_scan_index, scan_index);
+    auto& scan = m_scans[last_scan_index];
+
+    // The term is kept as a join filter even if it drives a hash join, as hash buckets may contain collisions.
+    scan.join_filters.append(term);
+    if (scan.hash_key)
+        return;
+
+    auto const* equality = dynamic_cast<BinaryOperatorExpression const*>(term.ptr());
+    if (!equality || equality->type() != BinaryOperator::Equals)
+        return;
+
+    auto try_hash_key = [&](NonnullRefPtr<Expression> const& key, NonnullRefPtr<Expression> const& probe) {
+        auto const* column = dynamic_cast<ColumnNameExpression const*>(key.ptr());
+        if (!column || scan_for_column(*column, m_scans) != last_scan_index)
+            return false;
+        auto type = column_type(*scan.table, *column);
+        if (!type.has_value() || !can_hash_join_on(*type))
+            return false;
+
+        Vector<size_t> probe_scans;
+        if (!collect_referenced_scans(*probe, m_scans, probe_scans) || probe_scans.contains_slow(last_scan_index))
+            return false;
+
+        scan.hash_key = static_ptr_cast<ColumnNameExpression>(key);
+        scan.probe_key = probe;
+        return true;
+    };
+
+    if (!try_hash_key(equality->rhs(), equality->lhs()))
+        try_hash_key(equality->lhs(), equality->rhs());
+}
+
+NonnullOwnPtr<Operator> QueryPlan::create_operator() const
+{
+    if (m_scans.is_empty())
+        return make<FilterOperator>(make<ConstantRowOperator>(), m_residual_filters);
+
+    auto const& first_scan = m_scans.first();
+    NonnullOwnPtr<Operator> rows = make<TableScanOperator>(first_scan.table, first_scan.filters);
+    auto descriptor = first_scan.table->to_tuple_descriptor();
+
+    for (size_t ix = 1; ix < m_scans.size(); ++ix) {
+        auto const& scan = m_scans[ix];
+
+        auto joined_descriptor = adopt_ref(*new TupleDescriptor);
+        joined_descriptor->extend(descriptor);
+        joined_descriptor->extend(scan.table->to_tuple_descriptor());
+
+        Optional<JoinOperator::HashKey> hash_key;
+        if (scan.hash_key)
+            hash_key = JoinOperator::HashKey { *scan.hash_key, *scan.probe_key, column_type(*scan.table, *scan.hash_key).value() };
+
+        rows = make<JoinOperator>(move(rows), make<TableScanOperator>(scan.table, scan.filters), joined_descriptor, scan.join_filters, move(hash_key));
+        descriptor = move(joined_descriptor);
+    }
+
+    if (!m_residual_filters.is_empty())
+        rows = make<FilterOperator>(move(rows), m_residual_filters);
+    return rows;
+}
+
+Vector<String> QueryPlan::describe() const
+{
+    Vector<String> steps;
+
+    if (m_scans.is_empty())
+        steps.append("CONSTANT ROW");
+
+    for (size_t ix = 0; ix < m_scans.size(); ++ix) {
+        auto const& scan = m_scans[ix];
+        auto table_name = String::formatted("{}.{}", scan.table->parent()->name(), scan.table->name());
+
+        StringBuilder builder;
+        if (ix == 0)
+            builder.appendff("SCAN {}", table_name);
+        else if (scan.hash_key)
+            builder.appendff("HASH JOIN {} ON {}", table_name, column_reference(*scan.hash_key));
+        else
+            builder.appendff("NESTED LOOP JOIN {}", table_name);
+
+        if (!scan.filters.is_empty())
+            builder.appendff(" FILTERED BY {} TERM(S)", scan.filters.size());
+        if (!scan.join_filters.is_empty())
+            builder.appendff(" JOIN FILTERED BY {} TERM(S)", scan.join_filters.size());
+        steps.append(builder.build());
+    }
+
+    if (!m_residual_filters.is_empty())
+        steps.append(String::formatted("FILTER COMPLETE ROWS BY {} TERM(S)", m_residual_filters.size()));
+
+    return steps;
+}
+
+}
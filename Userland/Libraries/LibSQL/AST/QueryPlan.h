@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/RefPtr.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Result.h>
+
+namespace SQL::AST {
+
+// Describes how the rows of a SELECT statement are produced from its FROM and WHERE clauses.
+//
+// The WHERE clause is split into its AND-ed terms, and every term is evaluated as soon as all the
+// columns it refers to are available, instead of on the full cartesian product of all tables:
+//  - Terms on a single table filter the rows of that table while it is scanned.
+//  - Terms spanning several tables filter the partially joined rows right after the last of those
+//    tables is joined in.
+//  - An equality between a column of the table being joined and an expression over the tables joined
+//    before it turns the join into a hash join on that column.
+// Terms that can't be attributed to specific tables are evaluated on the complete rows.
+class QueryPlan {
+public:
+    struct TableScan {
+        NonnullRefPtr<TableDef> table;
+        NonnullRefPtrVector<Expression> filters {};
+        NonnullRefPtrVector<Expression> join_filters {};
+        RefPtr<ColumnNameExpression> hash_key {};
+        RefPtr<Expression> probe_key {};
+    };
+
+    static ResultOr<QueryPlan> create(ExecutionContext&, Select const&);
+
+    Vector<TableScan> const& scans() const { return m_scans; }
+    NonnullRefPtrVector<Expression> const& residual_filters() const { return m_residual_filters; }
+
+    // Builds the operators producing the rows that satisfy the WHERE clause, with the columns of every
+    // table in the order the tables appear in the FROM clause.
+    NonnullOwnPtr<Operator> create_operator() const;
+
+    // One line per step of the plan, as shown by EXPLAIN.
+    Vector<String> describe() const;
+
+private:
+    QueryPlan() = default;
+
+    void add_term(NonnullRefPtr<Expression>);
+
+    Vector<TableScan> m_scans;
+    NonnullRefPtrVector<Expression> m_residual_filters;
+};
+
+}
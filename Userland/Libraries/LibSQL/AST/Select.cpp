@@ -6,13 +6,15 @@
 
 #include <AK/NumericLimits.h>
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Operator.h>
+#include <LibSQL/AST/QueryPlan.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
 
 namespace SQL::AST {
 
-ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+ResultOr<NonnullOwnPtr<Operator>> Select::create_operator(ExecutionContext& context) const
 {
     NonnullRefPtrVector<ResultColumn> columns;
 
@@ -48,72 +50,11 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
         }
     }
 
-    ResultSet result { SQLCommand::Select };
-
-    auto descriptor = adopt_ref(*new TupleDescriptor);
-    Tuple tuple(descriptor);
-    Vector<Tuple> rows;
-    descriptor->empend("__unity__"sv);
-    tuple.append(Value(SQLType::Boolean, true));
-    rows.append(tuple);
-
-    for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor.is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
-
-        auto table_def = TRY(context.database->get_table(table_descriptor.schema_name(), table_descriptor.table_name()));
-        if (table_def->num_columns() == 0)
-            continue;
-
-        auto old_descriptor_size = descriptor->size();
-        descriptor->extend(table_def->to_tuple_descriptor());
-
-        while (!rows.is_empty() && (rows.first().size() == old_descriptor_size)) {
-            auto cartesian_row = rows.take_first();
-            auto table_rows = TRY(context.database->select_all(*table_def));
-
-            for (auto& table_row : table_rows) {
-                auto new_row = cartesian_row;
-                new_row.extend(table_row);
-                rows.append(new_row);
-            }
-        }
-    }
-
-    bool has_ordering { false };
-    auto sort_descriptor = adopt_ref(*new TupleDescriptor);
-    for (auto& term : m_ordering_term_list) {
-        sort_descriptor->append(TupleElementDescriptor { .order = term.order() });
-        has_ordering = true;
-    }
-    Tuple sort_key(sort_descriptor);
-
-    for (auto& row : rows) {
-        context.current_row = &row;
-
-        if (where_clause()) {
-            auto where_result = TRY(where_clause()->evaluate(context));
-            if (!where_result)
-                continue;
-        }
-
-        tuple.clear();
-
-        for (auto& col : columns) {
-            auto value = TRY(col.expression()->evaluate(context));
-            tuple.append(value);
-        }
-
-        if (has_ordering) {
-            sort_key.clear();
-            for (auto& term : m_ordering_term_list) {
-                auto value = TRY(term.expression()->evaluate(context));
-                sort_key.append(value);
-            }
-        }
-
-        result.insert_row(tuple, sort_key);
-    }
+    auto plan = TRY(QueryPlan::create(context, *this));
+    auto rows = plan.create_operator();
+    if (!m_ordering_term_list.is_empty())
+        rows = make<SortOperator>(move(rows), m_ordering_term_list);
+    rows = make<ProjectOperator>(move(rows), move(columns));
 
     if (m_limit_clause != nullptr) {
         size_t limit_value = NumericLimits<size_t>::max();
@@ -139,7 +80,22 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
             }
         }
 
-        result.limit(offset_value, limit_value);
+        rows = make<LimitOperator>(move(rows), offset_value, limit_value);
+    }
+
+    return rows;
+}
+
+ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+{
+    auto rows = TRY(create_operator(context));
+
+    ResultSet result { SQLCommand::Select };
+    while (true) {
+        auto row = TRY(rows->next(context));
+        if (!row.has_value())
+            break;
+        result.insert_row(row.value(), Tuple {});
     }
 
     return result;
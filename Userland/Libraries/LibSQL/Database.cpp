@@ -179,11 +179,18 @@ ErrorOr<Vector<Row>> Database::select_all(TableDef const& table)
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
     Vector<Row> ret;
     for (auto pointer = table.pointer(); pointer; pointer = ret.last().next_pointer()) {
-        ret.append(m_serializer.deserialize_block<Row>(pointer, table, pointer));
+        ret.append(TRY(read_row(table, pointer)));
     }
     return ret;
 }
 
+// The rows of a table form a list, starting at TableDef::pointer() and linked through Row::next_pointer().
+ErrorOr<Row> Database::read_row(TableDef const& table, u32 pointer)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    return m_serializer.deserialize_block<Row>(pointer, table, pointer);
+}
+
 ErrorOr<Vector<Row>> Database::match(TableDef const& table, Key const& key)
 {
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
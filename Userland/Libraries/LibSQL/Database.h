@@ -30,6 +30,7 @@ public:
     ErrorOr<void> open();
     bool is_open() const { return m_open; }
     ErrorOr<void> commit();
+    Heap::CacheStatistics const& cache_statistics() const { return m_heap->cache_statistics(); }
 
     ErrorOr<void> add_schema(SchemaDef const&);
     static Key get_schema_key(String const&);
@@ -40,6 +41,7 @@ public:
     ErrorOr<RefPtr<TableDef>> get_table(String const&, String const&);
 
     ErrorOr<Vector<Row>> select_all(TableDef const&);
+    ErrorOr<Row> read_row(TableDef const&, u32 pointer);
     ErrorOr<Vector<Row>> match(TableDef const&, Key const&);
     ErrorOr<void> insert(Row&);
     ErrorOr<void> update(Row&);
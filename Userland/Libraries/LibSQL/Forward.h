@@ -57,6 +57,7 @@ class DropTable;
 class ErrorExpression;
 class ErrorStatement;
 class ExistsExpression;
+class Explain;
 class Expression;
 class GroupByClause;
 class InChainedExpression;
@@ -74,9 +75,11 @@ class NestedExpression;
 class NullExpression;
 class NullLiteral;
 class NumericLiteral;
+class Operator;
 class OrderingTerm;
 class Parser;
 class QualifiedTableName;
+class QueryPlan;
 class RenameColumn;
 class RenameTable;
 class ResultColumn;
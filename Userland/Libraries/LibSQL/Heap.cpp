@@ -22,7 +22,7 @@ Heap::Heap(String file_name)
 
 Heap::~Heap()
 {
-    if (m_file && !m_write_ahead_log.is_empty()) {
+    if (m_file) {
         if (auto maybe_error = flush(); maybe_error.is_error())
             warnln("~Heap({}): {}", name(), maybe_error.error());
     }
@@ -60,6 +60,14 @@ ErrorOr<void> Heap::open()
     } else {
         initialize_zero_block();
     }
+
+    // The zero block is rewritten whenever one of the roots or the free list changes, so it is kept in the cache.
+    TRY(pin_block(0));
+
+    // Other blocks are written past the zero block, so it has to be in the file first.
+    if (file_size == 0)
+        TRY(flush());
+    m_committed_next_block = m_next_block;
     dbgln_if(SQL_DEBUG, "Heap file {} opened. Size = {}", name(), size());
     return {};
 }
@@ -70,20 +78,157 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
         warnln("Heap({})::read_block({}): Heap file not opened"sv, name(), block);
         return Error::from_string_literal("Heap()::read_block(): Heap file not opened"sv);
     }
-    auto buffer_or_empty = m_write_ahead_log.get(block);
-    if (buffer_or_empty.has_value())
-        return buffer_or_empty.release_value();
+    if (auto slot = m_cache_slots.get(block); slot.has_value()) {
+        auto& cached_block = m_cache[slot.value()];
+        cached_block.referenced = true;
+        ++m_cache_statistics.hits;
+        return cached_block.buffer;
+    }
 
     if (block >= m_next_block) {
         warnln("Heap({})::read_block({}): block # out of range (>= {})"sv, name(), block, m_next_block);
         return Error::from_string_literal("Heap()::read_block(): block # out of range"sv);
     }
+    ++m_cache_statistics.misses;
+    auto buffer = TRY(read_block_from_file(block));
+    TRY(cache_block(block, buffer));
+    return buffer;
+}
+
+ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
+{
+    dbgln_if(SQL_DEBUG, "Write heap block {} to cache, size {}", block, buffer.size());
+    dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
+        *buffer.offset_pointer(0), *buffer.offset_pointer(1),
+        *buffer.offset_pointer(2), *buffer.offset_pointer(3),
+        *buffer.offset_pointer(4), *buffer.offset_pointer(5),
+        *buffer.offset_pointer(6), *buffer.offset_pointer(7));
+    if (buffer.size() > BLOCKSIZE) {
+        warnln("Heap({})::write_block({}): Oversized block ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
+        return Error::from_string_literal("Heap()::write_block(): Oversized block"sv);
+    }
+
+    if (auto slot = m_cache_slots.get(block); slot.has_value()) {
+        auto& cached_block = m_cache[slot.value()];
+        cached_block.buffer = buffer;
+        cached_block.dirty = true;
+        cached_block.referenced = true;
+        return {};
+    }
+
+    auto* cached_block = TRY(cache_block(block, buffer));
+    cached_block->dirty = true;
+    return {};
+}
+
+ErrorOr<void> Heap::pin_block(u32 block)
+{
+    if (!m_cache_slots.contains(block))
+        TRY(read_block(block));
+    ++m_cache[m_cache_slots.get(block).value()].pin_count;
+    return {};
+}
+
+void Heap::unpin_block(u32 block)
+{
+    auto slot = m_cache_slots.get(block);
+    VERIFY(slot.has_value());
+    auto& cached_block = m_cache[slot.value()];
+    VERIFY(cached_block.pin_count > 0);
+    --cached_block.pin_count;
+}
+
+void Heap::set_cache_size(size_t cache_size)
+{
+    VERIFY(!valid());
+    VERIFY(cache_size > 0);
+    m_cache_size = cache_size;
+}
+
+void Heap::set_read_through_mapping(bool read_through_mapping)
+{
+    m_read_through_mapping = read_through_mapping;
+    if (!m_read_through_mapping)
+        m_mapped_file = nullptr;
+}
+
+ErrorOr<Heap::CachedBlock*> Heap::cache_block(u32 block, ByteBuffer buffer)
+{
+    auto slot = TRY(find_free_cache_slot());
+    auto& cached_block = m_cache[slot];
+    cached_block.block = block;
+    cached_block.buffer = move(buffer);
+    cached_block.pin_count = 0;
+    cached_block.dirty = false;
+    cached_block.referenced = true;
+    m_cache_slots.set(block, slot);
+    return &cached_block;
+}
+
+ErrorOr<size_t> Heap::find_free_cache_slot()
+{
+    if (m_cache.size() < m_cache_size) {
+        TRY(m_cache.try_append({}));
+        return m_cache.size() - 1;
+    }
+
+    // Clock eviction: the hand sweeps over the cache, giving blocks used since it last passed them a second chance.
+    // Dirty blocks haven't been committed yet, so they can't be written to the file and have to stay as well.
+    // Two rounds are enough to find a victim, unless every block is pinned or dirty.
+    for (size_t ix = 0; ix < 2 * m_cache.size(); ++ix) {
+        auto slot = m_clock_hand;
+        m_clock_hand = (m_clock_hand + 1) % m_cache.size();
+
+        auto& cached_block = m_cache[slot];
+        if (cached_block.pin_count > 0 || cached_block.dirty)
+            continue;
+        if (cached_block.referenced) {
+            cached_block.referenced = false;
+            continue;
+        }
+
+        m_cache_slots.remove(cached_block.block);
+        ++m_cache_statistics.evictions;
+        return slot;
+    }
+
+    dbgln_if(SQL_DEBUG, "All {} blocks cached for {} are pinned or dirty, growing the cache", m_cache.size(), name());
+    TRY(m_cache.try_append({}));
+    return m_cache.size() - 1;
+}
+
+ErrorOr<ByteBuffer> Heap::read_block_from_file(u32 block)
+{
+    if (m_file.is_null()) {
+        warnln("Heap({})::read_block_from_file({}): Heap file not opened"sv, name(), block);
+        return Error::from_string_literal("Heap()::read_block_from_file(): Heap file not opened"sv);
+    }
+
+    if (m_read_through_mapping && block < m_end_of_file) {
+        auto block_end = (static_cast<size_t>(block) + 1) * BLOCKSIZE;
+
+        // The mapping is dropped whenever blocks inside it are written, and when the file has grown past it.
+        if (!m_mapped_file || block_end > m_mapped_file->size()) {
+            auto mapped_file_or_error = Core::MappedFile::map(name());
+            if (mapped_file_or_error.is_error()) {
+                dbgln_if(SQL_DEBUG, "Heap({}): Could not map file, reading blocks with read(): {}", name(), mapped_file_or_error.error());
+                m_read_through_mapping = false;
+            } else {
+                m_mapped_file = mapped_file_or_error.release_value();
+            }
+        }
+
+        if (m_mapped_file && block_end <= m_mapped_file->size()) {
+            dbgln_if(SQL_DEBUG, "Read heap block {} from mapping", block);
+            return ByteBuffer::copy(m_mapped_file->bytes().slice(block_end - BLOCKSIZE, BLOCKSIZE));
+        }
+    }
     dbgln_if(SQL_DEBUG, "Read heap block {}", block);
     TRY(seek_block(block));
     auto ret = m_file->read(BLOCKSIZE);
     if (ret.is_empty()) {
-        warnln("Heap({})::read_block({}): Could not read block"sv, name(), block);
-        return Error::from_string_literal("Heap()::read_block(): Could not read block"sv);
+        warnln("Heap({})::read_block_from_file({}): Could not read block"sv, name(), block);
+        return Error::from_string_literal("Heap()::read_block_from_file(): Could not read block"sv);
     }
     dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
         *ret.offset_pointer(0), *ret.offset_pointer(1),
@@ -93,27 +238,35 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
     return ret;
 }
 
-ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
+ErrorOr<void> Heap::write_block_to_file(u32 block, ByteBuffer& buffer)
 {
     if (m_file.is_null()) {
-        warnln("Heap({})::write_block({}): Heap file not opened"sv, name(), block);
-        return Error::from_string_literal("Heap()::write_block(): Heap file not opened"sv);
+        warnln("Heap({})::write_block_to_file({}): Heap file not opened"sv, name(), block);
+        return Error::from_string_literal("Heap()::write_block_to_file(): Heap file not opened"sv);
     }
     if (block > m_next_block) {
-        warnln("Heap({})::write_block({}): block # out of range (> {})"sv, name(), block, m_next_block);
-        return Error::from_string_literal("Heap()::write_block(): block # out of range"sv);
+        warnln("Heap({})::write_block_to_file({}): block # out of range (> {})"sv, name(), block, m_next_block);
+        return Error::from_string_literal("Heap()::write_block_to_file(): block # out of range"sv);
+    }
+
+    // Dirty blocks are not necessarily written back in the order they were allocated in, so the blocks in between
+    // are filled with zeroes until they are written themselves.
+    while (m_end_of_file < block) {
+        auto zero_block = TRY(ByteBuffer::create_zeroed(BLOCKSIZE));
+        TRY(write_block_to_file(m_end_of_file, zero_block));
     }
+
     TRY(seek_block(block));
     dbgln_if(SQL_DEBUG, "Write heap block {} size {}", block, buffer.size());
     if (buffer.size() > BLOCKSIZE) {
-        warnln("Heap({})::write_block({}): Oversized block ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
-        return Error::from_string_literal("Heap()::write_block(): Oversized block"sv);
+        warnln("Heap({})::write_block_to_file({}): Oversized block ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
+        return Error::from_string_literal("Heap()::write_block_to_file(): Oversized block"sv);
     }
     auto sz = buffer.size();
     if (sz < BLOCKSIZE) {
         if (buffer.try_resize(BLOCKSIZE).is_error()) {
-            warnln("Heap({})::write_block({}): Could not align block of size {} to {}"sv, name(), block, buffer.size(), BLOCKSIZE);
-            return Error::from_string_literal("Heap()::write_block(): Could not align block"sv);
+            warnln("Heap({})::write_block_to_file({}): Could not align block of size {} to {}"sv, name(), block, buffer.size(), BLOCKSIZE);
+            return Error::from_string_literal("Heap()::write_block_to_file(): Could not align block"sv);
         }
         memset(buffer.offset_pointer((int)sz), 0, BLOCKSIZE - sz);
     }
@@ -122,13 +275,15 @@ ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
         *buffer.offset_pointer(2), *buffer.offset_pointer(3),
         *buffer.offset_pointer(4), *buffer.offset_pointer(5),
         *buffer.offset_pointer(6), *buffer.offset_pointer(7));
+    if (m_mapped_file && static_cast<size_t>(block) * BLOCKSIZE < m_mapped_file->size())
+        m_mapped_file = nullptr;
     if (m_file->write(buffer.data(), (int)buffer.size())) {
         if (block == m_end_of_file)
             m_end_of_file++;
         return {};
     }
-    warnln("Heap({})::write_block({}): Could not full write block"sv, name(), block);
-    return Error::from_string_literal("Heap()::write_block(): Could not full write block"sv);
+    warnln("Heap({})::write_block_to_file({}): Could not full write block"sv, name(), block);
+    return Error::from_string_literal("Heap()::write_block_to_file(): Could not full write block"sv);
 }
 
 ErrorOr<void> Heap::seek_block(u32 block)
@@ -175,22 +330,71 @@ u32 Heap::new_record_pointer()
 ErrorOr<void> Heap::flush()
 {
     VERIFY(!m_file.is_null());
-    Vector<u32> blocks;
-    for (auto& wal_entry : m_write_ahead_log) {
-        blocks.append(wal_entry.key);
-    }
-    quick_sort(blocks);
-    for (auto& block : blocks) {
-        auto buffer_it = m_write_ahead_log.find(block);
-        VERIFY(buffer_it != m_write_ahead_log.end());
-        dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
-        TRY(write_block(block, buffer_it->value));
-    }
-    m_write_ahead_log.clear();
-    dbgln_if(SQL_DEBUG, "WAL flushed. Heap size = {}", size());
+    Vector<size_t> dirty_slots;
+    for (size_t slot = 0; slot < m_cache.size(); ++slot) {
+        if (m_cache[slot].dirty)
+            dirty_slots.append(slot);
+    }
+    quick_sort(dirty_slots, [&](auto slot, auto other_slot) { return m_cache[slot].block < m_cache[other_slot].block; });
+    for (auto slot : dirty_slots) {
+        auto& cached_block = m_cache[slot];
+        dbgln_if(SQL_DEBUG, "Flushing block {} to {}", cached_block.block, name());
+        TRY(write_block_to_file(cached_block.block, cached_block.buffer));
+        cached_block.dirty = false;
+        ++m_cache_statistics.writebacks;
+    }
+    m_committed_next_block = m_next_block;
+
+    // Dirty blocks may have grown the cache past its size. Now that they are clean, give that room back.
+    if (m_cache.size() > m_cache_size) {
+        Vector<CachedBlock> cache;
+        for (auto& cached_block : m_cache) {
+            if (cached_block.pin_count > 0 || cache.size() < m_cache_size)
+                cache.append(move(cached_block));
+        }
+        m_cache = move(cache);
+        rebuild_cache_slots();
+    }
+    dbgln_if(SQL_DEBUG, "Cache flushed. Heap size = {}", size());
+    return {};
+}
+
+ErrorOr<void> Heap::rollback()
+{
+    VERIFY(!m_file.is_null());
+    // Whoever pinned a block may still be looking at its contents, which rolling back would change under them.
+    for (auto& cached_block : m_cache) {
+        if (cached_block.dirty && cached_block.block != 0 && cached_block.pin_count > 0)
+            return Error::from_string_literal("Heap()::rollback(): Uncommitted block is pinned"sv);
+    }
+
+    Vector<CachedBlock> cache;
+    for (auto& cached_block : m_cache) {
+        if (cached_block.dirty && cached_block.block != 0)
+            continue;
+        cache.append(move(cached_block));
+    }
+    m_cache = move(cache);
+    rebuild_cache_slots();
+
+    // The zero block stays pinned, so it's reloaded in place, along with the roots and the free list it holds.
+    auto& zero_block = m_cache[m_cache_slots.get(0).value()];
+    zero_block.buffer = TRY(read_block_from_file(0));
+    zero_block.dirty = false;
+    TRY(read_zero_block());
+    m_next_block = m_committed_next_block;
+    dbgln_if(SQL_DEBUG, "Rolled back uncommitted blocks of {}. Heap size = {}", name(), size());
     return {};
 }
 
+void Heap::rebuild_cache_slots()
+{
+    m_cache_slots.clear();
+    for (size_t slot = 0; slot < m_cache.size(); ++slot)
+        m_cache_slots.set(m_cache[slot].block, slot);
+    m_clock_hand = 0;
+}
+
 constexpr static StringView FILE_ID = "SerenitySQL "sv;
 constexpr static int VERSION_OFFSET = 12;
 constexpr static int SCHEMAS_ROOT_OFFSET = 16;
@@ -252,7 +456,8 @@ void Heap::update_zero_block()
     buffer.overwrite(FREE_LIST_OFFSET, &m_free_list, sizeof(u32));
     buffer.overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
 
-    add_to_wal(0, buffer);
+    // Once the heap is opened the zero block is pinned, so writing it never has to evict another block.
+    MUST(write_block(0, buffer));
 }
 
 void Heap::initialize_zero_block()
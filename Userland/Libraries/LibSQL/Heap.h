@@ -12,6 +12,7 @@
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/Object.h>
 
 namespace SQL {
@@ -28,16 +29,48 @@ constexpr static u32 BLOCKSIZE = 1024;
  * assumed that a single SQL database is backed by a single Heap.
  *
  * Currently only B-Trees and tuple stores are implemented.
+ *
+ * Blocks are read and written through a bounded cache, which keeps the most
+ * recently used blocks in memory. Written blocks stay dirty in the cache until
+ * the Heap is flushed, which is when they are written to the file. Dirty blocks
+ * are never evicted, so nothing reaches the file before it is committed, and
+ * the cache grows past its size if it has to.
  */
 class Heap : public Core::Object {
     C_OBJECT(Heap);
 
 public:
+    static constexpr size_t default_cache_size = 1024;
+
+    struct CacheStatistics {
+        u64 hits { 0 };
+        u64 misses { 0 };
+        u64 evictions { 0 };
+        u64 writebacks { 0 };
+    };
+
     virtual ~Heap() override;
 
     ErrorOr<void> open();
     u32 size() const { return m_end_of_file; }
     ErrorOr<ByteBuffer> read_block(u32);
+    ErrorOr<void> write_block(u32, ByteBuffer&);
+
+    // Pinned blocks are never evicted from the cache. Every pin_block() has to be matched by an unpin_block().
+    ErrorOr<void> pin_block(u32);
+    void unpin_block(u32);
+
+    // The number of blocks kept in the cache. Can only be changed before the Heap is opened.
+    size_t cache_size() const { return m_cache_size; }
+    void set_cache_size(size_t);
+
+    // Blocks missing from the cache are copied out of a read-only mapping of the file instead of being read with
+    // a seek and a read each.
+    bool reads_through_mapping() const { return m_read_through_mapping; }
+    void set_read_through_mapping(bool);
+
+    CacheStatistics const& cache_statistics() const { return m_cache_statistics; }
+
     [[nodiscard]] u32 new_record_pointer();
     [[nodiscard]] bool has_block(u32 block) const { return block < size(); }
     [[nodiscard]] bool valid() const { return m_file != nullptr; }
@@ -80,23 +113,28 @@ public:
         update_zero_block();
     }
 
-    void add_to_wal(u32 block, ByteBuffer& buffer)
-    {
-        dbgln_if(SQL_DEBUG, "Adding to WAL: block #{}, size {}", block, buffer.size());
-        dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
-            *buffer.offset_pointer(0), *buffer.offset_pointer(1),
-            *buffer.offset_pointer(2), *buffer.offset_pointer(3),
-            *buffer.offset_pointer(4), *buffer.offset_pointer(5),
-            *buffer.offset_pointer(6), *buffer.offset_pointer(7));
-        m_write_ahead_log.set(block, buffer);
-    }
-
     ErrorOr<void> flush();
 
+    // Throws away every block written since the last flush(), leaving the Heap as it was right after it.
+    // Fails without changing anything if one of these blocks is pinned.
+    ErrorOr<void> rollback();
+
 private:
     explicit Heap(String);
 
-    ErrorOr<void> write_block(u32, ByteBuffer&);
+    struct CachedBlock {
+        u32 block { 0 };
+        ByteBuffer buffer;
+        u32 pin_count { 0 };
+        bool dirty { false };
+        bool referenced { false };
+    };
+
+    ErrorOr<CachedBlock*> cache_block(u32, ByteBuffer);
+    ErrorOr<size_t> find_free_cache_slot();
+    void rebuild_cache_slots();
+    ErrorOr<ByteBuffer> read_block_from_file(u32);
+    ErrorOr<void> write_block_to_file(u32, ByteBuffer&);
     ErrorOr<void> seek_block(u32);
     ErrorOr<void> read_zero_block();
     void initialize_zero_block();
@@ -105,13 +143,22 @@ private:
     RefPtr<Core::File> m_file { nullptr };
     u32 m_free_list { 0 };
     u32 m_next_block { 1 };
+    u32 m_committed_next_block { 1 };
     u32 m_end_of_file { 1 };
     u32 m_schemas_root { 0 };
     u32 m_tables_root { 0 };
     u32 m_table_columns_root { 0 };
     u32 m_version { 0x00000001 };
     Array<u32, 16> m_user_values { 0 };
-    HashMap<u32, ByteBuffer> m_write_ahead_log;
+
+    size_t m_cache_size { default_cache_size };
+    Vector<CachedBlock> m_cache;
+    HashMap<u32, size_t> m_cache_slots;
+    size_t m_clock_hand { 0 };
+    CacheStatistics m_cache_statistics;
+
+    bool m_read_through_mapping { true };
+    RefPtr<Core::MappedFile> m_mapped_file;
 };
 
 }
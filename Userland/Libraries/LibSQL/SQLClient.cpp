@@ -48,20 +48,22 @@ void SQLClient::execution_success(int statement_id, bool has_results, int create
         outln("{} row(s) created, {} updated, {} deleted", created, updated, deleted);
 }
 
-void SQLClient::next_result(int statement_id, Vector<String> const& row)
+void SQLClient::next_results(int statement_id, Vector<Vector<String>> const& rows)
 {
-    if (on_next_result) {
-        on_next_result(statement_id, row);
-        return;
+    for (auto& row : rows) {
+        if (on_next_result) {
+            on_next_result(statement_id, row);
+            continue;
+        }
+        bool first = true;
+        for (auto& column : row) {
+            if (!first)
+                out(", ");
+            out("\"{}\"", column);
+            first = false;
+        }
+        outln();
     }
-    bool first = true;
-    for (auto& column : row) {
-        if (!first)
-            out(", ");
-        out("\"{}\"", column);
-        first = false;
-    }
-    outln();
 }
 
 void SQLClient::results_exhausted(int statement_id, int total_rows)
@@ -113,8 +113,7 @@ public:
         VERIFY(m_heap.ptr() != nullptr);
         reset();
         serialize<T>(t);
-        m_heap->add_to_wal(pointer, m_buffer);
-        return true;
+        return !m_heap->write_block(pointer, m_buffer).is_error();
     }
 
     [[nodiscard]] size_t offset() const { return m_current_offset; }
@@ -20,6 +20,13 @@ static constexpr int MILLISECONDS_PER_STATISTICS_PERIOD = 500;
 static constexpr int SUBPIXEL_BITS = 5;
 static constexpr int NUM_LIGHTS = 8;
 
+// Triangles are sorted into square tiles of this many pixels, which are then rasterized in parallel.
+// Must be a multiple of the widest pixel block (4x2) so that no block straddles two tiles.
+static constexpr int RASTERIZER_TILE_SIZE = 64;
+static constexpr int MAX_RASTERIZER_THREADS = 8;
+// Draw calls that cover fewer pixels than this are not worth waking up the other render threads for.
+static constexpr int MIN_PIXELS_FOR_PARALLEL_RASTERIZATION = 2 * RASTERIZER_TILE_SIZE * RASTERIZER_TILE_SIZE;
+
 // See: https://www.khronos.org/opengl/wiki/Common_Mistakes#Texture_edge_color_problem
 // FIXME: make this dynamically configurable through ConfigServer
 static constexpr bool CLAMP_DEPRECATED_BEHAVIOR = false;
@@ -6,11 +6,14 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
+#include <AK/CPUFeatures.h>
 #include <AK/Function.h>
 #include <AK/Math.h>
 #include <AK/NumericLimits.h>
 #include <AK/SIMDExtras.h>
 #include <AK/SIMDMath.h>
+#include <AK/Time.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/Vector2.h>
@@ -22,29 +25,25 @@
 
 namespace SoftGPU {
 
-static long long g_num_rasterized_triangles;
-static long long g_num_pixels;
-static long long g_num_pixels_shaded;
-static long long g_num_pixels_blended;
-static long long g_num_sampler_calls;
-static long long g_num_stencil_writes;
-static long long g_num_quads;
+// These are updated from all render threads
+static Atomic<long long> g_num_rasterized_triangles;
+static Atomic<long long> g_num_pixels;
+static Atomic<long long> g_num_pixels_shaded;
+static Atomic<long long> g_num_pixels_blended;
+static Atomic<long long> g_num_sampler_calls;
+static Atomic<long long> g_num_stencil_writes;
+static Atomic<long long> g_num_quads;
 
 using IntVector2 = Gfx::Vector2<int>;
 using IntVector3 = Gfx::Vector3<int>;
 
 using AK::SIMD::any;
 using AK::SIMD::exp;
-using AK::SIMD::expand4;
 using AK::SIMD::f32x4;
 using AK::SIMD::i32x4;
-using AK::SIMD::load4_masked;
 using AK::SIMD::maskbits;
 using AK::SIMD::maskcount;
 using AK::SIMD::none;
-using AK::SIMD::store4_masked;
-using AK::SIMD::to_f32x4;
-using AK::SIMD::to_u32x4;
 using AK::SIMD::u32x4;
 
 constexpr static int edge_function(const IntVector2& a, const IntVector2& b, const IntVector2& c)
@@ -52,7 +51,8 @@ constexpr static int edge_function(const IntVector2& a, const IntVector2& b, con
     return ((c.x() - a.x()) * (b.y() - a.y()) - (c.y() - a.y()) * (b.x() - a.x()));
 }
 
-constexpr static i32x4 edge_function4(const IntVector2& a, const IntVector2& b, const Vector2<i32x4>& c)
+template<typename I32>
+constexpr static I32 edge_function4(const IntVector2& a, const IntVector2& b, const Vector2<I32>& c)
 {
     return ((c.x() - a.x()) * (b.y() - a.y()) - (c.y() - a.y()) * (b.x() - a.x()));
 }
@@ -63,25 +63,27 @@ constexpr static auto interpolate(const T& v0, const T& v1, const T& v2, const V
     return v0 * barycentric_coords.x() + v1 * barycentric_coords.y() + v2 * barycentric_coords.z();
 }
 
-ALWAYS_INLINE static u32x4 to_rgba32(const Vector4<f32x4>& v)
+template<typename U32, typename F32>
+ALWAYS_INLINE static U32 to_rgba32(const Vector4<F32>& v)
 {
-    auto clamped = v.clamped(expand4(0.0f), expand4(1.0f));
-    auto r = to_u32x4(clamped.x() * 255);
-    auto g = to_u32x4(clamped.y() * 255);
-    auto b = to_u32x4(clamped.z() * 255);
-    auto a = to_u32x4(clamped.w() * 255);
+    auto clamped = v.clamped(expand<F32>(0.0f), expand<F32>(1.0f));
+    auto r = convert<U32>(clamped.x() * 255);
+    auto g = convert<U32>(clamped.y() * 255);
+    auto b = convert<U32>(clamped.z() * 255);
+    auto a = convert<U32>(clamped.w() * 255);
 
     return a << 24 | r << 16 | g << 8 | b;
 }
 
-static Vector4<f32x4> to_vec4(u32x4 rgba)
+template<typename F32, typename U32>
+static Vector4<F32> to_vec4(U32 rgba)
 {
-    auto constexpr one_over_255 = expand4(1.0f / 255);
+    auto constexpr one_over_255 = expand<F32>(1.0f / 255);
     return {
-        to_f32x4((rgba >> 16) & 0xff) * one_over_255,
-        to_f32x4((rgba >> 8) & 0xff) * one_over_255,
-        to_f32x4(rgba & 0xff) * one_over_255,
-        to_f32x4((rgba >> 24) & 0xff) * one_over_255,
+        convert<F32>((rgba >> 16) & 0xff) * one_over_255,
+        convert<F32>((rgba >> 8) & 0xff) * one_over_255,
+        convert<F32>(rgba & 0xff) * one_over_255,
+        convert<F32>((rgba >> 24) & 0xff) * one_over_255,
     };
 }
 
@@ -178,14 +180,124 @@ void Device::setup_blend_factors()
     }
 }
 
-void Device::rasterize_triangle(const Triangle& triangle)
+void Device::create_tiles()
 {
-    INCREASE_STATISTICS_COUNTER(g_num_rasterized_triangles, 1);
+    m_tiles.clear();
+    m_active_tiles.clear();
+
+    auto const target_rect = m_render_target->rect();
+    for (int y = 0; y < target_rect.height(); y += RASTERIZER_TILE_SIZE) {
+        for (int x = 0; x < target_rect.width(); x += RASTERIZER_TILE_SIZE) {
+            RasterizerTile tile;
+            tile.rect = Gfx::IntRect { x, y, RASTERIZER_TILE_SIZE, RASTERIZER_TILE_SIZE }.intersected(target_rect);
+            m_tiles.append(move(tile));
+        }
+    }
+}
 
+void Device::rasterize_triangles()
+{
     // Return if alpha testing is a no-op
     if (m_options.enable_alpha_test && m_options.alpha_test_func == AlphaTestFunction::Never)
         return;
 
+    auto render_bounds = m_render_target->rect();
+    if (m_options.scissor_enabled)
+        render_bounds.intersect(window_coordinates_to_target_coordinates(m_options.scissor_box));
+    if (render_bounds.is_empty())
+        return;
+
+    INCREASE_STATISTICS_COUNTER(g_num_rasterized_triangles, m_processed_triangles.size());
+
+    // Sort the triangles into the tiles that their bounding boxes overlap. Every tile draws its triangles in the
+    // order they were submitted, and tiles share no pixels, so the result is the same as drawing all triangles
+    // one after another.
+    int const tiles_per_row = (m_render_target->width() + RASTERIZER_TILE_SIZE - 1) / RASTERIZER_TILE_SIZE;
+    size_t covered_pixels = 0;
+    for (size_t i = 0; i < m_processed_triangles.size(); ++i) {
+        auto const& vertices = m_processed_triangles[i].vertices;
+        auto const min_x = min(min(vertices[0].window_coordinates.x(), vertices[1].window_coordinates.x()), vertices[2].window_coordinates.x());
+        auto const max_x = max(max(vertices[0].window_coordinates.x(), vertices[1].window_coordinates.x()), vertices[2].window_coordinates.x());
+        auto const min_y = min(min(vertices[0].window_coordinates.y(), vertices[1].window_coordinates.y()), vertices[2].window_coordinates.y());
+        auto const max_y = max(max(vertices[0].window_coordinates.y(), vertices[1].window_coordinates.y()), vertices[2].window_coordinates.y());
+
+        // Leave a pixel of slack on every side, the exact coverage is determined by the rasterizer
+        int const x0 = static_cast<int>(floorf(min_x)) - 1;
+        int const y0 = static_cast<int>(floorf(min_y)) - 1;
+        int const x1 = static_cast<int>(ceilf(max_x)) + 1;
+        int const y1 = static_cast<int>(ceilf(max_y)) + 1;
+        auto const triangle_bounds = Gfx::IntRect { x0, y0, x1 - x0 + 1, y1 - y0 + 1 }.intersected(render_bounds);
+        if (triangle_bounds.is_empty())
+            continue;
+        covered_pixels += triangle_bounds.width() * triangle_bounds.height();
+
+        for (int row = triangle_bounds.top() / RASTERIZER_TILE_SIZE; row <= triangle_bounds.bottom() / RASTERIZER_TILE_SIZE; ++row) {
+            for (int column = triangle_bounds.left() / RASTERIZER_TILE_SIZE; column <= triangle_bounds.right() / RASTERIZER_TILE_SIZE; ++column) {
+                size_t tile_index = row * tiles_per_row + column;
+                auto& tile = m_tiles[tile_index];
+                if (tile.triangle_indices.is_empty())
+                    m_active_tiles.append(tile_index);
+                tile.triangle_indices.append(i);
+            }
+        }
+    }
+
+    Function<void(size_t)> rasterize_tile = [&](size_t active_tile_index) {
+        auto& tile = m_tiles[m_active_tiles[active_tile_index]];
+        auto const tile_bounds = tile.rect.intersected(render_bounds);
+
+        Time start_time;
+        if constexpr (ENABLE_STATISTICS_OVERLAY)
+            start_time = Time::now_monotonic();
+
+        for (auto triangle_index : tile.triangle_indices)
+            rasterize_triangle(m_processed_triangles[triangle_index], tile_bounds);
+        tile.triangle_indices.clear_with_capacity();
+
+        if constexpr (ENABLE_STATISTICS_OVERLAY)
+            tile.microseconds_spent += (Time::now_monotonic() - start_time).to_microseconds();
+    };
+
+    if (covered_pixels < static_cast<size_t>(MIN_PIXELS_FOR_PARALLEL_RASTERIZATION)) {
+        for (size_t i = 0; i < m_active_tiles.size(); ++i)
+            rasterize_tile(i);
+    } else {
+        m_thread_pool.run(m_active_tiles.size(), rasterize_tile);
+    }
+
+    m_active_tiles.clear_with_capacity();
+}
+
+void Device::rasterize_triangle(Triangle const& triangle, Gfx::IntRect const& render_bounds)
+{
+#if ARCH(X86_64)
+    if (m_use_wide_pixel_blocks) {
+        rasterize_triangle_with_wide_blocks(triangle, render_bounds);
+        return;
+    }
+#endif
+    rasterize_triangle_blocks<PixelQuad>(triangle, render_bounds);
+}
+
+#if ARCH(X86_64)
+// Everything that is called from here is inlined, so that the whole 8-lane pipeline is compiled for AVX2.
+[[gnu::target("avx2"), gnu::flatten]] void Device::rasterize_triangle_with_wide_blocks(Triangle const& triangle, Gfx::IntRect const& render_bounds)
+{
+    rasterize_triangle_blocks<WidePixelBlock>(triangle, render_bounds);
+}
+#endif
+
+template<typename PixelBlockType>
+void Device::rasterize_triangle_blocks(Triangle const& triangle, Gfx::IntRect const& render_bounds)
+{
+    using F32 = typename PixelBlockType::f32;
+    using I32 = typename PixelBlockType::i32;
+    using U32 = typename PixelBlockType::u32;
+    using Layout = typename PixelBlockType::Layout;
+    constexpr size_t lanes = PixelBlockType::lanes;
+    constexpr int block_width = Layout::width;
+    constexpr int block_height = Layout::height;
+
     // Vertices
     Vertex const vertex0 = triangle.vertices[0];
     Vertex const vertex1 = triangle.vertices[1];
@@ -204,10 +316,6 @@ void Device::rasterize_triangle(const Triangle& triangle)
 
     auto const one_over_area = 1.0f / area;
 
-    auto render_bounds = m_render_target->rect();
-    if (m_options.scissor_enabled)
-        render_bounds.intersect(window_coordinates_to_target_coordinates(m_options.scissor_box));
-
     // Obey top-left rule:
     // This sets up "zero" for later pixel coverage tests.
     // Depending on where on the triangle the edge is located
@@ -222,7 +330,7 @@ void Device::rasterize_triangle(const Triangle& triangle)
         zero.set_y(0);
 
     // This function calculates the 3 edge values for the pixel relative to the triangle.
-    auto calculate_edge_values4 = [v0, v1, v2](Vector2<i32x4> const& p) -> Vector3<i32x4> {
+    auto calculate_edge_values4 = [v0, v1, v2](Vector2<I32> const& p) -> Vector3<I32> {
         return {
             edge_function4(v1, v2, p),
             edge_function4(v2, v0, p),
@@ -231,7 +339,7 @@ void Device::rasterize_triangle(const Triangle& triangle)
     };
 
     // This function tests whether a point as identified by its 3 edge values lies within the triangle
-    auto test_point4 = [zero](Vector3<i32x4> const& edges) -> i32x4 {
+    auto test_point4 = [zero](Vector3<I32> const& edges) -> I32 {
         return edges.x() >= zero.x()
             && edges.y() >= zero.y()
             && edges.z() >= zero.z();
@@ -239,10 +347,10 @@ void Device::rasterize_triangle(const Triangle& triangle)
 
     // Calculate block-based bounds
     // clang-format off
-    int const bx0 =  max(render_bounds.left(),   min(min(v0.x(), v1.x()), v2.x()) / subpixel_factor) & ~1;
-    int const bx1 = (min(render_bounds.right(),  max(max(v0.x(), v1.x()), v2.x()) / subpixel_factor) & ~1) + 2;
-    int const by0 =  max(render_bounds.top(),    min(min(v0.y(), v1.y()), v2.y()) / subpixel_factor) & ~1;
-    int const by1 = (min(render_bounds.bottom(), max(max(v0.y(), v1.y()), v2.y()) / subpixel_factor) & ~1) + 2;
+    int const bx0 =  max(render_bounds.left(),   min(min(v0.x(), v1.x()), v2.x()) / subpixel_factor) & ~(block_width - 1);
+    int const bx1 = (min(render_bounds.right(),  max(max(v0.x(), v1.x()), v2.x()) / subpixel_factor) & ~(block_width - 1)) + block_width;
+    int const by0 =  max(render_bounds.top(),    min(min(v0.y(), v1.y()), v2.y()) / subpixel_factor) & ~(block_height - 1);
+    int const by1 = (min(render_bounds.bottom(), max(max(v0.y(), v1.y()), v2.y()) / subpixel_factor) & ~(block_height - 1)) + block_height;
     // clang-format on
 
     // Fog depths
@@ -255,28 +363,28 @@ void Device::rasterize_triangle(const Triangle& triangle)
     int const render_bounds_top = render_bounds.y();
     int const render_bounds_bottom = render_bounds.y() + render_bounds.height();
 
-    auto const half_pixel_offset = Vector2<i32x4> {
-        expand4(subpixel_factor / 2),
-        expand4(subpixel_factor / 2),
+    auto const half_pixel_offset = Vector2<I32> {
+        expand<I32>(subpixel_factor / 2),
+        expand<I32>(subpixel_factor / 2),
     };
 
     // Stencil configuration and writing
     auto const stencil_configuration = m_stencil_configuration[Face::Front];
     auto const stencil_reference_value = stencil_configuration.reference_value & stencil_configuration.test_mask;
 
-    auto write_to_stencil = [](u8* stencil_ptrs[4], i32x4 stencil_value, StencilOperation op, u8 reference_value, u8 write_mask, i32x4 pixel_mask) {
+    auto write_to_stencil = [](Array<u8*, lanes> const& stencil_ptrs, I32 stencil_value, StencilOperation op, u8 reference_value, u8 write_mask, I32 pixel_mask) {
         if (write_mask == 0 || op == StencilOperation::Keep)
             return;
 
         switch (op) {
         case StencilOperation::Decrement:
-            stencil_value = (stencil_value & ~write_mask) | (max(stencil_value - 1, expand4(0)) & write_mask);
+            stencil_value = (stencil_value & ~write_mask) | (max(stencil_value - 1, expand<I32>(0)) & write_mask);
             break;
         case StencilOperation::DecrementWrap:
             stencil_value = (stencil_value & ~write_mask) | (((stencil_value - 1) & 0xFF) & write_mask);
             break;
         case StencilOperation::Increment:
-            stencil_value = (stencil_value & ~write_mask) | (min(stencil_value + 1, expand4(0xFF)) & write_mask);
+            stencil_value = (stencil_value & ~write_mask) | (min(stencil_value + 1, expand<I32>(0xFF)) & write_mask);
             break;
         case StencilOperation::IncrementWrap:
             stencil_value = (stencil_value & ~write_mask) | (((stencil_value + 1) & 0xFF) & write_mask);
@@ -295,17 +403,29 @@ void Device::rasterize_triangle(const Triangle& triangle)
         }
 
         INCREASE_STATISTICS_COUNTER(g_num_stencil_writes, maskcount(pixel_mask));
-        store4_masked(stencil_value, stencil_ptrs[0], stencil_ptrs[1], stencil_ptrs[2], stencil_ptrs[3], pixel_mask);
+        store_masked(stencil_value, stencil_ptrs, maskbits(pixel_mask));
+    };
+
+    // Returns the addresses of the covered pixels of the block in the given buffer
+    auto pixel_pointers = [](auto get_scanline, int bx, int by, int coverage_bits) {
+        Array<decltype(get_scanline(0)), block_height> rows;
+        for (int y = 0; y < block_height; ++y)
+            rows[y] = get_scanline(by + y) + bx;
+
+        Array<decltype(get_scanline(0)), lanes> pointers;
+        for (size_t i = 0; i < lanes; ++i)
+            pointers[i] = coverage_bits & (1 << i) ? rows[i / block_width] + i % block_width : nullptr;
+        return pointers;
     };
 
     // Iterate over all blocks within the bounds of the triangle
-    for (int by = by0; by < by1; by += 2) {
-        for (int bx = bx0; bx < bx1; bx += 2) {
-            PixelQuad quad;
+    for (int by = by0; by < by1; by += block_height) {
+        for (int bx = bx0; bx < bx1; bx += block_width) {
+            PixelBlockType quad;
 
             quad.screen_coordinates = {
-                i32x4 { bx, bx + 1, bx, bx + 1 },
-                i32x4 { by, by, by + 1, by + 1 },
+                bx + Layout::x_offsets,
+                by + Layout::y_offsets,
             };
 
             auto edge_values = calculate_edge_values4(quad.screen_coordinates * subpixel_factor + half_pixel_offset);
@@ -326,30 +446,27 @@ void Device::rasterize_triangle(const Triangle& triangle)
             INCREASE_STATISTICS_COUNTER(g_num_pixels, maskcount(quad.mask));
 
             // Calculate barycentric coordinates from previously calculated edge values
-            quad.barycentrics = Vector3<f32x4> {
-                to_f32x4(edge_values.x()),
-                to_f32x4(edge_values.y()),
-                to_f32x4(edge_values.z()),
+            quad.barycentrics = Vector3<F32> {
+                convert<F32>(edge_values.x()),
+                convert<F32>(edge_values.y()),
+                convert<F32>(edge_values.z()),
             } * one_over_area;
 
             int coverage_bits = maskbits(quad.mask);
 
             // Stencil testing
-            u8* stencil_ptrs[4];
-            i32x4 stencil_value;
+            Array<u8*, lanes> stencil_ptrs;
+            I32 stencil_value;
             if (m_options.enable_stencil_test) {
-                stencil_ptrs[0] = coverage_bits & 1 ? &m_stencil_buffer->scanline(by)[bx] : nullptr;
-                stencil_ptrs[1] = coverage_bits & 2 ? &m_stencil_buffer->scanline(by)[bx + 1] : nullptr;
-                stencil_ptrs[2] = coverage_bits & 4 ? &m_stencil_buffer->scanline(by + 1)[bx] : nullptr;
-                stencil_ptrs[3] = coverage_bits & 8 ? &m_stencil_buffer->scanline(by + 1)[bx + 1] : nullptr;
+                stencil_ptrs = pixel_pointers([&](int y) { return m_stencil_buffer->scanline(y); }, bx, by, coverage_bits);
 
-                stencil_value = load4_masked(stencil_ptrs[0], stencil_ptrs[1], stencil_ptrs[2], stencil_ptrs[3], quad.mask);
+                stencil_value = load_masked<I32>(stencil_ptrs, maskbits(quad.mask));
                 stencil_value &= stencil_configuration.test_mask;
 
-                i32x4 stencil_test_passed;
+                I32 stencil_test_passed;
                 switch (stencil_configuration.test_function) {
                 case StencilTestFunction::Always:
-                    stencil_test_passed = expand4(~0);
+                    stencil_test_passed = expand<I32>(~0);
                     break;
                 case StencilTestFunction::Equal:
                     stencil_test_passed = stencil_value == stencil_reference_value;
@@ -367,7 +484,7 @@ void Device::rasterize_triangle(const Triangle& triangle)
                     stencil_test_passed = stencil_value <= stencil_reference_value;
                     break;
                 case StencilTestFunction::Never:
-                    stencil_test_passed = expand4(0);
+                    stencil_test_passed = expand<I32>(0);
                     break;
                 case StencilTestFunction::NotEqual:
                     stencil_test_passed = stencil_value != stencil_reference_value;
@@ -392,27 +509,22 @@ void Device::rasterize_triangle(const Triangle& triangle)
             }
 
             // Depth testing
-            float* depth_ptrs[4] = {
-                coverage_bits & 1 ? &m_depth_buffer->scanline(by)[bx] : nullptr,
-                coverage_bits & 2 ? &m_depth_buffer->scanline(by)[bx + 1] : nullptr,
-                coverage_bits & 4 ? &m_depth_buffer->scanline(by + 1)[bx] : nullptr,
-                coverage_bits & 8 ? &m_depth_buffer->scanline(by + 1)[bx + 1] : nullptr,
-            };
+            auto const depth_ptrs = pixel_pointers([&](int y) { return m_depth_buffer->scanline(y); }, bx, by, coverage_bits);
             if (m_options.enable_depth_test) {
-                auto depth = load4_masked(depth_ptrs[0], depth_ptrs[1], depth_ptrs[2], depth_ptrs[3], quad.mask);
+                auto depth = load_masked<F32>(depth_ptrs, maskbits(quad.mask));
 
                 quad.depth = interpolate(vertex0.window_coordinates.z(), vertex1.window_coordinates.z(), vertex2.window_coordinates.z(), quad.barycentrics);
                 // FIXME: Also apply depth_offset_factor which depends on the depth gradient
                 if (m_options.depth_offset_enabled)
                     quad.depth += m_options.depth_offset_constant * NumericLimits<float>::epsilon();
 
-                i32x4 depth_test_passed;
+                I32 depth_test_passed;
                 switch (m_options.depth_func) {
                 case DepthTestFunction::Always:
-                    depth_test_passed = expand4(~0);
+                    depth_test_passed = expand<I32>(~0);
                     break;
                 case DepthTestFunction::Never:
-                    depth_test_passed = expand4(0);
+                    depth_test_passed = expand<I32>(0);
                     break;
                 case DepthTestFunction::Greater:
                     depth_test_passed = quad.depth > depth;
@@ -424,12 +536,8 @@ void Device::rasterize_triangle(const Triangle& triangle)
 #ifdef __SSE__
                     depth_test_passed = quad.depth != depth;
 #else
-                    depth_test_passed = i32x4 {
-                        bit_cast<u32>(quad.depth[0]) != bit_cast<u32>(depth[0]) ? -1 : 0,
-                        bit_cast<u32>(quad.depth[1]) != bit_cast<u32>(depth[1]) ? -1 : 0,
-                        bit_cast<u32>(quad.depth[2]) != bit_cast<u32>(depth[2]) ? -1 : 0,
-                        bit_cast<u32>(quad.depth[3]) != bit_cast<u32>(depth[3]) ? -1 : 0,
-                    };
+                    for (size_t i = 0; i < lanes; ++i)
+                        depth_test_passed[i] = bit_cast<u32>(quad.depth[i]) != bit_cast<u32>(depth[i]) ? -1 : 0;
 #endif
                     break;
                 case DepthTestFunction::Equal:
@@ -447,12 +555,8 @@ void Device::rasterize_triangle(const Triangle& triangle)
                     // the first 32-bits of this depth value is "good enough" that if we get a hit on it being
                     // equal, we can pretty much guarantee that it's actually equal.
                     //
-                    depth_test_passed = i32x4 {
-                        bit_cast<u32>(quad.depth[0]) == bit_cast<u32>(depth[0]) ? -1 : 0,
-                        bit_cast<u32>(quad.depth[1]) == bit_cast<u32>(depth[1]) ? -1 : 0,
-                        bit_cast<u32>(quad.depth[2]) == bit_cast<u32>(depth[2]) ? -1 : 0,
-                        bit_cast<u32>(quad.depth[3]) == bit_cast<u32>(depth[3]) ? -1 : 0,
-                    };
+                    for (size_t i = 0; i < lanes; ++i)
+                        depth_test_passed[i] = bit_cast<u32>(quad.depth[i]) == bit_cast<u32>(depth[i]) ? -1 : 0;
 #endif
                     break;
                 case DepthTestFunction::LessOrEqual:
@@ -496,10 +600,10 @@ void Device::rasterize_triangle(const Triangle& triangle)
             INCREASE_STATISTICS_COUNTER(g_num_pixels_shaded, maskcount(quad.mask));
 
             // Draw the pixels according to the previously generated mask
-            auto const w_coordinates = Vector3<f32x4> {
-                expand4(vertex0.window_coordinates.w()),
-                expand4(vertex1.window_coordinates.w()),
-                expand4(vertex2.window_coordinates.w()),
+            auto const w_coordinates = Vector3<F32> {
+                expand<F32>(vertex0.window_coordinates.w()),
+                expand<F32>(vertex1.window_coordinates.w()),
+                expand<F32>(vertex2.window_coordinates.w()),
             };
 
             auto const interpolated_reciprocal_w = interpolate(w_coordinates.x(), w_coordinates.y(), w_coordinates.z(), quad.barycentrics);
@@ -508,13 +612,13 @@ void Device::rasterize_triangle(const Triangle& triangle)
 
             // FIXME: make this more generic. We want to interpolate more than just color and uv
             if (m_options.shade_smooth) {
-                quad.vertex_color = interpolate(expand4(vertex0.color), expand4(vertex1.color), expand4(vertex2.color), quad.barycentrics);
+                quad.vertex_color = interpolate(expand<F32>(vertex0.color), expand<F32>(vertex1.color), expand<F32>(vertex2.color), quad.barycentrics);
             } else {
-                quad.vertex_color = expand4(vertex0.color);
+                quad.vertex_color = expand<F32>(vertex0.color);
             }
 
             for (size_t i = 0; i < NUM_SAMPLERS; ++i)
-                quad.texture_coordinates[i] = interpolate(expand4(vertex0.tex_coords[i]), expand4(vertex1.tex_coords[i]), expand4(vertex2.tex_coords[i]), quad.barycentrics);
+                quad.texture_coordinates[i] = interpolate(expand<F32>(vertex0.tex_coords[i]), expand<F32>(vertex1.tex_coords[i]), expand<F32>(vertex2.tex_coords[i]), quad.barycentrics);
 
             if (m_options.fog_enabled) {
                 // Calculate depth of fragment for fog
@@ -522,7 +626,7 @@ void Device::rasterize_triangle(const Triangle& triangle)
                 // OpenGL 1.5 spec chapter 3.10: "An implementation may choose to approximate the
                 // eye-coordinate distance from the eye to each fragment center by |Ze|."
 
-                quad.fog_depth = interpolate(expand4(vertex0_eye_absz), expand4(vertex1_eye_absz), expand4(vertex2_eye_absz), quad.barycentrics);
+                quad.fog_depth = interpolate(expand<F32>(vertex0_eye_absz), expand<F32>(vertex1_eye_absz), expand<F32>(vertex2_eye_absz), quad.barycentrics);
             }
 
             shade_fragments(quad);
@@ -533,49 +637,44 @@ void Device::rasterize_triangle(const Triangle& triangle)
 
             // Write to depth buffer
             if (m_options.enable_depth_test && m_options.enable_depth_write)
-                store4_masked(quad.depth, depth_ptrs[0], depth_ptrs[1], depth_ptrs[2], depth_ptrs[3], quad.mask);
+                store_masked(quad.depth, depth_ptrs, maskbits(quad.mask));
 
             // We will not update the color buffer at all
             if (!m_options.color_mask || !m_options.enable_color_write)
                 continue;
 
-            Gfx::RGBA32* color_ptrs[4] = {
-                coverage_bits & 1 ? &m_render_target->scanline(by)[bx] : nullptr,
-                coverage_bits & 2 ? &m_render_target->scanline(by)[bx + 1] : nullptr,
-                coverage_bits & 4 ? &m_render_target->scanline(by + 1)[bx] : nullptr,
-                coverage_bits & 8 ? &m_render_target->scanline(by + 1)[bx + 1] : nullptr,
-            };
+            auto const color_ptrs = pixel_pointers([&](int y) { return m_render_target->scanline(y); }, bx, by, coverage_bits);
 
-            u32x4 dst_u32;
+            U32 dst_u32;
             if (m_options.enable_blending || m_options.color_mask != 0xffffffff)
-                dst_u32 = load4_masked(color_ptrs[0], color_ptrs[1], color_ptrs[2], color_ptrs[3], quad.mask);
+                dst_u32 = load_masked<U32>(color_ptrs, maskbits(quad.mask));
 
             if (m_options.enable_blending) {
                 INCREASE_STATISTICS_COUNTER(g_num_pixels_blended, maskcount(quad.mask));
 
                 // Blend color values from pixel_staging into m_render_target
-                Vector4<f32x4> const& src = quad.out_color;
-                auto dst = to_vec4(dst_u32);
+                Vector4<F32> const& src = quad.out_color;
+                auto dst = to_vec4<F32>(dst_u32);
 
-                auto src_factor = expand4(m_alpha_blend_factors.src_constant)
+                auto src_factor = expand<F32>(m_alpha_blend_factors.src_constant)
                     + src * m_alpha_blend_factors.src_factor_src_color
-                    + Vector4<f32x4> { src.w(), src.w(), src.w(), src.w() } * m_alpha_blend_factors.src_factor_src_alpha
+                    + Vector4<F32> { src.w(), src.w(), src.w(), src.w() } * m_alpha_blend_factors.src_factor_src_alpha
                     + dst * m_alpha_blend_factors.src_factor_dst_color
-                    + Vector4<f32x4> { dst.w(), dst.w(), dst.w(), dst.w() } * m_alpha_blend_factors.src_factor_dst_alpha;
+                    + Vector4<F32> { dst.w(), dst.w(), dst.w(), dst.w() } * m_alpha_blend_factors.src_factor_dst_alpha;
 
-                auto dst_factor = expand4(m_alpha_blend_factors.dst_constant)
+                auto dst_factor = expand<F32>(m_alpha_blend_factors.dst_constant)
                     + src * m_alpha_blend_factors.dst_factor_src_color
-                    + Vector4<f32x4> { src.w(), src.w(), src.w(), src.w() } * m_alpha_blend_factors.dst_factor_src_alpha
+                    + Vector4<F32> { src.w(), src.w(), src.w(), src.w() } * m_alpha_blend_factors.dst_factor_src_alpha
                     + dst * m_alpha_blend_factors.dst_factor_dst_color
-                    + Vector4<f32x4> { dst.w(), dst.w(), dst.w(), dst.w() } * m_alpha_blend_factors.dst_factor_dst_alpha;
+                    + Vector4<F32> { dst.w(), dst.w(), dst.w(), dst.w() } * m_alpha_blend_factors.dst_factor_dst_alpha;
 
                 quad.out_color = src * src_factor + dst * dst_factor;
             }
 
             if (m_options.color_mask == 0xffffffff)
-                store4_masked(to_rgba32(quad.out_color), color_ptrs[0], color_ptrs[1], color_ptrs[2], color_ptrs[3], quad.mask);
+                store_masked(to_rgba32<U32>(quad.out_color), color_ptrs, maskbits(quad.mask));
             else
-                store4_masked((to_rgba32(quad.out_color) & m_options.color_mask) | (dst_u32 & ~m_options.color_mask), color_ptrs[0], color_ptrs[1], color_ptrs[2], color_ptrs[3], quad.mask);
+                store_masked((to_rgba32<U32>(quad.out_color) & m_options.color_mask) | (dst_u32 & ~m_options.color_mask), color_ptrs, maskbits(quad.mask));
         }
     }
 }
@@ -587,6 +686,12 @@ Device::Device(const Gfx::IntSize& size)
 {
     m_options.scissor_box = m_render_target->rect();
     m_options.viewport = m_render_target->rect();
+    create_tiles();
+
+#if ARCH(X86_64)
+    static bool const avx2_supported = cpu_supports_avx2();
+    m_use_wide_pixel_blocks = avx2_supported;
+#endif
 }
 
 DeviceInfo Device::info() const
@@ -955,6 +1060,7 @@ void Device::draw_primitives(PrimitiveType primitive_type, FloatMatrix4x4 const&
         }
     }
 
+    size_t num_accepted_triangles = 0;
     for (auto& triangle : m_processed_triangles) {
         // Let's calculate the (signed) area of the triangle
         // https://cp-algorithms.com/geometry/oriented-triangle-area.html
@@ -1003,19 +1109,25 @@ void Device::draw_primitives(PrimitiveType primitive_type, FloatMatrix4x4 const&
             triangle.vertices[2].tex_coords[i] = texture_transform * triangle.vertices[2].tex_coords[i];
         }
 
-        rasterize_triangle(triangle);
+        m_processed_triangles[num_accepted_triangles++] = triangle;
     }
+    m_processed_triangles.shrink(num_accepted_triangles, true);
+
+    rasterize_triangles();
 }
 
-ALWAYS_INLINE void Device::shade_fragments(PixelQuad& quad)
+template<typename PixelBlockType>
+ALWAYS_INLINE void Device::shade_fragments(PixelBlockType& quad)
 {
+    using F32 = typename PixelBlockType::f32;
+
     quad.out_color = quad.vertex_color;
 
     for (size_t i : m_enabled_texture_units) {
         // FIXME: implement GL_TEXTURE_1D, GL_TEXTURE_3D and GL_TEXTURE_CUBE_MAP
         auto const& sampler = m_samplers[i];
 
-        auto texel = sampler.sample_2d({ quad.texture_coordinates[i].x(), quad.texture_coordinates[i].y() });
+        auto texel = sampler.sample_2d(Vector2<F32> { quad.texture_coordinates[i].x(), quad.texture_coordinates[i].y() });
         INCREASE_STATISTICS_COUNTER(g_num_sampler_calls, 1);
 
         // FIXME: Implement more blend modes
@@ -1043,7 +1155,7 @@ ALWAYS_INLINE void Device::shade_fragments(PixelQuad& quad)
 
     // FIXME: exponential fog is not vectorized, we should add a SIMD exp function that calculates an approximation.
     if (m_options.fog_enabled) {
-        auto factor = expand4(0.0f);
+        auto factor = expand<F32>(0.0f);
         switch (m_options.fog_mode) {
         case FogMode::Linear:
             factor = (m_options.fog_end - quad.fog_depth) / (m_options.fog_end - m_options.fog_start);
@@ -1062,17 +1174,18 @@ ALWAYS_INLINE void Device::shade_fragments(PixelQuad& quad)
         }
 
         // Mix texel's RGB with fog's RBG - leave alpha alone
-        auto fog_color = expand4(m_options.fog_color);
+        auto fog_color = expand<F32>(m_options.fog_color);
         quad.out_color.set_x(mix(fog_color.x(), quad.out_color.x(), factor));
         quad.out_color.set_y(mix(fog_color.y(), quad.out_color.y(), factor));
         quad.out_color.set_z(mix(fog_color.z(), quad.out_color.z(), factor));
     }
 }
 
-ALWAYS_INLINE bool Device::test_alpha(PixelQuad& quad)
+template<typename PixelBlockType>
+ALWAYS_INLINE bool Device::test_alpha(PixelBlockType& quad)
 {
     auto const alpha = quad.out_color.w();
-    auto const ref_value = expand4(m_options.alpha_test_ref_value);
+    auto const ref_value = expand<typename PixelBlockType::f32>(m_options.alpha_test_ref_value);
 
     switch (m_options.alpha_test_func) {
     case AlphaTestFunction::Less:
@@ -1108,6 +1221,7 @@ void Device::resize(const Gfx::IntSize& size)
 
     m_render_target = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, size).release_value_but_fixme_should_propagate_errors();
     m_depth_buffer = adopt_own(*new DepthBuffer(size));
+    create_tiles();
 }
 
 void Device::clear_color(const FloatVector4& color)
@@ -1222,15 +1336,34 @@ void Device::draw_statistics_overlay(Gfx::Bitmap& target)
         builder.append(String::formatted("Timings      : {:.1}ms {:.1}FPS\n",
             static_cast<double>(milliseconds) / frame_counter,
             (milliseconds > 0) ? 1000.0 * frame_counter / milliseconds : 9999.0));
-        builder.append(String::formatted("Triangles    : {}\n", g_num_rasterized_triangles));
+        builder.append(String::formatted("Triangles    : {}\n", g_num_rasterized_triangles.load()));
         builder.append(String::formatted("SIMD usage   : {}%\n", g_num_quads > 0 ? g_num_pixels_shaded * 25 / g_num_quads : 0));
         builder.append(String::formatted("Pixels       : {}, Stencil: {}%, Shaded: {}%, Blended: {}%, Overdraw: {}%\n",
-            g_num_pixels,
+            g_num_pixels.load(),
             g_num_pixels > 0 ? g_num_stencil_writes * 100 / g_num_pixels : 0,
             g_num_pixels > 0 ? g_num_pixels_shaded * 100 / g_num_pixels : 0,
             g_num_pixels_shaded > 0 ? g_num_pixels_blended * 100 / g_num_pixels_shaded : 0,
             num_rendertarget_pixels > 0 ? g_num_pixels_shaded * 100 / num_rendertarget_pixels - 100 : 0));
-        builder.append(String::formatted("Sampler calls: {}\n", g_num_sampler_calls));
+        builder.append(String::formatted("Sampler calls: {}\n", g_num_sampler_calls.load()));
+
+        // Per-tile rasterization times, averaged over the frames of this period
+        i64 busiest_tile_microseconds = 0;
+        i64 total_tile_microseconds = 0;
+        size_t num_busy_tiles = 0;
+        for (auto& tile : m_tiles) {
+            busiest_tile_microseconds = max(busiest_tile_microseconds, tile.microseconds_spent);
+            total_tile_microseconds += tile.microseconds_spent;
+            if (tile.microseconds_spent > 0)
+                ++num_busy_tiles;
+            tile.microseconds_spent = 0;
+        }
+        builder.append(String::formatted("Tiles        : {} busy of {}, {} threads, Busiest: {:.2}ms, Average: {:.2}ms, Total: {:.2}ms\n",
+            num_busy_tiles,
+            m_tiles.size(),
+            m_thread_pool.thread_count(),
+            busiest_tile_microseconds / 1000.0 / frame_counter,
+            num_busy_tiles > 0 ? total_tile_microseconds / 1000.0 / num_busy_tiles / frame_counter : 0.0,
+            total_tile_microseconds / 1000.0 / frame_counter));
 
         debug_string = builder.to_string();
 
@@ -1258,7 +1391,7 @@ void Device::draw_statistics_overlay(Gfx::Bitmap& target)
 
 void Device::wait_for_all_threads() const
 {
-    // FIXME: Wait for all render threads to finish when multithreading is being implemented
+    // The render threads only ever run inside draw_primitives(), which waits for them before returning.
 }
 
 void Device::set_options(const RasterizerOptions& options)
@@ -1269,8 +1402,6 @@ void Device::set_options(const RasterizerOptions& options)
 
     if (m_options.enable_blending)
         setup_blend_factors();
-
-    // FIXME: Recreate or reinitialize render threads here when multithreading is being implemented
 }
 
 void Device::set_light_model_params(const LightModelParameters& lighting_model)
@@ -1278,8 +1409,6 @@ void Device::set_light_model_params(const LightModelParameters& lighting_model)
     wait_for_all_threads();
 
     m_lighting_model = lighting_model;
-
-    // FIXME: Recreate or reinitialize render threads here when multithreading is being implemented
 }
 
 Gfx::RGBA32 Device::get_backbuffer_pixel(int x, int y)
@@ -10,6 +10,7 @@
 #include <AK/Array.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/OwnPtr.h>
+#include <AK/Platform.h>
 #include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Matrix3x3.h>
@@ -30,6 +31,7 @@
 #include <LibSoftGPU/StencilBuffer.h>
 #include <LibSoftGPU/Triangle.h>
 #include <LibSoftGPU/Vertex.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace SoftGPU {
 
@@ -87,7 +89,8 @@ struct LightModelParameters {
     bool two_sided_lighting { false };
 };
 
-struct PixelQuad;
+template<size_t Lanes>
+struct PixelBlock;
 
 struct RasterPosition {
     FloatVector4 window_coordinates { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -109,6 +112,13 @@ struct StencilConfiguration {
     u8 write_mask;
 };
 
+struct RasterizerTile {
+    Gfx::IntRect rect;
+    // Indices into the triangles of the current draw call whose bounding boxes overlap this tile, in submission order
+    Vector<size_t> triangle_indices;
+    i64 microseconds_spent { 0 };
+};
+
 class Device final {
 public:
     Device(const Gfx::IntSize& min_size);
@@ -147,10 +157,19 @@ private:
     Gfx::IntRect raster_rect_in_target_coordinates(Gfx::IntSize size);
     Gfx::IntRect window_coordinates_to_target_coordinates(Gfx::IntRect const&);
 
-    void rasterize_triangle(const Triangle& triangle);
+    void create_tiles();
+    void rasterize_triangles();
+    void rasterize_triangle(Triangle const&, Gfx::IntRect const& render_bounds);
+#if ARCH(X86_64)
+    [[gnu::target("avx2")]] void rasterize_triangle_with_wide_blocks(Triangle const&, Gfx::IntRect const& render_bounds);
+#endif
+    template<typename PixelBlockType>
+    void rasterize_triangle_blocks(Triangle const&, Gfx::IntRect const& render_bounds);
     void setup_blend_factors();
-    void shade_fragments(PixelQuad&);
-    bool test_alpha(PixelQuad&);
+    template<typename PixelBlockType>
+    void shade_fragments(PixelBlockType&);
+    template<typename PixelBlockType>
+    bool test_alpha(PixelBlockType&);
 
     RefPtr<Gfx::Bitmap> m_render_target;
     NonnullOwnPtr<DepthBuffer> m_depth_buffer;
@@ -168,6 +187,10 @@ private:
     Array<Material, 2u> m_materials;
     RasterPosition m_raster_position;
     Array<StencilConfiguration, 2u> m_stencil_configuration;
+    Vector<RasterizerTile> m_tiles;
+    Vector<size_t> m_active_tiles;
+    Threading::ThreadPool m_thread_pool { "SoftGPU"sv, MAX_RASTERIZER_THREADS };
+    bool m_use_wide_pixel_blocks { false };
 };
 
 }
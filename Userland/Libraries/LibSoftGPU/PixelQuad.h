@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/SIMD.h>
 #include <LibGfx/Vector2.h>
 #include <LibGfx/Vector3.h>
@@ -14,15 +15,55 @@
 
 namespace SoftGPU {
 
-struct PixelQuad final {
-    Vector2<AK::SIMD::i32x4> screen_coordinates;
-    Vector3<AK::SIMD::f32x4> barycentrics;
-    AK::SIMD::f32x4 depth;
-    Vector4<AK::SIMD::f32x4> vertex_color;
-    Array<Vector4<AK::SIMD::f32x4>, NUM_SAMPLERS> texture_coordinates;
-    Vector4<AK::SIMD::f32x4> out_color;
-    AK::SIMD::f32x4 fog_depth;
-    AK::SIMD::i32x4 mask;
+// A block of pixels that is shaded together, one pixel per SIMD lane.
+template<size_t Lanes>
+struct PixelBlockLayout;
+
+// 2x2 pixels
+template<>
+struct PixelBlockLayout<4> {
+    using f32 = AK::SIMD::f32x4;
+    using i32 = AK::SIMD::i32x4;
+    using u32 = AK::SIMD::u32x4;
+
+    static constexpr int width = 2;
+    static constexpr int height = 2;
+    static constexpr i32 x_offsets { 0, 1, 0, 1 };
+    static constexpr i32 y_offsets { 0, 0, 1, 1 };
+};
+
+// 4x2 pixels, for CPUs that have 256-bit vector registers
+template<>
+struct PixelBlockLayout<8> {
+    using f32 = AK::SIMD::f32x8;
+    using i32 = AK::SIMD::i32x8;
+    using u32 = AK::SIMD::u32x8;
+
+    static constexpr int width = 4;
+    static constexpr int height = 2;
+    static constexpr i32 x_offsets { 0, 1, 2, 3, 0, 1, 2, 3 };
+    static constexpr i32 y_offsets { 0, 0, 0, 0, 1, 1, 1, 1 };
 };
 
+template<size_t Lanes>
+struct PixelBlock final {
+    using Layout = PixelBlockLayout<Lanes>;
+    using f32 = typename Layout::f32;
+    using i32 = typename Layout::i32;
+    using u32 = typename Layout::u32;
+    static constexpr size_t lanes = Lanes;
+
+    Vector2<i32> screen_coordinates;
+    Vector3<f32> barycentrics;
+    f32 depth;
+    Vector4<f32> vertex_color;
+    Array<Vector4<f32>, NUM_SAMPLERS> texture_coordinates;
+    Vector4<f32> out_color;
+    f32 fog_depth;
+    i32 mask;
+};
+
+using PixelQuad = PixelBlock<4>;
+using WidePixelBlock = PixelBlock<8>;
+
 }
@@ -6,13 +6,88 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/SIMDExtras.h>
+#include <AK/StdLibExtras.h>
 #include <LibGfx/Vector2.h>
 #include <LibGfx/Vector3.h>
 #include <LibGfx/Vector4.h>
 
 namespace SoftGPU {
 
+template<typename VectorType>
+using SIMDElementType = RemoveCVReference<decltype(declval<VectorType>()[0])>;
+
+template<typename VectorType>
+inline constexpr size_t simd_lane_count = sizeof(VectorType) / sizeof(SIMDElementType<VectorType>);
+
+// Lane count agnostic versions of the AK::SIMD helpers, for code that works on both 4 and 8 lanes
+
+template<typename VectorType>
+ALWAYS_INLINE static constexpr VectorType expand(SIMDElementType<VectorType> value)
+{
+    return VectorType {} + value;
+}
+
+template<typename VectorType, typename T>
+ALWAYS_INLINE static constexpr Vector3<VectorType> expand(Vector3<T> const& v)
+{
+    return Vector3<VectorType> {
+        expand<VectorType>(v.x()),
+        expand<VectorType>(v.y()),
+        expand<VectorType>(v.z()),
+    };
+}
+
+template<typename VectorType, typename T>
+ALWAYS_INLINE static constexpr Vector4<VectorType> expand(Vector4<T> const& v)
+{
+    return Vector4<VectorType> {
+        expand<VectorType>(v.x()),
+        expand<VectorType>(v.y()),
+        expand<VectorType>(v.z()),
+        expand<VectorType>(v.w()),
+    };
+}
+
+template<typename VectorType, typename SourceType>
+ALWAYS_INLINE static VectorType convert(SourceType v)
+{
+    return __builtin_convertvector(v, VectorType);
+}
+
+namespace Detail {
+
+template<typename VectorType, typename T, size_t N, unsigned... Indices>
+ALWAYS_INLINE static VectorType load_masked(Array<T*, N> const& pointers, int mask_bits, IndexSequence<Indices...>)
+{
+    return VectorType {
+        (mask_bits & (1 << Indices)) ? static_cast<SIMDElementType<VectorType>>(*pointers[Indices]) : 0 ...
+    };
+}
+
+template<typename VectorType, typename T, size_t N, unsigned... Indices>
+ALWAYS_INLINE static void store_masked(VectorType v, Array<T*, N> const& pointers, int mask_bits, IndexSequence<Indices...>)
+{
+    ((mask_bits & (1 << Indices) ? (void)(*pointers[Indices] = v[Indices]) : (void)0), ...);
+}
+
+}
+
+template<typename VectorType, typename T, size_t N>
+ALWAYS_INLINE static VectorType load_masked(Array<T*, N> const& pointers, int mask_bits)
+{
+    static_assert(N == simd_lane_count<VectorType>);
+    return Detail::load_masked<VectorType>(pointers, mask_bits, MakeIndexSequence<N> {});
+}
+
+template<typename VectorType, typename T, size_t N>
+ALWAYS_INLINE static void store_masked(VectorType v, Array<T*, N> const& pointers, int mask_bits)
+{
+    static_assert(N == simd_lane_count<VectorType>);
+    Detail::store_masked(v, pointers, mask_bits, MakeIndexSequence<N> {});
+}
+
 ALWAYS_INLINE static constexpr Vector2<AK::SIMD::f32x4> expand4(Vector2<float> const& v)
 {
     return Vector2<AK::SIMD::f32x4> {
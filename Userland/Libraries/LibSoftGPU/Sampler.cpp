@@ -6,53 +6,57 @@
 
 #include <AK/SIMDExtras.h>
 #include <AK/SIMDMath.h>
+#include <AK/StdLibExtras.h>
 #include <LibSoftGPU/Config.h>
 #include <LibSoftGPU/Image.h>
+#include <LibSoftGPU/PixelQuad.h>
 #include <LibSoftGPU/SIMD.h>
 #include <LibSoftGPU/Sampler.h>
 #include <math.h>
 
 namespace SoftGPU {
 
-using AK::SIMD::f32x4;
-using AK::SIMD::i32x4;
-using AK::SIMD::u32x4;
-
 using AK::SIMD::clamp;
-using AK::SIMD::expand4;
 using AK::SIMD::floor_int_range;
 using AK::SIMD::frac_int_range;
 using AK::SIMD::maskbits;
-using AK::SIMD::to_f32x4;
-using AK::SIMD::to_i32x4;
-using AK::SIMD::to_u32x4;
-using AK::SIMD::truncate_int_range;
 
-static f32x4 wrap_repeat(f32x4 value)
+// The sampling code is written for any lane count, so that it can be used for both 2x2 and 4x2 pixel blocks.
+template<typename F32>
+using SamplerLayout = PixelBlockLayout<simd_lane_count<F32>>;
+
+template<typename F32>
+static F32 wrap_repeat(F32 value)
 {
     return frac_int_range(value);
 }
 
-[[maybe_unused]] static f32x4 wrap_clamp(f32x4 value)
+template<typename F32>
+[[maybe_unused]] static F32 wrap_clamp(F32 value)
 {
-    return clamp(value, expand4(0.0f), expand4(1.0f));
+    return clamp(value, expand<F32>(0.0f), expand<F32>(1.0f));
 }
 
-static f32x4 wrap_clamp_to_edge(f32x4 value, u32x4 num_texels)
+template<typename F32, typename U32>
+static F32 wrap_clamp_to_edge(F32 value, U32 num_texels)
 {
-    f32x4 const clamp_limit = 1.f / to_f32x4(2 * num_texels);
+    F32 const clamp_limit = 1.f / convert<F32>(2 * num_texels);
     return clamp(value, clamp_limit, 1.0f - clamp_limit);
 }
 
-static f32x4 wrap_mirrored_repeat(f32x4 value, u32x4 num_texels)
+template<typename F32, typename U32>
+static F32 wrap_mirrored_repeat(F32 value, U32 num_texels)
 {
-    f32x4 integer = floor_int_range(value);
-    f32x4 frac = value - integer;
-    auto is_odd = to_i32x4(integer) & 1;
+    using I32 = typename SamplerLayout<F32>::i32;
+
+    F32 integer = floor_int_range(value);
+    F32 frac = value - integer;
+    auto is_odd = convert<I32>(integer) & 1;
     return wrap_clamp_to_edge(is_odd ? 1 - frac : frac, num_texels);
 }
 
-static f32x4 wrap(f32x4 value, TextureWrapMode mode, u32x4 num_texels)
+template<typename F32, typename U32>
+static F32 wrap(F32 value, TextureWrapMode mode, U32 num_texels)
 {
     switch (mode) {
     case TextureWrapMode::Repeat:
@@ -72,132 +76,143 @@ static f32x4 wrap(f32x4 value, TextureWrapMode mode, u32x4 num_texels)
     }
 }
 
-ALWAYS_INLINE static Vector4<f32x4> texel4(Image const& image, u32x4 layer, u32x4 level, u32x4 x, u32x4 y, u32x4 z)
+template<typename F32, typename U32, unsigned... Indices>
+ALWAYS_INLINE static Vector4<F32> texels(Image const& image, U32 layer, U32 level, U32 x, U32 y, U32 z, IndexSequence<Indices...>)
 {
-    auto t0 = image.texel(layer[0], level[0], x[0], y[0], z[0]);
-    auto t1 = image.texel(layer[1], level[1], x[1], y[1], z[1]);
-    auto t2 = image.texel(layer[2], level[2], x[2], y[2], z[2]);
-    auto t3 = image.texel(layer[3], level[3], x[3], y[3], z[3]);
-
-    return Vector4<f32x4> {
-        f32x4 { t0.x(), t1.x(), t2.x(), t3.x() },
-        f32x4 { t0.y(), t1.y(), t2.y(), t3.y() },
-        f32x4 { t0.z(), t1.z(), t2.z(), t3.z() },
-        f32x4 { t0.w(), t1.w(), t2.w(), t3.w() },
+    Array<FloatVector4, sizeof...(Indices)> const t { image.texel(layer[Indices], level[Indices], x[Indices], y[Indices], z[Indices])... };
+
+    return Vector4<F32> {
+        F32 { t[Indices].x()... },
+        F32 { t[Indices].y()... },
+        F32 { t[Indices].z()... },
+        F32 { t[Indices].w()... },
     };
 }
 
-ALWAYS_INLINE static Vector4<f32x4> texel4border(Image const& image, u32x4 layer, u32x4 level, u32x4 x, u32x4 y, u32x4 z, FloatVector4 const& border, u32x4 w, u32x4 h)
+template<typename F32, typename U32, unsigned... Indices>
+ALWAYS_INLINE static Vector4<F32> texels_with_border(Image const& image, U32 layer, U32 level, U32 x, U32 y, U32 z, FloatVector4 const& border, U32 w, U32 h, IndexSequence<Indices...>)
 {
     auto border_mask = maskbits(x < 0 || x >= w || y < 0 || y >= h);
 
-    auto t0 = border_mask & 1 ? border : image.texel(layer[0], level[0], x[0], y[0], z[0]);
-    auto t1 = border_mask & 2 ? border : image.texel(layer[1], level[1], x[1], y[1], z[1]);
-    auto t2 = border_mask & 4 ? border : image.texel(layer[2], level[2], x[2], y[2], z[2]);
-    auto t3 = border_mask & 8 ? border : image.texel(layer[3], level[3], x[3], y[3], z[3]);
+    Array<FloatVector4, sizeof...(Indices)> const t {
+        (border_mask & (1 << Indices)) ? border : image.texel(layer[Indices], level[Indices], x[Indices], y[Indices], z[Indices])...
+    };
 
-    return Vector4<f32x4> {
-        f32x4 { t0.x(), t1.x(), t2.x(), t3.x() },
-        f32x4 { t0.y(), t1.y(), t2.y(), t3.y() },
-        f32x4 { t0.z(), t1.z(), t2.z(), t3.z() },
-        f32x4 { t0.w(), t1.w(), t2.w(), t3.w() },
+    return Vector4<F32> {
+        F32 { t[Indices].x()... },
+        F32 { t[Indices].y()... },
+        F32 { t[Indices].z()... },
+        F32 { t[Indices].w()... },
     };
 }
 
-Vector4<AK::SIMD::f32x4> Sampler::sample_2d(Vector2<AK::SIMD::f32x4> const& uv) const
+template<typename F32>
+ALWAYS_INLINE static Vector4<F32> sample_2d_impl(SamplerConfig const& config, Vector2<F32> const& uv)
 {
-    if (m_config.bound_image.is_null())
-        return expand4(FloatVector4 { 1, 0, 0, 1 });
+    using I32 = typename SamplerLayout<F32>::i32;
+    using U32 = typename SamplerLayout<F32>::u32;
+    constexpr auto lanes = simd_lane_count<F32>;
+    constexpr auto lane_indices = MakeIndexSequence<lanes> {};
+
+    if (config.bound_image.is_null())
+        return expand<F32>(FloatVector4 { 1, 0, 0, 1 });
 
-    auto const& image = *m_config.bound_image;
+    auto const& image = *config.bound_image;
 
-    u32x4 const layer = expand4(0u);
+    U32 const layer = expand<U32>(0u);
     // FIXME: calculate actual mipmap level  to use
-    u32x4 const level = expand4(0u);
+    U32 const level = expand<U32>(0u);
 
-    u32x4 const width = {
-        image.level_width(level[0]),
-        image.level_width(level[1]),
-        image.level_width(level[2]),
-        image.level_width(level[3]),
-    };
-    u32x4 const height = {
-        image.level_height(level[0]),
-        image.level_height(level[1]),
-        image.level_height(level[2]),
-        image.level_height(level[3]),
-    };
+    U32 width;
+    U32 height;
+    for (size_t i = 0; i < lanes; ++i) {
+        width[i] = image.level_width(level[i]);
+        height[i] = image.level_height(level[i]);
+    }
 
-    u32x4 width_mask = width - 1;
-    u32x4 height_mask = height - 1;
+    U32 width_mask = width - 1;
+    U32 height_mask = height - 1;
 
-    f32x4 s = wrap(uv.x(), m_config.texture_wrap_u, width);
-    f32x4 t = wrap(uv.y(), m_config.texture_wrap_v, height);
+    F32 s = wrap(uv.x(), config.texture_wrap_u, width);
+    F32 t = wrap(uv.y(), config.texture_wrap_v, height);
 
-    f32x4 u = s * to_f32x4(width);
-    f32x4 v = t * to_f32x4(height);
+    F32 u = s * convert<F32>(width);
+    F32 v = t * convert<F32>(height);
 
-    if (m_config.texture_mag_filter == TextureFilter::Nearest) {
-        u32x4 i = to_u32x4(u);
-        u32x4 j = to_u32x4(v);
-        u32x4 k = expand4(0u);
+    if (config.texture_mag_filter == TextureFilter::Nearest) {
+        U32 i = convert<U32>(u);
+        U32 j = convert<U32>(v);
+        U32 k = expand<U32>(0u);
 
         i = image.width_is_power_of_two() ? i & width_mask : i % width;
         j = image.height_is_power_of_two() ? j & height_mask : j % height;
 
-        return texel4(image, layer, level, i, j, k);
+        return texels<F32>(image, layer, level, i, j, k, lane_indices);
     }
 
     u -= 0.5f;
     v -= 0.5f;
 
-    i32x4 i0 = to_i32x4(floor_int_range(u));
-    i32x4 i1 = i0 + 1;
-    i32x4 j0 = to_i32x4(floor_int_range(v));
-    i32x4 j1 = j0 + 1;
+    I32 i0 = convert<I32>(floor_int_range(u));
+    I32 i1 = i0 + 1;
+    I32 j0 = convert<I32>(floor_int_range(v));
+    I32 j1 = j0 + 1;
 
-    if (m_config.texture_wrap_u == TextureWrapMode::Repeat) {
+    if (config.texture_wrap_u == TextureWrapMode::Repeat) {
         if (image.width_is_power_of_two()) {
-            i0 = (i32x4)(i0 & width_mask);
-            i1 = (i32x4)(i1 & width_mask);
+            i0 = (I32)(i0 & width_mask);
+            i1 = (I32)(i1 & width_mask);
         } else {
-            i0 = (i32x4)(i0 % width);
-            i1 = (i32x4)(i1 % width);
+            i0 = (I32)(i0 % width);
+            i1 = (I32)(i1 % width);
         }
     }
 
-    if (m_config.texture_wrap_v == TextureWrapMode::Repeat) {
+    if (config.texture_wrap_v == TextureWrapMode::Repeat) {
         if (image.height_is_power_of_two()) {
-            j0 = (i32x4)(j0 & height_mask);
-            j1 = (i32x4)(j1 & height_mask);
+            j0 = (I32)(j0 & height_mask);
+            j1 = (I32)(j1 & height_mask);
         } else {
-            j0 = (i32x4)(j0 % height);
-            j1 = (i32x4)(j1 % height);
+            j0 = (I32)(j0 % height);
+            j1 = (I32)(j1 % height);
         }
     }
 
-    u32x4 k = expand4(0u);
+    U32 k = expand<U32>(0u);
 
-    Vector4<f32x4> t0, t1, t2, t3;
+    Vector4<F32> t0, t1, t2, t3;
 
-    if (m_config.texture_wrap_u == TextureWrapMode::Repeat && m_config.texture_wrap_v == TextureWrapMode::Repeat) {
-        t0 = texel4(image, layer, level, to_u32x4(i0), to_u32x4(j0), k);
-        t1 = texel4(image, layer, level, to_u32x4(i1), to_u32x4(j0), k);
-        t2 = texel4(image, layer, level, to_u32x4(i0), to_u32x4(j1), k);
-        t3 = texel4(image, layer, level, to_u32x4(i1), to_u32x4(j1), k);
+    if (config.texture_wrap_u == TextureWrapMode::Repeat && config.texture_wrap_v == TextureWrapMode::Repeat) {
+        t0 = texels<F32>(image, layer, level, convert<U32>(i0), convert<U32>(j0), k, lane_indices);
+        t1 = texels<F32>(image, layer, level, convert<U32>(i1), convert<U32>(j0), k, lane_indices);
+        t2 = texels<F32>(image, layer, level, convert<U32>(i0), convert<U32>(j1), k, lane_indices);
+        t3 = texels<F32>(image, layer, level, convert<U32>(i1), convert<U32>(j1), k, lane_indices);
     } else {
-        t0 = texel4border(image, layer, level, to_u32x4(i0), to_u32x4(j0), k, m_config.border_color, width, height);
-        t1 = texel4border(image, layer, level, to_u32x4(i1), to_u32x4(j0), k, m_config.border_color, width, height);
-        t2 = texel4border(image, layer, level, to_u32x4(i0), to_u32x4(j1), k, m_config.border_color, width, height);
-        t3 = texel4border(image, layer, level, to_u32x4(i1), to_u32x4(j1), k, m_config.border_color, width, height);
+        t0 = texels_with_border<F32>(image, layer, level, convert<U32>(i0), convert<U32>(j0), k, config.border_color, width, height, lane_indices);
+        t1 = texels_with_border<F32>(image, layer, level, convert<U32>(i1), convert<U32>(j0), k, config.border_color, width, height, lane_indices);
+        t2 = texels_with_border<F32>(image, layer, level, convert<U32>(i0), convert<U32>(j1), k, config.border_color, width, height, lane_indices);
+        t3 = texels_with_border<F32>(image, layer, level, convert<U32>(i1), convert<U32>(j1), k, config.border_color, width, height, lane_indices);
     }
 
-    f32x4 const alpha = frac_int_range(u);
-    f32x4 const beta = frac_int_range(v);
+    F32 const alpha = frac_int_range(u);
+    F32 const beta = frac_int_range(v);
 
     auto const lerp_0 = mix(t0, t1, alpha);
     auto const lerp_1 = mix(t2, t3, alpha);
     return mix(lerp_0, lerp_1, beta);
 }
 
+Vector4<AK::SIMD::f32x4> Sampler::sample_2d(Vector2<AK::SIMD::f32x4> const& uv) const
+{
+    return sample_2d_impl(m_config, uv);
+}
+
+#if ARCH(X86_64)
+// Only called from the AVX2 rasterizer, so everything inlined here may use AVX2 as well.
+[[gnu::target("avx2"), gnu::flatten]] Vector4<AK::SIMD::f32x8> Sampler::sample_2d(Vector2<AK::SIMD::f32x8> const& uv) const
+{
+    return sample_2d_impl(m_config, uv);
+}
+#endif
+
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Platform.h>
 #include <AK/RefPtr.h>
 #include <AK/SIMD.h>
 #include <LibGfx/Vector2.h>
@@ -54,6 +55,9 @@ struct SamplerConfig final {
 class Sampler final {
 public:
     Vector4<AK::SIMD::f32x4> sample_2d(Vector2<AK::SIMD::f32x4> const& uv) const;
+#if ARCH(X86_64)
+    [[gnu::target("avx2")]] Vector4<AK::SIMD::f32x8> sample_2d(Vector2<AK::SIMD::f32x8> const& uv) const;
+#endif
 
     void set_config(SamplerConfig const& config) { m_config = config; }
     SamplerConfig const& config() const { return m_config; }
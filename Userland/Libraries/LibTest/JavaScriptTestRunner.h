@@ -126,6 +126,7 @@ static consteval size_t __testjs_last()
 static constexpr auto TOP_LEVEL_TEST_NAME = "__$$TOP_LEVEL$$__";
 extern RefPtr<JS::VM> g_vm;
 extern bool g_collect_on_every_allocation;
+extern bool g_incremental_marking;
 extern bool g_run_bytecode;
 extern String g_currently_running_test;
 struct FunctionWithLength {
@@ -298,6 +299,7 @@ inline JSFileResult TestRunner::run_file_test(const String& test_path)
     JS::VM::InterpreterExecutionScope scope(*interpreter);
 
     interpreter->heap().set_should_collect_on_every_allocation(g_collect_on_every_allocation);
+    interpreter->heap().set_incremental_marking_enabled(g_incremental_marking);
 
     if (g_run_file) {
         auto result = g_run_file(test_path, *interpreter);
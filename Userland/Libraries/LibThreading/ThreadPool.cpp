@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/String.h>
+#include <LibThreading/ThreadPool.h>
+#include <unistd.h>
+
+namespace Threading {
+
+ThreadPool::ThreadPool(StringView name, size_t max_thread_count)
+{
+    auto online_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = clamp(online_processors > 0 ? static_cast<size_t>(online_processors) : 1, 1, max(max_thread_count, 1));
+    for (size_t i = 1; i < thread_count; ++i) {
+        auto worker = Thread::construct([this] { return worker_main(); }, String::formatted("{} {}", name, i));
+        worker->start();
+        m_workers.append(move(worker));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        MutexLocker locker(m_mutex);
+        m_exiting = true;
+        m_work_available.broadcast();
+    }
+    for (auto& worker : m_workers)
+        (void)worker.join();
+}
+
+void ThreadPool::run_jobs(Function<void(size_t)> const& job, size_t count)
+{
+    for (;;) {
+        auto index = m_next_index.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        if (index >= count)
+            return;
+        job(index);
+    }
+}
+
+intptr_t ThreadPool::worker_main()
+{
+    u64 seen_generation = 0;
+    for (;;) {
+        Function<void(size_t)> const* job;
+        size_t count;
+        {
+            MutexLocker locker(m_mutex);
+            // A worker that wakes up late may find that the others already finished the batch it was woken for.
+            m_work_available.wait_while([&] { return !m_exiting && (!m_job || m_generation == seen_generation); });
+            if (m_exiting)
+                return 0;
+            seen_generation = m_generation;
+            job = m_job;
+            count = m_job_count;
+            ++m_active_workers;
+        }
+
+        run_jobs(*job, count);
+
+        MutexLocker locker(m_mutex);
+        if (--m_active_workers == 0)
+            m_work_done.signal();
+    }
+}
+
+void ThreadPool::run(size_t count, Function<void(size_t)> const& job)
+{
+    if (m_workers.is_empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i)
+            job(i);
+        return;
+    }
+
+    {
+        MutexLocker locker(m_mutex);
+        m_job = &job;
+        m_job_count = count;
+        m_next_index.store(0, AK::MemoryOrder::memory_order_relaxed);
+        ++m_generation;
+        m_work_available.broadcast();
+    }
+
+    run_jobs(job, count);
+
+    MutexLocker locker(m_mutex);
+    m_work_done.wait_while([&] { return m_active_workers > 0; });
+    m_job = nullptr;
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/StringView.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace Threading {
+
+// A fixed set of threads that stay around for the lifetime of the pool, so that splitting work up doesn't have to
+// pay for creating threads every time. The thread calling run() takes part in the work as well.
+class ThreadPool {
+    AK_MAKE_NONCOPYABLE(ThreadPool);
+    AK_MAKE_NONMOVABLE(ThreadPool);
+
+public:
+    // Uses one thread per online CPU (including the calling one), up to max_thread_count. Workers are named after `name`.
+    ThreadPool(StringView name, size_t max_thread_count);
+    ~ThreadPool();
+
+    size_t thread_count() const { return m_workers.size() + 1; }
+
+    // Calls job(index) for every index in [0, count), spread over all threads, and returns once all calls are done.
+    void run(size_t count, Function<void(size_t)> const& job);
+
+private:
+    intptr_t worker_main();
+    void run_jobs(Function<void(size_t)> const&, size_t count);
+
+    NonnullRefPtrVector<Thread> m_workers;
+
+    Mutex m_mutex;
+    ConditionVariable m_work_available { m_mutex };
+    ConditionVariable m_work_done { m_mutex };
+    Function<void(size_t)> const* m_job { nullptr };
+    size_t m_job_count { 0 };
+    u64 m_generation { 0 };
+    size_t m_active_workers { 0 };
+    bool m_exiting { false };
+
+    Atomic<size_t> m_next_index { 0 };
+};
+
+}
@@ -13,6 +13,15 @@
 
 namespace Wasm {
 
+CompiledFunction const* WasmFunction::compiled_function(Store& store)
+{
+    if (m_compilation_state == CompilationState::NotCompiled) {
+        m_compiled_function = CompiledFunction::try_create(store, *this);
+        m_compilation_state = m_compiled_function ? CompilationState::Compiled : CompilationState::Failed;
+    }
+    return m_compiled_function.ptr();
+}
+
 Optional<FunctionAddress> Store::allocate(ModuleInstance& module, Module::Function const& function)
 {
     FunctionAddress address { m_functions.size() };
@@ -11,6 +11,7 @@
 #include <AK/HashTable.h>
 #include <AK/OwnPtr.h>
 #include <AK/Result.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
 #include <LibWasm/Types.h>
 
 namespace Wasm {
@@ -271,10 +272,21 @@ public:
     auto& module() const { return m_module; }
     auto& code() const { return m_code; }
 
+    // Lowers the function on first use; returns null if it can't be compiled.
+    CompiledFunction const* compiled_function(Store&);
+
 private:
+    enum class CompilationState : u8 {
+        NotCompiled,
+        Compiled,
+        Failed,
+    };
+
     FunctionType m_type;
     ModuleInstance const& m_module;
     Module::Function const& m_code;
+    CompilationState m_compilation_state { CompilationState::NotCompiled };
+    RefPtr<CompiledFunction> m_compiled_function;
 };
 
 class HostFunction {
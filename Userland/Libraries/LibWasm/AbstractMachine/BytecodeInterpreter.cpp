@@ -983,4 +983,12 @@ void DebuggerBytecodeInterpreter::interpret(Configuration& configuration, Instru
         }
     }
 }
+
+Optional<Result> DebuggerBytecodeInterpreter::try_call_compiled(Configuration& configuration, WasmFunction& function, Vector<Value>& arguments)
+{
+    // The hooks need to see every instruction, so only the stack-based interpreter can run with them.
+    if (pre_interpret_hook || post_interpret_hook)
+        return {};
+    return BytecodeInterpreter::try_call_compiled(configuration, function, arguments);
+}
 }
@@ -18,6 +18,10 @@ struct BytecodeInterpreter : public Interpreter {
     virtual bool did_trap() const override { return m_trap.has_value(); }
     virtual String trap_reason() const override { return m_trap.value().reason; }
     virtual void clear_trap() override { m_trap.clear(); }
+    virtual Optional<Result> try_call_compiled(Configuration&, WasmFunction&, Vector<Value>&) override;
+
+    // Functions are lowered into a register-based form on their first call and run from that, unless disabled here.
+    void set_compiled_execution_enabled(bool enabled) { m_compiled_execution_enabled = enabled; }
 
     struct CallFrameHandle {
         explicit CallFrameHandle(BytecodeInterpreter& interpreter, Configuration& configuration)
@@ -58,6 +62,10 @@ protected:
     T read_value(ReadonlyBytes data);
 
     Vector<Value> pop_values(Configuration& configuration, size_t count);
+
+    bool execute_compiled(Configuration&, CompiledFunction const&, size_t base);
+    bool call_from_compiled(Configuration&, FunctionAddress, size_t arguments_base);
+
     ALWAYS_INLINE bool trap_if_not(bool value, StringView reason)
     {
         if (!value)
@@ -67,10 +75,12 @@ protected:
 
     Optional<Trap> m_trap;
     StackInfo m_stack_info;
+    bool m_compiled_execution_enabled { true };
 };
 
 struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
     virtual ~DebuggerBytecodeInterpreter() override = default;
+    virtual Optional<Result> try_call_compiled(Configuration&, WasmFunction&, Vector<Value>&) override;
 
     Function<bool(Configuration&, InstructionPointer&, Instruction const&)> pre_interpret_hook;
     Function<bool(Configuration&, InstructionPointer&, Instruction const&, Interpreter const&)> post_interpret_hook;
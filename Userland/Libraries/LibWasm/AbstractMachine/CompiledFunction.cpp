@@ -0,0 +1,839 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/HashMap.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
+#include <LibWasm/Opcode.h>
+#include <LibWasm/Printer/Printer.h>
+
+namespace Wasm {
+
+// While compiling, slot operands that depend on the final frame layout are tagged and fixed up at the end,
+// once the number of constants is known. Untagged operands are local indices (or plain numbers).
+static constexpr u32 stack_slot_tag = 0x80000000;
+static constexpr u32 constant_slot_tag = 0x40000000;
+static constexpr u32 slot_tag_mask = stack_slot_tag | constant_slot_tag;
+
+class FunctionCompiler {
+public:
+    FunctionCompiler(Store& store, WasmFunction const& function)
+        : m_store(store)
+        , m_function(function)
+        , m_module(function.module())
+        , m_compiled(adopt_ref(*new CompiledFunction(function.module())))
+    {
+    }
+
+    RefPtr<CompiledFunction> compile();
+
+private:
+    // The value at a given operand stack height either lives in its own stack slot already, or is
+    // a local or a constant that hasn't been copied there yet (and may never need to be).
+    struct StackEntry {
+        enum class Kind : u8 {
+            Stack,
+            Local,
+            Constant,
+        };
+        Kind kind { Kind::Stack };
+        u32 index { 0 };
+    };
+
+    struct PendingJump {
+        bool is_branch_table_target { false };
+        size_t index { 0 };
+    };
+
+    struct ControlFrame {
+        enum class Kind : u8 {
+            Block,
+            Loop,
+            If,
+        };
+        Kind kind { Kind::Block };
+        size_t height { 0 };
+        size_t parameter_count { 0 };
+        size_t result_count { 0 };
+        size_t loop_start { 0 };
+        Optional<size_t> else_jump;
+        Vector<PendingJump> jumps_to_end;
+
+        size_t branch_arity() const { return kind == Kind::Loop ? parameter_count : result_count; }
+    };
+
+    struct Condition {
+        CompiledOpcode jump_if_true { CompiledOpcode::jump_if_not_zero };
+        u32 lhs { 0 };
+        u32 rhs { 0 };
+    };
+
+    bool compile_instruction(Instruction const&);
+    bool compile_block_start(Instruction const&);
+    void compile_else();
+    void compile_end();
+    void compile_branch(size_t depth);
+    void compile_conditional_branch(size_t depth);
+    void compile_branch_table(Instruction::TableBranchArgs const&);
+    void compile_return();
+    void compile_call(FunctionType const&, CompiledOpcode, Optional<u32> index = {}, u64 immediate = 0, u32 type_index = 0);
+    void compile_local_set(u32 local, bool keep_value);
+
+    size_t emit(CompiledOpcode opcode, u32 a = 0, u32 b = 0, u32 c = 0, u64 immediate = 0);
+    void emit_jump_to(ControlFrame&, CompiledOpcode, u32 lhs = 0, u32 rhs = 0);
+    void emit_jump_to_end(ControlFrame&, size_t instruction_index);
+    void bind_label();
+    void bind_jumps(Vector<PendingJump> const&);
+
+    static u32 stack_slot(size_t height) { return stack_slot_tag | static_cast<u32>(height); }
+    u32 slot_of(StackEntry const&, size_t height) const;
+    u32 constant(u64 value);
+    void push_local(u32 local) { m_stack.append({ StackEntry::Kind::Local, local }); }
+    void push_constant(u64 value) { m_stack.append({ StackEntry::Kind::Constant, constant(value) }); }
+    u32 push_result();
+    u32 pop_operand();
+    Condition pop_condition();
+    void materialize(size_t height);
+    void materialize_top(size_t count);
+    void materialize_all();
+    void materialize_local(u32 local);
+    bool branch_needs_copies(ControlFrame const&) const;
+    void emit_branch_copies(ControlFrame const&);
+    void mark_unreachable();
+    Optional<size_t> block_parameter_and_result_counts(BlockType const&, size_t& parameter_count) const;
+
+    Store& m_store;
+    WasmFunction const& m_function;
+    ModuleInstance const& m_module;
+    NonnullRefPtr<CompiledFunction> m_compiled;
+
+    size_t m_local_count { 0 };
+    Vector<u64> m_constants;
+    HashMap<u64, u32> m_constant_indices;
+
+    Vector<StackEntry> m_stack;
+    size_t m_max_stack_height { 0 };
+    Vector<ControlFrame> m_control_stack;
+
+    // Number of nested blocks entered since the code became unreachable, plus one. Zero while reachable.
+    size_t m_unreachable_depth { 0 };
+
+    // The last emitted instruction wrote its result to the stack slot of the current top entry,
+    // so a following local.set can write the local directly, or a br_if can fuse with the comparison.
+    Optional<size_t> m_last_result_instruction;
+    bool m_last_result_is_fusable_comparison { false };
+};
+
+u32 FunctionCompiler::slot_of(StackEntry const& entry, size_t height) const
+{
+    switch (entry.kind) {
+    case StackEntry::Kind::Stack:
+        return stack_slot(height);
+    case StackEntry::Kind::Local:
+        return entry.index;
+    case StackEntry::Kind::Constant:
+        return constant_slot_tag | entry.index;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+u32 FunctionCompiler::constant(u64 value)
+{
+    if (auto index = m_constant_indices.get(value); index.has_value())
+        return *index;
+    u32 index = m_constants.size();
+    m_constants.append(value);
+    m_constant_indices.set(value, index);
+    return index;
+}
+
+u32 FunctionCompiler::push_result()
+{
+    m_stack.append({ StackEntry::Kind::Stack, 0 });
+    m_max_stack_height = max(m_max_stack_height, m_stack.size());
+    return stack_slot(m_stack.size() - 1);
+}
+
+u32 FunctionCompiler::pop_operand()
+{
+    auto entry = m_stack.take_last();
+    return slot_of(entry, m_stack.size());
+}
+
+void FunctionCompiler::materialize(size_t height)
+{
+    auto& entry = m_stack[height];
+    if (entry.kind == StackEntry::Kind::Stack)
+        return;
+    emit(CompiledOpcode::copy, stack_slot(height), slot_of(entry, height));
+    entry = { StackEntry::Kind::Stack, 0 };
+    m_max_stack_height = max(m_max_stack_height, height + 1);
+}
+
+void FunctionCompiler::materialize_top(size_t count)
+{
+    for (size_t height = m_stack.size() - count; height < m_stack.size(); ++height)
+        materialize(height);
+}
+
+void FunctionCompiler::materialize_all()
+{
+    materialize_top(m_stack.size());
+}
+
+void FunctionCompiler::materialize_local(u32 local)
+{
+    for (size_t height = 0; height < m_stack.size(); ++height) {
+        if (m_stack[height].kind == StackEntry::Kind::Local && m_stack[height].index == local)
+            materialize(height);
+    }
+}
+
+size_t FunctionCompiler::emit(CompiledOpcode opcode, u32 a, u32 b, u32 c, u64 immediate)
+{
+    m_last_result_instruction.clear();
+    m_last_result_is_fusable_comparison = false;
+    m_compiled->m_instructions.append({ opcode, a, b, c, immediate });
+    return m_compiled->m_instructions.size() - 1;
+}
+
+void FunctionCompiler::bind_label()
+{
+    // Something jumps here, so the previous instruction can't be rewritten anymore.
+    m_last_result_instruction.clear();
+    m_last_result_is_fusable_comparison = false;
+}
+
+void FunctionCompiler::bind_jumps(Vector<PendingJump> const& jumps)
+{
+    bind_label();
+    auto target = m_compiled->m_instructions.size();
+    for (auto& jump : jumps) {
+        if (jump.is_branch_table_target)
+            m_compiled->m_branch_table_targets[jump.index] = target;
+        else
+            m_compiled->m_instructions[jump.index].immediate = target;
+    }
+}
+
+void FunctionCompiler::emit_jump_to_end(ControlFrame& frame, size_t instruction_index)
+{
+    frame.jumps_to_end.append({ false, instruction_index });
+}
+
+void FunctionCompiler::emit_jump_to(ControlFrame& frame, CompiledOpcode opcode, u32 lhs, u32 rhs)
+{
+    if (frame.kind == ControlFrame::Kind::Loop) {
+        emit(opcode, 0, lhs, rhs, frame.loop_start);
+        return;
+    }
+    emit_jump_to_end(frame, emit(opcode, 0, lhs, rhs));
+}
+
+bool FunctionCompiler::branch_needs_copies(ControlFrame const& frame) const
+{
+    auto arity = frame.branch_arity();
+    auto first_height = m_stack.size() - arity;
+    for (size_t i = 0; i < arity; ++i) {
+        if (first_height + i != frame.height + i || m_stack[first_height + i].kind != StackEntry::Kind::Stack)
+            return true;
+    }
+    return false;
+}
+
+void FunctionCompiler::emit_branch_copies(ControlFrame const& frame)
+{
+    // The target slots are never above the values being copied, so copying upwards doesn't clobber any of them.
+    auto arity = frame.branch_arity();
+    auto first_height = m_stack.size() - arity;
+    for (size_t i = 0; i < arity; ++i) {
+        auto& entry = m_stack[first_height + i];
+        if (first_height + i == frame.height + i && entry.kind == StackEntry::Kind::Stack)
+            continue;
+        emit(CompiledOpcode::copy, stack_slot(frame.height + i), slot_of(entry, first_height + i));
+    }
+}
+
+void FunctionCompiler::mark_unreachable()
+{
+    m_unreachable_depth = 1;
+}
+
+auto FunctionCompiler::pop_condition() -> Condition
+{
+    auto& top = m_stack.last();
+    if (m_last_result_instruction.has_value() && top.kind == StackEntry::Kind::Stack) {
+        auto& instruction = m_compiled->m_instructions[*m_last_result_instruction];
+        auto opcode = instruction.opcode;
+        if (m_last_result_is_fusable_comparison && instruction.a == stack_slot(m_stack.size() - 1)) {
+            Condition condition;
+            if (opcode == CompiledOpcode::i32_eqz) {
+                condition = { CompiledOpcode::jump_if_zero, instruction.b, 0 };
+            } else {
+                switch (opcode) {
+#define M(name, ...)                                                                     \
+    case CompiledOpcode::name:                                                           \
+        condition = { CompiledOpcode::jump_if_##name, instruction.b, instruction.c };    \
+        break;
+                    ENUMERATE_COMPILED_WASM_FUSED_COMPARISONS(M)
+#undef M
+                default:
+                    VERIFY_NOT_REACHED();
+                }
+            }
+            // The comparison result is only used by the branch, so it doesn't have to be stored.
+            m_compiled->m_instructions.take_last();
+            m_stack.take_last();
+            bind_label();
+            return condition;
+        }
+    }
+    return { CompiledOpcode::jump_if_not_zero, pop_operand(), 0 };
+}
+
+static bool is_fusable_comparison(CompiledOpcode opcode)
+{
+    switch (opcode) {
+#define M(name, ...) case CompiledOpcode::name:
+        ENUMERATE_COMPILED_WASM_FUSED_COMPARISONS(M)
+#undef M
+        return true;
+    default:
+        return false;
+    }
+}
+
+static CompiledOpcode inverse_jump(CompiledOpcode opcode)
+{
+    switch (opcode) {
+    case CompiledOpcode::jump_if_zero:
+        return CompiledOpcode::jump_if_not_zero;
+    case CompiledOpcode::jump_if_not_zero:
+        return CompiledOpcode::jump_if_zero;
+#define M(name, type, operator_, inverse) \
+    case CompiledOpcode::jump_if_##name:  \
+        return CompiledOpcode::jump_if_##inverse;
+        ENUMERATE_COMPILED_WASM_FUSED_COMPARISONS(M)
+#undef M
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+Optional<size_t> FunctionCompiler::block_parameter_and_result_counts(BlockType const& block_type, size_t& parameter_count) const
+{
+    parameter_count = 0;
+    switch (block_type.kind()) {
+    case BlockType::Empty:
+        return 0;
+    case BlockType::Type:
+        return 1;
+    case BlockType::Index: {
+        auto index = block_type.type_index().value();
+        if (index >= m_module.types().size())
+            return {};
+        auto& type = m_module.types()[index];
+        parameter_count = type.parameters().size();
+        return type.results().size();
+    }
+    }
+    return {};
+}
+
+bool FunctionCompiler::compile_block_start(Instruction const& instruction)
+{
+    auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
+    size_t parameter_count = 0;
+    auto result_count = block_parameter_and_result_counts(args.block_type, parameter_count);
+    if (!result_count.has_value() || m_stack.size() < parameter_count + (instruction.opcode() == Instructions::if_ ? 1 : 0))
+        return false;
+
+    ControlFrame frame;
+    frame.parameter_count = parameter_count;
+    frame.result_count = *result_count;
+
+    Optional<Condition> condition;
+    if (instruction.opcode() == Instructions::if_)
+        condition = pop_condition();
+
+    // Values below the block (and its parameters) have to stay in their stack slots while inside it,
+    // as they would otherwise have to be copied on every path that leaves it.
+    materialize_all();
+    frame.height = m_stack.size() - parameter_count;
+
+    if (instruction.opcode() == Instructions::block) {
+        frame.kind = ControlFrame::Kind::Block;
+    } else if (instruction.opcode() == Instructions::loop) {
+        frame.kind = ControlFrame::Kind::Loop;
+        bind_label();
+        frame.loop_start = m_compiled->m_instructions.size();
+    } else {
+        frame.kind = ControlFrame::Kind::If;
+        frame.else_jump = emit(inverse_jump(condition->jump_if_true), 0, condition->lhs, condition->rhs);
+    }
+    m_control_stack.append(move(frame));
+    return true;
+}
+
+void FunctionCompiler::compile_else()
+{
+    auto& frame = m_control_stack.last();
+    VERIFY(frame.kind == ControlFrame::Kind::If && frame.else_jump.has_value());
+
+    if (m_unreachable_depth == 0) {
+        materialize_top(frame.result_count);
+        emit_jump_to_end(frame, emit(CompiledOpcode::jump));
+    }
+    m_unreachable_depth = 0;
+
+    bind_label();
+    m_compiled->m_instructions[*frame.else_jump].immediate = m_compiled->m_instructions.size();
+    frame.else_jump.clear();
+
+    // The else branch starts out with the block's parameters, which are still in their stack slots.
+    m_stack.resize(frame.height);
+    for (size_t i = 0; i < frame.parameter_count; ++i)
+        push_result();
+}
+
+void FunctionCompiler::compile_end()
+{
+    auto frame = m_control_stack.take_last();
+    if (m_unreachable_depth == 0)
+        materialize_top(frame.result_count);
+    m_unreachable_depth = 0;
+
+    // An if without an else passes its parameters through unchanged when the condition is false.
+    if (frame.else_jump.has_value())
+        emit_jump_to_end(frame, *frame.else_jump);
+
+    bind_jumps(frame.jumps_to_end);
+
+    m_stack.resize(frame.height);
+    for (size_t i = 0; i < frame.result_count; ++i)
+        push_result();
+}
+
+void FunctionCompiler::compile_branch(size_t depth)
+{
+    auto& frame = m_control_stack[m_control_stack.size() - depth - 1];
+    if (&frame == &m_control_stack.first()) {
+        compile_return();
+        return;
+    }
+    emit_branch_copies(frame);
+    emit_jump_to(frame, CompiledOpcode::jump);
+    mark_unreachable();
+}
+
+void FunctionCompiler::compile_conditional_branch(size_t depth)
+{
+    auto condition = pop_condition();
+    auto& frame = m_control_stack[m_control_stack.size() - depth - 1];
+
+    if (&frame == &m_control_stack.first()) {
+        auto skip = emit(inverse_jump(condition.jump_if_true), 0, condition.lhs, condition.rhs);
+        compile_return();
+        m_unreachable_depth = 0;
+        bind_label();
+        m_compiled->m_instructions[skip].immediate = m_compiled->m_instructions.size();
+        return;
+    }
+
+    if (!branch_needs_copies(frame)) {
+        emit_jump_to(frame, condition.jump_if_true, condition.lhs, condition.rhs);
+        return;
+    }
+
+    // The results only get moved into place if the branch is taken, as the values stay on the stack otherwise.
+    auto skip = emit(inverse_jump(condition.jump_if_true), 0, condition.lhs, condition.rhs);
+    emit_branch_copies(frame);
+    emit_jump_to(frame, CompiledOpcode::jump);
+    bind_label();
+    m_compiled->m_instructions[skip].immediate = m_compiled->m_instructions.size();
+}
+
+void FunctionCompiler::compile_branch_table(Instruction::TableBranchArgs const& args)
+{
+    auto index = pop_operand();
+    auto& targets = m_compiled->m_branch_table_targets;
+    auto first_target = targets.size();
+    auto target_count = args.labels.size();
+    targets.resize(first_target + target_count + 1);
+
+    emit(CompiledOpcode::br_table, 0, index, 0, (static_cast<u64>(first_target) << 32) | target_count);
+
+    // Targets that need values moved around first get a little stub after the br_table, which is unreachable otherwise.
+    HashMap<size_t, size_t> stubs;
+    auto add_target = [&](size_t target_index, LabelIndex label) {
+        auto depth = label.value();
+        auto& frame = m_control_stack[m_control_stack.size() - depth - 1];
+        if (&frame != &m_control_stack.first() && !branch_needs_copies(frame)) {
+            if (frame.kind == ControlFrame::Kind::Loop)
+                targets[target_index] = frame.loop_start;
+            else
+                frame.jumps_to_end.append({ true, target_index });
+            return;
+        }
+        if (auto stub = stubs.get(depth); stub.has_value()) {
+            targets[target_index] = *stub;
+            return;
+        }
+        auto stub = m_compiled->m_instructions.size();
+        stubs.set(depth, stub);
+        targets[target_index] = stub;
+        compile_branch(depth);
+    };
+
+    for (size_t i = 0; i < target_count; ++i)
+        add_target(first_target + i, args.labels[i]);
+    add_target(first_target + target_count, args.default_);
+
+    mark_unreachable();
+}
+
+void FunctionCompiler::compile_return()
+{
+    auto result_count = m_compiled->m_result_count;
+    if (result_count == 0) {
+        emit(CompiledOpcode::return_);
+    } else if (result_count == 1) {
+        auto height = m_stack.size() - 1;
+        emit(CompiledOpcode::return_value, 0, slot_of(m_stack.last(), height));
+    } else {
+        auto& frame = m_control_stack.first();
+        emit_branch_copies(frame);
+        emit(CompiledOpcode::return_values, stack_slot(0), 0, result_count);
+    }
+    mark_unreachable();
+}
+
+void FunctionCompiler::compile_call(FunctionType const& type, CompiledOpcode opcode, Optional<u32> index, u64 immediate, u32 type_index)
+{
+    // The callee's frame starts at the first argument, so the arguments have to be in their stack slots,
+    // and the results end up in the stack slots that held the arguments.
+    auto parameter_count = type.parameters().size();
+    u32 index_slot = index.value_or(0);
+    materialize_top(parameter_count);
+    auto first_argument = m_stack.size() - parameter_count;
+    emit(opcode, stack_slot(first_argument), index_slot, type_index, immediate);
+    m_stack.resize(first_argument);
+    for (size_t i = 0; i < type.results().size(); ++i)
+        push_result();
+}
+
+void FunctionCompiler::compile_local_set(u32 local, bool keep_value)
+{
+    auto height = m_stack.size() - 1;
+    auto entry = m_stack.last();
+
+    auto references_local = [&] {
+        for (size_t i = 0; i < height; ++i) {
+            if (m_stack[i].kind == StackEntry::Kind::Local && m_stack[i].index == local)
+                return true;
+        }
+        return false;
+    };
+
+    // Let the instruction that computed the value write it to the local right away.
+    if (entry.kind == StackEntry::Kind::Stack && m_last_result_instruction.has_value() && !references_local()) {
+        auto& instruction = m_compiled->m_instructions[*m_last_result_instruction];
+        if (instruction.a == stack_slot(height)) {
+            instruction.a = local;
+            m_last_result_instruction.clear();
+            m_last_result_is_fusable_comparison = false;
+            m_stack.take_last();
+            if (keep_value)
+                push_local(local);
+            return;
+        }
+    }
+
+    if (entry.kind == StackEntry::Kind::Local && entry.index == local) {
+        if (!keep_value)
+            m_stack.take_last();
+        return;
+    }
+
+    materialize_local(local);
+    auto source = slot_of(m_stack.last(), height);
+    m_stack.take_last();
+    emit(CompiledOpcode::copy, local, source);
+    if (keep_value)
+        push_local(local);
+}
+
+bool FunctionCompiler::compile_instruction(Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+
+    if (m_unreachable_depth > 0) {
+        // Skip dead code up to the end of the block it's in.
+        switch (opcode.value()) {
+        case Instructions::block.value():
+        case Instructions::loop.value():
+        case Instructions::if_.value():
+            ++m_unreachable_depth;
+            return true;
+        case Instructions::structured_else.value():
+            if (m_unreachable_depth == 1)
+                compile_else();
+            return true;
+        case Instructions::structured_end.value():
+            if (--m_unreachable_depth == 0) {
+                m_unreachable_depth = 1;
+                compile_end();
+            }
+            return true;
+        default:
+            return true;
+        }
+    }
+
+    auto emit_unary = [&](CompiledOpcode compiled_opcode) {
+        auto operand = pop_operand();
+        auto result = push_result();
+        m_last_result_instruction = emit(compiled_opcode, result, operand);
+        m_last_result_is_fusable_comparison = compiled_opcode == CompiledOpcode::i32_eqz;
+    };
+    auto emit_binary = [&](CompiledOpcode compiled_opcode) {
+        auto rhs = pop_operand();
+        auto lhs = pop_operand();
+        auto result = push_result();
+        m_last_result_instruction = emit(compiled_opcode, result, lhs, rhs);
+        m_last_result_is_fusable_comparison = is_fusable_comparison(compiled_opcode);
+    };
+    auto emit_load = [&](CompiledOpcode compiled_opcode) {
+        if (m_module.memories().is_empty())
+            return false;
+        auto& argument = instruction.arguments().get<Instruction::MemoryArgument>();
+        auto address = pop_operand();
+        auto result = push_result();
+        m_last_result_instruction = emit(compiled_opcode, result, address, 0, argument.offset);
+        return true;
+    };
+    auto emit_store = [&](CompiledOpcode compiled_opcode) {
+        if (m_module.memories().is_empty())
+            return false;
+        auto& argument = instruction.arguments().get<Instruction::MemoryArgument>();
+        auto value = pop_operand();
+        auto address = pop_operand();
+        emit(compiled_opcode, 0, address, value, argument.offset);
+        return true;
+    };
+
+    switch (opcode.value()) {
+    case Instructions::unreachable.value():
+        emit(CompiledOpcode::unreachable);
+        mark_unreachable();
+        return true;
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+    case Instructions::loop.value():
+    case Instructions::if_.value():
+        return compile_block_start(instruction);
+    case Instructions::structured_else.value():
+        compile_else();
+        return true;
+    case Instructions::structured_end.value():
+        if (m_control_stack.size() <= 1)
+            return false;
+        compile_end();
+        return true;
+    case Instructions::br.value():
+        compile_branch(instruction.arguments().get<LabelIndex>().value());
+        return true;
+    case Instructions::br_if.value():
+        compile_conditional_branch(instruction.arguments().get<LabelIndex>().value());
+        return true;
+    case Instructions::br_table.value():
+        compile_branch_table(instruction.arguments().get<Instruction::TableBranchArgs>());
+        return true;
+    case Instructions::return_.value():
+        compile_return();
+        return true;
+    case Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_module.functions().size())
+            return false;
+        auto address = m_module.functions()[index];
+        auto* callee = m_store.get(address);
+        if (!callee)
+            return false;
+        FunctionType const* type { nullptr };
+        callee->visit([&](auto const& function) { type = &function.type(); });
+        compile_call(*type, CompiledOpcode::call, {}, address.value());
+        return true;
+    }
+    case Instructions::call_indirect.value(): {
+        auto& args = instruction.arguments().get<Instruction::IndirectCallArgs>();
+        if (args.table.value() >= m_module.tables().size() || args.type.value() >= m_module.types().size())
+            return false;
+        auto table_address = m_module.tables()[args.table.value()];
+        auto index = pop_operand();
+        compile_call(m_module.types()[args.type.value()], CompiledOpcode::call_indirect, index, table_address.value(), args.type.value());
+        return true;
+    }
+    case Instructions::drop.value():
+        m_stack.take_last();
+        return true;
+    case Instructions::select.value():
+    case Instructions::select_typed.value(): {
+        auto condition = pop_operand();
+        auto rhs = pop_operand();
+        materialize(m_stack.size() - 1);
+        auto lhs = stack_slot(m_stack.size() - 1);
+        emit(CompiledOpcode::select, lhs, rhs, condition);
+        return true;
+    }
+    case Instructions::local_get.value():
+        push_local(instruction.arguments().get<LocalIndex>().value());
+        return true;
+    case Instructions::local_set.value():
+        compile_local_set(instruction.arguments().get<LocalIndex>().value(), false);
+        return true;
+    case Instructions::local_tee.value():
+        compile_local_set(instruction.arguments().get<LocalIndex>().value(), true);
+        return true;
+    case Instructions::global_get.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>().value();
+        if (index >= m_module.globals().size())
+            return false;
+        auto result = push_result();
+        m_last_result_instruction = emit(CompiledOpcode::global_get, result, 0, 0, m_module.globals()[index].value());
+        return true;
+    }
+    case Instructions::global_set.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>().value();
+        if (index >= m_module.globals().size())
+            return false;
+        auto value = pop_operand();
+        emit(CompiledOpcode::global_set, 0, value, 0, m_module.globals()[index].value());
+        return true;
+    }
+    case Instructions::memory_size.value(): {
+        if (m_module.memories().is_empty())
+            return false;
+        auto result = push_result();
+        m_last_result_instruction = emit(CompiledOpcode::memory_size, result);
+        return true;
+    }
+    case Instructions::memory_grow.value():
+        if (m_module.memories().is_empty())
+            return false;
+        emit_unary(CompiledOpcode::memory_grow);
+        return true;
+    case Instructions::i32_const.value():
+        push_constant(static_cast<u32>(instruction.arguments().get<i32>()));
+        return true;
+    case Instructions::i64_const.value():
+        push_constant(bit_cast<u64>(instruction.arguments().get<i64>()));
+        return true;
+    case Instructions::f32_const.value():
+        push_constant(bit_cast<u32>(instruction.arguments().get<float>()));
+        return true;
+    case Instructions::f64_const.value():
+        push_constant(bit_cast<u64>(instruction.arguments().get<double>()));
+        return true;
+    case Instructions::ref_null.value():
+        push_constant(CompiledFunction::null_reference);
+        return true;
+    case Instructions::ref_func.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_module.functions().size())
+            return false;
+        push_constant(m_module.functions()[index].value());
+        return true;
+    }
+    case Instructions::ref_is_null.value():
+        emit_unary(CompiledOpcode::ref_is_null);
+        return true;
+#define M(name, ...)                              \
+    case Instructions::name.value():              \
+        emit_unary(CompiledOpcode::name);         \
+        return true;
+        ENUMERATE_COMPILED_WASM_UNARY_OPERATIONS(M)
+#undef M
+#define M(name, ...)                              \
+    case Instructions::name.value():              \
+        emit_binary(CompiledOpcode::name);        \
+        return true;
+        ENUMERATE_COMPILED_WASM_BINARY_OPERATIONS(M)
+#undef M
+#define M(name, ...)                 \
+    case Instructions::name.value(): \
+        return emit_load(CompiledOpcode::name);
+        ENUMERATE_COMPILED_WASM_LOAD_OPERATIONS(M)
+#undef M
+#define M(name, ...)                 \
+    case Instructions::name.value(): \
+        return emit_store(CompiledOpcode::name);
+        ENUMERATE_COMPILED_WASM_STORE_OPERATIONS(M)
+#undef M
+    default:
+        dbgln_if(WASM_TRACE_DEBUG, "Not compiling function with unsupported instruction {}", instruction_name(opcode));
+        return false;
+    }
+}
+
+RefPtr<CompiledFunction> FunctionCompiler::compile()
+{
+    auto& type = m_function.type();
+    auto& locals = m_function.code().locals();
+    m_compiled->m_parameter_count = type.parameters().size();
+    m_compiled->m_result_count = type.results().size();
+    m_local_count = type.parameters().size() + locals.size();
+
+    ControlFrame function_frame;
+    function_frame.result_count = type.results().size();
+    m_control_stack.append(move(function_frame));
+
+    for (auto& instruction : m_function.code().body().instructions()) {
+        if (!compile_instruction(instruction))
+            return nullptr;
+    }
+
+    // The body has no explicit end; falling off of it returns.
+    if (m_control_stack.size() != 1)
+        return nullptr;
+    if (m_unreachable_depth == 0)
+        compile_return();
+
+    // Now that the number of constants is known, resolve the operands to their final slots.
+    auto constants_start = m_local_count;
+    auto stack_start = constants_start + m_constants.size();
+    auto resolve = [&](u32& operand) {
+        if (operand & stack_slot_tag)
+            operand = stack_start + (operand & ~slot_tag_mask);
+        else if (operand & constant_slot_tag)
+            operand = constants_start + (operand & ~slot_tag_mask);
+    };
+    for (auto& instruction : m_compiled->m_instructions) {
+        resolve(instruction.a);
+        resolve(instruction.b);
+        resolve(instruction.c);
+    }
+
+    auto& frame_template = m_compiled->m_frame_template;
+    frame_template.ensure_capacity(locals.size() + m_constants.size());
+    for (auto& local : locals)
+        frame_template.unchecked_append(local.is_reference() ? CompiledFunction::null_reference : 0);
+    frame_template.extend(m_constants);
+    m_compiled->m_frame_size = max(stack_start + m_max_stack_height, m_local_count);
+
+    dbgln_if(WASM_TRACE_DEBUG, "Compiled function with {} instructions into {}, frame size {}", m_function.code().body().instructions().size(), m_compiled->m_instructions.size(), m_compiled->m_frame_size);
+    return m_compiled;
+}
+
+RefPtr<CompiledFunction> CompiledFunction::try_create(Store& store, WasmFunction const& function)
+{
+    FunctionCompiler compiler { store, function };
+    return compiler.compile();
+}
+
+}
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
+#include <LibWasm/AbstractMachine/Configuration.h>
+#include <LibWasm/AbstractMachine/Operators.h>
+
+namespace Wasm {
+
+template<typename T>
+ALWAYS_INLINE static T from_slot(u64 slot)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<float>(static_cast<u32>(slot));
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<double>(slot);
+    else
+        return static_cast<T>(slot);
+}
+
+template<typename T>
+ALWAYS_INLINE static u64 to_slot(T value)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<u32>(value);
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<u64>(value);
+    else
+        return static_cast<MakeUnsigned<T>>(value);
+}
+
+static u64 value_to_slot(Value const& value)
+{
+    return value.value().visit(
+        [](i32 value) { return to_slot(value); },
+        [](i64 value) { return to_slot(value); },
+        [](float value) { return to_slot(value); },
+        [](double value) { return to_slot(value); },
+        [](Reference const& reference) {
+            return reference.ref().visit(
+                [](Reference::Null const&) { return CompiledFunction::null_reference; },
+                [](Reference::Func const& func) { return func.address.value(); },
+                [](Reference::Extern const& extern_) { return extern_.address.value(); });
+        });
+}
+
+static Value slot_to_value(u64 slot, ValueType type)
+{
+    switch (type.kind()) {
+    case ValueType::I32:
+        return Value(from_slot<i32>(slot));
+    case ValueType::I64:
+        return Value(from_slot<i64>(slot));
+    case ValueType::F32:
+        return Value(from_slot<float>(slot));
+    case ValueType::F64:
+        return Value(from_slot<double>(slot));
+    case ValueType::FunctionReference:
+    case ValueType::NullFunctionReference:
+        if (slot == CompiledFunction::null_reference)
+            return Value(Reference { Reference::Null { ValueType(ValueType::FunctionReference) } });
+        return Value(Reference { Reference::Func { FunctionAddress { slot } } });
+    case ValueType::ExternReference:
+    case ValueType::NullExternReference:
+        if (slot == CompiledFunction::null_reference)
+            return Value(Reference { Reference::Null { ValueType(ValueType::ExternReference) } });
+        return Value(Reference { Reference::Extern { ExternAddress { slot } } });
+    }
+    VERIFY_NOT_REACHED();
+}
+
+template<typename T>
+using RawMemoryType = Conditional<sizeof(T) == 1, u8, Conditional<sizeof(T) == 2, u16, Conditional<sizeof(T) == 4, u32, u64>>>;
+
+template<typename T>
+ALWAYS_INLINE static T read_from_memory(u8 const* data)
+{
+    RawMemoryType<T> raw;
+    __builtin_memcpy(&raw, data, sizeof(raw));
+    return bit_cast<T>(AK::convert_between_host_and_little_endian(raw));
+}
+
+template<typename T>
+ALWAYS_INLINE static void write_to_memory(u8* data, T value)
+{
+    auto raw = AK::convert_between_host_and_little_endian(bit_cast<RawMemoryType<T>>(value));
+    __builtin_memcpy(data, &raw, sizeof(raw));
+}
+
+// Stores the result of an operator, or traps if the operator failed.
+template<typename PushType, typename T>
+ALWAYS_INLINE static bool store_result(u64& slot, T result, Optional<Trap>& trap)
+{
+    if constexpr (IsSpecializationOf<T, AK::Result>) {
+        if (result.is_error()) {
+            trap = Trap { result.error() };
+            return false;
+        }
+        slot = to_slot<PushType>(result.release_value());
+    } else {
+        slot = to_slot<PushType>(result);
+    }
+    return true;
+}
+
+static bool function_types_match(FunctionType const& a, FunctionType const& b)
+{
+    return a.parameters() == b.parameters() && a.results() == b.results();
+}
+
+Optional<Result> BytecodeInterpreter::try_call_compiled(Configuration& configuration, WasmFunction& function, Vector<Value>& arguments)
+{
+    if (!m_compiled_execution_enabled)
+        return {};
+    auto* compiled_function = function.compiled_function(configuration.store());
+    if (!compiled_function)
+        return {};
+
+    m_trap.clear();
+    auto& registers = configuration.registers();
+    auto base = configuration.register_stack_top();
+    if (registers.try_resize(max(registers.size(), base + compiled_function->frame_size())).is_error())
+        return Result { Trap { "Not enough memory for the call frame" } };
+    for (size_t i = 0; i < arguments.size(); ++i)
+        registers[base + i] = value_to_slot(arguments[i]);
+
+    auto succeeded = execute_compiled(configuration, *compiled_function, base);
+    configuration.register_stack_top() = base;
+    if (!succeeded)
+        return Result { Trap { m_trap->reason } };
+
+    Vector<Value> results;
+    results.ensure_capacity(compiled_function->result_count());
+    for (size_t i = 0; i < compiled_function->result_count(); ++i)
+        results.unchecked_append(slot_to_value(configuration.registers()[base + i], function.type().results()[i]));
+    return Result { move(results) };
+}
+
+bool BytecodeInterpreter::call_from_compiled(Configuration& configuration, FunctionAddress address, size_t arguments_base)
+{
+    auto* instance = configuration.store().get(address);
+    if (!instance) {
+        m_trap = Trap { "Call to a nonexistent function" };
+        return false;
+    }
+
+    if (auto* wasm_function = instance->get_pointer<WasmFunction>()) {
+        if (auto* compiled_function = wasm_function->compiled_function(configuration.store()))
+            return execute_compiled(configuration, *compiled_function, arguments_base);
+    }
+
+    // Host functions and functions that couldn't be compiled take the regular path, with values boxed as usual.
+    FunctionType const* type { nullptr };
+    instance->visit([&](auto const& function) { type = &function.type(); });
+    Vector<Value> arguments;
+    arguments.ensure_capacity(type->parameters().size());
+    for (size_t i = 0; i < type->parameters().size(); ++i)
+        arguments.unchecked_append(slot_to_value(configuration.registers()[arguments_base + i], type->parameters()[i]));
+
+    Result result { Trap { ""sv } };
+    {
+        CallFrameHandle handle { *this, configuration };
+        result = configuration.call(*this, address, move(arguments));
+    }
+    if (result.is_trap()) {
+        m_trap = move(result.trap());
+        return false;
+    }
+
+    for (size_t i = 0; i < result.values().size(); ++i)
+        configuration.registers()[arguments_base + i] = value_to_slot(result.values()[i]);
+    return true;
+}
+
+bool BytecodeInterpreter::execute_compiled(Configuration& configuration, CompiledFunction const& function, size_t base)
+{
+    if (m_stack_info.size_free() < Constants::minimum_stack_space_to_keep_free) {
+        m_trap = Trap { "Call stack exhausted" };
+        return false;
+    }
+
+    auto& registers = configuration.registers();
+    auto frame_end = base + function.frame_size();
+    if (registers.size() < frame_end && registers.try_resize(frame_end).is_error()) {
+        m_trap = Trap { "Not enough memory for the call frame" };
+        return false;
+    }
+    auto saved_register_stack_top = configuration.register_stack_top();
+    configuration.register_stack_top() = frame_end;
+
+    u64* slots = registers.data() + base;
+    auto& frame_template = function.frame_template();
+    if (!frame_template.is_empty())
+        __builtin_memcpy(slots + function.parameter_count(), frame_template.data(), frame_template.size() * sizeof(u64));
+
+    // Memory can move when it grows, which may also happen inside any call.
+    MemoryInstance* memory = nullptr;
+    u8* memory_data = nullptr;
+    u64 memory_size = 0;
+    auto reload_memory = [&] {
+        if (function.module().memories().is_empty())
+            return;
+        memory = configuration.store().get(function.module().memories().first());
+        memory_data = memory->data().data();
+        memory_size = memory->size();
+    };
+    reload_memory();
+
+    auto const should_limit_instruction_count = configuration.should_limit_instruction_count();
+    u64 executed_branches = 0;
+
+    static void* const handlers[] = {
+#define M(name, ...) &&handle_##name,
+        ENUMERATE_COMPILED_WASM_CONTROL_OPERATIONS(M)
+        ENUMERATE_COMPILED_WASM_UNARY_OPERATIONS(M)
+        ENUMERATE_COMPILED_WASM_BINARY_OPERATIONS(M)
+        ENUMERATE_COMPILED_WASM_LOAD_OPERATIONS(M)
+        ENUMERATE_COMPILED_WASM_STORE_OPERATIONS(M)
+#undef M
+#define M(name, ...) &&handle_jump_if_##name,
+        ENUMERATE_COMPILED_WASM_FUSED_COMPARISONS(M)
+#undef M
+    };
+
+    auto const* instructions = function.instructions().data();
+    auto const* instruction = instructions;
+
+#define DISPATCH() goto* handlers[to_underlying(instruction->opcode)]
+
+#define NEXT()         \
+    do {               \
+        ++instruction; \
+        DISPATCH();    \
+    } while (false)
+
+    // Only taken branches and calls are counted against the instruction limit, which bounds every loop all the same.
+#define JUMP(target)                                                                            \
+    do {                                                                                        \
+        if (should_limit_instruction_count) [[unlikely]] {                                      \
+            if (++executed_branches >= Constants::max_allowed_executed_instructions_per_call) { \
+                m_trap = Trap { "Exceeded maximum allowed number of instructions" };            \
+                return false;                                                                   \
+            }                                                                                   \
+        }                                                                                       \
+        instruction = instructions + (target);                                                  \
+        DISPATCH();                                                                             \
+    } while (false)
+
+#define TRAP(reason)                                                        \
+    do {                                                                    \
+        m_trap = Trap { reason };                                           \
+        dbgln_if(WASM_TRACE_DEBUG, "Trapped in compiled code: {}", reason); \
+        return false;                                                       \
+    } while (false)
+
+#define CALL(address, arguments_base)                                             \
+    do {                                                                          \
+        if (!call_from_compiled(configuration, address, base + (arguments_base))) \
+            return false;                                                         \
+        slots = configuration.registers().data() + base;                          \
+        reload_memory();                                                          \
+    } while (false)
+
+    DISPATCH();
+
+handle_copy:
+    slots[instruction->a] = slots[instruction->b];
+    NEXT();
+
+handle_select:
+    if (from_slot<u32>(slots[instruction->c]) == 0)
+        slots[instruction->a] = slots[instruction->b];
+    NEXT();
+
+handle_jump:
+    JUMP(instruction->immediate);
+
+handle_jump_if_zero:
+    if (from_slot<u32>(slots[instruction->b]) == 0)
+        JUMP(instruction->immediate);
+    NEXT();
+
+handle_jump_if_not_zero:
+    if (from_slot<u32>(slots[instruction->b]) != 0)
+        JUMP(instruction->immediate);
+    NEXT();
+
+#define M(name, type, operator_, inverse)                                                        \
+    handle_jump_if_##name:                                                                       \
+    if (from_slot<type>(slots[instruction->b]) operator_ from_slot<type>(slots[instruction->c])) \
+        JUMP(instruction->immediate);                                                            \
+    NEXT();
+    ENUMERATE_COMPILED_WASM_FUSED_COMPARISONS(M)
+#undef M
+
+handle_br_table : {
+    auto index = from_slot<u32>(slots[instruction->b]);
+    auto target_count = static_cast<u32>(instruction->immediate);
+    auto first_target = instruction->immediate >> 32;
+    JUMP(function.branch_table_targets()[first_target + min(index, target_count)]);
+}
+
+handle_call:
+    CALL(FunctionAddress { instruction->immediate }, instruction->a);
+    JUMP(instruction - instructions + 1);
+
+handle_call_indirect : {
+    auto* table = configuration.store().get(TableAddress { instruction->immediate });
+    auto index = from_slot<u32>(slots[instruction->b]);
+    if (!table || index >= table->elements().size())
+        TRAP("Indirect call index out of bounds"sv);
+    auto& element = table->elements()[index];
+    if (!element.has_value() || !element->ref().has<Reference::Func>())
+        TRAP("Indirect call to a null or non-function reference"sv);
+    auto address = element->ref().get<Reference::Func>().address;
+    auto* callee = configuration.store().get(address);
+    if (!callee)
+        TRAP("Indirect call to a nonexistent function"sv);
+    FunctionType const* type { nullptr };
+    callee->visit([&](auto const& function) { type = &function.type(); });
+    if (!function_types_match(*type, function.module().types()[instruction->c]))
+        TRAP("Indirect call type mismatch"sv);
+    CALL(address, instruction->a);
+    JUMP(instruction - instructions + 1);
+}
+
+handle_return_:
+    configuration.register_stack_top() = saved_register_stack_top;
+    return true;
+
+handle_return_value:
+    slots[0] = slots[instruction->b];
+    configuration.register_stack_top() = saved_register_stack_top;
+    return true;
+
+handle_return_values:
+    __builtin_memmove(slots, slots + instruction->a, instruction->c * sizeof(u64));
+    configuration.register_stack_top() = saved_register_stack_top;
+    return true;
+
+handle_unreachable:
+    TRAP("Unreachable"sv);
+
+handle_global_get:
+    slots[instruction->a] = value_to_slot(configuration.store().get(GlobalAddress { instruction->immediate })->value());
+    NEXT();
+
+handle_global_set : {
+    auto* global = configuration.store().get(GlobalAddress { instruction->immediate });
+    global->set_value(slot_to_value(slots[instruction->b], global->value().type()));
+    NEXT();
+}
+
+handle_memory_size:
+    slots[instruction->a] = to_slot(static_cast<i32>(memory_size / Constants::page_size));
+    NEXT();
+
+handle_memory_grow : {
+    auto old_pages = static_cast<i32>(memory_size / Constants::page_size);
+    auto pages_to_grow = from_slot<u32>(slots[instruction->b]);
+    auto grew = memory->grow(static_cast<u64>(pages_to_grow) * Constants::page_size);
+    reload_memory();
+    slots[instruction->a] = to_slot(grew ? old_pages : -1);
+    NEXT();
+}
+
+handle_ref_is_null:
+    slots[instruction->a] = slots[instruction->b] == CompiledFunction::null_reference ? 1 : 0;
+    NEXT();
+
+#define M(name, PopType, PushType, Operator)                                                                            \
+    handle_##name:                                                                                                      \
+    if (!store_result<PushType>(slots[instruction->a], Operator {}(from_slot<PopType>(slots[instruction->b])), m_trap)) \
+        return false;                                                                                                   \
+    NEXT();
+    ENUMERATE_COMPILED_WASM_UNARY_OPERATIONS(M)
+#undef M
+
+#define M(name, PopType, PushType, Operator)                                                                                                                       \
+    handle_##name:                                                                                                                                                 \
+    if (!store_result<PushType>(slots[instruction->a], Operator {}(from_slot<PopType>(slots[instruction->b]), from_slot<PopType>(slots[instruction->c])), m_trap)) \
+        return false;                                                                                                                                              \
+    NEXT();
+    ENUMERATE_COMPILED_WASM_BINARY_OPERATIONS(M)
+#undef M
+
+#define M(name, MemoryType, PushType)                                                                    \
+    handle_##name : {                                                                                    \
+        auto address = static_cast<u64>(from_slot<u32>(slots[instruction->b])) + instruction->immediate; \
+        if (address + sizeof(MemoryType) > memory_size)                                                  \
+            TRAP("Memory access out of bounds"sv);                                                       \
+        slots[instruction->a] = to_slot<PushType>(read_from_memory<MemoryType>(memory_data + address));  \
+        NEXT();                                                                                          \
+    }
+    ENUMERATE_COMPILED_WASM_LOAD_OPERATIONS(M)
+#undef M
+
+#define M(name, PopType, MemoryType)                                                                                \
+    handle_##name : {                                                                                               \
+        auto address = static_cast<u64>(from_slot<u32>(slots[instruction->b])) + instruction->immediate;            \
+        if (address + sizeof(MemoryType) > memory_size)                                                             \
+            TRAP("Memory access out of bounds"sv);                                                                  \
+        write_to_memory(memory_data + address, static_cast<MemoryType>(from_slot<PopType>(slots[instruction->c]))); \
+        NEXT();                                                                                                     \
+    }
+    ENUMERATE_COMPILED_WASM_STORE_OPERATIONS(M)
+#undef M
+
+#undef CALL
+#undef TRAP
+#undef JUMP
+#undef NEXT
+#undef DISPATCH
+}
+
+}
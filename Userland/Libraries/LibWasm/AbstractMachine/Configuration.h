@@ -43,6 +43,10 @@ public:
     ALWAYS_INLINE auto& store() const { return m_store; }
     ALWAYS_INLINE auto& store() { return m_store; }
 
+    // Value slots for the frames of compiled functions, see CompiledFunction.
+    ALWAYS_INLINE auto& registers() { return m_registers; }
+    ALWAYS_INLINE auto& register_stack_top() { return m_register_stack_top; }
+
     struct CallFrameHandle {
         explicit CallFrameHandle(Configuration& configuration)
             : frame_index(configuration.m_current_frame_index)
@@ -80,6 +84,8 @@ private:
     size_t m_depth { 0 };
     InstructionPointer m_ip;
     bool m_should_limit_instruction_count { false };
+    Vector<u64> m_registers;
+    size_t m_register_stack_top { 0 };
 };
 
 }
@@ -16,6 +16,9 @@ struct Interpreter {
     virtual bool did_trap() const = 0;
     virtual String trap_reason() const = 0;
     virtual void clear_trap() = 0;
+
+    // Runs the function on a faster path than interpret() if the interpreter has one for it.
+    virtual Optional<Result> try_call_compiled(Configuration&, WasmFunction&, Vector<Value>&) { return {}; }
 };
 
 }
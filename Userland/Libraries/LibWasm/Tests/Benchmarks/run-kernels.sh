@@ -0,0 +1,22 @@
+#!/bin/sh
+
+# Runs the kernels in Fixtures/Kernels through the wasm utility, once with the
+# register-based executor and once with the plain stack interpreter.
+# Usage: run-kernels.sh [path to wasm utility]
+
+WASM="${1:-wasm}"
+KERNELS="$(dirname "$0")/../Fixtures/Kernels"
+
+run_kernel() {
+    kernel="$1"
+    argument="$2"
+    iterations="$3"
+    echo "== $kernel($argument)"
+    "$WASM" "$KERNELS/$kernel.wasm" -e "$kernel" --arg "$argument" -b "$iterations"
+    "$WASM" "$KERNELS/$kernel.wasm" -e "$kernel" --arg "$argument" -b "$iterations" --no-compile
+}
+
+run_kernel fib 25 10
+run_kernel sieve 1000000 5
+run_kernel matmul 60 10
+run_kernel crc32 200000 10
@@ -0,0 +1,31 @@
+function loadKernel(name) {
+    const content = readBinaryWasmFile(`Fixtures/Kernels/${name}.wasm`);
+    return parseWebAssemblyModule(content);
+}
+
+test("fib", () => {
+    const module = loadKernel("fib");
+    const fib = module.getExport("fib");
+    expect(module.invoke(fib, 0)).toBe(0);
+    expect(module.invoke(fib, 1)).toBe(1);
+    expect(module.invoke(fib, 20)).toBe(6765);
+});
+
+test("sieve", () => {
+    const module = loadKernel("sieve");
+    const sieve = module.getExport("sieve");
+    expect(module.invoke(sieve, 100)).toBe(25);
+    expect(module.invoke(sieve, 100000)).toBe(9592);
+});
+
+test("matmul", () => {
+    const module = loadKernel("matmul");
+    const matmul = module.getExport("matmul");
+    expect(module.invoke(matmul, 20)).toBe(266000);
+});
+
+test("crc32", () => {
+    const module = loadKernel("crc32");
+    const crc32 = module.getExport("crc32");
+    expect(module.invoke(crc32, 10000)).toBe(-1889975008);
+});
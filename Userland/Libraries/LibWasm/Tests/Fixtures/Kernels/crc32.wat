@@ -0,0 +1,127 @@
+;; Table-driven CRC-32 over $length pseudo-random bytes, returns the checksum.
+(module
+  (memory 16)
+  (global $seed (mut i32) (i32.const 12345))
+  (func $next_byte (result i32)
+    global.get $seed
+    i32.const 1103515245
+    i32.mul
+    i32.const 12345
+    i32.add
+    global.set $seed
+    global.get $seed
+    i32.const 16
+    i32.shr_u
+    i32.const 255
+    i32.and
+  )
+  (func $build_table
+    (local $n i32) (local $c i32) (local $k i32)
+    block $done
+      loop $entries
+        local.get $n
+        i32.const 256
+        i32.eq
+        br_if $done
+        local.get $n
+        local.set $c
+        i32.const 0
+        local.set $k
+        block $bits_done
+          loop $bits
+            local.get $k
+            i32.const 8
+            i32.eq
+            br_if $bits_done
+            i32.const 0xedb88320
+            local.get $c
+            i32.const 1
+            i32.shr_u
+            i32.xor
+            local.get $c
+            i32.const 1
+            i32.shr_u
+            local.get $c
+            i32.const 1
+            i32.and
+            select
+            local.set $c
+            local.get $k
+            i32.const 1
+            i32.add
+            local.set $k
+            br $bits
+          end
+        end
+        local.get $n
+        i32.const 2
+        i32.shl
+        local.get $c
+        i32.store
+        local.get $n
+        i32.const 1
+        i32.add
+        local.set $n
+        br $entries
+      end
+    end
+  )
+  (func $crc32 (export "crc32") (param $length i32) (result i32)
+    (local $i i32) (local $crc i32)
+    call $build_table
+    i32.const 12345
+    global.set $seed
+    i32.const 0
+    local.set $i
+    block $filled
+      loop $fill
+        local.get $i
+        local.get $length
+        i32.ge_u
+        br_if $filled
+        local.get $i
+        call $next_byte
+        i32.store8 offset=1024
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $fill
+      end
+    end
+    i32.const -1
+    local.set $crc
+    i32.const 0
+    local.set $i
+    block $done
+      loop $bytes
+        local.get $i
+        local.get $length
+        i32.ge_u
+        br_if $done
+        local.get $crc
+        local.get $i
+        i32.load8_u offset=1024
+        i32.xor
+        i32.const 255
+        i32.and
+        i32.const 2
+        i32.shl
+        i32.load
+        local.get $crc
+        i32.const 8
+        i32.shr_u
+        i32.xor
+        local.set $crc
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $bytes
+      end
+    end
+    local.get $crc
+    i32.const -1
+    i32.xor
+  )
+)
@@ -0,0 +1,21 @@
+;; Naive recursive fibonacci, mostly measures the cost of calls.
+(module
+  (func $fib (export "fib") (param $n i32) (result i32)
+    local.get $n
+    i32.const 2
+    i32.lt_u
+    if
+      local.get $n
+      return
+    end
+    local.get $n
+    i32.const 1
+    i32.sub
+    call $fib
+    local.get $n
+    i32.const 2
+    i32.sub
+    call $fib
+    i32.add
+  )
+)
@@ -0,0 +1,159 @@
+;; Multiplies two $n x $n matrices of doubles and returns the sum of the product's elements.
+(module
+  (memory 16)
+  (func $element_address (param $base i32) (param $n i32) (param $row i32) (param $column i32) (result i32)
+    local.get $base
+    local.get $row
+    local.get $n
+    i32.mul
+    local.get $column
+    i32.add
+    i32.const 3
+    i32.shl
+    i32.add
+  )
+  (func $matmul (export "matmul") (param $n i32) (result f64)
+    (local $i i32) (local $j i32) (local $k i32) (local $a i32) (local $b i32) (local $c i32) (local $sum f64) (local $total f64)
+    i32.const 0
+    local.set $a
+    local.get $n
+    local.get $n
+    i32.mul
+    i32.const 3
+    i32.shl
+    local.tee $b
+    local.get $b
+    i32.add
+    local.set $c
+    ;; a[i][j] = i + j, b[i][j] = i - j
+    block $init_done
+      loop $init_rows
+        local.get $i
+        local.get $n
+        i32.ge_u
+        br_if $init_done
+        i32.const 0
+        local.set $j
+        block $row_done
+          loop $init_columns
+            local.get $j
+            local.get $n
+            i32.ge_u
+            br_if $row_done
+            local.get $a
+            local.get $n
+            local.get $i
+            local.get $j
+            call $element_address
+            local.get $i
+            local.get $j
+            i32.add
+            f64.convert_i32_s
+            f64.store
+            local.get $b
+            local.get $n
+            local.get $i
+            local.get $j
+            call $element_address
+            local.get $i
+            local.get $j
+            i32.sub
+            f64.convert_i32_s
+            f64.store
+            local.get $j
+            i32.const 1
+            i32.add
+            local.set $j
+            br $init_columns
+          end
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $init_rows
+      end
+    end
+    i32.const 0
+    local.set $i
+    block $i_done
+      loop $i_loop
+        local.get $i
+        local.get $n
+        i32.ge_u
+        br_if $i_done
+        i32.const 0
+        local.set $j
+        block $j_done
+          loop $j_loop
+            local.get $j
+            local.get $n
+            i32.ge_u
+            br_if $j_done
+            f64.const 0
+            local.set $sum
+            i32.const 0
+            local.set $k
+            block $k_done
+              loop $k_loop
+                local.get $k
+                local.get $n
+                i32.ge_u
+                br_if $k_done
+                local.get $sum
+                local.get $i
+                local.get $n
+                i32.mul
+                local.get $k
+                i32.add
+                i32.const 3
+                i32.shl
+                f64.load
+                local.get $k
+                local.get $n
+                i32.mul
+                local.get $j
+                i32.add
+                i32.const 3
+                i32.shl
+                local.get $b
+                i32.add
+                f64.load
+                f64.mul
+                f64.add
+                local.set $sum
+                local.get $k
+                i32.const 1
+                i32.add
+                local.set $k
+                br $k_loop
+              end
+            end
+            local.get $c
+            local.get $n
+            local.get $i
+            local.get $j
+            call $element_address
+            local.get $sum
+            f64.store
+            local.get $total
+            local.get $sum
+            f64.add
+            local.set $total
+            local.get $j
+            i32.const 1
+            i32.add
+            local.set $j
+            br $j_loop
+          end
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $i_loop
+      end
+    end
+    local.get $total
+  )
+)
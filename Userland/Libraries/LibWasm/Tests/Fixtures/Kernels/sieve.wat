@@ -0,0 +1,71 @@
+;; Sieve of Eratosthenes over one byte per number, returns the number of primes below $limit.
+(module
+  (memory 16)
+  (func $sieve (export "sieve") (param $limit i32) (result i32)
+    (local $i i32) (local $j i32) (local $count i32)
+    ;; Clear the flags.
+    i32.const 0
+    local.set $i
+    block $clear_done
+      loop $clear
+        local.get $i
+        local.get $limit
+        i32.ge_u
+        br_if $clear_done
+        local.get $i
+        i32.const 0
+        i32.store8
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $clear
+      end
+    end
+    i32.const 2
+    local.set $i
+    block $done
+      loop $outer
+        local.get $i
+        local.get $limit
+        i32.ge_u
+        br_if $done
+        local.get $i
+        i32.load8_u
+        i32.eqz
+        if
+          local.get $count
+          i32.const 1
+          i32.add
+          local.set $count
+          local.get $i
+          local.get $i
+          i32.add
+          local.set $j
+          block $marked
+            loop $mark
+              local.get $j
+              local.get $limit
+              i32.ge_u
+              br_if $marked
+              local.get $j
+              i32.const 1
+              i32.store8
+              local.get $j
+              local.get $i
+              i32.add
+              local.set $j
+              br $mark
+            end
+          end
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $outer
+      end
+    end
+    local.get $count
+  )
+)
@@ -46,6 +46,7 @@ public:
             return *it->value;
         auto* prototype = heap().allocate<T>(*this, *this);
         m_prototypes.set(class_name, prototype);
+        JS::Heap::write_barrier(prototype);
         return *prototype;
     }
 
@@ -57,6 +58,7 @@ public:
             return *it->value;
         auto* constructor = heap().allocate<T>(*this, *this);
         m_constructors.set(class_name, constructor);
+        JS::Heap::write_barrier(constructor);
         define_direct_property(class_name, JS::Value(constructor), JS::Attribute::Writable | JS::Attribute::Configurable);
         return *constructor;
     }
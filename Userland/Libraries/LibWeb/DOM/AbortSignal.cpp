@@ -51,6 +51,7 @@ void AbortSignal::signal_abort(JS::Value reason)
         m_abort_reason = reason;
     else
         m_abort_reason = wrap(wrapper()->global_object(), AbortError::create("Aborted without reason"));
+    JS::Heap::write_barrier(m_abort_reason);
 
     // 3. For each algorithm in signal’s abort algorithms: run algorithm.
     for (auto& algorithm : m_abort_algorithms)
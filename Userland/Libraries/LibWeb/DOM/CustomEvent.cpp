@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibJS/Heap/Heap.h>
 #include <LibWeb/DOM/CustomEvent.h>
 
 namespace Web::DOM {
@@ -25,6 +26,7 @@ void CustomEvent::init_custom_event(String const& type, bool bubbles, bool cance
 
     // 3. Set this’s detail attribute to detail.
     m_detail = detail;
+    JS::Heap::write_barrier(detail);
 }
 
 }
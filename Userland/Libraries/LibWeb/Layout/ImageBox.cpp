@@ -91,11 +91,34 @@ void ImageBox::paint(PaintContext& context, PaintPhase phase)
                 alt = image_element.src();
             context.painter().draw_text(enclosing_int_rect(absolute_rect()), alt, Gfx::TextAlignment::Center, computed_values().color(), Gfx::TextElision::Right);
         } else if (auto bitmap = m_image_loader.bitmap(m_image_loader.current_frame_index())) {
-            context.painter().draw_scaled_bitmap(rounded_int_rect(absolute_rect()), *bitmap, bitmap->rect(), 1.0f, Gfx::Painter::ScalingMode::BilinearBlend);
+            auto image_rect = rounded_int_rect(absolute_rect());
+            // Bilinear blending only looks at the four nearest pixels, which makes images alias when they are scaled down.
+            if (image_rect.width() < bitmap->width() || image_rect.height() < bitmap->height()) {
+                if (auto* scaled_down_bitmap = this->scaled_down_bitmap(*bitmap, image_rect.size(), context.painter().target()->scale())) {
+                    context.painter().blit(image_rect.location(), *scaled_down_bitmap, scaled_down_bitmap->rect());
+                    return;
+                }
+            }
+            context.painter().draw_scaled_bitmap(image_rect, *bitmap, bitmap->rect(), 1.0f, Gfx::Painter::ScalingMode::BilinearBlend);
         }
     }
 }
 
+Gfx::Bitmap const* ImageBox::scaled_down_bitmap(Gfx::Bitmap const& source, Gfx::IntSize const& size, int scale)
+{
+    if (m_scaled_down_source == &source && m_scaled_down_bitmap->size() == size && m_scaled_down_bitmap->scale() == scale)
+        return m_scaled_down_bitmap;
+
+    auto bitmap_or_error = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, size, scale);
+    if (bitmap_or_error.is_error())
+        return nullptr;
+    m_scaled_down_bitmap = bitmap_or_error.release_value();
+    m_scaled_down_source = source;
+    Gfx::Painter painter(*m_scaled_down_bitmap);
+    painter.draw_scaled_bitmap(m_scaled_down_bitmap->rect(), source, source.rect(), 1.0f, Gfx::Painter::ScalingMode::BoxSampling);
+    return m_scaled_down_bitmap;
+}
+
 bool ImageBox::renders_as_alt_text() const
 {
     if (is<HTML::HTMLImageElement>(dom_node()))
@@ -33,7 +33,13 @@ private:
     int preferred_width() const;
     int preferred_height() const;
 
+    Gfx::Bitmap const* scaled_down_bitmap(Gfx::Bitmap const&, Gfx::IntSize const&, int scale);
+
     const ImageLoader& m_image_loader;
+
+    // Box sampling is too slow to redo on every paint, so the last scaled down image is kept around.
+    RefPtr<Gfx::Bitmap const> m_scaled_down_source;
+    RefPtr<Gfx::Bitmap> m_scaled_down_bitmap;
 };
 
 }
@@ -179,7 +179,8 @@ bool FrameLoader::load(LoadRequest& request, Type type)
                 if (data.is_empty())
                     return;
                 RefPtr<Gfx::Bitmap> favicon_bitmap;
-                auto decoded_image = image_decoder_client().decode_image(data);
+                // Favicons are only ever shown at 16x16.
+                auto decoded_image = image_decoder_client().decode_image(data, { 16, 16 });
                 if (!decoded_image.has_value() || decoded_image->frames.is_empty()) {
                     dbgln("Could not decode favicon {}", favicon_url);
                 } else {
@@ -38,6 +38,7 @@ void WebAssemblyInstanceObject::initialize(JS::GlobalObject& global_object)
                 if (!object.has_value()) {
                     object = create_native_function(global_object, address, export_.name());
                     cache.function_instances.set(address, *object);
+                    JS::Heap::write_barrier(*object);
                 }
                 m_exports_object->define_direct_property(export_.name(), *object, JS::default_attributes);
             },
@@ -46,6 +47,7 @@ void WebAssemblyInstanceObject::initialize(JS::GlobalObject& global_object)
                 if (!object.has_value()) {
                     object = heap().allocate<Web::Bindings::WebAssemblyMemoryObject>(global_object, global_object, address);
                     cache.memory_instances.set(address, *object);
+                    JS::Heap::write_barrier(*object);
                 }
                 m_exports_object->define_direct_property(export_.name(), *object, JS::default_attributes);
             },
@@ -474,6 +474,7 @@ JS::NativeFunction* create_native_function(JS::GlobalObject& global_object, Wasm
         });
 
     WebAssemblyObject::s_global_cache.function_instances.set(address, function);
+    JS::Heap::write_barrier(function);
     return function;
 }
 
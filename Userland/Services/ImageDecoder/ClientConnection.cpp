@@ -9,9 +9,18 @@
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageDecoder.h>
+#include <unistd.h>
 
 namespace ImageDecoder {
 
+static constexpr size_t max_decoding_thread_count = 4;
+
+static size_t decoding_thread_count()
+{
+    auto online_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return clamp(online_processors > 0 ? static_cast<size_t>(online_processors) : 1, 1, max_decoding_thread_count);
+}
+
 ClientConnection::ClientConnection(NonnullOwnPtr<Core::Stream::LocalSocket> socket)
     : IPC::ClientConnection<ImageDecoderClientEndpoint, ImageDecoderServerEndpoint>(*this, move(socket), 1)
 {
@@ -26,7 +35,7 @@ void ClientConnection::die()
     Core::EventLoop::current().quit(0);
 }
 
-Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image(Core::AnonymousBuffer const& encoded_buffer)
+Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image(Core::AnonymousBuffer const& encoded_buffer, Gfx::IntSize const& target_size)
 {
     if (!encoded_buffer.is_valid()) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
@@ -40,6 +49,9 @@ Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image
         return { false, 0, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
     }
 
+    decoder->set_decoding_thread_count(decoding_thread_count());
+    decoder->set_target_size(target_size);
+
     if (!decoder->frame_count()) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode image from encoded data");
         return { false, 0, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
@@ -27,7 +27,7 @@ public:
 private:
     explicit ClientConnection(NonnullOwnPtr<Core::Stream::LocalSocket>);
 
-    virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&) override;
+    virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&, Gfx::IntSize const&) override;
 };
 
 }
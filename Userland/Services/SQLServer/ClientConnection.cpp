@@ -55,6 +55,18 @@ void ClientConnection::disconnect(int connection_id)
         dbgln("Database connection has disappeared");
 }
 
+Messages::SQLServer::CacheStatisticsResponse ClientConnection::cache_statistics(int connection_id)
+{
+    dbgln_if(SQLSERVER_DEBUG, "ClientConnection::cache_statistics(connection_id: {})", connection_id);
+    auto database_connection = DatabaseConnection::connection_for(connection_id);
+    if (!database_connection || !database_connection->database()) {
+        dbgln("Database connection has disappeared");
+        return { 0, 0, 0, 0 };
+    }
+    auto const& statistics = database_connection->database()->cache_statistics();
+    return { statistics.hits, statistics.misses, statistics.evictions, statistics.writebacks };
+}
+
 Messages::SQLServer::SqlStatementResponse ClientConnection::sql_statement(int connection_id, String const& sql)
 {
     dbgln_if(SQLSERVER_DEBUG, "ClientConnection::sql_statement(connection_id: {}, sql: '{}')", connection_id, sql);
@@ -31,6 +31,7 @@ private:
     virtual Messages::SQLServer::SqlStatementResponse sql_statement(int, String const&) override;
     virtual void statement_execute(int) override;
     virtual void disconnect(int) override;
+    virtual Messages::SQLServer::CacheStatisticsResponse cache_statistics(int) override;
 };
 
 }
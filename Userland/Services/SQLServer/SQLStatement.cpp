@@ -49,6 +49,8 @@ void SQLStatement::report_error(SQL::Result result)
 
     m_statement = nullptr;
     m_result = {};
+    m_result_rows = nullptr;
+    m_context = {};
 }
 
 void SQLStatement::execute()
@@ -69,9 +71,28 @@ void SQLStatement::execute()
 
         VERIFY(!connection()->database().is_null());
 
-        auto execution_result = m_statement->execute(connection()->database().release_nonnull());
-        if (execution_result.is_error()) {
-            report_error(execution_result.release_error());
+        if (is<SQL::AST::Select>(*m_statement)) {
+            // SELECT results are streamed: rows are only computed as the batches they belong to are sent.
+            m_context = SQL::AST::ExecutionContext { connection()->database().release_nonnull(), m_statement.ptr(), nullptr };
+            auto result_rows = static_cast<SQL::AST::Select const&>(*m_statement).create_operator(*m_context);
+            if (result_rows.is_error()) {
+                report_error(result_rows.release_error());
+                return;
+            }
+            m_result_rows = result_rows.release_value();
+        } else {
+            auto execution_result = m_statement->execute(connection()->database().release_nonnull());
+            if (execution_result.is_error()) {
+                report_error(execution_result.release_error());
+                return;
+            }
+            m_result = execution_result.release_value();
+        }
+
+        m_index = 0;
+        auto first_batch = next_batch();
+        if (first_batch.is_error()) {
+            report_error(first_batch.release_error());
             return;
         }
 
@@ -81,14 +102,13 @@ void SQLStatement::execute()
             return;
         }
 
-        m_result = execution_result.release_value();
-
-        if (should_send_result_rows()) {
+        if (should_send_result_rows() && !first_batch.value().is_empty()) {
             client_connection->async_execution_success(statement_id(), true, 0, 0, 0);
-            m_index = 0;
-            next();
+            send_batch(first_batch.release_value());
         } else {
-            client_connection->async_execution_success(statement_id(), false, 0, m_result->size(), 0);
+            client_connection->async_execution_success(statement_id(), false, 0, m_result.has_value() ? m_result->size() : 0, 0);
+            m_result_rows = nullptr;
+            m_context = {};
         }
     });
 }
@@ -105,13 +125,14 @@ SQL::ResultOr<void> SQLStatement::parse()
 
 bool SQLStatement::should_send_result_rows() const
 {
-    VERIFY(m_result.has_value());
+    if (m_result_rows)
+        return true;
 
-    if (m_result->is_empty())
-        return false;
+    VERIFY(m_result.has_value());
 
     switch (m_result->command()) {
     case SQL::SQLCommand::Describe:
+    case SQL::SQLCommand::Explain:
     case SQL::SQLCommand::Select:
         return true;
     default:
@@ -119,23 +140,62 @@ bool SQLStatement::should_send_result_rows() const
     }
 }
 
-void SQLStatement::next()
+SQL::ResultOr<Vector<Vector<String>>> SQLStatement::next_batch()
+{
+    Vector<Vector<String>> batch;
+
+    if (m_result_rows) {
+        while (batch.size() < max_rows_per_batch) {
+            auto row = TRY(m_result_rows->next(*m_context));
+            if (!row.has_value())
+                break;
+            batch.append(row->to_string_vector());
+        }
+        return batch;
+    }
+
+    if (!should_send_result_rows())
+        return batch;
+    for (auto ix = m_index; ix < m_result->size() && batch.size() < max_rows_per_batch; ++ix)
+        batch.append(m_result->at(ix).row.to_string_vector());
+    return batch;
+}
+
+void SQLStatement::send_batch(Vector<Vector<String>> batch)
 {
-    VERIFY(!m_result->is_empty());
     auto client_connection = ClientConnection::client_connection_for(connection()->client_id());
     if (!client_connection) {
         warnln("Cannot yield next result. Client disconnected");
         return;
     }
-    if (m_index < m_result->size()) {
-        auto& tuple = m_result->at(m_index++).row;
-        client_connection->async_next_result(statement_id(), tuple.to_string_vector());
+
+    auto batch_size = batch.size();
+    if (batch_size > 0) {
+        m_index += batch_size;
+        client_connection->async_next_results(statement_id(), move(batch));
+    }
+
+    // A partial batch means there are no more rows to compute.
+    if (batch_size == max_rows_per_batch) {
         deferred_invoke([this]() {
             next();
         });
-    } else {
-        client_connection->async_results_exhausted(statement_id(), (int)m_index);
+        return;
+    }
+
+    client_connection->async_results_exhausted(statement_id(), (int)m_index);
+    m_result_rows = nullptr;
+    m_context = {};
+}
+
+void SQLStatement::next()
+{
+    auto batch = next_batch();
+    if (batch.is_error()) {
+        report_error(batch.release_error());
+        return;
     }
+    send_batch(batch.release_value());
 }
 
 }
@@ -7,9 +7,11 @@
 #pragma once
 
 #include <AK/NonnullRefPtr.h>
+#include <AK/OwnPtr.h>
 #include <AK/String.h>
 #include <LibCore/Object.h>
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Operator.h>
 #include <LibSQL/Result.h>
 #include <LibSQL/ResultSet.h>
 #include <SQLServer/DatabaseConnection.h>
@@ -31,8 +33,13 @@ public:
 
 private:
     SQLStatement(DatabaseConnection&, String sql);
+    // Rows are sent to the client in batches of this size, each one computed only once the previous one is sent.
+    static constexpr size_t max_rows_per_batch = 64;
+
     SQL::ResultOr<void> parse();
     bool should_send_result_rows() const;
+    SQL::ResultOr<Vector<Vector<String>>> next_batch();
+    void send_batch(Vector<Vector<String>>);
     void next();
     void report_error(SQL::Result);
 
@@ -41,6 +48,8 @@ private:
     size_t m_index { 0 };
     RefPtr<SQL::AST::Statement> m_statement { nullptr };
     Optional<SQL::ResultSet> m_result {};
+    Optional<SQL::AST::ExecutionContext> m_context {};
+    OwnPtr<SQL::AST::Operator> m_result_rows {};
 };
 
 }
@@ -39,6 +39,7 @@ public:
 
 private:
     virtual void visit_edges(Visitor&) override;
+    virtual bool may_interfere_with_property_lookup_caches() const override { return true; }
 
     // Because $0 is not a nice C++ function name
     JS_DECLARE_NATIVE_FUNCTION(inspected_node_getter);
@@ -8,16 +8,15 @@
 #include <AK/Base64.h>
 #include <AK/Debug.h>
 #include <AK/LexicalPath.h>
-#include <AK/MemoryStream.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <AK/URL.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/MimeData.h>
+#include <LibCore/System.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
@@ -28,68 +27,102 @@
 
 namespace WebServer {
 
-Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket, Core::Object* parent)
+// How long an idle keep-alive connection is kept open, waiting for the next request.
+static constexpr int keep_alive_timeout_ms = 10000;
+
+Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket, int socket_fd, Core::Object* parent)
     : Core::Object(parent)
     , m_socket(move(socket))
+    , m_socket_fd(socket_fd)
 {
 }
 
 void Client::die()
 {
+    if (m_keep_alive_timer)
+        m_keep_alive_timer->stop();
     m_socket->close();
     deferred_invoke([this] { remove_from_parent(); });
 }
 
 void Client::start()
 {
+    m_keep_alive_timer = Core::Timer::create_single_shot(keep_alive_timeout_ms, [this] { die(); }, this);
+
     m_socket->on_ready_to_read = [this] {
-        StringBuilder builder;
+        m_keep_alive_timer->stop();
 
-        auto maybe_buffer = ByteBuffer::create_uninitialized(m_socket->buffer_size());
-        if (maybe_buffer.is_error()) {
-            warnln("Could not create buffer for client: {}", maybe_buffer.error());
+        auto maybe_did_read = read_requests();
+        if (maybe_did_read.is_error()) {
+            warnln("Failed to handle the request: {}", maybe_did_read.error());
             die();
             return;
         }
 
-        auto buffer = maybe_buffer.release_value();
-        for (;;) {
-            auto maybe_can_read = m_socket->can_read_without_blocking();
-            if (maybe_can_read.is_error()) {
-                warnln("Failed to get the blocking status for the socket: {}", maybe_can_read.error());
-                die();
-                return;
-            }
-
-            if (!maybe_can_read.value())
-                break;
+        if (m_socket->is_open())
+            m_keep_alive_timer->start();
+    };
+}
 
-            auto maybe_nread = m_socket->read_until_any_of(buffer, Array { "\r"sv, "\n"sv, "\r\n"sv });
-            if (maybe_nread.is_error()) {
-                warnln("Failed to read a line from the request: {}", maybe_nread.error());
-                die();
-                return;
-            }
+ErrorOr<void> Client::read_requests()
+{
+    auto buffer = TRY(ByteBuffer::create_uninitialized(m_socket->buffer_size()));
 
-            if (m_socket->is_eof()) {
-                die();
-                break;
-            }
+    while (TRY(m_socket->can_read_without_blocking())) {
+        auto nread = TRY(m_socket->read_until_any_of(buffer, Array { "\r"sv, "\n"sv, "\r\n"sv }));
 
-            builder.append(StringView { buffer.data(), maybe_nread.value() });
-            builder.append("\r\n");
+        if (m_socket->is_eof()) {
+            die();
+            return {};
         }
 
-        auto request = builder.to_byte_buffer();
+        // The buffered socket splits "\r\n" at the '\n', so the '\r' ends up at the end of the line.
+        auto line = StringView { buffer.data(), nread };
+        if (line.ends_with('\r'))
+            line = line.substring_view(0, line.length() - 1);
+        m_request_builder.append(line);
+        m_request_builder.append("\r\n");
+
+        // An empty line ends the request headers.
+        if (!line.is_empty())
+            continue;
+
+        auto request = m_request_builder.to_byte_buffer();
+        m_request_builder.clear();
         dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(request));
 
-        auto maybe_did_handle = handle_request(request);
-        if (maybe_did_handle.is_error()) {
-            warnln("Failed to handle the request: {}", maybe_did_handle.error());
+        m_keep_alive = false;
+        TRY(handle_request(request));
+
+        if (!m_keep_alive) {
+            die();
+            return {};
         }
+    }
 
-        die();
-    };
+    return {};
+}
+
+static Optional<String> header_value(HTTP::HttpRequest const& request, StringView name)
+{
+    for (auto& header : request.headers()) {
+        if (header.name.equals_ignoring_case(name))
+            return header.value;
+    }
+    return {};
+}
+
+static bool wants_keep_alive(HTTP::HttpRequest const& request)
+{
+    auto connection = header_value(request, "Connection"sv);
+    if (connection.has_value()) {
+        if (connection->equals_ignoring_case("close"sv))
+            return false;
+        if (connection->equals_ignoring_case("keep-alive"sv))
+            return true;
+    }
+    // Connections are persistent by default since HTTP/1.1.
+    return request.protocol() == "HTTP/1.1";
 }
 
 ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
@@ -106,7 +139,11 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         }
     }
 
-    if (request.method() != HTTP::HttpRequest::Method::GET) {
+    m_keep_alive = wants_keep_alive(request);
+
+    if (request.method() != HTTP::HttpRequest::Method::GET && request.method() != HTTP::HttpRequest::Method::HEAD) {
+        // We don't read request bodies, so whatever follows can't be parsed as the next request.
+        m_keep_alive = false;
         TRY(send_error_response(501, request));
         return false;
     }
@@ -162,66 +199,178 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         return false;
     }
 
-    Core::InputFileStream stream { file };
-
-    TRY(send_response(stream, request, Core::guess_mime_type_based_on_filename(real_path)));
+    TRY(send_file_response(file, request, Core::guess_mime_type_based_on_filename(real_path)));
     return true;
 }
 
-ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest const& request, String const& content_type)
+ErrorOr<void> Client::send_headers(unsigned code, HTTP::HttpRequest const& request, ContentInfo const& content_info, Vector<String> const& headers)
 {
     StringBuilder builder;
-    builder.append("HTTP/1.0 200 OK\r\n");
-    builder.append("Server: WebServer (SerenityOS)\r\n");
-    builder.append("X-Frame-Options: SAMEORIGIN\r\n");
-    builder.append("X-Content-Type-Options: nosniff\r\n");
-    builder.append("Pragma: no-cache\r\n");
-    builder.append("Content-Type: ");
-    builder.append(content_type);
+    builder.appendff("HTTP/1.1 {} ", code);
+    builder.append(HTTP::HttpResponse::reason_phrase_for_code(code));
     builder.append("\r\n");
+    builder.append("Server: WebServer (SerenityOS)\r\n");
+
+    for (auto& header : headers) {
+        builder.append(header);
+        builder.append("\r\n");
+    }
+
+    if (!content_info.type.is_empty()) {
+        builder.append("Content-Type: ");
+        builder.append(content_info.type);
+        builder.append("\r\n");
+    }
+    builder.appendff("Content-Length: {}\r\n", content_info.length);
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
     builder.append("\r\n");
 
     auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
-    log_response(200, request);
+    TRY(write_all(builder_contents));
+    log_response(code, request);
+    return {};
+}
 
-    char buffer[PAGE_SIZE];
-    do {
-        auto size = response.read({ buffer, sizeof(buffer) });
-        if (response.unreliable_eof() && size == 0)
-            break;
+ErrorOr<void> Client::write_all(ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nwritten = TRY(m_socket->write(bytes));
+        bytes = bytes.slice(nwritten);
+    }
+    return {};
+}
 
-        ReadonlyBytes write_buffer { buffer, size };
-        while (!write_buffer.is_empty()) {
-            auto nwritten = TRY(m_socket->write(write_buffer));
+static Vector<String> content_headers()
+{
+    return {
+        "X-Frame-Options: SAMEORIGIN",
+        "X-Content-Type-Options: nosniff",
+        "Pragma: no-cache",
+    };
+}
 
-            if (nwritten == 0) {
-                dbgln("EEEEEE got 0 bytes written!");
-            }
+ErrorOr<void> Client::send_response(ReadonlyBytes response, HTTP::HttpRequest const& request, String const& content_type)
+{
+    TRY(send_headers(200, request, { content_type, response.size() }, content_headers()));
 
-            write_buffer = write_buffer.slice(nwritten);
-        }
-    } while (true);
+    if (request.method() == HTTP::HttpRequest::Method::HEAD)
+        return {};
+    return write_all(response);
+}
 
-    return {};
+struct ByteRange {
+    u64 start { 0 };
+    u64 length { 0 };
+};
+
+// https://datatracker.ietf.org/doc/html/rfc7233#section-2.1
+// Returns an empty Optional if the header should be ignored and the whole file sent, and a range of length 0 if the
+// requested range lies outside of the file. Requests for multiple ranges get the whole file as well, which is allowed.
+static Optional<ByteRange> parse_byte_range(StringView value, u64 file_size)
+{
+    if (!value.starts_with("bytes="sv))
+        return {};
+    auto range_set = value.substring_view(6).trim_whitespace();
+    if (range_set.contains(','))
+        return {};
+
+    auto dash = range_set.find('-');
+    if (!dash.has_value())
+        return {};
+    auto first_part = range_set.substring_view(0, *dash).trim_whitespace();
+    auto last_part = range_set.substring_view(*dash + 1).trim_whitespace();
+
+    // "bytes=-N" asks for the last N bytes.
+    if (first_part.is_empty()) {
+        auto suffix_length = last_part.to_uint<u64>();
+        if (!suffix_length.has_value())
+            return {};
+        auto length = min(*suffix_length, file_size);
+        return ByteRange { file_size - length, length };
+    }
+
+    auto first = first_part.to_uint<u64>();
+    if (!first.has_value())
+        return {};
+    if (*first >= file_size)
+        return ByteRange {};
+
+    auto last = file_size - 1;
+    if (!last_part.is_empty()) {
+        auto requested_last = last_part.to_uint<u64>();
+        if (!requested_last.has_value() || *requested_last < *first)
+            return {};
+        last = min(*requested_last, last);
+    }
+    return ByteRange { *first, last - *first + 1 };
 }
 
-ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
+ErrorOr<void> Client::send_file_response(Core::File& file, HTTP::HttpRequest const& request, String const& content_type)
 {
-    StringBuilder builder;
-    builder.append("HTTP/1.0 301 Moved Permanently\r\n");
-    builder.append("Location: ");
-    builder.append(redirect_path);
-    builder.append("\r\n");
-    builder.append("\r\n");
+    auto file_size = static_cast<u64>(TRY(Core::System::fstat(file.fd())).st_size);
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
+    unsigned code = 200;
+    ByteRange range { 0, file_size };
+    auto headers = content_headers();
+    headers.append("Accept-Ranges: bytes");
+
+    if (auto range_header = header_value(request, "Range"sv); range_header.has_value()) {
+        if (auto requested_range = parse_byte_range(*range_header, file_size); requested_range.has_value()) {
+            if (requested_range->length == 0)
+                return send_error_response(416, request, { String::formatted("Content-Range: bytes */{}", file_size) });
 
-    log_response(301, request);
+            code = 206;
+            range = *requested_range;
+            headers.append(String::formatted("Content-Range: bytes {}-{}/{}", range.start, range.start + range.length - 1, file_size));
+        }
+    }
+
+    TRY(send_headers(code, request, { content_type, range.length }, headers));
+
+    if (request.method() == HTTP::HttpRequest::Method::HEAD)
+        return {};
+    return send_file_contents(file, range.start, range.length);
+}
+
+ErrorOr<void> Client::send_file_contents(Core::File& file, off_t offset, u64 length)
+{
+#if defined(__serenity__) || defined(__linux__)
+    // Have the kernel move the file contents into the socket, instead of copying them through our buffers.
+    while (length > 0) {
+        auto nsent_or_error = Core::System::sendfile(m_socket_fd, file.fd(), &offset, length);
+        if (nsent_or_error.is_error()) {
+            // Not every kind of file can be sent like this, in which case we copy it ourselves below.
+            auto code = nsent_or_error.error().code();
+            if (code == EINVAL || code == ENOSYS)
+                break;
+            return nsent_or_error.release_error();
+        }
+        if (nsent_or_error.value() == 0)
+            return Error::from_string_literal("File got truncated while sending it"sv);
+        length -= nsent_or_error.value();
+    }
+    if (length == 0)
+        return {};
+#endif
+
+    TRY(Core::System::lseek(file.fd(), offset, SEEK_SET));
+
+    u8 buffer[PAGE_SIZE];
+    while (length > 0) {
+        auto nread = TRY(Core::System::read(file.fd(), { buffer, min<u64>(sizeof(buffer), length) }));
+        if (nread == 0)
+            return Error::from_string_literal("File got truncated while sending it"sv);
+        TRY(write_all({ buffer, static_cast<size_t>(nread) }));
+        length -= nread;
+    }
     return {};
 }
 
+ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
+{
+    return send_headers(301, request, {}, { String::formatted("Location: {}", redirect_path) });
+}
+
 static String folder_image_data()
 {
     static String cache;
@@ -317,35 +466,24 @@ ErrorOr<void> Client::handle_directory_listing(String const& requested_path, Str
     builder.append("</html>\n");
 
     auto response = builder.to_string();
-    InputMemoryStream stream { response.bytes() };
-    return send_response(stream, request, "text/html");
+    return send_response(response.bytes(), request, "text/html");
 }
 
 ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
 {
     auto reason_phrase = HTTP::HttpResponse::reason_phrase_for_code(code);
     StringBuilder builder;
-    builder.appendff("HTTP/1.0 {} ", code);
-    builder.append(reason_phrase);
-    builder.append("\r\n");
-
-    for (auto& header : headers) {
-        builder.append(header);
-        builder.append("\r\n");
-    }
-    builder.append("Content-Type: text/html; charset=UTF-8\r\n");
-
-    builder.append("\r\n");
     builder.append("<!DOCTYPE html><html><body><h1>");
     builder.appendff("{} ", code);
     builder.append(reason_phrase);
     builder.append("</h1></body></html>");
+    auto body = builder.to_byte_buffer();
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
+    TRY(send_headers(code, request, { "text/html; charset=UTF-8", body.size() }, headers));
 
-    log_response(code, request);
-    return {};
+    if (request.method() == HTTP::HttpRequest::Method::HEAD)
+        return {};
+    return write_all(body);
 }
 
 void Client::log_response(unsigned code, HTTP::HttpRequest const& request)
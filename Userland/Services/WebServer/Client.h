@@ -6,8 +6,11 @@
 
 #pragma once
 
+#include <AK/StringBuilder.h>
+#include <LibCore/Forward.h>
 #include <LibCore/Object.h>
 #include <LibCore/Stream.h>
+#include <LibCore/Timer.h>
 #include <LibHTTP/Forward.h>
 #include <LibHTTP/HttpRequest.h>
 
@@ -20,18 +23,34 @@ public:
     void start();
 
 private:
-    Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket>, Core::Object* parent);
+    Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket>, int socket_fd, Core::Object* parent);
 
+    struct ContentInfo {
+        String type;
+        u64 length { 0 };
+    };
+
+    ErrorOr<void> read_requests();
     ErrorOr<bool> handle_request(ReadonlyBytes);
-    ErrorOr<void> send_response(InputStream&, HTTP::HttpRequest const&, String const& content_type);
+    ErrorOr<void> send_headers(unsigned code, HTTP::HttpRequest const&, ContentInfo const&, Vector<String> const& headers = {});
+    ErrorOr<void> send_response(ReadonlyBytes, HTTP::HttpRequest const&, String const& content_type);
+    ErrorOr<void> send_file_response(Core::File&, HTTP::HttpRequest const&, String const& content_type);
+    ErrorOr<void> send_file_contents(Core::File&, off_t offset, u64 length);
     ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
     ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
+    ErrorOr<void> write_all(ReadonlyBytes);
     void die();
     void log_response(unsigned code, HTTP::HttpRequest const&);
     ErrorOr<void> handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
     NonnullOwnPtr<Core::Stream::BufferedTCPSocket> m_socket;
+    // The fd of m_socket, for handing file contents to the kernel with sendfile().
+    int m_socket_fd { -1 };
+
+    StringBuilder m_request_builder;
+    bool m_keep_alive { false };
+    RefPtr<Core::Timer> m_keep_alive_timer;
 };
 
 }
@@ -78,7 +78,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             return;
         }
 
-        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(maybe_client_socket.release_value());
+        auto client_socket = maybe_client_socket.release_value();
+        auto client_socket_fd = client_socket->fd();
+        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(move(client_socket));
         if (maybe_buffered_socket.is_error()) {
             warnln("Could not obtain a buffered socket for the client: {}", maybe_buffered_socket.error());
             return;
@@ -86,7 +88,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
         // FIXME: Propagate errors
         MUST(maybe_buffered_socket.value()->set_blocking(true));
-        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), server);
+        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), client_socket_fd, server);
         client->start();
     };
 
@@ -1158,6 +1158,12 @@ void ClientConnection::set_flash_flush(bool enabled)
     Compositor::the().set_flash_flush(enabled);
 }
 
+Messages::WindowServer::GetCompositorStatisticsResponse ClientConnection::get_compositor_statistics()
+{
+    auto& statistics = Compositor::the().statistics();
+    return { statistics.frame_count, statistics.total_compose_time_us, statistics.last_compose_time_us, statistics.max_compose_time_us, statistics.last_tile_count, statistics.thread_count };
+}
+
 void ClientConnection::set_window_parent_from_client(i32 client_id, i32 parent_id, i32 child_id)
 {
     auto child_window = window_from_id(child_id);
@@ -16,11 +16,13 @@
 #include <AK/Debug.h>
 #include <AK/Memory.h>
 #include <AK/ScopeGuard.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/Timer.h>
 #include <LibGfx/Font.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/StylePainter.h>
 #include <LibThreading/BackgroundAction.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace WindowServer {
 
@@ -63,9 +65,16 @@ Compositor::Compositor()
         },
         this);
 
+    m_thread_pool = make<Threading::ThreadPool>("Compositor"sv, max_compose_threads);
+    m_statistics.thread_count = m_thread_pool->thread_count();
+
     init_bitmaps();
 }
 
+Compositor::~Compositor()
+{
+}
+
 const Gfx::Bitmap* Compositor::cursor_bitmap_for_screenshot(Badge<ClientConnection>, Screen& screen) const
 {
     if (!m_current_cursor)
@@ -174,6 +183,9 @@ void Compositor::compose()
         return;
     }
 
+    Core::ElapsedTimer compose_timer(true);
+    compose_timer.start();
+
     if (m_occlusions_dirty) {
         m_occlusions_dirty = false;
         recompute_occlusions();
@@ -247,6 +259,7 @@ void Compositor::compose()
         screen_data.m_flush_rects.clear_with_capacity();
         screen_data.m_flush_transparent_rects.clear_with_capacity();
         screen_data.m_flush_special_rects.clear_with_capacity();
+        screen_data.m_paint_commands.clear_with_capacity();
         return IterationDecision::Continue;
     });
 
@@ -301,27 +314,8 @@ void Compositor::compose()
     if (!cursor_screen.compositor_screen_data().m_cursor_back_bitmap || m_invalidated_cursor)
         check_restore_cursor_back(cursor_screen, cursor_rect);
 
-    auto paint_wallpaper = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect, const Gfx::IntRect& screen_rect) {
-        // FIXME: If the wallpaper is opaque and covers the whole rect, no need to fill with color!
-        painter.fill_rect(rect, background_color);
-        if (m_wallpaper) {
-            if (m_wallpaper_mode == WallpaperMode::Center) {
-                Gfx::IntPoint offset { (screen.width() - m_wallpaper->width()) / 2, (screen.height() - m_wallpaper->height()) / 2 };
-                painter.blit_offset(rect.location(), *m_wallpaper, rect.translated(-screen_rect.location()), offset);
-            } else if (m_wallpaper_mode == WallpaperMode::Tile) {
-                painter.draw_tiled_bitmap(rect, *m_wallpaper);
-            } else if (m_wallpaper_mode == WallpaperMode::Stretch) {
-                float hscale = (float)m_wallpaper->width() / (float)screen.width();
-                float vscale = (float)m_wallpaper->height() / (float)screen.height();
-
-                // TODO: this may look ugly, we should scale to a backing bitmap and then blit
-                auto relative_rect = rect.translated(-screen_rect.location());
-                auto src_rect = Gfx::FloatRect { relative_rect.x() * hscale, relative_rect.y() * vscale, relative_rect.width() * hscale, relative_rect.height() * vscale };
-                painter.draw_scaled_bitmap(rect, *m_wallpaper, src_rect);
-            } else {
-                VERIFY_NOT_REACHED();
-            }
-        }
+    auto add_wallpaper_command = [&](Screen& screen, const Gfx::IntRect& rect, bool to_temp_bitmap) {
+        screen.compositor_screen_data().m_paint_commands.append({ .type = CompositorPaintCommand::Type::Wallpaper, .to_temp_bitmap = to_temp_bitmap, .rect = rect });
     };
 
     {
@@ -334,8 +328,7 @@ void Compositor::compose()
                 if (!screen_render_rect.is_empty()) {
                     dbgln_if(COMPOSE_DEBUG, "  render wallpaper opaque: {} on screen #{}", screen_render_rect, screen.index());
                     prepare_rect(screen, render_rect);
-                    auto& back_painter = *screen.compositor_screen_data().m_back_painter;
-                    paint_wallpaper(screen, back_painter, render_rect, screen_rect);
+                    add_wallpaper_command(screen, render_rect, false);
                 }
                 return IterationDecision::Continue;
             });
@@ -348,8 +341,7 @@ void Compositor::compose()
                 if (!screen_render_rect.is_empty()) {
                     dbgln_if(COMPOSE_DEBUG, "  render wallpaper transparent: {} on screen #{}", screen_render_rect, screen.index());
                     prepare_transparency_rect(screen, render_rect);
-                    auto& temp_painter = *screen.compositor_screen_data().m_temp_painter;
-                    paint_wallpaper(screen, temp_painter, render_rect, screen_rect);
+                    add_wallpaper_command(screen, render_rect, true);
                 }
                 return IterationDecision::Continue;
             });
@@ -365,35 +357,26 @@ void Compositor::compose()
         auto transition_offset = window_transition_offset(window);
         auto frame_rect = window.frame().render_rect().translated(transition_offset);
         auto window_rect = window.rect().translated(transition_offset);
-        auto frame_rects = frame_rect.shatter(window_rect);
 
         dbgln_if(COMPOSE_DEBUG, "  window {} frame rect: {}", window.title(), frame_rect);
 
-        RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect) {
-            if (!window.is_fullscreen()) {
-                rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
-                    Gfx::PainterStateSaver saver(painter);
-                    painter.add_clip_rect(intersected_rect);
-                    painter.translate(transition_offset);
-                    dbgln_if(COMPOSE_DEBUG, "    render frame: {}", intersected_rect);
-                    window.frame().paint(screen, painter, intersected_rect.translated(-transition_offset));
-                    return IterationDecision::Continue;
-                });
-            }
-
-            auto clear_window_rect = [&](const Gfx::IntRect& clear_rect) {
-                auto fill_color = wm.palette().window();
-                if (!window.is_opaque())
-                    fill_color.set_alpha(255 * window.opacity());
-                painter.fill_rect(clear_rect, fill_color);
-            };
-
-            if (!backing_store) {
-                clear_window_rect(window_rect.intersected(rect));
-                return;
-            }
+        CompositorPaintCommand window_command {
+            .type = CompositorPaintCommand::Type::Window,
+            .transition_offset = transition_offset,
+            .window_rect = window_rect,
+            .frame_rect = frame_rect,
+            .unconstrained_frame_rect = window.frame().unconstrained_render_rect(),
+            .frame_opacity = window.frame().opacity(),
+            .backing_store = window.backing_store(),
+            .opacity = window.opacity(),
+            .is_opaque = window.is_opaque(),
+            .is_unresponsive = window.client() && window.client()->is_unresponsive(),
+            .fill_color = wm.palette().window(),
+        };
+        if (!window.is_opaque())
+            window_command.fill_color.set_alpha(255 * window.opacity());
 
+        if (auto* backing_store = window_command.backing_store) {
             // Decide where we would paint this window's backing store.
             // This is subtly different from widow.rect(), because window
             // size may be different from its backing store size. This
@@ -402,7 +385,7 @@ void Compositor::compose()
             // we want to try to blit the backing store at the same place
             // it was previously, and fill the rest of the window with its
             // background color.
-            Gfx::IntRect backing_rect;
+            auto& backing_rect = window_command.backing_rect;
             backing_rect.set_size(backing_store->size());
             switch (WindowManager::the().resize_direction_of_window(window)) {
             case ResizeDirection::None:
@@ -426,34 +409,16 @@ void Compositor::compose()
                 backing_rect.set_top(window_rect.top());
                 break;
             }
+        }
 
-            Gfx::IntRect dirty_rect_in_backing_coordinates = rect.intersected(window_rect)
-                                                                 .intersected(backing_rect)
-                                                                 .translated(-backing_rect.location());
-
-            if (!dirty_rect_in_backing_coordinates.is_empty()) {
-                auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
-
-                if (window.client() && window.client()->is_unresponsive()) {
-                    if (window.is_opaque()) {
-                        painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
-                            return src.to_grayscale().darkened(0.75f);
-                        });
-                    } else {
-                        u8 alpha = 255 * window.opacity();
-                        painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [&](Color src) {
-                            auto color = src.to_grayscale().darkened(0.75f);
-                            color.set_alpha(alpha);
-                            return color;
-                        });
-                    }
-                } else {
-                    painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
-                }
-            }
-
-            for (auto background_rect : window_rect.shatter(backing_rect))
-                clear_window_rect(background_rect);
+        auto add_window_command = [&](Screen& screen, const Gfx::IntRect& rect, bool to_temp_bitmap) {
+            auto command = window_command;
+            command.to_temp_bitmap = to_temp_bitmap;
+            command.rect = rect;
+            // The frame is rendered into its cache here, as painting it from the worker threads must not modify it.
+            if (!window.is_fullscreen())
+                command.frame_cache = window.frame().render_to_cache(screen);
+            screen.compositor_screen_data().m_paint_commands.append(command);
         };
 
         auto& dirty_rects = window.dirty_rects();
@@ -478,10 +443,7 @@ void Compositor::compose()
                     dbgln_if(COMPOSE_DEBUG, "    render opaque: {} on screen #{}", screen_render_rect, screen->index());
 
                     prepare_rect(*screen, screen_render_rect);
-                    auto& back_painter = *screen->compositor_screen_data().m_back_painter;
-                    Gfx::PainterStateSaver saver(back_painter);
-                    back_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, back_painter, screen_render_rect);
+                    add_window_command(*screen, screen_render_rect, false);
                 }
                 return IterationDecision::Continue;
             });
@@ -499,9 +461,8 @@ void Compositor::compose()
                         continue;
                     dbgln_if(COMPOSE_DEBUG, "    render wallpaper: {} on screen #{}", screen_render_rect, screen->index());
 
-                    auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
                     prepare_transparency_rect(*screen, screen_render_rect);
-                    paint_wallpaper(*screen, temp_painter, screen_render_rect, screen_rect);
+                    add_wallpaper_command(*screen, screen_render_rect, true);
                 }
                 return IterationDecision::Continue;
             });
@@ -517,10 +478,7 @@ void Compositor::compose()
                     dbgln_if(COMPOSE_DEBUG, "    render transparent: {} on screen #{}", screen_render_rect, screen->index());
 
                     prepare_transparency_rect(*screen, screen_render_rect);
-                    auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
-                    Gfx::PainterStateSaver saver(temp_painter);
-                    temp_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, temp_painter, screen_render_rect);
+                    add_window_command(*screen, screen_render_rect, true);
                 }
                 return IterationDecision::Continue;
             });
@@ -528,7 +486,7 @@ void Compositor::compose()
         return IterationDecision::Continue;
     };
 
-    // Paint the window stack.
+    // Work out what the window stack needs to paint.
     if (m_invalidated_window) {
         auto* fullscreen_window = wm.active_fullscreen_window();
         if (fullscreen_window && fullscreen_window->is_opaque()) {
@@ -562,20 +520,56 @@ void Compositor::compose()
             });
             return is_overlapping;
         }());
+    }
+
+    // Paint the wallpaper and the window stack. Each tile replays the commands of its screen
+    // in the order they were recorded, so the result is the same as painting them one after another.
+    size_t tile_count = paint_tiles(
+        [&](Screen& screen, const Gfx::IntRect& tile_rect) {
+            for (auto& command : screen.compositor_screen_data().m_paint_commands) {
+                if (command.rect.intersects(tile_rect))
+                    return true;
+            }
+            return false;
+        },
+        [&](Tile& tile) {
+            auto& screen = *tile.screen;
+            auto screen_rect = screen.rect();
+            for (auto& command : screen.compositor_screen_data().m_paint_commands) {
+                auto rect = command.rect.intersected(tile.rect);
+                if (rect.is_empty())
+                    continue;
+                auto& painter = command.to_temp_bitmap ? *tile.temp_painter : *tile.back_painter;
+                Gfx::PainterStateSaver saver(painter);
+                painter.add_clip_rect(rect);
+                if (command.type == CompositorPaintCommand::Type::Wallpaper)
+                    paint_wallpaper(screen, painter, rect, screen_rect, background_color);
+                else
+                    paint_window_rect(painter, command, rect);
+            }
+        });
 
+    if (m_invalidated_window) {
         if (!m_overlay_list.is_empty()) {
             // Render everything to the temporary buffer before we copy it back
             render_overlays();
         }
 
         // Copy anything rendered to the temporary buffer to the back buffer
-        Screen::for_each([&](auto& screen) {
-            auto screen_rect = screen.rect();
-            auto& screen_data = screen.compositor_screen_data();
-            for (auto& rect : screen_data.m_flush_transparent_rects.rects())
-                screen_data.m_back_painter->blit(rect.location(), *screen_data.m_temp_bitmap, rect.translated(-screen_rect.location()));
-            return IterationDecision::Continue;
-        });
+        paint_tiles(
+            [&](Screen& screen, const Gfx::IntRect& tile_rect) {
+                return screen.compositor_screen_data().m_flush_transparent_rects.intersects(tile_rect);
+            },
+            [&](Tile& tile) {
+                auto& screen = *tile.screen;
+                auto screen_rect = screen.rect();
+                auto& screen_data = screen.compositor_screen_data();
+                for (auto& rect : screen_data.m_flush_transparent_rects.rects()) {
+                    auto tile_flush_rect = rect.intersected(tile.rect);
+                    if (!tile_flush_rect.is_empty())
+                        tile.back_painter->blit(tile_flush_rect.location(), *screen_data.m_temp_bitmap, tile_flush_rect.translated(-screen_rect.location()));
+                }
+            });
     }
 
     m_invalidated_any = false;
@@ -604,6 +598,121 @@ void Compositor::compose()
         flush(screen);
         return IterationDecision::Continue;
     });
+
+    auto compose_time_us = static_cast<u32>(compose_timer.elapsed_time().to_microseconds());
+    m_statistics.frame_count++;
+    m_statistics.total_compose_time_us += compose_time_us;
+    m_statistics.last_compose_time_us = compose_time_us;
+    m_statistics.max_compose_time_us = max(m_statistics.max_compose_time_us, compose_time_us);
+    m_statistics.last_tile_count = tile_count;
+}
+
+void Compositor::paint_wallpaper(Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect, const Gfx::IntRect& screen_rect, Color background_color)
+{
+    // FIXME: If the wallpaper is opaque and covers the whole rect, no need to fill with color!
+    painter.fill_rect(rect, background_color);
+    if (m_wallpaper) {
+        if (m_wallpaper_mode == WallpaperMode::Center) {
+            Gfx::IntPoint offset { (screen.width() - m_wallpaper->width()) / 2, (screen.height() - m_wallpaper->height()) / 2 };
+            painter.blit_offset(rect.location(), *m_wallpaper, rect.translated(-screen_rect.location()), offset);
+        } else if (m_wallpaper_mode == WallpaperMode::Tile) {
+            painter.draw_tiled_bitmap(rect, *m_wallpaper);
+        } else if (m_wallpaper_mode == WallpaperMode::Stretch) {
+            float hscale = (float)m_wallpaper->width() / (float)screen.width();
+            float vscale = (float)m_wallpaper->height() / (float)screen.height();
+
+            // TODO: this may look ugly, we should scale to a backing bitmap and then blit
+            auto relative_rect = rect.translated(-screen_rect.location());
+            auto src_rect = Gfx::FloatRect { relative_rect.x() * hscale, relative_rect.y() * vscale, relative_rect.width() * hscale, relative_rect.height() * vscale };
+            painter.draw_scaled_bitmap(rect, *m_wallpaper, src_rect);
+        } else {
+            VERIFY_NOT_REACHED();
+        }
+    }
+}
+
+void Compositor::paint_window_rect(Gfx::Painter& painter, CompositorPaintCommand const& command, const Gfx::IntRect& rect)
+{
+    auto& window_rect = command.window_rect;
+
+    if (command.frame_cache) {
+        auto frame_rects = command.frame_rect.shatter(window_rect);
+        rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
+            Gfx::PainterStateSaver saver(painter);
+            painter.add_clip_rect(intersected_rect);
+            painter.translate(command.transition_offset);
+            dbgln_if(COMPOSE_DEBUG, "    render frame: {}", intersected_rect);
+            auto frame_paint_rect = intersected_rect.translated(-command.transition_offset);
+            command.frame_cache->paint(painter, frame_paint_rect, command.unconstrained_frame_rect, window_rect.translated(-command.transition_offset), command.frame_opacity);
+            return IterationDecision::Continue;
+        });
+    }
+
+    auto* backing_store = command.backing_store;
+    if (!backing_store) {
+        painter.fill_rect(window_rect.intersected(rect), command.fill_color);
+        return;
+    }
+
+    auto& backing_rect = command.backing_rect;
+    Gfx::IntRect dirty_rect_in_backing_coordinates = rect.intersected(window_rect)
+                                                         .intersected(backing_rect)
+                                                         .translated(-backing_rect.location());
+
+    if (!dirty_rect_in_backing_coordinates.is_empty()) {
+        auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
+
+        if (command.is_unresponsive) {
+            if (command.is_opaque) {
+                painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
+                    return src.to_grayscale().darkened(0.75f);
+                });
+            } else {
+                u8 alpha = 255 * command.opacity;
+                painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [&](Color src) {
+                    auto color = src.to_grayscale().darkened(0.75f);
+                    color.set_alpha(alpha);
+                    return color;
+                });
+            }
+        } else {
+            painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, command.opacity);
+        }
+    }
+
+    for (auto background_rect : window_rect.shatter(backing_rect))
+        painter.fill_rect(background_rect, command.fill_color);
+}
+
+size_t Compositor::paint_tiles(Function<bool(Screen&, const Gfx::IntRect&)> const& needs_painting, Function<void(Tile&)> const& paint)
+{
+    // Painters hold a reference to their bitmap, and reference counts aren't atomic,
+    // so every tile gets its own painters here on the main thread.
+    Screen::for_each([&](auto& screen) {
+        auto screen_rect = screen.rect();
+        auto& screen_data = screen.compositor_screen_data();
+        for (int y = screen_rect.top(); y <= screen_rect.bottom(); y += tile_size) {
+            for (int x = screen_rect.left(); x <= screen_rect.right(); x += tile_size) {
+                auto tile_rect = Gfx::IntRect { x, y, tile_size, tile_size }.intersected(screen_rect);
+                if (!needs_painting(screen, tile_rect))
+                    continue;
+                Tile tile { &screen, tile_rect, make<Gfx::Painter>(*screen_data.m_back_bitmap), make<Gfx::Painter>(*screen_data.m_temp_bitmap) };
+                for (auto* painter : { tile.back_painter.ptr(), tile.temp_painter.ptr() }) {
+                    painter->translate(-screen_rect.location());
+                    painter->add_clip_rect(tile_rect);
+                }
+                m_tiles.append(move(tile));
+            }
+        }
+        return IterationDecision::Continue;
+    });
+
+    size_t tile_count = m_tiles.size();
+    m_thread_pool->run(tile_count, [&](size_t index) {
+        paint(m_tiles[index]);
+    });
+    m_tiles.clear_with_capacity();
+    return tile_count;
 }
 
 void Compositor::flush(Screen& screen)
@@ -6,13 +6,20 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
+#include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibGfx/Color.h>
 #include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Font.h>
 #include <WindowServer/Overlays.h>
+#include <WindowServer/WindowFrame.h>
+
+namespace Threading {
+class ThreadPool;
+}
 
 namespace WindowServer {
 
@@ -32,6 +39,42 @@ enum class WallpaperMode {
     Unchecked
 };
 
+// compose() first works out what has to be painted where, and then paints the dirty
+// tiles of each screen in parallel by replaying these commands, clipped to the tile.
+struct CompositorPaintCommand {
+    enum class Type {
+        Wallpaper,
+        Window,
+    };
+    Type type { Type::Wallpaper };
+    bool to_temp_bitmap { false };
+    Gfx::IntRect rect {};
+
+    // Everything below is only used by Type::Window, and is looked up before painting
+    // so that the worker threads don't have to touch the window or the window manager.
+    Gfx::IntPoint transition_offset {};
+    Gfx::IntRect window_rect {};
+    Gfx::IntRect frame_rect {};
+    Gfx::IntRect unconstrained_frame_rect {};
+    WindowFrame::PerScaleRenderedCache const* frame_cache { nullptr };
+    float frame_opacity { 1 };
+    Gfx::Bitmap const* backing_store { nullptr };
+    Gfx::IntRect backing_rect {};
+    float opacity { 1 };
+    bool is_opaque { true };
+    bool is_unresponsive { false };
+    Gfx::Color fill_color {};
+};
+
+struct CompositorStatistics {
+    u64 frame_count { 0 };
+    u64 total_compose_time_us { 0 };
+    u32 last_compose_time_us { 0 };
+    u32 max_compose_time_us { 0 };
+    u32 last_tile_count { 0 };
+    u32 thread_count { 0 };
+};
+
 struct CompositorScreenData {
     RefPtr<Gfx::Bitmap> m_front_bitmap;
     RefPtr<Gfx::Bitmap> m_back_bitmap;
@@ -54,6 +97,8 @@ struct CompositorScreenData {
     Gfx::DisjointRectSet m_flush_transparent_rects;
     Gfx::DisjointRectSet m_flush_special_rects;
 
+    Vector<CompositorPaintCommand> m_paint_commands;
+
     Gfx::Painter& overlay_painter() { return *m_temp_painter; }
 
     void init_bitmaps(Compositor&, Screen&);
@@ -92,6 +137,7 @@ class Compositor final : public Core::Object {
 
 public:
     static Compositor& the();
+    virtual ~Compositor() override;
 
     void compose();
     void invalidate_window();
@@ -183,12 +229,26 @@ public:
 
     void set_flash_flush(bool b) { m_flash_flush = b; }
 
+    CompositorStatistics const& statistics() const { return m_statistics; }
+
     static NonnullOwnPtr<CompositorScreenData> create_screen_data(Badge<Screen>)
     {
         return adopt_own(*new CompositorScreenData());
     }
 
 private:
+    // Screens are split into tiles of this many logical pixels on each side, which are painted in parallel.
+    static constexpr int tile_size = 256;
+    // At most this many threads (including the one composing) paint tiles, fewer if there aren't as many CPUs.
+    static constexpr size_t max_compose_threads = 8;
+
+    struct Tile {
+        Screen* screen { nullptr };
+        Gfx::IntRect rect;
+        OwnPtr<Gfx::Painter> back_painter;
+        OwnPtr<Gfx::Painter> temp_painter;
+    };
+
     Compositor();
     void init_bitmaps();
     void invalidate_current_screen_number_rects();
@@ -204,6 +264,9 @@ private:
     void recompute_occlusions();
     void change_cursor(const Cursor*);
     void flush(Screen&);
+    void paint_wallpaper(Screen&, Gfx::Painter&, Gfx::IntRect const&, Gfx::IntRect const& screen_rect, Gfx::Color background_color);
+    void paint_window_rect(Gfx::Painter&, CompositorPaintCommand const&, Gfx::IntRect const&);
+    size_t paint_tiles(Function<bool(Screen&, Gfx::IntRect const&)> const& needs_painting, Function<void(Tile&)> const& paint);
     Gfx::IntPoint window_transition_offset(Window&);
     void update_animations(Screen&, Gfx::DisjointRectSet& flush_rects);
     void create_window_stack_switch_overlay(WindowStack&);
@@ -248,6 +311,10 @@ private:
     Optional<Gfx::Color> m_custom_background_color;
 
     HashTable<Animation*> m_animations;
+
+    OwnPtr<Threading::ThreadPool> m_thread_pool;
+    Vector<Tile> m_tiles;
+    CompositorStatistics m_statistics;
 };
 
 }
@@ -30,6 +30,8 @@ public:
 
     public:
         void paint(WindowFrame&, Gfx::Painter&, const Gfx::IntRect&);
+        // Doesn't look at the frame or the window manager, so it can be called from the compositor's threads.
+        void paint(Gfx::Painter&, Gfx::IntRect const&, Gfx::IntRect const& frame_rect, Gfx::IntRect const& window_rect, float opacity) const;
         void render(WindowFrame&, Screen&);
         Optional<HitTestResult> hit_test(WindowFrame&, Gfx::IntPoint const&, Gfx::IntPoint const&);
 
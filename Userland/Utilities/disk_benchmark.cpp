@@ -12,6 +12,7 @@
 #include <LibCore/ElapsedTimer.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -39,12 +40,87 @@ static Result average_result(const Vector<Result>& results)
 
 static void exit_with_usage(int rc)
 {
-    warnln("Usage: disk_benchmark [-h] [-d directory] [-t time_per_benchmark] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]");
+    warnln("Usage: disk_benchmark [-h] [-c] [-d directory] [-t time_per_benchmark] [-p thread_count] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]");
     exit(rc);
 }
 
 static Optional<Result> benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache);
 
+struct BenchmarkThread {
+    pthread_t thread {};
+    String filename;
+    int file_size { 0 };
+    int block_size { 0 };
+    int time_per_benchmark { 0 };
+    bool allow_cache { false };
+    Vector<Result> results;
+    bool failed { false };
+};
+
+// Every thread repeatedly writes and reads back its own file, so that concurrent readers and writers of the same
+// file system can be compared against a single one.
+static void* run_benchmark_thread(void* argument)
+{
+    auto& benchmark_thread = *static_cast<BenchmarkThread*>(argument);
+    auto buffer_result = ByteBuffer::create_uninitialized(benchmark_thread.block_size);
+    if (buffer_result.is_error()) {
+        benchmark_thread.failed = true;
+        return nullptr;
+    }
+
+    auto timer = Core::ElapsedTimer::start_new();
+    while (timer.elapsed() < benchmark_thread.time_per_benchmark * 1000) {
+        auto result = benchmark(benchmark_thread.filename, benchmark_thread.file_size, benchmark_thread.block_size, buffer_result.value(), benchmark_thread.allow_cache);
+        if (!result.has_value()) {
+            benchmark_thread.failed = true;
+            return nullptr;
+        }
+        benchmark_thread.results.append(result.release_value());
+        usleep(100);
+    }
+    return nullptr;
+}
+
+static bool run_threaded_benchmark(const String& filename, int file_size, int block_size, int time_per_benchmark, bool allow_cache, int thread_count)
+{
+    Vector<BenchmarkThread> threads;
+    threads.resize(thread_count);
+    for (int i = 0; i < thread_count; ++i) {
+        auto& benchmark_thread = threads[i];
+        benchmark_thread.filename = String::formatted("{}.{}", filename, i);
+        benchmark_thread.file_size = file_size;
+        benchmark_thread.block_size = block_size;
+        benchmark_thread.time_per_benchmark = time_per_benchmark;
+        benchmark_thread.allow_cache = allow_cache;
+    }
+
+    auto timer = Core::ElapsedTimer::start_new();
+    for (auto& benchmark_thread : threads) {
+        if (int rc = pthread_create(&benchmark_thread.thread, nullptr, run_benchmark_thread, &benchmark_thread); rc != 0) {
+            warnln("pthread_create: {}", strerror(rc));
+            exit(1);
+        }
+    }
+
+    Result total;
+    bool failed = false;
+    for (int i = 0; i < thread_count; ++i) {
+        auto& benchmark_thread = threads[i];
+        pthread_join(benchmark_thread.thread, nullptr);
+        if (benchmark_thread.failed || benchmark_thread.results.is_empty()) {
+            warnln("Thread {} failed", i);
+            failed = true;
+            continue;
+        }
+        auto average = average_result(benchmark_thread.results);
+        outln("Thread {}: runs={} write_bps={} read_bps={}", i, benchmark_thread.results.size(), average.write_bps, average.read_bps);
+        total.write_bps += average.write_bps;
+        total.read_bps += average.read_bps;
+    }
+    outln("Finished: threads={} time={}ms total_write_bps={} total_read_bps={}", thread_count, timer.elapsed(), total.write_bps, total.read_bps);
+    return !failed;
+}
+
 int main(int argc, char** argv)
 {
     String directory = ".";
@@ -52,9 +128,10 @@ int main(int argc, char** argv)
     Vector<size_t> file_sizes;
     Vector<size_t> block_sizes;
     bool allow_cache = false;
+    int thread_count = 1;
 
     int opt;
-    while ((opt = getopt(argc, argv, "chd:t:f:b:")) != -1) {
+    while ((opt = getopt(argc, argv, "chd:t:p:f:b:")) != -1) {
         switch (opt) {
         case 'h':
             exit_with_usage(0);
@@ -68,6 +145,11 @@ int main(int argc, char** argv)
         case 't':
             time_per_benchmark = atoi(optarg);
             break;
+        case 'p':
+            thread_count = atoi(optarg);
+            if (thread_count < 1)
+                exit_with_usage(1);
+            break;
         case 'f':
             for (const auto& size : String(optarg).split(','))
                 file_sizes.append(atoi(size.characters()));
@@ -95,6 +177,14 @@ int main(int argc, char** argv)
             if (block_size > file_size)
                 continue;
 
+            if (thread_count > 1) {
+                outln("Running: file_size={} block_size={} threads={}", file_size, block_size, thread_count);
+                if (!run_threaded_benchmark(filename, file_size, block_size, time_per_benchmark, allow_cache, thread_count))
+                    return 1;
+                sleep(1);
+                continue;
+            }
+
             auto buffer_result = ByteBuffer::create_uninitialized(block_size);
             if (buffer_result.is_error()) {
                 warnln("Not enough memory to allocate space for block size = {}", block_size);
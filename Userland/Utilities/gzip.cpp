@@ -18,17 +18,29 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool keep_input_files { false };
     bool write_to_stdout { false };
     bool decompress { false };
+    bool fast { false };
+    bool best { false };
+    unsigned thread_count { 1 };
 
     Core::ArgsParser args_parser;
     args_parser.add_option(keep_input_files, "Keep (don't delete) input files", "keep", 'k');
     args_parser.add_option(write_to_stdout, "Write to stdout, keep original files unchanged", "stdout", 'c');
     args_parser.add_option(decompress, "Decompress", "decompress", 'd');
+    args_parser.add_option(fast, "Compress faster", "fast", '1');
+    args_parser.add_option(best, "Compress better", "best", '9');
+    args_parser.add_option(thread_count, "Compress on this many threads", "threads", 'j', "count");
     args_parser.add_positional_argument(filenames, "Files", "FILES");
     args_parser.parse(arguments);
 
     if (write_to_stdout)
         keep_input_files = true;
 
+    auto compression_level = Compress::DeflateCompressor::CompressionLevel::GOOD;
+    if (fast)
+        compression_level = Compress::DeflateCompressor::CompressionLevel::FAST;
+    else if (best)
+        compression_level = Compress::DeflateCompressor::CompressionLevel::GREAT;
+
     for (auto const& input_filename : filenames) {
         String output_filename;
         if (decompress) {
@@ -54,7 +66,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         if (decompress)
             output_bytes = Compress::GzipDecompressor::decompress_all(input_bytes);
         else
-            output_bytes = Compress::GzipCompressor::compress_all(input_bytes);
+            output_bytes = Compress::GzipCompressor::compress_all(input_bytes, compression_level, thread_count);
 
         if (!output_bytes.has_value()) {
             warnln("Failed gzip {} input file", decompress ? "decompressing"sv : "compressing"sv);
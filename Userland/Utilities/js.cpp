@@ -1344,6 +1344,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 #endif
 
     bool gc_on_every_allocation = false;
+    bool incremental_gc = false;
+    bool print_gc_statistics = false;
     bool disable_syntax_highlight = false;
     StringView evaluate_script;
     Vector<StringView> script_paths;
@@ -1359,6 +1361,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(s_strip_ansi, "Disable ANSI colors", "disable-ansi-colors", 'i');
     args_parser.add_option(s_disable_source_location_hints, "Disable source location hints", "disable-source-location-hints", 'h');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
+    args_parser.add_option(incremental_gc, "Mark the heap incrementally between allocations", "incremental-gc", 'I');
+    args_parser.add_option(print_gc_statistics, "Print GC pause time statistics on exit", "gc-statistics", 'G');
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
     args_parser.add_option(evaluate_script, "Evaluate argument as a script", "evaluate", 'c', "script");
     args_parser.add_positional_argument(script_paths, "Path to script files", "scripts", Core::ArgsParser::Required::No);
@@ -1399,6 +1403,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         ReplConsoleClient console_client(interpreter->global_object().console());
         interpreter->global_object().console().set_client(console_client);
         interpreter->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
+        interpreter->heap().set_incremental_marking_enabled(incremental_gc);
 
         auto& global_environment = interpreter->realm().global_environment();
 
@@ -1610,6 +1615,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         ReplConsoleClient console_client(interpreter->global_object().console());
         interpreter->global_object().console().set_client(console_client);
         interpreter->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
+        interpreter->heap().set_incremental_marking_enabled(incremental_gc);
 
         signal(SIGINT, [](int) {
             sigint_handler();
@@ -1641,5 +1647,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             return 1;
     }
 
+    if (print_gc_statistics)
+        interpreter->heap().dump_pause_time_statistics();
+
     return 0;
 }
@@ -318,6 +318,12 @@ private:
             m_loop.deferred_invoke([this]() {
                 read_sql();
             });
+        } else if (command == ".stats") {
+            auto statistics = m_sql_client->cache_statistics(m_connection_id);
+            outln("Page cache: {} hit(s), {} miss(es), {} eviction(s), {} block(s) written", statistics.hits(), statistics.misses(), statistics.evictions(), statistics.writebacks());
+            m_loop.deferred_invoke([this]() {
+                read_sql();
+            });
         } else {
             outln("\033[33;1mUnrecognized command:\033[0m {}", command);
         }
@@ -6,6 +6,7 @@
  */
 
 #include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
 #include <LibCore/FileStream.h>
 #include <LibLine/Editor.h>
@@ -275,6 +276,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool debug = false;
     bool export_all_imports = false;
     bool shell_mode = false;
+    bool no_compile = false;
+    unsigned benchmark_iterations = 0;
     String exported_function_to_execute;
     Vector<u64> values_to_push;
     Vector<String> modules_to_link_in;
@@ -287,6 +290,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     parser.add_option(exported_function_to_execute, "Attempt to execute the named exported function from the module (implies -i)", "execute", 'e', "name");
     parser.add_option(export_all_imports, "Export noop functions corresponding to imports", "export-noop", 0);
     parser.add_option(shell_mode, "Launch a REPL in the module's context (implies -i)", "shell", 's');
+    parser.add_option(no_compile, "Run functions on the stack-based interpreter instead of compiling them first", "no-compile", 0);
+    parser.add_option(benchmark_iterations, "Execute the function this many times and print how long that took", "benchmark", 'b', "iterations");
     parser.add_option(Core::ArgsParser::Option {
         .requires_argument = true,
         .help_string = "Extra modules to link with, use to resolve imports",
@@ -334,6 +339,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (!exported_function_to_execute.is_empty())
         attempt_instantiate = true;
 
+    if (no_compile)
+        g_interpreter.set_compiled_execution_enabled(false);
+
     auto parse_result = parse(filename);
     if (!parse_result.has_value())
         return 1;
@@ -510,6 +518,19 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
                 outln();
             }
 
+            if (benchmark_iterations > 0) {
+                auto timer = Core::ElapsedTimer::start_new();
+                for (unsigned i = 0; i < benchmark_iterations; ++i) {
+                    auto result = machine.invoke(g_interpreter, run_address.value(), values);
+                    if (result.is_trap()) {
+                        warnln("Execution trapped: {}", result.trap().reason);
+                        return 1;
+                    }
+                }
+                auto elapsed_ms = timer.elapsed();
+                outln("{}: {} iterations in {} ms ({:.3} ms per iteration)", exported_function_to_execute, benchmark_iterations, elapsed_ms, static_cast<double>(elapsed_ms) / benchmark_iterations);
+            }
+
             auto result = machine.invoke(g_interpreter, run_address.value(), move(values));
 
             if (debug)
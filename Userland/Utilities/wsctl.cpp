@@ -13,11 +13,24 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     auto app = GUI::Application::construct(arguments);
 
     int flash_flush = -1;
+    bool show_statistics = false;
     Core::ArgsParser args_parser;
     args_parser.add_option(flash_flush, "Flash flush (repaint) rectangles", "flash-flush", 'f', "0/1");
+    args_parser.add_option(show_statistics, "Show compositor frame time statistics", "stats", 's');
     args_parser.parse(arguments);
 
     if (flash_flush != -1)
         GUI::WindowServerConnection::the().async_set_flash_flush(flash_flush);
+
+    if (show_statistics) {
+        auto statistics = GUI::WindowServerConnection::the().get_compositor_statistics();
+        auto frame_count = statistics.frame_count();
+        outln("Frames composed:    {}", frame_count);
+        outln("Last compose time:  {} us", statistics.last_compose_time_us());
+        outln("Avg. compose time:  {} us", frame_count > 0 ? statistics.total_compose_time_us() / frame_count : 0);
+        outln("Max. compose time:  {} us", statistics.max_compose_time_us());
+        outln("Tiles in last frame: {}", statistics.last_tile_count());
+        outln("Compositor threads: {}", statistics.thread_count());
+    }
     return 0;
 }